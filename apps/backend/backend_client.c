@@ -71,6 +71,8 @@
 #include "backend_handle.h"
 #include "backend_get.h"
 #include "backend_client.h"
+#include "backend_private.h"
+#include "backend_history.h"
 
 /*! Find client by session-id 
  * @param[in] ce_list   List of clients
@@ -211,6 +213,8 @@ backend_client_rm(clicon_handle        h,
                 ce->ce_s = 0;
                 if (release_all_dbs(h, ce->ce_id) < 0)
                     return -1;
+                if (private_candidate_free(h, ce) < 0)
+                    return -1;
             }
             break;
         }
@@ -362,6 +366,8 @@ from_client_edit_config(clicon_handle h,
             goto done;
         goto ok;
     }
+    if (private_candidate_db(h, ce, target, &target) < 0)
+        goto done;
     /* Check if target locked by other client */
     iddb = xmldb_islocked(h, target);
     if (iddb && myid != iddb){
@@ -483,14 +489,25 @@ from_client_edit_config(clicon_handle h,
                 break;
             }
         }
-        if ((ret = candidate_commit(h, NULL, "candidate", cbret)) < 0){ /* Assume validation fail, nofatal */
+        if (ce->ce_privdb)
+            ret = private_candidate_commit(h, ce, NULL, cbret);
+        else
+            ret = candidate_commit(h, NULL, "candidate", cbret);
+        if (ret < 0){ /* Assume validation fail, nofatal */
             if (netconf_operation_failed(cbret, "application", clicon_err_reason)< 0)
                 goto done;
-            xmldb_copy(h, "running", "candidate");
+            if (ce->ce_privdb)
+                private_candidate_discard(h, ce);
+            else
+                xmldb_copy(h, "running", "candidate");
             goto ok;
         }
         if (ret == 0){ /* discard */
-            if (xmldb_copy(h, "running", "candidate") < 0){
+            if (ce->ce_privdb)
+                ret = private_candidate_discard(h, ce);
+            else
+                ret = xmldb_copy(h, "running", "candidate");
+            if (ret < 0){
                 if (netconf_operation_failed(cbret, "application", clicon_err_reason)< 0)
                     goto done;
                 goto ok;
@@ -584,6 +601,10 @@ from_client_copy_config(clicon_handle h,
             goto done;
         goto ok;
     }
+    if (private_candidate_db(h, ce, source, &source) < 0)
+        goto done;
+    if (private_candidate_db(h, ce, target, &target) < 0)
+        goto done;
     /* Check if target locked by other client */
     iddb = xmldb_islocked(h, target);
     if (iddb && myid != iddb){
@@ -655,6 +676,8 @@ from_client_delete_config(clicon_handle h,
             goto done;
         goto ok;
     }
+    if (private_candidate_db(h, ce, target, &target) < 0)
+        goto done;
     /* Check if target locked by other client */
     iddb = xmldb_islocked(h, target);
     if (iddb && myid != iddb){
@@ -740,6 +763,9 @@ from_client_lock(clicon_handle h,
             goto done;
         goto ok;
     }
+    /* A private candidate is only modified by this session, 2) below does not apply */
+    if (private_candidate_db(h, ce, db, &db) < 0)
+        goto done;
     /*
      * A lock MUST not be granted if either of the following conditions is true:
      * 1) A lock is already held by any NETCONF session or another entity.
@@ -827,6 +853,8 @@ from_client_unlock(clicon_handle h,
             goto done;
         goto ok;
     }
+    if (private_candidate_db(h, ce, db, &db) < 0)
+        goto done;
     iddb = xmldb_islocked(h, db);
     /* 
      * An unlock operation will not succeed if any of the following
@@ -1386,6 +1414,8 @@ from_client_hello(clicon_handle       h,
 {
     int      retval = -1;
     uint32_t id;
+    cxobj   *xcaps;
+    cxobj   *xc;
 
     if (clicon_session_id_get(h, &id) < 0){
         clicon_err(OE_NETCONF, ENOENT, "session_id not set");
@@ -1393,8 +1423,22 @@ from_client_hello(clicon_handle       h,
     }
     id++;
     clicon_session_id_set(h, id);
-    cprintf(cbret, "<hello xmlns=\"%s\"><session-id>%u</session-id></hello>",
+    /* Binary encoded replies if client supports it */
+    ce->ce_binary = 0;
+    if (clicon_option_bool(h, "CLICON_SOCK_BINARY") &&
+        (xcaps = xml_find_type(x, NULL, "capabilities", CX_ELMNT)) != NULL){
+        xc = NULL;
+        while ((xc = xml_child_each(xcaps, xc, CX_ELMNT)) != NULL)
+            if (strcmp(xml_name(xc), "capability") == 0 &&
+                xml_body(xc) && strcmp(xml_body(xc), CLIXON_BIN_CAPABILITY) == 0)
+                ce->ce_binary = 1;
+    }
+    cprintf(cbret, "<hello xmlns=\"%s\"><session-id>%u</session-id>",
             NETCONF_BASE_NAMESPACE, id);
+    if (ce->ce_binary)
+        cprintf(cbret, "<capabilities><capability>%s</capability></capabilities>",
+                CLIXON_BIN_CAPABILITY);
+    cprintf(cbret, "</hello>");
     retval = 0;
  done:
     return retval;
@@ -1443,6 +1487,11 @@ from_client_msg(clicon_handle        h,
         clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
     }
+    if (clicon_msg_binary(msg) && !clicon_option_bool(h, "CLICON_SOCK_BINARY")){
+        if (netconf_malformed_message(cbret, "Binary encoding not enabled") < 0)
+            goto done;
+        goto reply;
+    }
     /* Decode msg from client -> xml top (ct) and session id 
      * Bind is a part of the decode function
      */
@@ -1590,7 +1639,8 @@ from_client_msg(clicon_handle        h,
     if (cbuf_len(cbret) == 0)
         if (netconf_operation_failed(cbret, "application", clicon_errno?clicon_err_reason:"unknown")< 0)
             goto done;
-    clicon_debug(1, "%s cbret:%s", __FUNCTION__, cbuf_get(cbret));
+    clicon_debug(1, "%s cbret:%s", __FUNCTION__,
+                 clixon_bin_magic(cbuf_get(cbret), cbuf_len(cbret))?"(binary)":cbuf_get(cbret));
     /* XXX problem here is that cbret has not been parsed so may contain 
        parse errors */
     if (send_msg_reply(ce->ce_s, cbuf_get(cbret), cbuf_len(cbret)+1) < 0){
@@ -1751,6 +1801,12 @@ backend_rpc_init(clicon_handle h)
     if (rpc_callback_register(h, from_client_process_control, NULL,
                               CLIXON_LIB_NS, "process-control") < 0)
         goto done;
+    if (rpc_callback_register(h, from_client_expand_values, NULL,
+                              CLIXON_LIB_NS, "expand-values") < 0)
+        goto done;
+    if (rpc_callback_register(h, from_client_rollback, NULL,
+                              CLIXON_LIB_NS, "rollback") < 0)
+        goto done;
     retval =0;
  done:
     return retval;
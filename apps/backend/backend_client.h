@@ -54,6 +54,10 @@ struct client_entry{
     uint32_t              ce_id;      /* Session id, accessor functions: clicon_session_id_get/set */
     char                 *ce_username;/* Translated from peer user cred */
     clicon_handle         ce_handle;  /* clicon config handle (all clients have same?) */
+    int                   ce_binary;  /* Binary encoded replies negotiated in hello */
+    char                 *ce_privdb;  /* Private candidate, see CLICON_XMLDB_PRIVATE_CANDIDATE */
+    cxobj                *ce_privbase;/* Copy of running that ce_privdb is based on */
+    uint64_t              ce_privgen; /* Generation of running when ce_privbase was copied */
 };
 
 /*
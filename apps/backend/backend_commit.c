@@ -70,6 +70,8 @@
 #include "backend_handle.h"
 #include "clixon_backend_commit.h"
 #include "backend_client.h"
+#include "backend_private.h"
+#include "backend_history.h"
 
 /*! Key values are checked for validity independent of user-defined callbacks
  *
@@ -99,8 +101,16 @@ generic_validate(clicon_handle       h,
     int        ret;
     cbuf      *cb = NULL;
 
+    if (clicon_option_bool(h, "CLICON_VALIDATE_INCREMENTAL")){
+        /* Changed entries and constraints depending on them */
+        if ((ret = xml_yang_validate_changes(h, td->td_target,
+                                             td->td_dvec, td->td_dlen,
+                                             td->td_avec, td->td_alen,
+                                             td->td_tcvec, td->td_clen, xret)) < 0)
+            goto done;
+    }
     /* All entries */
-    if ((ret = xml_yang_validate_all_top(h, td->td_target, xret)) < 0) 
+    else if ((ret = xml_yang_validate_all_top(h, td->td_target, xret)) < 0) 
         goto done;
     if (ret == 0)
         goto fail;
@@ -706,7 +716,10 @@ candidate_commit(clicon_handle h,
      /* After commit, make a post-commit call (sure that all plugins have committed) */
      if (plugin_transaction_commit_done_all(h, td) < 0)
          goto done;
-     
+     /* Add reverse diff to commit history, while source tree and vectors are valid */
+     if (history_commit(h, td) < 0)
+         goto done;
+
      /* Clear cached trees from default values and marking */
      if (xmldb_get0_clear(h, td->td_target) < 0)
          goto done;
@@ -718,6 +731,9 @@ candidate_commit(clicon_handle h,
      if (xmldb_copy(h, db, "running") < 0)
          goto done;
      xmldb_modified_set(h, db, 0); /* reset dirty bit */
+     /* State may depend on config, do not serve state cached before the commit */
+     if (clixon_statedata_cache_invalidate(h, NULL, NULL) < 0)
+         goto done;
      /* Here pointers to old (source) tree are obsolete */
      if (td->td_dvec){
          td->td_dlen = 0;
@@ -815,7 +831,11 @@ from_client_commit(clicon_handle h,
             goto done;
         goto ok;
     }
-    if ((ret = candidate_commit(h, xe, "candidate", cbret)) < 0){ /* Assume validation fail, nofatal */
+    if (clicon_option_bool(h, "CLICON_XMLDB_PRIVATE_CANDIDATE"))
+        ret = private_candidate_commit(h, ce, xe, cbret);
+    else
+        ret = candidate_commit(h, xe, "candidate", cbret);
+    if (ret < 0){ /* Assume validation fail, nofatal */
         clicon_debug(1, "Commit candidate failed");
         if (ret < 0)
             if (netconf_operation_failed(cbret, "application", clicon_err_reason)< 0)
@@ -856,9 +876,12 @@ from_client_discard_changes(clicon_handle h,
     uint32_t             myid = ce->ce_id;
     uint32_t             iddb;
     cbuf                *cbx = NULL; /* Assist cbuf */
-    
+    char                *db;
+
+    if (private_candidate_db(h, ce, "candidate", &db) < 0)
+        goto done;
     /* Check if target locked by other client */
-    iddb = xmldb_islocked(h, "candidate");
+    iddb = xmldb_islocked(h, db);
     if (iddb && myid != iddb){
         if ((cbx = cbuf_new()) == NULL){
             clicon_err(OE_XML, errno, "cbuf_new");
@@ -869,12 +892,21 @@ from_client_discard_changes(clicon_handle h,
             goto done;
         goto ok;
     }
-    if (xmldb_copy(h, "running", "candidate") < 0){
-        if (netconf_operation_failed(cbret, "application", clicon_err_reason)< 0)
-            goto done;
-        goto ok;
+    if (ce->ce_privdb){
+        if (private_candidate_discard(h, ce) < 0){
+            if (netconf_operation_failed(cbret, "application", clicon_err_reason)< 0)
+                goto done;
+            goto ok;
+        }
+    }
+    else{
+        if (xmldb_copy(h, "running", "candidate") < 0){
+            if (netconf_operation_failed(cbret, "application", clicon_err_reason)< 0)
+                goto done;
+            goto ok;
+        }
+        xmldb_modified_set(h, "candidate", 0); /* reset dirty bit */
     }
-    xmldb_modified_set(h, "candidate", 0); /* reset dirty bit */
     cprintf(cbret, "<rpc-reply xmlns=\"%s\"><ok/></rpc-reply>", NETCONF_BASE_NAMESPACE);
  ok:
     retval = 0;
@@ -901,9 +933,10 @@ from_client_validate(clicon_handle h,
                      void         *arg,
                      void         *regarg)
 {
-    int   retval = -1;
-    int   ret;
-    char *db;
+    int                  retval = -1;
+    int                  ret;
+    char                *db;
+    struct client_entry *ce = (struct client_entry *)arg;
 
     clicon_debug(1, "%s", __FUNCTION__);
     if ((db = netconf_db_find(xe, "source")) == NULL){
@@ -911,6 +944,8 @@ from_client_validate(clicon_handle h,
             goto done;
         goto ok;
     }
+    if (private_candidate_db(h, ce, db, &db) < 0)
+        goto done;
     if ((ret = candidate_validate(h, db, cbret)) < 0)
         goto done;
     if (ret == 1)
@@ -70,6 +70,7 @@
 #include "backend_handle.h"
 #include "clixon_backend_commit.h"
 #include "backend_client.h"
+#include "backend_history.h"
 
 /* 
  * Local types 
@@ -390,6 +391,8 @@ cancel_confirmed_commit(clicon_handle h)
 
     if (xmldb_delete(h, "rollback") < 0)
         clicon_err(OE_DB, 0, "Error deleting the rollback configuration");
+    if (history_unmark(h) < 0)
+        clicon_err(OE_DB, 0, "Error unmarking the confirmed-commit in the commit history");
     return 0;
 }
 
@@ -574,10 +577,15 @@ handle_confirmed_commit(clicon_handle h,
          *     rollback database will be committed to running and then deleted.  If the system is configured to use a
          *     startup configuration instead, any present rollback database will be deleted.
          *
+         * With a commit history (CLICON_XMLDB_HISTORY), running is not copied. Instead the start of
+         * the sequence is marked in the history and the rollback database is created from the
+         * reverse diffs of the commits after the mark, only if there is a rollback.
          */
-
-        db_exists = xmldb_exists(h, "rollback");
-        if (db_exists == -1) {
+        if (clicon_option_int(h, "CLICON_XMLDB_HISTORY") > 0){
+            if (!history_marked(h) && history_mark(h) < 0)
+                goto done;
+        }
+        else if ((db_exists = xmldb_exists(h, "rollback")) == -1) {
             clicon_err(OE_DAEMON, 0, "there was an error while checking existence of the rollback database");
             goto done;
         } else if (db_exists == 0) {
@@ -602,6 +610,8 @@ handle_confirmed_commit(clicon_handle h,
             clicon_err(OE_DB, 0, "Error deleting the rollback configuration");
             goto done;
         }
+        if (history_unmark(h) < 0)
+            goto done;
     }
     retval = 0;
  done:
@@ -650,7 +660,10 @@ do_rollback(clicon_handle h,
         confirmed_commit_persist_id_set(h, NULL);
     }
     confirmed_commit_state_set(h, ROLLBACK);
-    if (candidate_commit(h, NULL, "rollback", cbret) < 0) { /* Assume validation fail, nofatal */
+    /* With a commit history, create the rollback database from the reverse diffs */
+    if ((clicon_option_int(h, "CLICON_XMLDB_HISTORY") > 0 &&
+         history_mark_db(h, "rollback") < 1) ||
+        candidate_commit(h, NULL, "rollback", cbret) < 0) { /* Assume validation fail, nofatal */
         /* theoretically, this should never error, since the rollback database was previously active and therefore
          * had itself been previously and successfully committed.
          */
@@ -685,6 +698,8 @@ do_rollback(clicon_handle h,
     };
     retval = 0;
  done:
+    if (history_unmark(h) < 0)
+        clicon_log(LOG_WARNING, "A rollback occurred but the commit history wasn't unmarked.");
     confirmed_commit_state_set(h, INACTIVE);
     if (errs)
         *errs = errstate;
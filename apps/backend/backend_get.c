@@ -72,6 +72,7 @@
 #include "backend_client.h"
 #include "backend_handle.h"
 #include "backend_get.h"
+#include "backend_private.h"
 
 /*!
  * Maybe should be in the restconf client instead of backend?
@@ -383,57 +384,122 @@ filter_xpath_again(clicon_handle h,
     return retval;
 }
 
-/*! Help function for NACM access and returnmessage
+/*! Help function for NACM read access, remove nodes the user may not read
  *
  * @param[in]  h        Clicon handle 
  * @param[in]  xret     Result XML tree
- * @param[in]  xvec    xpath lookup result on xret
- * @param[in]  xlen    length of xvec
- * @param[in]  xpath    XPath point to object to get
- * @param[in]  nsc      Namespace context of xpath
+ * @param[in]  xvec     xpath lookup result on xret
+ * @param[in]  xlen     length of xvec
  * @param[in]  username User name for NACM access
- * @param[in]  depth    Nr of levels to print, -1 is all, 0 is none
- * @param[out] cbret    Return xml tree, eg <rpc-reply>..., <rpc-error.. 
  * @retval     0        OK
  * @retval    -1        Error
  */
 static int
-get_nacm_and_reply(clicon_handle h,
-                   cxobj        *xret,
-                   cxobj       **xvec,
-                   size_t        xlen,
-                   char         *xpath,
-                   cvec         *nsc,
-                   char         *username,
-                   int32_t       depth,
-                   cbuf         *cbret)
+get_nacm(clicon_handle h,
+         cxobj        *xret,
+         cxobj       **xvec,
+         size_t        xlen,
+         char         *username)
 {
-    int     retval = -1;
-    cxobj  *xnacm = NULL;
+    cxobj *xnacm;
 
     /* Pre-NACM access step */
     xnacm = clicon_nacm_cache(h);
     if (xnacm != NULL){ /* Do NACM validation */
         /* NACM datanode/module read validation */
         if (nacm_datanode_read(h, xret, xvec, xlen, username, xnacm) < 0) 
+            return -1;
+    }
+    return 0;
+}
+
+/*! Help function for return message
+ *
+ * @param[in]  xret     Result XML tree, NACM already applied
+ * @param[in]  depth    Nr of levels to print, -1 is all, 0 is none
+ * @param[in]  binary   Binary encoded reply, as negotiated with client in hello
+ * @param[out] cbret    Return xml tree, eg <rpc-reply>..., <rpc-error.. 
+ * @retval     0        OK
+ * @retval    -1        Error
+ */
+static int
+get_reply(cxobj  *xret,
+          int32_t depth,
+          int     binary,
+          cbuf   *cbret)
+{
+    int             retval = -1;
+    clixon_bin_enc *be = NULL;
+
+    if (xret && xml_name_set(xret, NETCONF_OUTPUT_DATA) < 0)
+        goto done;
+    if (binary && cbuf_len(cbret) == 0){
+        if ((be = clixon_bin_enc_new(cbret)) == NULL)
+            goto done;
+        if (clixon_bin_enc_elmnt(be, NULL, "rpc-reply") < 0 ||
+            clixon_bin_enc_attr(be, NULL, "xmlns", NETCONF_BASE_NAMESPACE) < 0)
+            goto done;
+        if (xret == NULL){
+            if (clixon_bin_enc_elmnt(be, NULL, NETCONF_OUTPUT_DATA) < 0 ||
+                clixon_bin_enc_end(be) < 0)
+                goto done;
+        }
+        else if (clixon_bin_enc_xml(be, xret, depth>0?depth+1:depth) < 0)
             goto done;
+        if (clixon_bin_enc_end(be) < 0 || /* rpc-reply */
+            clixon_bin_enc_end(be) < 0)   /* message */
+            goto done;
+        goto ok;
     }
     cprintf(cbret, "<rpc-reply xmlns=\"%s\">", NETCONF_BASE_NAMESPACE);     /* OK */
     if (xret==NULL)
         cprintf(cbret, "<data/>");
     else{
-        if (xml_name_set(xret, NETCONF_OUTPUT_DATA) < 0)
-            goto done;
         /* Top level is data, so add 1 to depth if significant */
         if (clixon_xml2cbuf(cbret, xret, 0, 0, depth>0?depth+1:depth, 0) < 0)
             goto done;
     }
     cprintf(cbret, "</rpc-reply>");
+ ok:
     retval = 0;
  done:
+    if (be)
+        clixon_bin_enc_free(be);
     return retval;
 }
 
+/*! Help function for NACM access and returnmessage
+ *
+ * @param[in]  h        Clicon handle 
+ * @param[in]  xret     Result XML tree
+ * @param[in]  xvec     xpath lookup result on xret
+ * @param[in]  xlen     length of xvec
+ * @param[in]  xpath    XPath point to object to get
+ * @param[in]  nsc      Namespace context of xpath
+ * @param[in]  username User name for NACM access
+ * @param[in]  depth    Nr of levels to print, -1 is all, 0 is none
+ * @param[in]  binary   Binary encoded reply, as negotiated with client in hello
+ * @param[out] cbret    Return xml tree, eg <rpc-reply>..., <rpc-error.. 
+ * @retval     0        OK
+ * @retval    -1        Error
+ */
+static int
+get_nacm_and_reply(clicon_handle h,
+                   cxobj        *xret,
+                   cxobj       **xvec,
+                   size_t        xlen,
+                   char         *xpath,
+                   cvec         *nsc,
+                   char         *username,
+                   int32_t       depth,
+                   int           binary,
+                   cbuf         *cbret)
+{
+    if (get_nacm(h, xret, xvec, xlen, username) < 0)
+        return -1;
+    return get_reply(xret, depth, binary, cbret);
+}
+
 /*! Help function for parsing restconf query parameter and setting netconf attribute
  *
  * If not "unbounded", parse and set a numeric value
@@ -495,6 +561,599 @@ list_pagination_hdr(clicon_handle h,
     return retval;
 }
 
+/* Key of list-pagination sort cache in clicon handle */
+#define LIST_PAGINATION_SORT "list-pagination-sort"
+
+/*! Cached sort permutation of config list entries, see sort-by
+ *
+ * The vector points to entries in the datastore cache and is valid as long as the 
+ * generation of the datastore is unchanged
+ */
+typedef struct {
+    qelem_t   ls_qelem;    /* List header */
+    char     *ls_db;       /* Datastore name */
+    char     *ls_xpath;    /* Canonical xpath of list */
+    char     *ls_sortby;   /* Value of sort-by parameter */
+    uint64_t  ls_gen;      /* Generation of datastore cache, see de_gen */
+    cxobj   **ls_vec;      /* Entries in sort-by order */
+    size_t    ls_len;      /* Length of ls_vec */
+} list_sort_t;
+
+/*! List-pagination sort cache, LRU of at most LIST_PAGINATION_SORT_NR sorts
+ */
+typedef struct {
+    list_sort_t *lc_sorts; /* Most recently used first */
+    int          lc_nr;
+} list_sort_cache;
+
+/*! Sort entry used when building a sort permutation
+ */
+typedef struct {
+    cxobj  *se_x;   /* List entry */
+    cg_var *se_cv;  /* Value of sort-by node, NULL if missing */
+    size_t  se_i;   /* Original (key) position, keeps sort stable */
+} list_sort_entry;
+
+static int
+list_sort_free(list_sort_t *ls)
+{
+    if (ls->ls_db)
+        free(ls->ls_db);
+    if (ls->ls_xpath)
+        free(ls->ls_xpath);
+    if (ls->ls_sortby)
+        free(ls->ls_sortby);
+    if (ls->ls_vec)
+        free(ls->ls_vec);
+    free(ls);
+    return 0;
+}
+
+/*! Free list-pagination sort cache
+ *
+ * @param[in]  h      Clicon handle
+ */
+int
+list_pagination_sort_free(clicon_handle h)
+{
+    list_sort_cache *lc = NULL;
+    list_sort_t     *ls;
+
+    if (clicon_ptr_get(h, LIST_PAGINATION_SORT, (void**)&lc) == 0 && lc != NULL){
+        while ((ls = lc->lc_sorts) != NULL){
+            DELQ(ls, lc->lc_sorts, list_sort_t *);
+            list_sort_free(ls);
+        }
+        free(lc);
+        clicon_ptr_del(h, LIST_PAGINATION_SORT);
+    }
+    return 0;
+}
+
+/*! Sort ascending on value, missing values last, and otherwise keep original order
+ */
+static int
+list_sort_cmp(const void *arg1,
+              const void *arg2)
+{
+    const list_sort_entry *se1 = arg1;
+    const list_sort_entry *se2 = arg2;
+    int                    eq;
+
+    if (se1->se_cv != NULL && se2->se_cv != NULL){
+        if ((eq = cv_cmp(se1->se_cv, se2->se_cv)) != 0)
+            return eq;
+    }
+    else if (se1->se_cv != NULL)
+        return -1;
+    else if (se2->se_cv != NULL)
+        return 1;
+    return se1->se_i < se2->se_i ? -1 : se1->se_i > se2->se_i;
+}
+
+/*! Sort list entries on the value of a descendant leaf given by sort-by
+ *
+ * Values are parsed according to the yang type of the leaf, ie integers are sorted 
+ * numerically. Entries where the leaf is missing, or the value cannot be parsed, are
+ * sorted last.
+ * @param[in]  ylist  Yang of list
+ * @param[in]  sortby Descendant schema node id, eg "stats/count", prefixes are ignored
+ * @param[in]  ev     List entries in original order
+ * @param[in]  en     Length of ev
+ * @param[out] svp    Sorted vector of entries, free with free()
+ * @param[out] cbret  Return xml tree, eg <rpc-error.. 
+ * @retval     1      OK
+ * @retval     0      Invalid sort-by, netconf error in cbret
+ * @retval    -1      Error
+ */
+static int
+list_sort_build(yang_stmt *ylist,
+                char      *sortby,
+                cxobj    **ev,
+                size_t     en,
+                cxobj   ***svp,
+                cbuf      *cbret)
+{
+    int              retval = -1;
+    char           **steps = NULL;
+    int              nsteps = 0;
+    char            *name;
+    yang_stmt       *y;
+    yang_stmt       *yrestype = NULL;
+    int              options = 0;
+    uint8_t          fraction = 0;
+    enum cv_type     cvtype;
+    list_sort_entry *se = NULL;
+    cxobj          **sv = NULL;
+    cxobj           *x;
+    char            *body;
+    char            *reason = NULL;
+    cbuf            *cbmsg = NULL;
+    size_t           i;
+    int              j;
+    int              ret;
+
+    if ((steps = clicon_strsep(sortby, "/", &nsteps)) == NULL)
+        goto done;
+    y = ylist;
+    for (j=0; j<nsteps && y != NULL; j++){
+        if (j > 0 && yang_keyword_get(y) != Y_CONTAINER){
+            y = NULL;
+            break;
+        }
+        if ((name = strchr(steps[j], ':')) != NULL)
+            name++;
+        else
+            name = steps[j];
+        y = yang_find_datanode(y, name);
+    }
+    if (y == NULL || yang_keyword_get(y) != Y_LEAF){
+        if ((cbmsg = cbuf_new()) == NULL){
+            clicon_err(OE_UNIX, errno, "cbuf_new");
+            goto done;
+        }
+        cprintf(cbmsg, "sort-by \"%s\" is not a descendant leaf of %s", sortby, yang_argument_get(ylist));
+        if (netconf_invalid_value(cbret, "application", cbuf_get(cbmsg)) < 0)
+            goto done;
+        goto fail;
+    }
+    if (yang_type_get(y, NULL, &yrestype, &options, NULL, NULL, NULL, &fraction) < 0)
+        goto done;
+    yang2cv_type(yang_argument_get(yrestype), &cvtype);
+    if (cvtype == CGV_ERR || cvtype == CGV_REST)
+        cvtype = CGV_STRING;
+    if ((se = calloc(en?en:1, sizeof(*se))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    for (i=0; i<en; i++){
+        se[i].se_x = ev[i];
+        se[i].se_i = i;
+        x = ev[i];
+        for (j=0; j<nsteps && x != NULL; j++){
+            if ((name = strchr(steps[j], ':')) != NULL)
+                name++;
+            else
+                name = steps[j];
+            x = xml_find_type(x, NULL, name, CX_ELMNT);
+        }
+        if (x == NULL || (body = xml_body(x)) == NULL)
+            continue;
+        if ((se[i].se_cv = cv_new(cvtype)) == NULL){
+            clicon_err(OE_UNIX, errno, "cv_new");
+            goto done;
+        }
+        if (cvtype == CGV_DEC64)
+            cv_dec64_n_set(se[i].se_cv, fraction);
+        if ((ret = cv_parse1(body, se[i].se_cv, &reason)) < 0){
+            clicon_err(OE_UNIX, errno, "cv_parse1");
+            goto done;
+        }
+        if (ret == 0){ /* Sort last */
+            cv_free(se[i].se_cv);
+            se[i].se_cv = NULL;
+        }
+        if (reason){
+            free(reason);
+            reason = NULL;
+        }
+    }
+    qsort(se, en, sizeof(*se), list_sort_cmp);
+    if ((sv = calloc(en?en:1, sizeof(cxobj *))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    for (i=0; i<en; i++)
+        sv[i] = se[i].se_x;
+    *svp = sv;
+    retval = 1;
+ done:
+    if (se){
+        for (i=0; i<en; i++)
+            if (se[i].se_cv)
+                cv_free(se[i].se_cv);
+        free(se);
+    }
+    if (reason)
+        free(reason);
+    if (cbmsg)
+        cbuf_free(cbmsg);
+    if (steps)
+        free(steps);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Get entries of a config list sorted by sort-by, from the sort cache if valid
+ *
+ * The cache is keyed on datastore, list xpath and sort-by, and is valid as long as the
+ * datastore generation is unchanged, ie paging through a sorted list sorts it only once.
+ * @param[in]  h      Clicon handle
+ * @param[in]  db     Datastore name
+ * @param[in]  gen    Datastore cache generation, or 0 if not cached
+ * @param[in]  ylist  Yang of list
+ * @param[in]  xpath  Canonical xpath of list
+ * @param[in]  sortby sort-by parameter
+ * @param[in]  ev     List entries in original order
+ * @param[in]  en     Length of ev
+ * @param[out] lsp    Sort, owned by cache unless its ls_gen is 0 where it is freed by caller
+ * @param[out] cbret  Return xml tree, eg <rpc-error.. 
+ * @retval     1      OK
+ * @retval     0      Invalid sort-by, netconf error in cbret
+ * @retval    -1      Error
+ */
+static int
+list_sort_get(clicon_handle h,
+              char         *db,
+              uint64_t      gen,
+              yang_stmt    *ylist,
+              char         *xpath,
+              char         *sortby,
+              cxobj       **ev,
+              size_t        en,
+              list_sort_t **lsp,
+              cbuf         *cbret)
+{
+    int              retval = -1;
+    list_sort_cache *lc = NULL;
+    list_sort_t     *ls = NULL;
+    cxobj          **sv = NULL;
+    int              ret;
+
+    if (gen && LIST_PAGINATION_SORT_NR > 0){
+        if (clicon_ptr_get(h, LIST_PAGINATION_SORT, (void**)&lc) < 0 || lc == NULL){
+            if ((lc = malloc(sizeof(*lc))) == NULL){
+                clicon_err(OE_UNIX, errno, "malloc");
+                goto done;
+            }
+            memset(lc, 0, sizeof(*lc));
+            if (clicon_ptr_set(h, LIST_PAGINATION_SORT, lc) < 0){
+                free(lc);
+                goto done;
+            }
+        }
+        if ((ls = lc->lc_sorts) != NULL){
+            do {
+                if (strcmp(ls->ls_db, db) == 0 &&
+                    strcmp(ls->ls_xpath, xpath) == 0 &&
+                    strcmp(ls->ls_sortby, sortby) == 0)
+                    break;
+                ls = NEXTQ(list_sort_t *, ls);
+            } while (ls != lc->lc_sorts);
+            if (strcmp(ls->ls_db, db) == 0 &&
+                strcmp(ls->ls_xpath, xpath) == 0 &&
+                strcmp(ls->ls_sortby, sortby) == 0){
+                DELQ(ls, lc->lc_sorts, list_sort_t *);
+                lc->lc_nr--;
+                if (ls->ls_gen == gen){
+                    clicon_debug(1, "%s hit %s %s", __FUNCTION__, xpath, sortby);
+                    INSQ(ls, lc->lc_sorts);
+                    lc->lc_nr++;
+                    *lsp = ls;
+                    goto ok;
+                }
+                list_sort_free(ls);
+            }
+        }
+        ls = NULL;
+    }
+    if ((ret = list_sort_build(ylist, sortby, ev, en, &sv, cbret)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    if ((ls = malloc(sizeof(*ls))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(ls, 0, sizeof(*ls));
+    ls->ls_gen = lc ? gen : 0;
+    ls->ls_vec = sv;
+    ls->ls_len = en;
+    sv = NULL;
+    if ((ls->ls_db = strdup(db)) == NULL ||
+        (ls->ls_xpath = strdup(xpath)) == NULL ||
+        (ls->ls_sortby = strdup(sortby)) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    if (lc != NULL){
+        INSQ(ls, lc->lc_sorts);
+        lc->lc_nr++;
+        while (lc->lc_nr > LIST_PAGINATION_SORT_NR){
+            list_sort_t *ll = PREVQ(list_sort_t *, lc->lc_sorts);
+            DELQ(ll, lc->lc_sorts, list_sort_t *);
+            lc->lc_nr--;
+            list_sort_free(ll);
+        }
+    }
+    *lsp = ls;
+    ls = NULL;
+ ok:
+    retval = 1;
+ done:
+    if (retval < 0 && ls)
+        list_sort_free(ls);
+    if (sv)
+        free(sv);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Get entries of a config list in a sorted datastore tree
+ *
+ * If the xpath is a path of a single parent node followed by the list name, the entries
+ * are a slice of the child vector of the parent, found by binary search. Otherwise
+ * the xpath is evaluated.
+ * @param[in]  xt     Top of sorted datastore tree
+ * @param[in]  ylist  Yang of list or leaf-list
+ * @param[in]  xpath  Canonical xpath of list
+ * @param[in]  nsc    Namespace context of xpath
+ * @param[out] evp    List entries
+ * @param[out] enp    Length of evp
+ * @param[out] vecp   Allocated vector to free with free(), or NULL if evp is a slice
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+list_pagination_entries(cxobj      *xt,
+                        yang_stmt  *ylist,
+                        char       *xpath,
+                        cvec       *nsc,
+                        cxobj    ***evp,
+                        size_t     *enp,
+                        cxobj    ***vecp)
+{
+    int     retval = -1;
+    cxobj **pvec = NULL;
+    size_t  plen = 0;
+    cxobj **vec = NULL;
+    size_t  len = 0;
+    char   *last = NULL;
+    char   *parent = NULL;
+    char    q = 0;
+    int     depth = 0;
+    char   *p;
+    int     low;
+    int     upper;
+
+    /* Find last step outside of predicates and quotes */
+    for (p = xpath; *p; p++){
+        if (q){
+            if (*p == q)
+                q = 0;
+        }
+        else if (*p == '\'' || *p == '"')
+            q = *p;
+        else if (*p == '[')
+            depth++;
+        else if (*p == ']')
+            depth--;
+        else if (*p == '/' && depth == 0)
+            last = p;
+    }
+    if (last != NULL && last != xpath && *(last-1) != '/' &&
+        strchr(last, '[') == NULL && strchr(xpath, '|') == NULL){
+        if ((parent = strndup(xpath, last-xpath)) == NULL){
+            clicon_err(OE_UNIX, errno, "strndup");
+            goto done;
+        }
+        if (xpath_vec(xt, nsc, "%s", &pvec, &plen, parent) < 0)
+            goto done;
+    }
+    else if (last == xpath && strchr(last, '[') == NULL && strchr(xpath, '|') == NULL){
+        pvec = NULL;  /* Top-level list */
+        plen = 1;
+    }
+    if (plen == 1){
+        if (clixon_xml_find_range(pvec?pvec[0]:xt, ylist, &low, &upper) < 0)
+            goto done;
+        *evp = xml_childvec_get(pvec?pvec[0]:xt) + low;
+        *enp = upper - low;
+        *vecp = NULL;
+    }
+    else {
+        if (xpath_vec(xt, nsc, "%s", &vec, &len, xpath) < 0)
+            goto done;
+        *evp = vec;
+        *enp = len;
+        *vecp = vec;
+        vec = NULL;
+    }
+    retval = 0;
+ done:
+    if (vec)
+        free(vec);
+    if (pvec)
+        free(pvec);
+    if (parent)
+        free(parent);
+    return retval;
+}
+
+/*! Get a page of a config list with list-pagination parameters
+ *
+ * Entries are not copied until the page is selected. With the datastore cache the
+ * list entries are taken directly from the cache, where offset/limit is a slice of the
+ * sorted child vector and sort-by uses a cached sort permutation. Without cache, the
+ * list is first read from the datastore.
+ * The "where" expression is evaluated on each entry in order until limit entries are found.
+ * @param[in]  h         Clicon handle
+ * @param[in]  db        Datastore name
+ * @param[in]  ylist     Yang of list or leaf-list
+ * @param[in]  xpath     Canonical xpath of list
+ * @param[in]  nsc       Namespace context of xpath
+ * @param[in]  offset    Number of entries to skip
+ * @param[in]  limit     Max number of entries, 0 is unbounded
+ * @param[in]  backwards Traverse entries last to first
+ * @param[in]  sortby    sort-by parameter or NULL
+ * @param[in]  where     where xpath or NULL
+ * @param[in]  nscw      Namespace context of where
+ * @param[in]  wdef      With-defaults parameter, see RFC 6243
+ * @param[out] xret      Result tree with page. Free with xml_free()
+ * @param[out] cbret     Return xml tree, eg <rpc-error.. 
+ * @retval     1         OK
+ * @retval     0         Invalid, netconf error in cbret
+ * @retval    -1         Error
+ */
+static int
+list_pagination_config(clicon_handle     h,
+                       char             *db,
+                       yang_stmt        *ylist,
+                       char             *xpath,
+                       cvec             *nsc,
+                       uint32_t          offset,
+                       uint32_t          limit,
+                       int               backwards,
+                       char             *sortby,
+                       char             *where,
+                       cvec             *nscw,
+                       withdefaults_type wdef,
+                       cxobj           **xret,
+                       cbuf             *cbret)
+{
+    int           retval = -1;
+    cxobj        *xt = NULL;
+    cxobj        *xcopy = NULL;
+    cxobj        *xerr = NULL;
+    cbuf         *cbmsg = NULL;
+    db_elmnt     *de;
+    uint64_t      gen = 0;
+    cxobj       **ev = NULL;
+    size_t        en = 0;
+    cxobj       **vec = NULL;
+    list_sort_t  *ls = NULL;
+    cxobj       **page = NULL;
+    size_t        n = 0;
+    size_t        max;
+    size_t        i;
+    cxobj        *x;
+    int           ret;
+
+    if (clicon_datastore_cache(h) != DATASTORE_NOCACHE){
+        if ((ret = xmldb_cache_load(h, db, &xt, &xerr)) < 0)
+            goto readerr;
+        if (ret == 0){
+            if (clixon_xml2cbuf(cbret, xerr, 0, 0, -1, 0) < 0)
+                goto done;
+            goto fail;
+        }
+        if ((de = clicon_db_elmnt_get(h, db)) != NULL)
+            gen = de->de_gen;
+    }
+    else {
+        if (xmldb_get0(h, db, YB_MODULE, nsc, xpath, 1, WITHDEFAULTS_REPORT_ALL, &xcopy, NULL, NULL) < 0)
+            goto readerr;
+        xt = xcopy;
+    }
+    if (list_pagination_entries(xt, ylist, xpath, nsc, &ev, &en, &vec) < 0)
+        goto done;
+    if (sortby){
+        if ((ret = list_sort_get(h, db, gen, ylist, xpath, sortby, ev, en, &ls, cbret)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+        ev = ls->ls_vec;
+    }
+    max = en;
+    if (limit && limit < max)
+        max = limit;
+    if ((page = calloc(max?max:1, sizeof(cxobj *))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    /* Without where, offset is a direct index */
+    i = where ? 0 : offset;
+    for (; i<en && n<max; i++){
+        x = backwards ? ev[en-1-i] : ev[i];
+        if (where){
+            if ((ret = xpath_vec_bool(x, nscw, "%s", where)) < 0)
+                goto done;
+            if (ret == 0)
+                continue;
+            if (offset){
+                offset--;
+                continue;
+            }
+        }
+        page[n++] = x;
+    }
+    if (xmldb_get_vec(h, xt, page, n, wdef, xret) < 0)
+        goto done;
+    retval = 1;
+ done:
+    if (page)
+        free(page);
+    if (ls && ls->ls_gen == 0)
+        list_sort_free(ls);
+    if (vec)
+        free(vec);
+    if (xcopy)
+        xml_free(xcopy);
+    if (xerr)
+        xml_free(xerr);
+    if (cbmsg)
+        cbuf_free(cbmsg);
+    return retval;
+ readerr:
+    if ((cbmsg = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cbmsg, "Get %s datastore: %s", db, clicon_err_reason);
+    if (netconf_operation_failed(cbret, "application", cbuf_get(cbmsg)) < 0)
+        goto done;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Context for collecting list entries in a page result tree
+ */
+typedef struct {
+    yang_stmt *lpc_yang; /* Yang of list */
+    cxobj    **lpc_vec;  /* Collected entries */
+    int        lpc_len;  /* Length of lpc_vec */
+} list_pagination_collect;
+
+/*! Collect list entries, dont descend into entries
+ */
+static int
+list_pagination_collect_fn(cxobj *x,
+                           void  *arg)
+{
+    list_pagination_collect *lpc = (list_pagination_collect *)arg;
+
+    if (xml_spec(x) != lpc->lpc_yang)
+        return 0;
+    if (cxvec_append(x, &lpc->lpc_vec, &lpc->lpc_len) < 0)
+        return -1;
+    return 2;
+}
+
 /*! Specialized get for list-pagination
  *
  * It is specialized enough to have its own function. Specifically, extra attributes as well
@@ -511,7 +1170,8 @@ list_pagination_hdr(clicon_handle h,
  * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error.. 
  * @retval     0       OK
  * @retval    -1       Error
- * @note pagination uses appending xpath with predicate, eg [position()<limit], this may not work 
+ * Config lists are paged directly in the datastore, see list_pagination_config.
+ * @note state lists use an appended xpath predicate, eg [position()<limit], this may not work 
  *       if there is an existing predicate
  * XXX Lots of this code (in particular at the end) is copy of get_common
  */
@@ -546,12 +1206,13 @@ get_list_pagination(clicon_handle        h,
     cbuf           *cberr = NULL; 
     cxobj         **xvec = NULL;
     size_t          xlen;
-#ifdef NOTYET
     cxobj          *x;
-    char           *direction = NULL;
-    char           *sort = NULL;
+    int             backwards = 0;
+    char           *sortby = NULL;
     char           *where = NULL;
-#endif
+    cvec           *nscw = NULL;
+    xpath_tree     *xptw = NULL;
+    list_pagination_collect lpc = {0,};
 
     if (cbret == NULL){
         clicon_err(OE_PLUGIN, EINVAL, "cbret is NULL");
@@ -594,33 +1255,59 @@ get_list_pagination(clicon_handle        h,
     }
     if ((ret = list_pagination_hdr(h, xe, &offset, &limit, cbret)) < 0)
         goto done;
-#ifdef NOTYET
     /* direction */
-    if (ret && (x = xml_find_type(xe, NULL, "direction", CX_ELMNT)) != NULL){
-        direction = xml_body(x);
-        if (strcmp(direction, "forward") != 0 && strcmp(direction, "reverse") != 0){
-            if (netconf_bad_attribute(cbret, "application",
-                                      "direction", "Unrecognized value of direction attribute") < 0)
+    if (ret && (x = xml_find_type(xe, NULL, "direction", CX_ELMNT)) != NULL &&
+        xml_body(x) != NULL){
+        if (strcmp(xml_body(x), "backwards") == 0)
+            backwards = 1;
+        else if (strcmp(xml_body(x), "forwards") != 0){
+            if (netconf_bad_element(cbret, "application",
+                                    "direction", "Unrecognized value of direction") < 0)
                 goto done;
             goto ok;
         }
     }
-    /* sort */
-    if (ret && (x = xml_find_type(xe, NULL, "sort-by", CX_ELMNT)) != NULL)
-        sort = xml_body(x);
-    if (sort) {
-        /* XXX: nothing yet */
+    /* sort-by */
+    if (ret && (x = xml_find_type(xe, NULL, "sort-by", CX_ELMNT)) != NULL &&
+        (sortby = xml_body(x)) != NULL &&
+        strcmp(sortby, "none") == 0)
+        sortby = NULL;
+    /* where, namespace context is the one in scope on the where element */
+    if (ret && (x = xml_find_type(xe, NULL, "where", CX_ELMNT)) != NULL &&
+        (where = xml_body(x)) != NULL){
+        if (strcmp(where, "unfiltered") == 0)
+            where = NULL;
+        else {
+            if (xpath_parse(where, &xptw) < 0){
+                if (netconf_invalid_value(cbret, "application", "Invalid where xpath expression") < 0)
+                    goto done;
+                goto ok;
+            }
+            if (xml_nsctx_node(x, &nscw) < 0)
+                goto done;
+        }
+    }
+    if (ret && !list_config && (backwards || sortby || where)){
+        if (netconf_operation_not_supported(cbret, "application", "list-pagination where, sort-by and direction are only supported for config lists") < 0)
+            goto done;
+        goto ok;
     }
-    /* where */
-    if (ret && (x = xml_find_type(xe, NULL, "where", CX_ELMNT)) != NULL)
-        where = xml_body(x);
-#endif
     if (ret == 0)
         goto ok;
     /* Read config */
     switch (content){
     case CONTENT_CONFIG:    /* config data only */
     case CONTENT_ALL:       /* both config and state */
+        if (list_config){
+            /* Select the page directly from the datastore */
+            if ((ret = list_pagination_config(h, db, ylist, xpath, nsc,
+                                              offset, limit, backwards, sortby,
+                                              where, nscw, wdef, &xret, cbret)) < 0)
+                goto done;
+            if (ret == 0)
+                goto ok;
+            break;
+        }
         /* Build a "predicate" cbuf 
          * This solution uses xpath predicates to translate "limit" and "offset" to
          * relational operators <>.
@@ -634,10 +1321,6 @@ get_list_pagination(clicon_handle        h,
             cprintf(cbpath, "%s", xpath);
         else
             cprintf(cbpath, "/");
-#ifdef NOTYET
-        if (where)
-            cprintf(cbpath, "[%s]", where);
-#endif
         if (offset){
             cprintf(cbpath, "[%u <= position()", offset);
             if (limit)
@@ -720,7 +1403,15 @@ get_list_pagination(clicon_handle        h,
             goto ok;
         }
     }
-    if (xpath_vec(xret, nsc, "%s", &xvec, &xlen, xpath?xpath:"/") < 0)
+    if (list_config){
+        /* Page entries are in page order and not necessarily sorted, do not use xpath */
+        lpc.lpc_yang = ylist;
+        if (xml_apply(xret, CX_ELMNT, list_pagination_collect_fn, &lpc) < 0)
+            goto done;
+        xvec = lpc.lpc_vec;
+        xlen = lpc.lpc_len;
+    }
+    else if (xpath_vec(xret, nsc, "%s", &xvec, &xlen, xpath?xpath:"/") < 0)
         goto done;
     /* Help function to filter out anything that is outside of xpath */
     if (filter_xpath_again(h, yspec, xret, xvec, xlen, xpath, nsc) < 0)
@@ -751,13 +1442,17 @@ get_list_pagination(clicon_handle        h,
             cbuf_free(cba);
     }
 #endif /* LIST_PAGINATION_REMAINING */
-    if (get_nacm_and_reply(h, xret, xvec, xlen, xpath, nsc, username, depth, cbret) < 0)
+    if (get_nacm_and_reply(h, xret, xvec, xlen, xpath, nsc, username, depth, ce->ce_binary, cbret) < 0)
         goto done;
  ok:
     retval = 0;
  done:
     if (xvec)
         free(xvec);
+    if (nscw)
+        cvec_free(nscw);
+    if (xptw)
+        xpath_tree_free(xptw);
     if (cbmsg)
         cbuf_free(cbmsg);
     if (cbpath)
@@ -783,6 +1478,8 @@ get_list_pagination(clicon_handle        h,
  * @retval    -1       Error
  * @see from_client_get
  * @see from_client_get_config 
+ * @note a <filter> without select attribute and with element children is a subtree filter,
+ *       it is compiled and applied here, see clixon_xml_filter_compile
  */
 static int
 get_common(clicon_handle        h,
@@ -795,8 +1492,11 @@ get_common(clicon_handle        h,
 {
     int             retval = -1;
     cxobj          *xfilter;
+    char           *ftype;
+    clixon_xml_filter *xsubtree = NULL;
     char           *xpath = NULL;
     cxobj          *xret = NULL;
+    cxobj          *xsel = NULL;
     char           *username;
     cvec           *nsc0 = NULL; /* Create a netconf namespace context from filter */
     cvec           *nsc = NULL;
@@ -811,7 +1511,7 @@ get_common(clicon_handle        h,
     cbuf           *cbreason = NULL;
     int             list_pagination = 0;
     cxobj         **xvec = NULL;
-    size_t          xlen;
+    size_t          xlen = 0;
     cxobj          *xfind;
     uint32_t        offset = 0;
     uint32_t        limit = 0;
@@ -831,7 +1531,18 @@ get_common(clicon_handle        h,
         clicon_err(OE_YANG, ENOENT, "No yang spec9");
         goto done;
     }
-    if ((xfilter = xml_find(xe, "filter")) != NULL){
+    if ((xfilter = xml_find(xe, "filter")) != NULL &&
+        xml_find_value(xfilter, "select") == NULL &&
+        ((ftype = xml_find_value(xfilter, "type")) == NULL || strcmp(ftype, "subtree") == 0) &&
+        xml_child_nr_type(xfilter, CX_ELMNT) > 0){
+        /* Subtree filter: compile it and narrow retrieval to its top-level nodes.
+         * The filter is applied after state data is added, see clixon_xml_filter_apply */
+        if (clixon_xml_filter_compile(yspec, xfilter, &xsubtree) < 0)
+            goto done;
+        if (clixon_xml_filter_xpath(xsubtree, &xpath, &nsc) < 0)
+            goto done;
+    }
+    else if (xfilter != NULL){
         if ((xpath0 = xml_find_value(xfilter, "select"))==NULL)
             xpath0 = "/";
         /* Create namespace context for xpath from <filter>
@@ -869,7 +1580,7 @@ get_common(clicon_handle        h,
     if ((xfind = xml_find_type(xe, NULL, "list-pagination", CX_ELMNT)) != NULL){
         /* with non-presence list-pagination, use ad-hoc algorithm to determine
          * whether list-pagination is enabled:
-         * offset!=0 && limit!=unbounded
+         * offset!=0 || limit!=unbounded || any of where, sort-by, direction is not default
          */
         /* offset */
         if ((ret = element2value(h, xfind, "offset", "none", cbret, &offset)) < 0)
@@ -879,7 +1590,13 @@ get_common(clicon_handle        h,
             goto done;
         if (ret == 0)
             goto ok;
-        list_pagination = (offset != 0 || limit != 0);
+        list_pagination = (offset != 0 || limit != 0 ||
+                           ((attr = xml_find_body(xfind, "where")) != NULL &&
+                            strcmp(attr, "unfiltered") != 0) ||
+                           ((attr = xml_find_body(xfind, "sort-by")) != NULL &&
+                            strcmp(attr, "none") != 0) ||
+                           ((attr = xml_find_body(xfind, "direction")) != NULL &&
+                            strcmp(attr, "forwards") != 0));
     }
     /* Sanity check for list pagination: path must be a list/leaf-list, if it is,
      * check config/state
@@ -996,10 +1713,26 @@ get_common(clicon_handle        h,
     }
     if (xpath_vec(xret, nsc, "%s", &xvec, &xlen, xpath?xpath:"/") < 0)
         goto done;
-    if (filter_xpath_again(h, yspec, xret, xvec, xlen, xpath, nsc) < 0)
-        goto done;
-    if (get_nacm_and_reply(h, xret, xvec, xlen, xpath, nsc, username, depth, cbret) < 0)
-        goto done;
+    if (xsubtree){
+        /* NACM before the subtree filter, so that content match nodes cannot test
+         * values the user may not read, see RFC 8341 Sec 3.2.4 */
+        if (get_nacm(h, xret, xvec, xlen, username) < 0)
+            goto done;
+        /* Copy only nodes selected by subtree filter */
+        if (clixon_xml_filter_apply(xsubtree, xret, &xsel) < 0)
+            goto done;
+        xml_free(xret);
+        xret = xsel;
+        xsel = NULL;
+        if (get_reply(xret, depth, ce->ce_binary, cbret) < 0)
+            goto done;
+    }
+    else{
+        if (filter_xpath_again(h, yspec, xret, xvec, xlen, xpath, nsc) < 0)
+            goto done;
+        if (get_nacm_and_reply(h, xret, xvec, xlen, xpath, nsc, username, depth, ce->ce_binary, cbret) < 0)
+            goto done;
+    }
  ok:
     retval = 0;
  done:
@@ -1008,6 +1741,10 @@ get_common(clicon_handle        h,
         free(xvec);
     if (xret)
         xml_free(xret);
+    if (xsel)
+        xml_free(xsel);
+    if (xsubtree)
+        clixon_xml_filter_free(xsubtree);
     if (cbreason)
         cbuf_free(cbreason);
     if (nsc0)
@@ -1051,6 +1788,8 @@ from_client_get_config(clicon_handle h,
         clicon_err(OE_XML, 0, "db not found");
         goto done;
     }
+    if (private_candidate_db(h, ce, db, &db) < 0)
+        goto done;
     retval = get_common(h, ce, xe, CONTENT_CONFIG, db, cbret);
  done:
     return retval;
@@ -1084,3 +1823,525 @@ from_client_get(clicon_handle h,
         content = netconf_content_str2int(attr);
     return get_common(h, ce, xe, content, "running", cbret);
 }
+
+/*! Split the last location step from an xpath, eg /a:x/a:y -> /a:x and a:y
+ *
+ * Only a plain child step is split, ie no predicates, functions, wildcards or "..".
+ * @param[in,out] xpath  XPath, the last step is cut off
+ * @param[out]    step   Last step, points into xpath
+ * @retval        1      OK
+ * @retval        0      No plain last step, xpath unchanged
+ */
+static int
+expand_xpath_split(char  *xpath,
+                   char **step)
+{
+    char *p;
+
+    if ((p = strrchr(xpath, '/')) == NULL)
+        return 0;
+    if (p[1] == '\0' ||
+        strpbrk(p+1, "[]()*@'\" ") != NULL ||
+        strcmp(p+1, ".") == 0 ||
+        strcmp(p+1, "..") == 0 ||
+        (p > xpath && *(p-1) == '/'))
+        return 0;
+    *p = '\0';
+    *step = p+1;
+    return 1;
+}
+
+/*! Append a value to an expand-values reply
+ * @param[in]  cbval  Values as XML
+ * @param[in]  str    Value
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+expand_value_add(cbuf *cbval,
+                 char *str)
+{
+    cprintf(cbval, "<value xmlns=\"%s\">", CLIXON_LIB_NS);
+    if (xml_chardata_cbuf_append(cbval, str) < 0)
+        return -1;
+    cprintf(cbval, "</value>");
+    return 0;
+}
+
+/*! Check if a value should be added as an exact match of an expand-values request
+ *
+ * Values starting with prefix are already added, unless the reply was truncated by limit.
+ * If truncated, the exact value is added unless it is among the prefix values added.
+ * @param[in]  str        Exact value
+ * @param[in]  prefix     Prefix of request or NULL
+ * @param[in]  truncated  Prefix values are truncated by limit
+ * @param[in]  cvv        Prefix values added, if limit is set
+ */
+static int
+expand_exact_needed(char *str,
+                    char *prefix,
+                    int   truncated,
+                    cvec *cvv)
+{
+    cg_var *cv = NULL;
+
+    if (prefix != NULL && strncmp(str, prefix, strlen(prefix)) != 0)
+        return 1;
+    if (!truncated)
+        return 0;
+    while ((cv = cvec_each(cvv, cv)) != NULL)
+        if (strcmp(cv_string_get(cv), str) == 0)
+            return 0;
+    return 1;
+}
+
+/*! Get yang of an xpath location step, <prefix>:<name>, as a child of yang parent
+ *
+ * @param[in]  yspec  Yang spec
+ * @param[in]  yp     Yang parent, or NULL for top-level
+ * @param[in]  step   Location step
+ * @param[in]  nsc    Namespace context of xpath
+ * @param[out] yc     Yang of child or NULL if not found
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+expand_step_yang(yang_stmt  *yspec,
+                 yang_stmt  *yp,
+                 char       *step,
+                 cvec       *nsc,
+                 yang_stmt **yc)
+{
+    int        retval = -1;
+    char      *prefix = NULL;
+    char      *id = NULL;
+    char      *ns;
+    char      *ns1;
+    yang_stmt *y = NULL;
+
+    if (nodeid_split(step, &prefix, &id) < 0)
+        goto done;
+    if ((ns = xml_nsctx_get(nsc, prefix)) == NULL)
+        goto ok;
+    if (yp == NULL)
+        yp = yang_find_module_by_namespace(yspec, ns);
+    if (yp == NULL ||
+        (y = yang_find_datanode(yp, id)) == NULL ||
+        (ns1 = yang_find_mynamespace(y)) == NULL ||
+        strcmp(ns, ns1) != 0)
+        y = NULL;
+ ok:
+    *yc = y;
+    retval = 0;
+ done:
+    if (prefix)
+        free(prefix);
+    if (id)
+        free(id);
+    return retval;
+}
+
+/*! Evaluate parent xpath of expanded values and get yang of the child step
+ *
+ * All parents must have the same yang spec
+ * @param[in]  yspec  Yang spec
+ * @param[in]  xt     Top-of-tree
+ * @param[in]  path   XPath of parents, "" is top-of-tree
+ * @param[in]  step   Location step of child
+ * @param[in]  nsc    Namespace context of xpath
+ * @param[out] xvec   Parent nodes, free with free()
+ * @param[out] xlen   Length of xvec
+ * @param[out] yc     Yang of child or NULL if not found or no parents
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+expand_parents(yang_stmt  *yspec,
+               cxobj      *xt,
+               char       *path,
+               char       *step,
+               cvec       *nsc,
+               cxobj    ***xvec,
+               size_t     *xlen,
+               yang_stmt **yc)
+{
+    int        retval = -1;
+    yang_stmt *yp;
+    int        i;
+
+    *yc = NULL;
+    if (*path == '\0'){
+        if ((*xvec = malloc(sizeof(cxobj *))) == NULL){
+            clicon_err(OE_UNIX, errno, "malloc");
+            goto done;
+        }
+        (*xvec)[0] = xt;
+        *xlen = 1;
+    }
+    else if (xpath_vec(xt, nsc, "%s", xvec, xlen, path) < 0)
+        goto done;
+    if (*xlen == 0)
+        goto ok;
+    yp = xml_spec((*xvec)[0]);
+    for (i=1; i<*xlen; i++)
+        if (xml_spec((*xvec)[i]) != yp)
+            goto ok;
+    if (yp == NULL || yang_keyword_get(yp) == Y_SPEC){
+        if (*xlen > 1 || xml_parent((*xvec)[0]) != NULL) /* Not bound */
+            goto ok;
+        yp = NULL;
+    }
+    if (expand_step_yang(yspec, yp, step, nsc, yc) < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Get values of list keys or leaf-lists directly from a datastore cache
+ *
+ * Applies if the xpath ends with the single key of a list: <path>/<list>/<key>, or with a
+ * leaf-list: <path>/<leaf-list>. Then <path> is evaluated and the values are found by
+ * prefix search in the sorted children, without copying the datastore.
+ * @param[in]  yspec   Yang spec
+ * @param[in]  xt      Datastore cache top-of-tree, not modified
+ * @param[in]  xpath   XPath of values
+ * @param[in]  nsc     Namespace context of xpath
+ * @param[in]  prefix  Only return values starting with prefix
+ * @param[in]  limit   Max number of values, 0 is unbounded
+ * @param[in]  xe      Request, <exact> values are also returned if they exist
+ * @param[out] cbval   Values as XML
+ * @retval     1       OK, values in cbval
+ * @retval     0       Not applicable, cbval unchanged
+ * @retval    -1       Error
+ */
+static int
+expand_values_cache(yang_stmt *yspec,
+                    cxobj     *xt,
+                    char      *xpath,
+                    cvec      *nsc,
+                    char      *prefix,
+                    uint32_t   limit,
+                    cxobj     *xe,
+                    cbuf      *cbval)
+{
+    int          retval = -1;
+    char        *path = NULL;
+    char        *step1;
+    char        *step2;
+    cxobj      **xvec = NULL;
+    size_t       xlen = 0;
+    yang_stmt   *yc = NULL;
+    yang_stmt   *yk = NULL;
+    cvec        *cvk;
+    clixon_xvec *xv = NULL;
+    char        *keyname = NULL;
+    char        *str;
+    cxobj       *x;
+    cvec        *cvk1 = NULL;
+    cvec        *cvv = NULL;
+    cg_var      *cv;
+    uint32_t     n = 0;
+    int          i;
+    int          j;
+
+    if ((path = strdup(xpath)) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    if (expand_xpath_split(path, &step1) == 0)
+        goto fail;
+    /* First try <path>/<list>/<key> */
+    if (expand_xpath_split(path, &step2) == 1){
+        if (expand_parents(yspec, xt, path, step2, nsc, &xvec, &xlen, &yc) < 0)
+            goto done;
+        if (xlen == 0)
+            goto ok;
+        if (yc != NULL &&
+            yang_keyword_get(yc) == Y_LIST &&
+            (cvk = yang_cvec_get(yc)) != NULL &&
+            cvec_len(cvk) == 1){
+            if (expand_step_yang(yspec, yc, step1, nsc, &yk) < 0)
+                goto done;
+            keyname = cv_string_get(cvec_i(cvk, 0));
+            if (yk == NULL || strcmp(keyname, yang_argument_get(yk)) != 0)
+                yc = NULL;
+        }
+        else
+            yc = NULL;
+        if (yc == NULL){
+            /* Restore path and try leaf-list below */
+            *(step2-1) = '/';
+            free(xvec);
+            xvec = NULL;
+            xlen = 0;
+            keyname = NULL;
+        }
+    }
+    /* Then try <path>/<leaf-list> */
+    if (yc == NULL){
+        if (expand_parents(yspec, xt, path, step1, nsc, &xvec, &xlen, &yc) < 0)
+            goto done;
+        if (xlen == 0)
+            goto ok;
+        if (yc == NULL || yang_keyword_get(yc) != Y_LEAF_LIST)
+            goto fail;
+    }
+    if ((xv = clixon_xvec_new()) == NULL)
+        goto done;
+    if ((cvv = cvec_new(0)) == NULL){
+        clicon_err(OE_UNIX, errno, "cvec_new");
+        goto done;
+    }
+    for (i=0; i<xlen; i++){
+        clixon_xvec_free(xv);
+        if ((xv = clixon_xvec_new()) == NULL)
+            goto done;
+        if (clixon_xml_find_prefix(xvec[i], yc, prefix, limit?limit-n:0, xv) < 0)
+            goto done;
+        for (j=0; j<clixon_xvec_len(xv); j++){
+            if (keyname)
+                str = xml_find_body(clixon_xvec_i(xv, j), keyname);
+            else
+                str = xml_body(clixon_xvec_i(xv, j));
+            if (str == NULL)
+                continue;
+            if (expand_value_add(cbval, str) < 0)
+                goto done;
+            if (limit && cvec_add_string(cvv, NULL, str) < 0){
+                clicon_err(OE_UNIX, errno, "cvec_add_string");
+                goto done;
+            }
+            n++;
+        }
+        if (limit && n >= limit)
+            break;
+    }
+    /* Exact values by binary search */
+    if ((cvk1 = cvec_new(0)) == NULL){
+        clicon_err(OE_UNIX, errno, "cvec_new");
+        goto done;
+    }
+    if ((cv = cvec_add(cvk1, CGV_STRING)) == NULL){
+        clicon_err(OE_UNIX, errno, "cvec_add");
+        goto done;
+    }
+    cv_name_set(cv, keyname?keyname:yang_argument_get(yc));
+    x = NULL;
+    while ((x = xml_child_each(xe, x, CX_ELMNT)) != NULL){
+        if (strcmp(xml_name(x), "exact") != 0 ||
+            (str = xml_body(x)) == NULL ||
+            !expand_exact_needed(str, prefix, limit && n >= limit, cvv))
+            continue;
+        cv_string_set(cv, str);
+        for (i=0; i<xlen; i++){
+            clixon_xvec_free(xv);
+            if ((xv = clixon_xvec_new()) == NULL)
+                goto done;
+            if (clixon_xml_find_index(xvec[i], xml_spec(xvec[i])?NULL:yspec,
+                                      yang_find_mynamespace(yc), yang_argument_get(yc),
+                                      cvk1, xv) < 0)
+                goto done;
+            if (clixon_xvec_len(xv) > 0){
+                if (expand_value_add(cbval, str) < 0)
+                    goto done;
+                break;
+            }
+        }
+    }
+ ok:
+    retval = 1;
+ done:
+    if (cvv)
+        cvec_free(cvv);
+    if (cvk1)
+        cvec_free(cvk1);
+    if (xv)
+        clixon_xvec_free(xv);
+    if (xvec)
+        free(xvec);
+    if (path)
+        free(path);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Get values of a leaf or leaf-list in a datastore for CLI expansion
+ *
+ * Only values starting with a prefix are returned, and at most limit values. In addition,
+ * <exact> values are returned if they exist, so that a value typed in a CLI command is
+ * found regardless of prefix and limit.
+ * Without NACM, list keys and leaf-lists are read directly from the datastore cache,
+ * see expand_values_cache. Otherwise the xpath is evaluated on a copy of the datastore.
+ * @param[in]  h       Clicon handle 
+ * @param[in]  xe      Request: <rpc><xn></rpc> 
+ * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error.. 
+ * @param[in]  arg     client-entry
+ * @param[in]  regarg  User argument given at rpc_callback_register() 
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+int
+from_client_expand_values(clicon_handle h,
+                          cxobj        *xe,
+                          cbuf         *cbret,
+                          void         *arg,
+                          void         *regarg)
+{
+    int        retval = -1;
+    char      *db;
+    cxobj     *xpe;
+    char      *xpath;
+    char      *prefix;
+    uint32_t   limit = 0;
+    cvec      *nsc = NULL;
+    yang_stmt *yspec;
+    cxobj     *xnacm;
+    cxobj     *xt;
+    cxobj     *xret = NULL;
+    cxobj    **xvec = NULL;
+    size_t     xlen = 0;
+    cxobj     *x;
+    cxobj     *xe1;
+    char      *str;
+    char      *str0 = NULL;
+    cbuf      *cbval = NULL;
+    cbuf      *cbmsg = NULL;
+    cvec      *cvv = NULL;
+    size_t     plen;
+    uint32_t   n = 0;
+    int        i;
+    int        ret;
+
+    if ((yspec = clicon_dbspec_yang(h)) == NULL){
+        clicon_err(OE_YANG, ENOENT, "No yang spec");
+        goto done;
+    }
+    if ((cbval = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if ((db = xml_find_body(xe, "datastore")) == NULL)
+        db = "running";
+    if (xmldb_validate_db(db) < 0){
+        cprintf(cbval, "No such database: %s", db);
+        if (netconf_invalid_value(cbret, "protocol", cbuf_get(cbval))< 0)
+            goto done;
+        goto ok;
+    }
+    if ((xpe = xml_find_type(xe, NULL, "xpath", CX_ELMNT)) == NULL ||
+        (xpath = xml_body(xpe)) == NULL){
+        if (netconf_missing_element(cbret, "protocol", "xpath", NULL) < 0)
+            goto done;
+        goto ok;
+    }
+    /* The namespace declarations in scope on the <xpath> element */
+    if (xml_nsctx_node(xpe, &nsc) < 0)
+        goto done;
+    prefix = xml_find_body(xe, "prefix");
+    plen = prefix?strlen(prefix):0;
+    if ((ret = element2value(h, xe, "limit", "unbounded", cbret, &limit)) < 0)
+        goto done;
+    if (ret == 0)
+        goto ok;
+    xnacm = clicon_nacm_cache(h);
+    if (xnacm == NULL &&
+        (xt = xmldb_cache_get(h, db)) != NULL &&
+        ((x = xml_child_i_type(xt, 0, CX_ELMNT)) == NULL || xml_spec(x) != NULL)){ /* bound */
+        if ((ret = expand_values_cache(yspec, xt, xpath, nsc, prefix, limit, xe, cbval)) < 0)
+            goto done;
+        if (ret == 1)
+            goto reply;
+    }
+    /* Generic: get a copy of the matching datastore subtree */
+    if (xmldb_get0(h, db, YB_MODULE, nsc, xpath, 1, WITHDEFAULTS_EXPLICIT, &xret, NULL, NULL) < 0) {
+        if ((cbmsg = cbuf_new()) == NULL){
+            clicon_err(OE_UNIX, errno, "cbuf_new");
+            goto done;
+        }
+        cprintf(cbmsg, "Get %s datastore: %s", db, clicon_err_reason);
+        if (netconf_operation_failed(cbret, "application", cbuf_get(cbmsg)) < 0)
+            goto done;
+        goto ok;
+    }
+    if (xpath_vec(xret, nsc, "%s", &xvec, &xlen, xpath) < 0)
+        goto done;
+    if (xnacm != NULL){
+        if (nacm_datanode_read(h, xret, xvec, xlen, clicon_username_get(h), xnacm) < 0)
+            goto done;
+        /* Pruned nodes are removed */
+        free(xvec);
+        xvec = NULL;
+        xlen = 0;
+        if (xpath_vec(xret, nsc, "%s", &xvec, &xlen, xpath) < 0)
+            goto done;
+    }
+    if ((cvv = cvec_new(0)) == NULL){
+        clicon_err(OE_UNIX, errno, "cvec_new");
+        goto done;
+    }
+    for (i=0; i<xlen; i++){
+        x = xvec[i];
+        if (xml_type(x) == CX_BODY)
+            str = xml_value(x);
+        else
+            str = xml_body(x);
+        if (str == NULL)
+            continue;
+        if (plen && strncmp(str, prefix, plen) != 0)
+            continue;
+        if (str0 && strcmp(str, str0) == 0)
+            continue; /* Adjacent duplicate */
+        str0 = str;
+        if (expand_value_add(cbval, str) < 0)
+            goto done;
+        if (limit && cvec_add_string(cvv, NULL, str) < 0){
+            clicon_err(OE_UNIX, errno, "cvec_add_string");
+            goto done;
+        }
+        if (limit && ++n >= limit)
+            break;
+    }
+    /* Exact values by linear search */
+    xe1 = NULL;
+    while ((xe1 = xml_child_each(xe, xe1, CX_ELMNT)) != NULL){
+        if (strcmp(xml_name(xe1), "exact") != 0 ||
+            (str0 = xml_body(xe1)) == NULL ||
+            !expand_exact_needed(str0, prefix, limit && n >= limit, cvv))
+            continue;
+        for (i=0; i<xlen; i++){
+            x = xvec[i];
+            if (xml_type(x) == CX_BODY)
+                str = xml_value(x);
+            else
+                str = xml_body(x);
+            if (str && strcmp(str, str0) == 0){
+                if (expand_value_add(cbval, str) < 0)
+                    goto done;
+                break;
+            }
+        }
+    }
+ reply:
+    cprintf(cbret, "<rpc-reply xmlns=\"%s\">%s</rpc-reply>",
+            NETCONF_BASE_NAMESPACE, cbuf_get(cbval));
+ ok:
+    retval = 0;
+ done:
+    if (cvv)
+        cvec_free(cvv);
+    if (cbmsg)
+        cbuf_free(cbmsg);
+    if (cbval)
+        cbuf_free(cbval);
+    if (xvec)
+        free(xvec);
+    if (xret)
+        xml_free(xret);
+    if (nsc)
+        xml_nsctx_free(nsc);
+    return retval;
+}
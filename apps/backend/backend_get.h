@@ -43,5 +43,7 @@
 int from_client_get_config(clicon_handle h, cxobj *xe, cbuf *cbret, void *arg, void *regarg);
 int from_client_get(clicon_handle h, cxobj *xe, cbuf *cbret, void *arg, void *regarg);
 int from_client_get_pageable_list(clicon_handle h, cxobj *xe, cbuf *cbret, void *arg, void *regarg); /* XXX */
+int list_pagination_sort_free(clicon_handle h);
+int from_client_expand_values(clicon_handle h, cxobj *xe, cbuf *cbret, void *arg, void *regarg);
 
 #endif  /* _BACKEND_GET_H_ */
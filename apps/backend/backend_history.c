@@ -0,0 +1,1303 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+  Commit history as reverse diffs, see CLICON_XMLDB_HISTORY
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <syslog.h>
+#include <sys/time.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clicon */
+#include <clixon/clixon.h>
+
+#include "clixon_backend_transaction.h"
+#include "clixon_backend_plugin.h"
+#include "backend_handle.h"
+#include "clixon_backend_commit.h"
+#include "backend_client.h"
+#include "backend_history.h"
+
+/* Name of commit history file in CLICON_XMLDB_DIR, as given by xmldb_db2file */
+#define HISTORY_DB "history"
+
+/* Commit history
+ * Each commit is kept as a reverse diff: <commit id="n"><remove/><restore/></commit>
+ * where <remove> has the nodes added by the commit, with list keys only, and <restore> has
+ * the nodes deleted and the leaves changed by the commit, with their values before the commit.
+ * Ancestors of the nodes are included with list keys only.
+ * If entries of an ordered-by user list or leaf-list are deleted or moved, an <order> with
+ * the entries of the list before the commit, in order, is added to the reverse diff.
+ * Commits are also appended to the history file, with a <mark/> and <unmark/> record when a
+ * confirmed-commit starts and ends.
+ */
+struct commit_history {
+    cxobj    *ch_xml;     /* <history> with <commit> children, oldest first */
+    int       ch_len;     /* Number of commits in ch_xml */
+    uint64_t  ch_id;      /* Id of latest commit */
+    int       ch_marked;  /* A confirmed-commit is in progress */
+    uint64_t  ch_mark;    /* Id of latest commit before the confirmed-commit */
+    int       ch_records; /* Number of records in history file */
+};
+
+/*! Get commit history or NULL if not enabled
+ * @param[in]  h   Clicon handle
+ */
+static struct commit_history *
+history_get(clicon_handle h)
+{
+    struct commit_history *ch = NULL;
+
+    clicon_ptr_get(h, "commit-history-struct", (void**)&ch);
+    return ch;
+}
+
+/*! Get id of a history record
+ * @param[in]  x   <commit> or <mark> record
+ * @retval     id  Id, or 0 if not found
+ */
+static uint64_t
+history_id(cxobj *x)
+{
+    char *str;
+
+    if ((str = xml_find_type_value(x, NULL, "id", CX_ATTR)) == NULL)
+        return 0;
+    return strtoull(str, NULL, 10);
+}
+
+/*! Check if XML node is a key of its parent list entry
+ * @param[in]  xp  Parent XML node
+ * @param[in]  x   XML node
+ * @retval     1   Yes, x is a key
+ * @retval     0   No
+ */
+static int
+history_key(cxobj *xp,
+            cxobj *x)
+{
+    yang_stmt *yp;
+    cg_var    *cvi = NULL;
+
+    if ((yp = xml_spec(xp)) == NULL || yang_keyword_get(yp) != Y_LIST)
+        return 0;
+    while ((cvi = cvec_each(yang_cvec_get(yp), cvi)) != NULL)
+        if (strcmp(xml_name(x), cv_string_get(cvi)) == 0)
+            return 1;
+    return 0;
+}
+
+/*! Check if XML node in a <remove> tree is a node to remove or an ancestor of one
+ * @param[in]  x   XML node
+ * @retval     1   Node to remove: has no other children than list keys
+ * @retval     0   Ancestor
+ */
+static int
+history_target(cxobj *x)
+{
+    cxobj *xc = NULL;
+
+    while ((xc = xml_child_each(x, xc, CX_ELMNT)) != NULL)
+        if (!history_key(x, xc))
+            return 0;
+    return 1;
+}
+
+/*! Check if XML node is an entry of an ordered-by user list or leaf-list
+ * @param[in]  x   XML node
+ * @retval     1   Yes
+ * @retval     0   No
+ */
+static int
+history_ordered(cxobj *x)
+{
+    yang_stmt *y;
+
+    if ((y = xml_spec(x)) == NULL)
+        return 0;
+    if (yang_keyword_get(y) != Y_LIST && yang_keyword_get(y) != Y_LEAF_LIST)
+        return 0;
+    return yang_find(y, Y_ORDERED_BY, "user") != NULL;
+}
+
+/*! Copy an XML node to a reverse diff
+ * @param[in]  x     XML node in a datastore tree
+ * @param[in]  full  1: Copy the whole subtree, 0: Copy node, attributes and list keys only
+ * @param[out] xnp   New XML node, free with xml_free
+ * @retval     0     OK
+ * @retval    -1     Error
+ * Leaves and leaf-lists are always copied with their values
+ */
+static int
+history_copy(cxobj  *x,
+             int     full,
+             cxobj **xnp)
+{
+    int        retval = -1;
+    cxobj     *xn = NULL;
+    cxobj     *xc;
+    cxobj     *xa;
+    yang_stmt *y;
+    cg_var    *cvi = NULL;
+
+    y = xml_spec(x);
+    if (full || y == NULL ||
+        yang_keyword_get(y) == Y_LEAF || yang_keyword_get(y) == Y_LEAF_LIST){
+        if ((xn = xml_dup(x)) == NULL)
+            goto done;
+    }
+    else {
+        if ((xn = xml_new(xml_name(x), NULL, CX_ELMNT)) == NULL)
+            goto done;
+        if (xml_copy_one(x, xn) < 0)
+            goto done;
+        xa = NULL;
+        while ((xa = xml_child_each(x, xa, CX_ATTR)) != NULL){
+            if ((xc = xml_dup(xa)) == NULL)
+                goto done;
+            if (xml_addsub(xn, xc) < 0)
+                goto done;
+        }
+        if (yang_keyword_get(y) == Y_LIST){
+            while ((cvi = cvec_each(yang_cvec_get(y), cvi)) != NULL){
+                if ((xc = xml_find_type(x, NULL, cv_string_get(cvi), CX_ELMNT)) == NULL)
+                    continue;
+                if ((xc = xml_dup(xc)) == NULL)
+                    goto done;
+                if (xml_addsub(xn, xc) < 0)
+                    goto done;
+            }
+            xml_sort(xn);
+        }
+    }
+    *xnp = xn;
+    xn = NULL;
+    retval = 0;
+ done:
+    if (xn)
+        xml_free(xn);
+    return retval;
+}
+
+/*! Get the node corresponding to a datastore node in a reverse diff, create it if needed
+ * @param[in]  x     XML node in a datastore tree
+ * @param[in]  xtop  Top of reverse diff tree, <remove> or <restore>
+ * @param[out] xdp   Corresponding node in reverse diff tree
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+history_ancestor(cxobj  *x,
+                 cxobj  *xtop,
+                 cxobj **xdp)
+{
+    int    retval = -1;
+    cxobj *xp;
+    cxobj *xd = NULL;
+
+    if (xml_parent(x) == NULL){ /* Top symbol */
+        *xdp = xtop;
+        goto ok;
+    }
+    if (history_ancestor(xml_parent(x), xtop, &xp) < 0)
+        goto done;
+    if (match_base_child(xp, x, xml_spec(x), &xd) < 0)
+        goto done;
+    if (xd == NULL){
+        if (history_copy(x, 0, &xd) < 0)
+            goto done;
+        if (xml_insert(xp, xd, INS_LAST, NULL, NULL) < 0){
+            xml_free(xd);
+            goto done;
+        }
+    }
+    *xdp = xd;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Add a datastore node to a reverse diff
+ * @param[in]  x     XML node in a datastore tree
+ * @param[in]  xtop  Top of reverse diff tree, <remove> or <restore>
+ * @param[in]  full  1: Copy the whole subtree, 0: Copy node and list keys only
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+history_node_add(cxobj *x,
+                 cxobj *xtop,
+                 int    full)
+{
+    int    retval = -1;
+    cxobj *xp;
+    cxobj *xd = NULL;
+    int    ret;
+
+    if (xml_flag(x, XML_FLAG_DEFAULT))
+        goto ok;
+    if (history_ancestor(xml_parent(x), xtop, &xp) < 0)
+        goto done;
+    if (match_base_child(xp, x, xml_spec(x), &xd) < 0)
+        goto done;
+    if (xd && xml_purge(xd) < 0)
+        goto done;
+    if (history_copy(x, full, &xd) < 0)
+        goto done;
+    /* Default values are not restored, and the node may then be empty */
+    if (full && (ret = xml_defaults_nopresence(xd, 1)) != 0){
+        xml_free(xd);
+        if (ret < 0)
+            goto done;
+        goto ok;
+    }
+    if (xml_insert(xp, xd, INS_LAST, NULL, NULL) < 0){
+        xml_free(xd);
+        goto done;
+    }
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Add the order of the entries of an ordered-by user list or leaf-list to a reverse diff
+ *
+ * All entries of the list are copied in order, list entries with keys only
+ * @param[in]  x     Entry of the list in a datastore tree
+ * @param[in]  xtop  Top of reverse diff tree, <order>
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+history_order_add(cxobj *x,
+                  cxobj *xtop)
+{
+    int    retval = -1;
+    cxobj *xp;
+    cxobj *xc = NULL;
+    cxobj *xd;
+
+    if (history_ancestor(xml_parent(x), xtop, &xp) < 0)
+        goto done;
+    while ((xc = xml_child_each(xml_parent(x), xc, CX_ELMNT)) != NULL){
+        if (xml_spec(xc) != xml_spec(x))
+            continue;
+        xd = NULL;
+        if (match_base_child(xp, xc, xml_spec(xc), &xd) < 0)
+            goto done;
+        /* The entry may already be there as ancestor of another node, move it last */
+        if (xd != NULL){
+            if (xml_rm(xd) < 0)
+                goto done;
+        }
+        else if (history_copy(xc, 0, &xd) < 0)
+            goto done;
+        if (xml_insert(xp, xd, INS_LAST, NULL, NULL) < 0){
+            xml_free(xd);
+            goto done;
+        }
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Remove the nodes of a <remove> tree from a datastore tree
+ * @param[in]  xd    Node in <remove> tree
+ * @param[in]  xt    Corresponding node in datastore tree
+ * @retval     0     OK
+ * @retval    -1     Error
+ * Nodes that do not exist are skipped
+ */
+static int
+history_remove(cxobj *xd,
+               cxobj *xt)
+{
+    int        retval = -1;
+    cxobj     *xdc = NULL;
+    cxobj     *xtc;
+    yang_stmt *yc;
+
+    while ((xdc = xml_child_each(xd, xdc, CX_ELMNT)) != NULL){
+        if (history_key(xd, xdc))
+            continue;
+        if ((yc = xml_spec(xdc)) == NULL)
+            continue;
+        if (match_base_child(xt, xdc, yc, &xtc) < 0)
+            goto done;
+        if (xtc == NULL)
+            continue;
+        if (history_target(xdc)){
+            if (xml_purge(xtc) < 0)
+                goto done;
+        }
+        else if (history_remove(xdc, xtc) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Put the entries of an ordered-by user list or leaf-list in the order of a reverse diff
+ * @param[in]  xd    Parent node in <order> tree
+ * @param[in]  xt    Corresponding node in datastore tree
+ * @param[in]  y     Yang spec of list or leaf-list
+ * @retval     0     OK
+ * @retval    -1     Error
+ * Entries not in the <order> tree are placed after the others, in their existing order
+ */
+static int
+history_order_list(cxobj     *xd,
+                   cxobj     *xt,
+                   yang_stmt *y)
+{
+    int     retval = -1;
+    cxobj  *xdc = NULL;
+    cxobj  *xtc;
+    cxobj **vec = NULL;
+    int     veclen = 0;
+    int     i;
+    int     j;
+
+    xtc = NULL;
+    while ((xtc = xml_child_each(xt, xtc, CX_ELMNT)) != NULL)
+        if (xml_spec(xtc) == y)
+            xml_flag_reset(xtc, XML_FLAG_MARK);
+    while ((xdc = xml_child_each(xd, xdc, CX_ELMNT)) != NULL){
+        if (xml_spec(xdc) != y)
+            continue;
+        if (match_base_child(xt, xdc, y, &xtc) < 0)
+            goto done;
+        if (xtc == NULL || xml_flag(xtc, XML_FLAG_MARK))
+            continue;
+        xml_flag_set(xtc, XML_FLAG_MARK);
+        if (cxvec_append(xtc, &vec, &veclen) < 0)
+            goto done;
+    }
+    xtc = NULL;
+    while ((xtc = xml_child_each(xt, xtc, CX_ELMNT)) != NULL){
+        if (xml_spec(xtc) != y)
+            continue;
+        if (xml_flag(xtc, XML_FLAG_MARK))
+            xml_flag_reset(xtc, XML_FLAG_MARK);
+        else if (cxvec_append(xtc, &vec, &veclen) < 0)
+            goto done;
+    }
+    /* The entries are adjacent, replace them in place */
+    j = 0;
+    for (i=0; i<xml_child_nr(xt) && j<veclen; i++)
+        if (xml_spec(xml_child_i(xt, i)) == y)
+            xml_child_i_set(xt, i, vec[j++]);
+    retval = 0;
+ done:
+    if (vec)
+        free(vec);
+    return retval;
+}
+
+/*! Restore the order of ordered-by user lists and leaf-lists from an <order> tree
+ * @param[in]  xd    Node in <order> tree
+ * @param[in]  xt    Corresponding node in datastore tree
+ * @retval     0     OK
+ * @retval    -1     Error
+ * Nodes that do not exist are skipped
+ */
+static int
+history_order(cxobj *xd,
+              cxobj *xt)
+{
+    int        retval = -1;
+    cxobj     *xdc = NULL;
+    cxobj     *xtc;
+    yang_stmt *yc;
+    yang_stmt *yprev = NULL;
+
+    while ((xdc = xml_child_each(xd, xdc, CX_ELMNT)) != NULL){
+        if (history_key(xd, xdc))
+            continue;
+        if ((yc = xml_spec(xdc)) == NULL)
+            continue;
+        if (yc != yprev && history_ordered(xdc)){
+            if (history_order_list(xd, xt, yc) < 0)
+                goto done;
+            yprev = yc;
+        }
+        if (match_base_child(xt, xdc, yc, &xtc) < 0)
+            goto done;
+        if (xtc != NULL && history_order(xdc, xtc) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Undo a commit in a datastore tree
+ * @param[in]  xc     <commit> record
+ * @param[in]  xt     Datastore tree without default values, changed to its state before the commit
+ * @param[in]  yspec  Yang spec
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+history_undo(cxobj     *xc,
+             cxobj     *xt,
+             yang_stmt *yspec)
+{
+    int    retval = -1;
+    cxobj *xd;
+    cxobj *xm = NULL;
+    char  *reason = NULL;
+    int    ret;
+
+    if ((xd = xml_find_type(xc, NULL, "remove", CX_ELMNT)) != NULL &&
+        history_remove(xd, xt) < 0)
+        goto done;
+    if ((xd = xml_find_type(xc, NULL, "restore", CX_ELMNT)) != NULL &&
+        xml_child_nr_type(xd, CX_ELMNT) > 0){
+        /* xml_merge moves nodes from the merged tree */
+        if ((xm = xml_dup(xd)) == NULL)
+            goto done;
+        if ((ret = xml_merge(xt, xm, yspec, &reason)) < 0)
+            goto done;
+        if (ret == 0){
+            clicon_err(OE_XML, EINVAL, "Commit %" PRIu64 ": %s", history_id(xc), reason);
+            goto done;
+        }
+    }
+    if ((xd = xml_find_type(xc, NULL, "order", CX_ELMNT)) != NULL &&
+        history_order(xd, xt) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (xm)
+        xml_free(xm);
+    if (reason)
+        free(reason);
+    return retval;
+}
+
+/*! Open the history file
+ * @param[in]  h     Clicon handle
+ * @param[in]  mode  fopen mode
+ * @param[out] fp    Open file
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+history_file_open(clicon_handle h,
+                  const char   *mode,
+                  FILE        **fp)
+{
+    int   retval = -1;
+    char *filename = NULL;
+
+    if (xmldb_db2file(h, HISTORY_DB, &filename) < 0)
+        goto done;
+    if ((*fp = fopen(filename, mode)) == NULL){
+        clicon_err(OE_CFG, errno, "Opening file %s", filename);
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (filename)
+        free(filename);
+    return retval;
+}
+
+/*! Append a record to the history file
+ * @param[in]  h     Clicon handle
+ * @param[in]  ch    Commit history
+ * @param[in]  x     Record
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+history_file_append(clicon_handle          h,
+                    struct commit_history *ch,
+                    cxobj                 *x)
+{
+    int   retval = -1;
+    FILE *f = NULL;
+
+    if (history_file_open(h, "a", &f) < 0)
+        goto done;
+    if (clixon_xml2file(f, x, 0, 0, NULL, 0, 0) < 0)
+        goto done;
+    fprintf(f, "\n");
+    if (fflush(f) != 0 || fsync(fileno(f)) < 0){
+        clicon_err(OE_UNIX, errno, "fsync");
+        goto done;
+    }
+    ch->ch_records++;
+    retval = 0;
+ done:
+    if (f)
+        fclose(f);
+    return retval;
+}
+
+/*! Append a <mark> or <unmark> record to the history file
+ * @param[in]  h     Clicon handle
+ * @param[in]  ch    Commit history
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+history_file_mark(clicon_handle          h,
+                  struct commit_history *ch)
+{
+    int    retval = -1;
+    cxobj *x = NULL;
+    cbuf  *cb = NULL;
+
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (ch->ch_marked)
+        cprintf(cb, "<mark id=\"%" PRIu64 "\"/>", ch->ch_mark);
+    else
+        cprintf(cb, "<unmark/>");
+    if (clixon_xml_parse_string(cbuf_get(cb), YB_NONE, NULL, &x, NULL) < 0)
+        goto done;
+    if (history_file_append(h, ch, xml_child_i(x, 0)) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (x)
+        xml_free(x);
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Rewrite the history file from the commits in memory
+ *
+ * The file is written to a temporary file which then replaces the history file, so that
+ * the history file is intact if the backend stops while writing.
+ * @param[in]  h     Clicon handle
+ * @param[in]  ch    Commit history
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+history_file_write(clicon_handle          h,
+                   struct commit_history *ch)
+{
+    int    retval = -1;
+    char  *filename = NULL;
+    cbuf  *cb = NULL;
+    FILE  *f = NULL;
+    cxobj *xc = NULL;
+
+    if (xmldb_db2file(h, HISTORY_DB, &filename) < 0)
+        goto done;
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "%s.tmp", filename);
+    if ((f = fopen(cbuf_get(cb), "w")) == NULL){
+        clicon_err(OE_CFG, errno, "Creating file %s", cbuf_get(cb));
+        goto done;
+    }
+    ch->ch_records = 0;
+    while ((xc = xml_child_each(ch->ch_xml, xc, CX_ELMNT)) != NULL){
+        if (ch->ch_marked && history_id(xc) == ch->ch_mark + 1)
+            fprintf(f, "<mark id=\"%" PRIu64 "\"/>\n", ch->ch_mark);
+        if (clixon_xml2file(f, xc, 0, 0, NULL, 0, 0) < 0)
+            goto done;
+        fprintf(f, "\n");
+        ch->ch_records++;
+    }
+    if (ch->ch_marked && ch->ch_mark == ch->ch_id)
+        fprintf(f, "<mark id=\"%" PRIu64 "\"/>\n", ch->ch_mark);
+    if (fflush(f) != 0 || fsync(fileno(f)) < 0){
+        clicon_err(OE_UNIX, errno, "fsync %s", cbuf_get(cb));
+        goto done;
+    }
+    fclose(f);
+    f = NULL;
+    if (rename(cbuf_get(cb), filename) < 0){
+        clicon_err(OE_UNIX, errno, "rename %s", filename);
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (f)
+        fclose(f);
+    if (cb)
+        cbuf_free(cb);
+    if (filename)
+        free(filename);
+    return retval;
+}
+
+/*! Count complete top-level records of the history file, see clixon_xml_sax_callbacks
+ * @param[in]  x    XML element
+ * @param[in]  arg  Number of complete records
+ * @retval     0    OK, element is kept
+ */
+static int
+history_file_record(cxobj *x,
+                    void  *arg)
+{
+    int *nr = (int *)arg;
+
+    if (xml_parent(xml_parent(x)) == NULL)
+        (*nr)++;
+    return 0;
+}
+
+/*! Read the records of the history file
+ *
+ * The records are parsed one at a time. A record may be partially written if the backend
+ * stopped while appending. Then the complete records before it are kept and the rest of
+ * the file is skipped. It is removed from the file when the file is rewritten.
+ * @param[in]  f         Open history file
+ * @param[in]  filename  Name of history file
+ * @param[out] xtp       XML tree with the records as children, free with xml_free
+ * @retval     0         OK
+ * @retval    -1         Error
+ */
+static int
+history_file_read(FILE       *f,
+                  const char *filename,
+                  cxobj     **xtp)
+{
+    int             retval = -1;
+    cxobj          *xt = NULL;
+    cxobj          *x;
+    clixon_xml_sax *xs = NULL;
+    char            buf[BUFSIZ];
+    size_t          len;
+    int             nr = 0;
+    int             ret = 0;
+
+    if ((xt = xml_new(XML_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
+        goto done;
+    if ((xs = clixon_xml_sax_new(YB_NONE, NULL, xt)) == NULL)
+        goto done;
+    if (clixon_xml_sax_callbacks(xs, NULL, history_file_record, &nr) < 0)
+        goto done;
+    while ((len = fread(buf, 1, sizeof(buf), f)) > 0)
+        if ((ret = clixon_xml_sax_push(xs, buf, len)) < 0)
+            break;
+    if (ferror(f)){
+        clicon_err(OE_UNIX, errno, "fread %s", filename);
+        goto done;
+    }
+    if (ret == 0 && clixon_xml_sax_end(xs, NULL) < 0)
+        ret = -1;
+    if (ret < 0){
+        clicon_log(LOG_WARNING, "%s: commit history %s truncated after %d records: %s",
+                   __FUNCTION__, filename, nr, clicon_err_reason);
+        clicon_err_reset();
+        /* Remove the partial record */
+        while ((x = xml_child_i_type(xt, nr, CX_ELMNT)) != NULL)
+            if (xml_purge(x) < 0)
+                goto done;
+    }
+    *xtp = xt;
+    xt = NULL;
+    retval = 0;
+ done:
+    if (xs)
+        clixon_xml_sax_free(xs);
+    if (xt)
+        xml_free(xt);
+    return retval;
+}
+
+/*! Remove the oldest commits exceeding the history size, and compact the history file
+ *
+ * Commits made during a confirmed-commit are kept until it ends
+ * @param[in]  h     Clicon handle
+ * @param[in]  ch    Commit history
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+history_trim(clicon_handle          h,
+             struct commit_history *ch)
+{
+    int    retval = -1;
+    int    size;
+    cxobj *xc;
+
+    size = clicon_option_int(h, "CLICON_XMLDB_HISTORY");
+    while (ch->ch_len > size){
+        xc = xml_child_i(ch->ch_xml, 0);
+        if (ch->ch_marked && history_id(xc) > ch->ch_mark)
+            break;
+        if (xml_purge(xc) < 0)
+            goto done;
+        ch->ch_len--;
+    }
+    /* The file is appended, rewrite it when it has grown to twice the history */
+    if (ch->ch_records > 2*size && ch->ch_records > 2*ch->ch_len)
+        if (history_file_write(h, ch) < 0)
+            goto done;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Write a datastore file from an XML tree and clear its cache
+ * @param[in]  h    Clicon handle
+ * @param[in]  db   Datastore
+ * @param[in]  xt   XML tree with top DATASTORE_TOP_SYMBOL
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+history_db_write(clicon_handle h,
+                 const char   *db,
+                 cxobj        *xt)
+{
+    int   retval = -1;
+    char *filename = NULL;
+    FILE *f = NULL;
+
+    if (xmldb_clear(h, db) < 0)
+        goto done;
+    if (xmldb_db2file(h, db, &filename) < 0)
+        goto done;
+    if ((f = fopen(filename, "w")) == NULL){
+        clicon_err(OE_CFG, errno, "Creating file %s", filename);
+        goto done;
+    }
+    if (xmldb_dump(h, f, xt) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (f)
+        fclose(f);
+    if (filename)
+        free(filename);
+    return retval;
+}
+
+/*! Init commit history, read commits of a previous run from the history file
+ *
+ * Use history_mark_db() to get the running datastore before an interrupted confirmed-commit.
+ * @param[in]  h    Clicon handle
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @note Yang specs must be loaded
+ */
+int
+history_init(clicon_handle h)
+{
+    int                    retval = -1;
+    struct commit_history *ch = NULL;
+    yang_stmt             *yspec;
+    char                  *filename = NULL;
+    struct stat            st;
+    FILE                  *f = NULL;
+    cxobj                 *xt = NULL;
+    cxobj                 *x;
+    cxobj                 *xd;
+    cxobj                 *xerr = NULL;
+    int                    ret;
+
+    if (clicon_option_int(h, "CLICON_XMLDB_HISTORY") <= 0)
+        goto ok;
+    if ((yspec = clicon_dbspec_yang(h)) == NULL){
+        clicon_err(OE_YANG, ENOENT, "No yang spec");
+        goto done;
+    }
+    if ((ch = calloc(1, sizeof(*ch))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    if ((ch->ch_xml = xml_new("history", NULL, CX_ELMNT)) == NULL)
+        goto done;
+    if (clicon_ptr_set(h, "commit-history-struct", ch) < 0)
+        goto done;
+    if (xmldb_db2file(h, HISTORY_DB, &filename) < 0)
+        goto done;
+    if (stat(filename, &st) < 0)
+        goto ok;
+    if ((f = fopen(filename, "r")) == NULL){
+        clicon_err(OE_CFG, errno, "Opening file %s", filename);
+        goto done;
+    }
+    if (history_file_read(f, filename, &xt) < 0)
+        goto done;
+    while ((x = xml_child_i_type(xt, 0, CX_ELMNT)) != NULL){
+        if (xml_rm(x) < 0)
+            goto done;
+        if (strcmp(xml_name(x), "commit") == 0){
+            ch->ch_id = history_id(x);
+            xd = NULL;
+            while ((xd = xml_child_each(x, xd, CX_ELMNT)) != NULL){
+                if ((ret = xml_bind_yang(xd, YB_MODULE, yspec, &xerr)) < 0)
+                    goto done;
+                if (ret == 0)
+                    break;
+            }
+            if (xd != NULL){ /* Yang changed */
+                clicon_log(LOG_WARNING, "%s: commit %" PRIu64 " in commit history %s does not match yang, history is restarted",
+                           __FUNCTION__, ch->ch_id, filename);
+                xml_free(x);
+                xml_free(ch->ch_xml);
+                if ((ch->ch_xml = xml_new("history", NULL, CX_ELMNT)) == NULL)
+                    goto done;
+                ch->ch_len = 0;
+                ch->ch_marked = 0;
+                break;
+            }
+            if (xml_addsub(ch->ch_xml, x) < 0)
+                goto done;
+            ch->ch_len++;
+            continue;
+        }
+        if (strcmp(xml_name(x), "mark") == 0){
+            ch->ch_marked = 1;
+            ch->ch_mark = history_id(x);
+        }
+        else if (strcmp(xml_name(x), "unmark") == 0)
+            ch->ch_marked = 0;
+        xml_free(x);
+    }
+    clicon_debug(1, "%s %d commits", __FUNCTION__, ch->ch_len);
+    if (history_trim(h, ch) < 0)
+        goto done;
+    if (history_file_write(h, ch) < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    if (xerr)
+        xml_free(xerr);
+    if (xt)
+        xml_free(xt);
+    if (f)
+        fclose(f);
+    if (filename)
+        free(filename);
+    return retval;
+}
+
+/*! Free commit history
+ * @param[in]  h    Clicon handle
+ * @retval     0    OK
+ */
+int
+history_exit(clicon_handle h)
+{
+    struct commit_history *ch;
+
+    if ((ch = history_get(h)) != NULL){
+        if (ch->ch_xml)
+            xml_free(ch->ch_xml);
+        free(ch);
+        clicon_ptr_del(h, "commit-history-struct");
+    }
+    return 0;
+}
+
+/*! Remove all commits from the history, eg when running is replaced at startup
+ * @param[in]  h    Clicon handle
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+int
+history_reset(clicon_handle h)
+{
+    int                    retval = -1;
+    struct commit_history *ch;
+
+    if ((ch = history_get(h)) == NULL)
+        goto ok;
+    xml_free(ch->ch_xml);
+    if ((ch->ch_xml = xml_new("history", NULL, CX_ELMNT)) == NULL)
+        goto done;
+    ch->ch_len = 0;
+    ch->ch_marked = 0;
+    if (history_file_write(h, ch) < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Add the reverse diff of a commit to the history
+ *
+ * The diff is made from the transaction vectors, before the target is copied to running
+ * @param[in]  h    Clicon handle
+ * @param[in]  td   Transaction
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+int
+history_commit(clicon_handle       h,
+               transaction_data_t *td)
+{
+    int                    retval = -1;
+    struct commit_history *ch;
+    cxobj                 *xc = NULL;
+    cxobj                 *xa;
+    cxobj                 *xrm;
+    cxobj                 *xrs;
+    cxobj                 *xord = NULL;
+    cxobj                 *x;
+    cxobj                 *xprev = NULL;
+    cbuf                  *cb = NULL;
+    int                    i;
+
+    if ((ch = history_get(h)) == NULL)
+        goto ok;
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "%" PRIu64, ch->ch_id + 1);
+    if ((xc = xml_new("commit", NULL, CX_ELMNT)) == NULL)
+        goto done;
+    if ((xa = xml_new("id", xc, CX_ATTR)) == NULL)
+        goto done;
+    if (xml_value_set(xa, cbuf_get(cb)) < 0)
+        goto done;
+    if ((xrm = xml_new("remove", xc, CX_ELMNT)) == NULL)
+        goto done;
+    if ((xrs = xml_new("restore", xc, CX_ELMNT)) == NULL)
+        goto done;
+    for (i=0; i<td->td_alen; i++)
+        if (history_node_add(td->td_avec[i], xrm, 0) < 0)
+            goto done;
+    for (i=0; i<td->td_dlen; i++)
+        if (history_node_add(td->td_dvec[i], xrs, 1) < 0)
+            goto done;
+    for (i=0; i<td->td_clen; i++){
+        /* A default value changed: remove the new value */
+        if (xml_flag(td->td_scvec[i], XML_FLAG_DEFAULT)){
+            if (history_node_add(td->td_tcvec[i], xrm, 0) < 0)
+                goto done;
+        }
+        else if (history_node_add(td->td_scvec[i], xrs, 1) < 0)
+            goto done;
+    }
+    /* Order of ordered-by user lists with deleted entries, a moved entry is also deleted */
+    for (i=0; i<td->td_dlen; i++){
+        x = td->td_dvec[i];
+        if (!history_ordered(x))
+            continue;
+        if (xprev && xml_parent(xprev) == xml_parent(x) && xml_spec(xprev) == xml_spec(x))
+            continue;
+        if (xord == NULL &&
+            (xord = xml_new("order", xc, CX_ELMNT)) == NULL)
+            goto done;
+        if (history_order_add(x, xord) < 0)
+            goto done;
+        xprev = x;
+    }
+    if (xml_addsub(ch->ch_xml, xc) < 0)
+        goto done;
+    ch->ch_len++;
+    ch->ch_id++;
+    if (history_file_append(h, ch, xc) < 0){
+        xc = NULL;
+        goto done;
+    }
+    xc = NULL;
+    if (history_trim(h, ch) < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    if (xc)
+        xml_free(xc);
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Create a datastore with running as it was after a commit in the history
+ *
+ * The reverse diffs of the later commits are applied to a copy of running, latest first.
+ * Changes of running made in other ways than commit, eg edit-config of running, are not
+ * undone.
+ * @param[in]  h    Clicon handle
+ * @param[in]  id   Id of commit, or id of the commit before the oldest to undo all commits
+ * @param[in]  db   Datastore to create
+ * @retval     1    OK
+ * @retval     0    Commit not in history
+ * @retval    -1    Error
+ */
+int
+history_rollback_db(clicon_handle h,
+                    uint64_t      id,
+                    char         *db)
+{
+    int                    retval = -1;
+    struct commit_history *ch;
+    yang_stmt             *yspec;
+    cxobj                 *xt = NULL;
+    cxobj                 *xc;
+    int                    i;
+
+    if ((ch = history_get(h)) == NULL)
+        goto fail;
+    if (id > ch->ch_id || ch->ch_id - id > ch->ch_len)
+        goto fail;
+    if ((yspec = clicon_dbspec_yang(h)) == NULL){
+        clicon_err(OE_YANG, ENOENT, "No yang spec");
+        goto done;
+    }
+    if (xmldb_get0(h, "running", YB_MODULE, NULL, "/", 1, 0, &xt, NULL, NULL) < 0)
+        goto done;
+    if (xml_defaults_nopresence(xt, 1) < 0)
+        goto done;
+    for (i=ch->ch_len-1; i>=0; i--){
+        xc = xml_child_i(ch->ch_xml, i);
+        if (history_id(xc) <= id)
+            break;
+        if (history_undo(xc, xt, yspec) < 0)
+            goto done;
+    }
+    if (history_db_write(h, db, xt) < 0)
+        goto done;
+    retval = 1;
+ done:
+    if (xt)
+        xml_free(xt);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Mark the start of a confirmed-commit in the history
+ *
+ * Instead of copying running to the rollback datastore, the rollback datastore is created
+ * from the history if the confirmed-commit is cancelled, see history_mark_db()
+ * @param[in]  h    Clicon handle
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+int
+history_mark(clicon_handle h)
+{
+    int                    retval = -1;
+    struct commit_history *ch;
+
+    if ((ch = history_get(h)) == NULL)
+        goto ok;
+    ch->ch_marked = 1;
+    ch->ch_mark = ch->ch_id;
+    if (history_file_mark(h, ch) < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Check if a confirmed-commit is marked in the history
+ * @param[in]  h    Clicon handle
+ * @retval     1    Marked
+ * @retval     0    Not marked
+ */
+int
+history_marked(clicon_handle h)
+{
+    struct commit_history *ch;
+
+    if ((ch = history_get(h)) == NULL)
+        return 0;
+    return ch->ch_marked;
+}
+
+/*! Create a datastore with running as it was before the marked confirmed-commit, if any
+ * @param[in]  h    Clicon handle
+ * @param[in]  db   Datastore to create, eg "rollback"
+ * @retval     1    OK, db created
+ * @retval     0    No marked confirmed-commit
+ * @retval    -1    Error
+ */
+int
+history_mark_db(clicon_handle h,
+                char         *db)
+{
+    struct commit_history *ch;
+
+    if ((ch = history_get(h)) == NULL || !ch->ch_marked)
+        return 0;
+    return history_rollback_db(h, ch->ch_mark, db);
+}
+
+/*! Mark the end of a confirmed-commit in the history
+ * @param[in]  h    Clicon handle
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+int
+history_unmark(clicon_handle h)
+{
+    int                    retval = -1;
+    struct commit_history *ch;
+
+    if ((ch = history_get(h)) == NULL || !ch->ch_marked)
+        goto ok;
+    ch->ch_marked = 0;
+    if (history_file_mark(h, ch) < 0)
+        goto done;
+    if (history_trim(h, ch) < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Undo the latest commits of running, using the commit history
+ *
+ * The undo is itself a commit, which is added to the history
+ * @param[in]  h       Clicon handle 
+ * @param[in]  xe      Request: <rpc><xn></rpc> 
+ * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error.. 
+ * @param[in]  arg     client-entry
+ * @param[in]  regarg  User argument given at rpc_callback_register() 
+ * @retval     0       OK. This may indicate both ok and err msg back to client
+ * @retval    -1       Error
+ */
+int
+from_client_rollback(clicon_handle h,
+                     cxobj        *xe,
+                     cbuf         *cbret,
+                     void         *arg,
+                     void         *regarg)
+{
+    int                    retval = -1;
+    struct client_entry   *ce = (struct client_entry *)arg;
+    struct commit_history *ch;
+    yang_stmt             *yspec;
+    uint32_t               iddb;
+    uint32_t               commits = 1;
+    char                  *str;
+    char                  *reason = NULL;
+    cbuf                  *cbx = NULL;
+    int                    ret;
+
+    if ((yspec = clicon_dbspec_yang(h)) == NULL) {
+        clicon_err(OE_YANG, ENOENT, "No yang spec");
+        goto done;
+    }
+    if ((cbx = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    if ((ch = history_get(h)) == NULL){
+        if (netconf_operation_not_supported(cbret, "application", "Commit history is not enabled, see CLICON_XMLDB_HISTORY") < 0)
+            goto done;
+        goto ok;
+    }
+    if ((str = xml_find_body(xe, "commits")) != NULL){
+        if ((ret = parse_uint32(str, &commits, &reason)) < 0){
+            clicon_err(OE_XML, errno, "parse_uint32");
+            goto done;
+        }
+        if (ret == 0){
+            if (netconf_bad_element(cbret, "application", "commits", reason) < 0)
+                goto done;
+            goto ok;
+        }
+    }
+    if (commits == 0 || commits > ch->ch_len){
+        cprintf(cbx, "There are %d commits in history", ch->ch_len);
+        if (netconf_invalid_value(cbret, "application", cbuf_get(cbx)) < 0)
+            goto done;
+        goto ok;
+    }
+    /* Check if target locked by other client */
+    iddb = xmldb_islocked(h, "running");
+    if (iddb && ce->ce_id != iddb){
+        if (netconf_in_use(cbret, "protocol", "Operation failed, lock is already held") < 0)
+            goto done;
+        goto ok;
+    }
+    if (if_feature(yspec, "ietf-netconf", "confirmed-commit") &&
+        confirmed_commit_state_get(h) != INACTIVE){
+        if (netconf_in_use(cbret, "protocol", "Operation failed, confirmed-commit in progress") < 0)
+            goto done;
+        goto ok;
+    }
+    if ((ret = history_rollback_db(h, ch->ch_id - commits, "undo")) < 0)
+        goto done;
+    if (ret == 0){
+        cprintf(cbx, "Commit %" PRIu64 " not in history", ch->ch_id - commits);
+        if (netconf_invalid_value(cbret, "application", cbuf_get(cbx)) < 0)
+            goto done;
+        goto ok;
+    }
+    if ((ret = candidate_commit(h, NULL, "undo", cbret)) < 0){
+        if (netconf_operation_failed(cbret, "application", clicon_err_reason)< 0)
+            goto done;
+    }
+    if (xmldb_delete(h, "undo") < 0)
+        goto done;
+    if (ret == 1)
+        cprintf(cbret, "<rpc-reply xmlns=\"%s\"><ok/></rpc-reply>", NETCONF_BASE_NAMESPACE);
+ ok:
+    retval = 0;
+ done:
+    if (reason)
+        free(reason);
+    if (cbx)
+        cbuf_free(cbx);
+    return retval;
+}
@@ -77,6 +77,8 @@
 #include "backend_handle.h"
 #include "backend_startup.h"
 #include "backend_plugin_restconf.h"
+#include "backend_get.h"
+#include "backend_history.h"
 
 /* Command line options to be passed to getopt(3) */
 #define BACKEND_OPTS "hD:f:E:l:d:p:b:Fza:u:P:1qs:c:U:g:y:o:"
@@ -125,6 +127,7 @@ backend_terminate(clicon_handle h)
     if ((x = clicon_conf_xml(h)) != NULL)
         xml_free(x);
     confirmed_commit_free(h);
+    history_exit(h);
     stream_publish_exit();
     /* Delete all plugins, RPC callbacks, and upgrade callbacks */
     clixon_plugin_module_exit(h);
@@ -133,6 +136,9 @@ backend_terminate(clicon_handle h)
 
     xpath_optimize_exit();
     clixon_pagination_free(h);
+    clixon_statedata_cache_free(h);
+    list_pagination_sort_free(h);
+    xml_yang_validate_deps_free(h);
     if (pidfile)
         unlink(pidfile);   
     if (sockfamily==AF_UNIX && lstat(sockpath, &st) == 0)
@@ -339,6 +345,10 @@ check_drop_priv(clicon_handle h,
         if (xmldb_drop_priv(h, "rollback", newuid, gid) < 0)
             goto done;
     }
+    /* Commit history file is created at startup */
+    if (clicon_option_int(h, "CLICON_XMLDB_HISTORY") > 0)
+        if (xmldb_drop_priv(h, "history", newuid, gid) < 0)
+            goto done;
     if (setgid(gid) == -1) {
         clicon_err(OE_DAEMON, errno, "setgid %d", gid);
         goto done;
@@ -846,6 +856,10 @@ main(int    argc,
         goto done;
     if (clicon_nsctx_global_set(h, nsctx_global) < 0)
         goto done;
+    /* Compute constraint dependencies for incremental validation */
+    if (clicon_option_bool(h, "CLICON_VALIDATE_INCREMENTAL") &&
+        xml_yang_validate_deps_init(h, yspec) < 0)
+        goto done;
 
     /* Initialize server socket and save it to handle */
     if (backend_rpc_init(h) < 0)
@@ -860,6 +874,9 @@ main(int    argc,
         if (confirmed_commit_init(h) < 0)
             goto done;
     }
+    /* Init commit history, including marked confirmed-commit of previous run */
+    if (history_init(h) < 0)
+        goto done;
     /* Save modules state of the backend (server). Compare with startup XML */
     if (startup_module_state(h, yspec) < 0)
         goto done;
@@ -977,6 +994,9 @@ main(int    argc,
         status = STARTUP_OK;
         cbuf_reset(cbret); /* cbret contains error info */
     }
+    /* Running is replaced at startup, previous commits cannot be undone */
+    if (history_reset(h) < 0)
+        goto done;
     
     /* Initiate the shared candidate. */
     if (xmldb_copy(h, "running", "candidate") < 0)
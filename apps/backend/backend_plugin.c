@@ -51,6 +51,7 @@
 #include <syslog.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/time.h>
 #include <sys/param.h>
 #include <netinet/in.h>
 
@@ -313,9 +314,486 @@ clixon_plugin_statedata_one(clixon_plugin_t *cp,
     goto done;
 }
 
+/*! State data cache entry, one per registered (state callback, subtree) pair
+ * @see clixon_statedata_cache_register
+ */
+typedef struct {
+    qelem_t          sc_qelem;    /* List header */
+    plgstatedata_t  *sc_fn;       /* Plugin state data callback owning the subtree */
+    char            *sc_xpath;    /* XPath of owned subtree, absolute child steps only */
+    cvec            *sc_nsc;      /* Namespace context of sc_xpath */
+    xpath_tree      *sc_xpt;      /* Parsed sc_xpath */
+    xpath_tree      *sc_xrel;     /* Location path steps of sc_xpt (points into sc_xpt) */
+    uint32_t         sc_ttl;      /* Time-to-live in ms, 0 means no caching */
+    struct timeval   sc_expire;   /* Cached tree is valid until this time */
+    cxobj           *sc_xcache;   /* Cached state tree <config>..., bound and sorted */
+} statedata_cache_t;
+
+/*! Flatten a relative location path into a vector of XP_RELLOCPATH nodes, one per step
+ *
+ * The grammar is left-recursive: rellocpath -> rellocpath / step, so the first step is
+ * furthest down. Each vector entry has its step in c1 (or c0 for the first), and an axis
+ * of A_DESCENDANT_OR_SELF if the step was preceded by "//".
+ * @param[in]     xr    XPath tree of type XP_RELLOCPATH
+ * @param[in,out] vec   Vector of XP_RELLOCPATH nodes
+ * @param[in,out] len   Length of vector
+ */
+static int
+statedata_cache_steps(xpath_tree   *xr,
+                      xpath_tree ***vec,
+                      int          *len)
+{
+    if (xr == NULL || xr->xs_type != XP_RELLOCPATH)
+        return 0;
+    if (xr->xs_c1 != NULL &&
+        statedata_cache_steps(xr->xs_c0, vec, len) < 0)
+        return -1;
+    if ((*vec = realloc(*vec, (*len+1)*sizeof(xpath_tree *))) == NULL){
+        clicon_err(OE_UNIX, errno, "realloc");
+        return -1;
+    }
+    (*vec)[(*len)++] = xr;
+    return 0;
+}
+
+/*! Get step of a flattened rellocpath entry, see statedata_cache_steps
+ */
+static xpath_tree *
+statedata_cache_step(xpath_tree *xr)
+{
+    return xr->xs_c1 ? xr->xs_c1 : xr->xs_c0;
+}
+
+/*! Check if two absolute child-step location paths may select overlapping subtrees
+ *
+ * Two paths intersect if one is a prefix of the other. Predicates are ignored since
+ * they only narrow the selection.
+ * @param[in]  xr0   Request path, XP_RELLOCPATH
+ * @param[in]  nsc0  Namespace context of request
+ * @param[in]  xr1   Registered path, XP_RELLOCPATH
+ * @param[in]  nsc1  Namespace context of registered path
+ * @retval     1     May intersect
+ * @retval     0     Does not intersect
+ * @retval    -1     Error
+ */
+static int
+statedata_cache_path_intersect(xpath_tree *xr0,
+                               cvec       *nsc0,
+                               xpath_tree *xr1,
+                               cvec       *nsc1)
+{
+    int          retval = -1;
+    xpath_tree **vec0 = NULL;
+    int          len0 = 0;
+    xpath_tree **vec1 = NULL;
+    int          len1 = 0;
+    xpath_tree  *xs0;
+    xpath_tree  *xs1;
+    xpath_tree  *xn0;
+    xpath_tree  *xn1;
+    char        *ns0;
+    char        *ns1;
+    int          i;
+
+    if (statedata_cache_steps(xr0, &vec0, &len0) < 0)
+        goto done;
+    if (statedata_cache_steps(xr1, &vec1, &len1) < 0)
+        goto done;
+    for (i=0; i<len0 && i<len1; i++){
+        if (vec0[i]->xs_int == A_DESCENDANT_OR_SELF) /* "//" may match anywhere below */
+            break;
+        xs0 = statedata_cache_step(vec0[i]);
+        xs1 = statedata_cache_step(vec1[i]);
+        if (xs0->xs_type != XP_STEP || xs0->xs_int != A_CHILD)
+            break;
+        if ((xn0 = xs0->xs_c0) == NULL || xn0->xs_type != XP_NODE ||
+            xn0->xs_s1 == NULL || strcmp(xn0->xs_s1, "*") == 0)
+            continue;   /* Wildcard, node() etc */
+        xn1 = xs1->xs_c0;
+        if (strcmp(xn0->xs_s1, xn1->xs_s1) != 0)
+            goto fail;
+        ns0 = xml_nsctx_get(nsc0, xn0->xs_s0);
+        ns1 = xml_nsctx_get(nsc1, xn1->xs_s0);
+        if (ns0 && ns1 && strcmp(ns0, ns1) != 0)
+            goto fail;
+    }
+    retval = 1;
+ done:
+    if (vec0)
+        free(vec0);
+    if (vec1)
+        free(vec1);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Check if a request xpath may select nodes in the subtree owned by a cache entry
+ *
+ * Conservative: anything but (unions of) simple location paths is assumed to intersect.
+ * @param[in]  sc    State cache entry
+ * @param[in]  xt    Parsed request xpath, or NULL for all
+ * @param[in]  nsc   Namespace context of request xpath
+ * @retval     1     May intersect
+ * @retval     0     Does not intersect
+ * @retval    -1     Error
+ */
+static int
+statedata_cache_intersect(statedata_cache_t *sc,
+                          xpath_tree        *xt,
+                          cvec              *nsc)
+{
+    int ret;
+
+    if (xt == NULL)
+        return 1;
+    switch (xt->xs_type){
+    case XP_UNION:
+        if (xt->xs_c1 == NULL)
+            return statedata_cache_intersect(sc, xt->xs_c0, nsc);
+        if ((ret = statedata_cache_intersect(sc, xt->xs_c0, nsc)) != 0)
+            return ret;
+        return statedata_cache_intersect(sc, xt->xs_c1, nsc);
+    case XP_EXP:
+    case XP_AND:
+    case XP_RELEX:
+    case XP_ADD:
+    case XP_PATHEXPR:
+        if (xt->xs_c1 != NULL) /* Binary expression or filterexpr/path */
+            return 1;
+        return statedata_cache_intersect(sc, xt->xs_c0, nsc);
+    case XP_LOCPATH:
+        return statedata_cache_intersect(sc, xt->xs_c0, nsc);
+    case XP_ABSPATH:
+        if (xt->xs_int != A_ROOT || xt->xs_c0 == NULL)
+            return 1;
+        return statedata_cache_path_intersect(xt->xs_c0, nsc, sc->sc_xrel, sc->sc_nsc);
+    case XP_RELLOCPATH: /* Relative to top-level */
+        return statedata_cache_path_intersect(xt, nsc, sc->sc_xrel, sc->sc_nsc);
+    default:
+        break;
+    }
+    return 1;
+}
+/*! Get location path steps of a simple absolute xpath
+ *
+ * @param[in]  xt    Parsed xpath
+ * @param[out] xrp   XP_RELLOCPATH of the steps, or NULL if xpath is "/"
+ * @retval     1     OK, xpath is an absolute path with named child steps only
+ * @retval     0     Not a simple absolute path
+ */
+static int
+statedata_cache_locpath(xpath_tree  *xt,
+                        xpath_tree **xrp)
+{
+    xpath_tree **vec = NULL;
+    int          len = 0;
+    xpath_tree  *xs;
+    int          i;
+    int          retval = 0;
+
+    while (xt && xt->xs_c1 == NULL &&
+           (xt->xs_type == XP_EXP || xt->xs_type == XP_AND || xt->xs_type == XP_RELEX ||
+            xt->xs_type == XP_ADD || xt->xs_type == XP_UNION ||
+            xt->xs_type == XP_PATHEXPR || xt->xs_type == XP_LOCPATH))
+        xt = xt->xs_c0;
+    if (xt == NULL || xt->xs_type != XP_ABSPATH || xt->xs_int != A_ROOT)
+        goto done;
+    if (statedata_cache_steps(xt->xs_c0, &vec, &len) < 0)
+        goto done;
+    for (i=0; i<len; i++){
+        xs = statedata_cache_step(vec[i]);
+        if (vec[i]->xs_int == A_DESCENDANT_OR_SELF ||
+            xs->xs_type != XP_STEP || xs->xs_int != A_CHILD ||
+            xs->xs_c0 == NULL || xs->xs_c0->xs_type != XP_NODE ||
+            xs->xs_c0->xs_s1 == NULL || strcmp(xs->xs_c0->xs_s1, "*") == 0)
+            goto done;
+    }
+    *xrp = xt->xs_c0;
+    retval = 1;
+ done:
+    if (vec)
+        free(vec);
+    return retval;
+}
+
+/*! Register a state data subtree owned by a plugin state callback, and its cache lifetime
+ *
+ * Once a state callback has at least one registration, it is only invoked when a request
+ * xpath intersects one of its registered subtrees, and then with the registered xpath and 
+ * namespace context instead of the request xpath. The result is cached for ttl milliseconds
+ * and shared by all requests in that interval, the system filters the cached tree
+ * against each request xpath.
+ * A callback may register several disjoint subtrees, each is invoked and cached separately.
+ * @param[in]  h      Clixon handle
+ * @param[in]  fn     Plugin state data callback, as given in ca_statedata
+ * @param[in]  nsc    Namespace context of xpath
+ * @param[in]  xpath  Absolute xpath of owned subtree, eg /if:interfaces-state, or "/"
+ * @param[in]  ttl    Time-to-live of cached subtree in milliseconds, 0 disables caching
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @code
+ *   if ((nsc = xml_nsctx_init("ex", "urn:example:counters")) == NULL)
+ *      goto done;
+ *   if (clixon_statedata_cache_register(h, example_statedata, nsc, "/ex:counters", 5000) < 0)
+ *      goto done;
+ * @endcode
+ * @see clixon_statedata_cache_invalidate
+ */
+int
+clixon_statedata_cache_register(clicon_handle   h,
+                                plgstatedata_t *fn,
+                                cvec           *nsc,
+                                char           *xpath,
+                                uint32_t        ttl)
+{
+    int                retval = -1;
+    statedata_cache_t *sc = NULL;
+    statedata_cache_t *schead = NULL;
+    
+    clicon_debug(1, "%s %s ttl:%u", __FUNCTION__, xpath, ttl);
+    if (fn == NULL || xpath == NULL){
+        clicon_err(OE_PLUGIN, EINVAL, "fn or xpath is NULL");
+        goto done;
+    }
+    if ((sc = malloc(sizeof(*sc))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(sc, 0, sizeof(*sc));
+    sc->sc_fn = fn;
+    sc->sc_ttl = ttl;
+    if ((sc->sc_xpath = strdup(xpath)) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    if (nsc && (sc->sc_nsc = cvec_dup(nsc)) == NULL){
+        clicon_err(OE_UNIX, errno, "cvec_dup");
+        goto done;
+    }
+    if (xpath_parse(xpath, &sc->sc_xpt) < 0)
+        goto done;
+    if (statedata_cache_locpath(sc->sc_xpt, &sc->sc_xrel) == 0){
+        clicon_err(OE_PLUGIN, EINVAL, "State cache xpath %s is not an absolute path of named child steps", xpath);
+        goto done;
+    }
+    clicon_ptr_get(h, "statedata-cache", (void**)&schead);
+    ADDQ(sc, schead);
+    if (clicon_ptr_set(h, "statedata-cache", schead) < 0)
+        goto done;
+    sc = NULL;
+    retval = 0;
+ done:
+    if (sc){
+        if (sc->sc_xpath)
+            free(sc->sc_xpath);
+        if (sc->sc_nsc)
+            cvec_free(sc->sc_nsc);
+        if (sc->sc_xpt)
+            xpath_tree_free(sc->sc_xpt);
+        free(sc);
+    }
+    return retval;
+}
+
+/*! Invalidate cached state subtrees intersecting an xpath
+ *
+ * Plugins call this when they know that state has changed before the ttl has expired.
+ * The cache is also invalidated on every successful commit.
+ * @param[in]  h      Clixon handle
+ * @param[in]  nsc    Namespace context of xpath
+ * @param[in]  xpath  XPath of changed state, or NULL for all
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+int
+clixon_statedata_cache_invalidate(clicon_handle h,
+                                  cvec         *nsc,
+                                  char         *xpath)
+{
+    int                retval = -1;
+    statedata_cache_t *schead = NULL;
+    statedata_cache_t *sc;
+    xpath_tree        *xt = NULL;
+    int                ret;
+
+    clicon_ptr_get(h, "statedata-cache", (void**)&schead);
+    if ((sc = schead) == NULL)
+        goto ok;
+    if (xpath && xpath_parse(xpath, &xt) < 0)
+        goto done;
+    do {
+        if (sc->sc_xcache){
+            if ((ret = statedata_cache_intersect(sc, xt, nsc)) < 0)
+                goto done;
+            if (ret == 1){
+                xml_free(sc->sc_xcache);
+                sc->sc_xcache = NULL;
+            }
+        }
+        sc = NEXTQ(statedata_cache_t *, sc);
+    } while (sc != schead);
+ ok:
+    retval = 0;
+ done:
+    if (xt)
+        xpath_tree_free(xt);
+    return retval;
+}
+
+/*! Free all state data cache registrations and cached trees
+ *
+ * @param[in]  h      Clixon handle
+ */
+int
+clixon_statedata_cache_free(clicon_handle h)
+{
+    statedata_cache_t *schead = NULL;
+    statedata_cache_t *sc;
+
+    clicon_ptr_get(h, "statedata-cache", (void**)&schead);
+    while ((sc = schead) != NULL){
+        DELQ(sc, schead, statedata_cache_t *);
+        if (sc->sc_xpath)
+            free(sc->sc_xpath);
+        if (sc->sc_nsc)
+            cvec_free(sc->sc_nsc);
+        if (sc->sc_xpt)
+            xpath_tree_free(sc->sc_xpt);
+        if (sc->sc_xcache)
+            xml_free(sc->sc_xcache);
+        free(sc);
+    }
+    clicon_ptr_del(h, "statedata-cache");
+    return 0;
+}
+
+/*! Get state data from one plugin callback, bind, and merge it into existing state tree
+ *
+ * If a cache entry is given, the state is read from the cache if valid, otherwise the 
+ * callback is invoked and the resulting tree is cached.
+ * @param[in]     h       Clicon handle
+ * @param[in]     cp      Plugin handle
+ * @param[in]     yspec   Yang spec
+ * @param[in]     nsc     Namespace context
+ * @param[in]     xpath   String with XPATH syntax. or NULL for all
+ * @param[in]     sc      State cache entry, or NULL
+ * @param[in,out] xret    State XML tree is merged with existing tree.
+ * @retval       -1       Error
+ * @retval        0       Statedata callback failed (xret set with netconf-error)
+ * @retval        1       OK
+ */
+static int
+clixon_plugin_statedata_merge(clicon_handle      h,
+                              clixon_plugin_t   *cp,
+                              yang_stmt         *yspec,
+                              cvec              *nsc,
+                              char              *xpath,
+                              statedata_cache_t *sc,
+                              cxobj            **xret)
+{
+    int              retval = -1;
+    int              ret;
+    cxobj           *x = NULL;
+    cbuf            *cberr = NULL; 
+    cxobj           *xerr = NULL;
+    struct timeval   now;
+    struct timeval   t;
+    
+    if (sc && sc->sc_ttl){
+        gettimeofday(&now, NULL);
+        if (sc->sc_xcache && timercmp(&now, &sc->sc_expire, <)){
+            clicon_debug(1, "%s %s cache hit", __FUNCTION__, sc->sc_xpath);
+            if ((x = xml_dup(sc->sc_xcache)) == NULL)
+                goto done;
+            goto merge;
+        }
+        if (sc->sc_xcache){
+            xml_free(sc->sc_xcache);
+            sc->sc_xcache = NULL;
+        }
+    }
+    if ((ret = clixon_plugin_statedata_one(cp, h, nsc, xpath, &x)) < 0)
+        goto done;
+    if (ret == 0){
+        if ((cberr = cbuf_new()) == NULL){
+            clicon_err(OE_UNIX, errno, "cbuf_new");
+            goto done;
+        }
+        /* error reason should be in clicon_err_reason */
+        cprintf(cberr, "Internal error, state callback in plugin %s returned invalid XML: %s",
+                clixon_plugin_name_get(cp), clicon_err_reason);
+        if (netconf_operation_failed_xml(&xerr, "application", cbuf_get(cberr)) < 0)
+            goto done;
+        xml_free(*xret);
+        *xret = xerr;
+        xerr = NULL;
+        goto fail;
+    }
+    if (x == NULL)
+        goto ok;
+    if (xml_child_nr(x) == 0){
+        if (sc && sc->sc_ttl) /* Cache empty state as well */
+            goto cache;
+        goto ok;
+    }
+    if (clicon_debug_get())
+        clicon_log_xml(LOG_DEBUG, x, "%s %s STATE:", __FUNCTION__, clixon_plugin_name_get(cp));
+    /* XXX: ret == 0 invalid yang binding should be handled as internal error */
+    if ((ret = xml_bind_yang(x, YB_MODULE, yspec, &xerr)) < 0)
+        goto done;
+    if (ret == 0){
+        if (clixon_netconf_internal_error(xerr,
+                                          ". Internal error, state callback returned invalid XML from plugin: ",
+                                          clixon_plugin_name_get(cp)) < 0)
+            goto done;
+        xml_free(*xret);
+        *xret = xerr;
+        xerr = NULL;
+        goto fail;
+    }
+    if (xml_sort_recurse(x) < 0)
+        goto done;
+    /* Remove global defaults and empty non-presence containers */
+    /* XXX: only for state data and according to with-defaults setting */
+    if (xml_defaults_nopresence(x, 2) < 0)
+        goto done;
+ cache:
+    if (sc && sc->sc_ttl){
+        if ((sc->sc_xcache = xml_dup(x)) == NULL)
+            goto done;
+        t.tv_sec = sc->sc_ttl/1000;
+        t.tv_usec = (sc->sc_ttl%1000)*1000;
+        timeradd(&now, &t, &sc->sc_expire);
+    }
+ merge:
+    if (xml_child_nr(x) == 0)
+        goto ok;
+    if ((ret = netconf_trymerge(x, yspec, xret)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+ ok:
+    retval = 1;
+ done:
+    if (xerr)
+        xml_free(xerr);
+    if (cberr)
+        cbuf_free(cberr);
+    if (x)
+        xml_free(x);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
 /*! Go through all backend statedata callbacks and collect state data
  * This is internal system call, plugin is invoked (does not call) this function
  * Backend plugins can register 
+ * Callbacks that have registered state subtrees with clixon_statedata_cache_register are
+ * only invoked for subtrees intersecting xpath, and may be served from the cache.
  * @param[in]     h       clicon handle
  * @param[in]     yspec   Yang spec
  * @param[in]     nsc     Namespace context
@@ -335,77 +813,50 @@ clixon_plugin_statedata_all(clicon_handle   h,
                             withdefaults_type wdef,
                             cxobj         **xret)
 {
-    int              retval = -1;
-    int              ret;
-    cxobj           *x = NULL;
-    clixon_plugin_t *cp = NULL;
-    cbuf            *cberr = NULL; 
-    cxobj           *xerr = NULL;
+    int                retval = -1;
+    int                ret;
+    clixon_plugin_t   *cp = NULL;
+    plgstatedata_t    *fn;
+    statedata_cache_t *schead = NULL;
+    statedata_cache_t *sc;
+    int                registered;
+    xpath_tree        *xt = NULL;
     
     clicon_debug(1, "%s", __FUNCTION__);
+    clicon_ptr_get(h, "statedata-cache", (void**)&schead);
+    if (schead && xpath && xpath_parse(xpath, &xt) < 0)
+        goto done;
     while ((cp = clixon_plugin_each(h, cp)) != NULL) {
-        if ((ret = clixon_plugin_statedata_one(cp, h, nsc, xpath, &x)) < 0)
-            goto done;
-        if (ret == 0){
-            if ((cberr = cbuf_new()) == NULL){
-                clicon_err(OE_UNIX, errno, "cbuf_new");
-                goto done;
-            }
-            /* error reason should be in clicon_err_reason */
-            cprintf(cberr, "Internal error, state callback in plugin %s returned invalid XML: %s",
-                    clixon_plugin_name_get(cp), clicon_err_reason);
-            if (netconf_operation_failed_xml(&xerr, "application", cbuf_get(cberr)) < 0)
-                goto done;
-            xml_free(*xret);
-            *xret = xerr;
-            xerr = NULL;
-            goto fail;
-        }
-        if (x == NULL)
+        if ((fn = clixon_plugin_api_get(cp)->ca_statedata) == NULL)
             continue;
-        if (xml_child_nr(x) == 0){
-            xml_free(x);
-            x = NULL;
+        registered = 0;
+        if ((sc = schead) != NULL)
+            do {
+                if (sc->sc_fn == fn){
+                    registered++;
+                    if ((ret = statedata_cache_intersect(sc, xt, nsc)) < 0)
+                        goto done;
+                    if (ret == 1){
+                        if ((ret = clixon_plugin_statedata_merge(h, cp, yspec, sc->sc_nsc, sc->sc_xpath,
+                                                                 sc, xret)) < 0)
+                            goto done;
+                        if (ret == 0)
+                            goto fail;
+                    }
+                }
+                sc = NEXTQ(statedata_cache_t *, sc);
+            } while (sc != schead);
+        if (registered)
             continue;
-        }
-        if (clicon_debug_get())
-            clicon_log_xml(LOG_DEBUG, x, "%s %s STATE:", __FUNCTION__, clixon_plugin_name_get(cp));
-        /* XXX: ret == 0 invalid yang binding should be handled as internal error */
-        if ((ret = xml_bind_yang(x, YB_MODULE, yspec, &xerr)) < 0)
-            goto done;
-        if (ret == 0){
-            if (clixon_netconf_internal_error(xerr,
-                                              ". Internal error, state callback returned invalid XML from plugin: ",
-                                              clixon_plugin_name_get(cp)) < 0)
-                goto done;
-            xml_free(*xret);
-            *xret = xerr;
-            xerr = NULL;
-            goto fail;
-        }
-        if (xml_sort_recurse(x) < 0)
-            goto done;
-        /* Remove global defaults and empty non-presence containers */
-        /* XXX: only for state data and according to with-defaults setting */
-        if (xml_defaults_nopresence(x, 2) < 0)
-            goto done;
-        if ((ret = netconf_trymerge(x, yspec, xret)) < 0)
+        if ((ret = clixon_plugin_statedata_merge(h, cp, yspec, nsc, xpath, NULL, xret)) < 0)
             goto done;
         if (ret == 0)
             goto fail;
-        if (x){
-            xml_free(x);
-            x = NULL;
-        }
     } /* while plugin */
     retval = 1;
  done:
-    if (xerr)
-        xml_free(xerr);
-    if (cberr)
-        cbuf_free(cberr);
-    if (x)
-        xml_free(x);
+    if (xt)
+        xpath_tree_free(xt);
     return retval;
  fail:
     retval = 0;
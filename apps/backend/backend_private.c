@@ -0,0 +1,642 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+  Private candidate datastores, see CLICON_XMLDB_PRIVATE_CANDIDATE
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <syslog.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clicon */
+#include <clixon/clixon.h>
+
+#include "clixon_backend_transaction.h"
+#include "clixon_backend_plugin.h"
+#include "backend_handle.h"
+#include "clixon_backend_commit.h"
+#include "backend_client.h"
+#include "backend_private.h"
+
+/*! Get a copy of a datastore without default values
+ * @param[in]  h    Clicon handle
+ * @param[in]  db   Datastore
+ * @param[out] xtp  XML tree, free with xml_free
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+private_db_get(clicon_handle h,
+               const char   *db,
+               cxobj       **xtp)
+{
+    int    retval = -1;
+    cxobj *xt = NULL;
+
+    if (xmldb_get0(h, db, YB_MODULE, NULL, "/", 1, 0, &xt, NULL, NULL) < 0)
+        goto done;
+    if (xml_defaults_nopresence(xt, 1) < 0)
+        goto done;
+    *xtp = xt;
+    xt = NULL;
+    retval = 0;
+ done:
+    if (xt)
+        xml_free(xt);
+    return retval;
+}
+
+/*! Set base of private candidate to the current running datastore
+ * @param[in]  h    Clicon handle
+ * @param[in]  ce   Client session
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+private_base_set(clicon_handle        h,
+                 struct client_entry *ce)
+{
+    int       retval = -1;
+    cxobj    *xt = NULL;
+    db_elmnt *de;
+
+    if (private_db_get(h, "running", &xt) < 0)
+        goto done;
+    if (ce->ce_privbase)
+        xml_free(ce->ce_privbase);
+    ce->ce_privbase = xt;
+    /* Read generation after get, which may load the cache */
+    if ((de = clicon_db_elmnt_get(h, "running")) != NULL)
+        ce->ce_privgen = de->de_gen;
+    else
+        ce->ce_privgen = 0;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Get the datastore of a session for a given datastore name
+ *
+ * If private candidates are enabled, "candidate" is translated to the private candidate of the
+ * session, which is created as a copy of running on first use.
+ * @param[in]  h    Clicon handle
+ * @param[in]  ce   Client session
+ * @param[in]  db   Datastore name in request, eg "candidate"
+ * @param[out] dbp  Datastore to use, private candidate or db
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+int
+private_candidate_db(clicon_handle        h,
+                     struct client_entry *ce,
+                     char                *db,
+                     char               **dbp)
+{
+    int   retval = -1;
+    cbuf *cb = NULL;
+
+    if (strcmp(db, "candidate") != 0 ||
+        !clicon_option_bool(h, "CLICON_XMLDB_PRIVATE_CANDIDATE")){
+        *dbp = db;
+        goto ok;
+    }
+    if (ce->ce_privdb == NULL){
+        if ((cb = cbuf_new()) == NULL){
+            clicon_err(OE_UNIX, errno, "cbuf_new");
+            goto done;
+        }
+        cprintf(cb, "candidate-%u", ce->ce_id);
+        if (xmldb_copy(h, "running", cbuf_get(cb)) < 0)
+            goto done;
+        xmldb_modified_set(h, cbuf_get(cb), 0);
+        if (private_base_set(h, ce) < 0)
+            goto done;
+        if ((ce->ce_privdb = strdup(cbuf_get(cb))) == NULL){
+            clicon_err(OE_UNIX, errno, "strdup");
+            goto done;
+        }
+        clicon_debug(1, "%s created %s", __FUNCTION__, ce->ce_privdb);
+    }
+    *dbp = ce->ce_privdb;
+ ok:
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Write a datastore file and clear its cache, so that it is read from the file on next access
+ *
+ * Used instead of xmldb_put for a whole tree, which is already NACM checked
+ * @param[in]  h    Clicon handle
+ * @param[in]  db   Datastore
+ * @param[in]  xt   XML tree with top DATASTORE_TOP_SYMBOL
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+private_db_write(clicon_handle h,
+                 const char   *db,
+                 cxobj        *xt)
+{
+    int   retval = -1;
+    char *filename = NULL;
+    FILE *f = NULL;
+
+    if (xmldb_clear(h, db) < 0)
+        goto done;
+    if (xmldb_db2file(h, db, &filename) < 0)
+        goto done;
+    if ((f = fopen(filename, "w")) == NULL){
+        clicon_err(OE_CFG, errno, "Creating file %s", filename);
+        goto done;
+    }
+    if (xmldb_dump(h, f, xt) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (f)
+        fclose(f);
+    if (filename)
+        free(filename);
+    return retval;
+}
+
+/*! Get api-path of XML node in a datastore tree
+ * @param[in]  x     XML node in a datastore tree
+ * @param[in]  cb    Path is appended to this buffer
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+private_path(cxobj *x,
+             cbuf  *cb)
+{
+    if (x == NULL || xml_parent(x) == NULL) /* Top symbol */
+        return 0;
+    if (private_path(xml_parent(x), cb) < 0)
+        return -1;
+    return xml2api_path_1(x, cb);
+}
+
+/*! Add api-paths of XML nodes to hash of paths
+ * @param[in]  xvec  Vector of XML nodes in a datastore tree
+ * @param[in]  xlen  Length of xvec
+ * @param[in]  hash  Hash of paths
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+private_path_add(cxobj        **xvec,
+                 int            xlen,
+                 clicon_hash_t *hash)
+{
+    int   retval = -1;
+    cbuf *cb = NULL;
+    int   one = 1;
+    int   i;
+
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    for (i=0; i<xlen; i++){
+        cbuf_reset(cb);
+        if (private_path(xvec[i], cb) < 0)
+            goto done;
+        if (clicon_hash_add(hash, cbuf_get(cb), &one, sizeof(one)) == NULL)
+            goto done;
+    }
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Check if any path in a hash, or any of its ancestors, is in another hash
+ * @param[in]  hash1  Hash of paths
+ * @param[in]  hash2  Hash of paths
+ * @param[out] cb     First overlapping path is appended, if any
+ * @retval     1      Overlap
+ * @retval     0      No overlap
+ * @retval    -1      Error
+ * Key values are percent-encoded in api-paths, so a '/' always separates two nodes
+ */
+static int
+private_path_overlap(clicon_hash_t *hash1,
+                     clicon_hash_t *hash2,
+                     cbuf          *cb)
+{
+    int     retval = -1;
+    char  **keys = NULL;
+    size_t  klen;
+    int     i;
+    char   *p = NULL;
+    char   *s;
+
+    if (clicon_hash_keys(hash1, &keys, &klen) < 0)
+        goto done;
+    for (i=0; i<klen; i++){
+        if ((p = strdup(keys[i])) == NULL){
+            clicon_err(OE_UNIX, errno, "strdup");
+            goto done;
+        }
+        do {
+            if (clicon_hash_lookup(hash2, p) != NULL){
+                cprintf(cb, "%s", keys[i]);
+                retval = 1;
+                goto done;
+            }
+            if ((s = strrchr(p, '/')) != NULL)
+                *s = '\0';
+        } while (s != NULL && s != p);
+        free(p);
+        p = NULL;
+    }
+    retval = 0;
+ done:
+    if (p)
+        free(p);
+    if (keys)
+        free(keys);
+    return retval;
+}
+
+/*! Find the node in another tree corresponding to an XML node
+ * @param[in]  x     XML node
+ * @param[in]  xt    Top of other tree
+ * @param[out] xmp   Matching node in xt, or NULL
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+private_match(cxobj  *x,
+              cxobj  *xt,
+              cxobj **xmp)
+{
+    cxobj *xmp0 = NULL;
+
+    *xmp = NULL;
+    if (xml_parent(x) == NULL){
+        *xmp = xt;
+        return 0;
+    }
+    if (private_match(xml_parent(x), xt, &xmp0) < 0)
+        return -1;
+    if (xmp0 == NULL)
+        return 0;
+    return match_base_child(xmp0, x, xml_spec(x), xmp);
+}
+
+/*! Copy nodes of the private candidate into the merged tree, replacing existing nodes
+ * @param[in]  xvec  Vector of nodes in private candidate
+ * @param[in]  xlen  Length of xvec
+ * @param[in]  xt    Top of merged tree
+ * @param[out] cb    Path of node whose parent does not exist in merged tree
+ * @retval     1     OK
+ * @retval     0     Parent of a node does not exist in merged tree
+ * @retval    -1     Error
+ */
+static int
+private_node_copy(cxobj **xvec,
+                  int     xlen,
+                  cxobj  *xt,
+                  cbuf   *cb)
+{
+    int    i;
+    cxobj *xp;
+    cxobj *xm;
+    cxobj *xc;
+
+    for (i=0; i<xlen; i++){
+        if (private_match(xml_parent(xvec[i]), xt, &xp) < 0)
+            return -1;
+        if (xp == NULL){
+            if (private_path(xvec[i], cb) < 0)
+                return -1;
+            return 0;
+        }
+        if (match_base_child(xp, xvec[i], xml_spec(xvec[i]), &xm) < 0)
+            return -1;
+        if (xm && xml_purge(xm) < 0)
+            return -1;
+        if ((xc = xml_dup(xvec[i])) == NULL)
+            return -1;
+        if (xml_addsub(xp, xc) < 0)
+            return -1;
+    }
+    return 1;
+}
+
+/*! Merge changes made in running since the private candidate was copied
+ *
+ * Compute the changes of the session (base -> private candidate) and of others 
+ * (base -> running). If a changed node of one is the same as, or an ancestor of, a changed
+ * node of the other, the changes conflict. Otherwise apply the changes of the session to
+ * a copy of running and replace the private candidate with the result.
+ * @param[in]  h      Clicon handle
+ * @param[in]  ce     Client session
+ * @param[out] cbret  Error reply if retval is 0
+ * @retval     1      OK, private candidate is based on current running
+ * @retval     0      Conflict, error reply in cbret
+ * @retval    -1      Error
+ */
+static int
+private_candidate_rebase(clicon_handle        h,
+                         struct client_entry *ce,
+                         cbuf                *cbret)
+{
+    int            retval = -1;
+    db_elmnt      *de;
+    yang_stmt     *yspec;
+    cxobj         *xr = NULL;   /* Running */
+    cxobj         *xp = NULL;   /* Private candidate */
+    cxobj         *xm = NULL;   /* Merged */
+    cxobj        **dvec = NULL; /* Changes of session */
+    int            dlen;
+    cxobj        **avec = NULL;
+    int            alen;
+    cxobj        **chvec0 = NULL;
+    cxobj        **chvec1 = NULL;
+    int            chlen;
+    cxobj        **odvec = NULL; /* Changes of others */
+    int            odlen;
+    cxobj        **oavec = NULL;
+    int            oalen;
+    cxobj        **ochvec0 = NULL;
+    cxobj        **ochvec1 = NULL;
+    int            ochlen;
+    clicon_hash_t *own = NULL;
+    clicon_hash_t *other = NULL;
+    cbuf          *cb = NULL;   /* Conflicting path */
+    cbuf          *cbmsg = NULL;
+    cxobj         *x;
+    int            i;
+    int            ret;
+
+    if ((de = clicon_db_elmnt_get(h, "running")) != NULL &&
+        de->de_gen == ce->ce_privgen)
+        goto ok;
+    if ((yspec = clicon_dbspec_yang(h)) == NULL){
+        clicon_err(OE_YANG, ENOENT, "No yang spec");
+        goto done;
+    }
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (private_db_get(h, "running", &xr) < 0)
+        goto done;
+    if (xml_diff(yspec, ce->ce_privbase, xr, &odvec, &odlen, &oavec, &oalen,
+                 &ochvec0, &ochvec1, &ochlen) < 0)
+        goto done;
+    if (odlen + oalen + ochlen == 0) /* Running not changed */
+        goto based;
+    if (private_db_get(h, ce->ce_privdb, &xp) < 0)
+        goto done;
+    if (xml_diff(yspec, ce->ce_privbase, xp, &dvec, &dlen, &avec, &alen,
+                 &chvec0, &chvec1, &chlen) < 0)
+        goto done;
+    if ((own = clicon_hash_init()) == NULL)
+        goto done;
+    if ((other = clicon_hash_init()) == NULL)
+        goto done;
+    if (private_path_add(dvec, dlen, own) < 0 ||
+        private_path_add(avec, alen, own) < 0 ||
+        private_path_add(chvec1, chlen, own) < 0)
+        goto done;
+    if (private_path_add(odvec, odlen, other) < 0 ||
+        private_path_add(oavec, oalen, other) < 0 ||
+        private_path_add(ochvec1, ochlen, other) < 0)
+        goto done;
+    if ((ret = private_path_overlap(own, other, cb)) < 0)
+        goto done;
+    if (ret == 0 && (ret = private_path_overlap(other, own, cb)) < 0)
+        goto done;
+    if (ret == 1)
+        goto conflict;
+    /* Apply changes of session to a copy of running */
+    if ((xm = xml_dup(xr)) == NULL)
+        goto done;
+    for (i=0; i<dlen; i++){
+        if (private_match(dvec[i], xm, &x) < 0)
+            goto done;
+        if (x && xml_purge(x) < 0)
+            goto done;
+    }
+    if ((ret = private_node_copy(chvec1, chlen, xm, cb)) < 0)
+        goto done;
+    if (ret == 1 && (ret = private_node_copy(avec, alen, xm, cb)) < 0)
+        goto done;
+    if (ret == 0)
+        goto conflict;
+    if (xml_sort_recurse(xm) < 0)
+        goto done;
+    if (private_db_write(h, ce->ce_privdb, xm) < 0)
+        goto done;
+ based:
+    /* The private candidate is now based on the current running */
+    if (ce->ce_privbase)
+        xml_free(ce->ce_privbase);
+    ce->ce_privbase = xr;
+    xr = NULL;
+    if ((de = clicon_db_elmnt_get(h, "running")) != NULL)
+        ce->ce_privgen = de->de_gen;
+ ok:
+    retval = 1;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    if (cbmsg)
+        cbuf_free(cbmsg);
+    if (own)
+        clicon_hash_free(own);
+    if (other)
+        clicon_hash_free(other);
+    if (dvec)
+        free(dvec);
+    if (avec)
+        free(avec);
+    if (chvec0)
+        free(chvec0);
+    if (chvec1)
+        free(chvec1);
+    if (odvec)
+        free(odvec);
+    if (oavec)
+        free(oavec);
+    if (ochvec0)
+        free(ochvec0);
+    if (ochvec1)
+        free(ochvec1);
+    if (xm)
+        xml_free(xm);
+    if (xp)
+        xml_free(xp);
+    if (xr)
+        xml_free(xr);
+    return retval;
+ conflict:
+    if ((cbmsg = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cbmsg, "Commit conflicts with a change in running by another session: %s", cbuf_get(cb));
+    if (netconf_operation_failed(cbret, "application", cbuf_get(cbmsg)) < 0)
+        goto done;
+    retval = 0;
+    goto done;
+}
+
+/*! Commit the private candidate of a session
+ *
+ * First merge changes made in running since the private candidate was copied, then commit
+ * the private candidate as a regular candidate
+ * @param[in]  h      Clicon handle
+ * @param[in]  ce     Client session
+ * @param[in]  xe     Request: <rpc><xn></rpc>  (or NULL)
+ * @param[out] cbret  Return xml tree, eg <rpc-reply>..., <rpc-error.. 
+ * @retval    -1      Error
+ * @retval     0      Conflict or validation failed (with cbret set)
+ * @retval     1      OK
+ * @see candidate_commit
+ */
+int
+private_candidate_commit(clicon_handle        h,
+                         struct client_entry *ce,
+                         cxobj               *xe,
+                         cbuf                *cbret)
+{
+    int   retval = -1;
+    char *db;
+    int   ret;
+
+    if (private_candidate_db(h, ce, "candidate", &db) < 0)
+        goto done;
+    if ((ret = private_candidate_rebase(h, ce, cbret)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    if ((ret = candidate_commit(h, xe, db, cbret)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    if (private_base_set(h, ce) < 0)
+        goto done;
+    retval = 1;
+ done:
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Revert the private candidate of a session to running
+ * @param[in]  h    Clicon handle
+ * @param[in]  ce   Client session
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+int
+private_candidate_discard(clicon_handle        h,
+                          struct client_entry *ce)
+{
+    int   retval = -1;
+    char *db;
+
+    if (private_candidate_db(h, ce, "candidate", &db) < 0)
+        goto done;
+    if (xmldb_copy(h, "running", db) < 0)
+        goto done;
+    xmldb_modified_set(h, db, 0); /* reset dirty bit */
+    if (private_base_set(h, ce) < 0)
+        goto done;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Remove the private candidate of a session, if any, eg when the session is closed
+ * @param[in]  h    Clicon handle
+ * @param[in]  ce   Client session
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+int
+private_candidate_free(clicon_handle        h,
+                       struct client_entry *ce)
+{
+    int      retval = -1;
+    char    *filename = NULL;
+
+    if (ce->ce_privbase){
+        xml_free(ce->ce_privbase);
+        ce->ce_privbase = NULL;
+    }
+    if (ce->ce_privdb == NULL)
+        goto ok;
+    if (xmldb_clear(h, ce->ce_privdb) < 0)
+        goto done;
+    clicon_hash_del(clicon_db_elmnt(h), ce->ce_privdb);
+    if (xmldb_db2file(h, ce->ce_privdb, &filename) < 0)
+        goto done;
+    if (unlink(filename) < 0 && errno != ENOENT){
+        clicon_err(OE_UNIX, errno, "unlink %s", filename);
+        goto done;
+    }
+    free(ce->ce_privdb);
+    ce->ce_privdb = NULL;
+ ok:
+    retval = 0;
+ done:
+    if (filename)
+        free(filename);
+    return retval;
+}
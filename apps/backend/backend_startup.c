@@ -70,6 +70,7 @@
 #include "backend_handle.h"
 #include "clixon_backend_commit.h"
 #include "backend_startup.h"
+#include "backend_history.h"
 
 /*! Merge db1 into db2 without commit 
  * @retval   -1       Error
@@ -153,8 +154,11 @@ startup_mode_startup(clicon_handle        h,
      * The presence of a rollback database means that before the rollback
      * database was deleted, either clixon_backend crashed or the machine
      * rebooted.
+     * With a commit history, the rollback database is created from the history instead.
      */
     if (if_feature(yspec, "ietf-netconf", "confirmed-commit")) {
+        if (history_mark_db(h, "rollback") < 0)
+            goto done;
         if ((rollback_exists = xmldb_exists(h, "rollback")) < 0) {
             clicon_err(OE_DAEMON, 0, "Error checking for the existence of the rollback database");
             goto done;
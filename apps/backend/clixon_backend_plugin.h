@@ -100,6 +100,9 @@ int clixon_plugin_daemon_all(clicon_handle h);
 
 int clixon_plugin_statedata_all(clicon_handle h, yang_stmt *yspec, cvec *nsc, char *xpath,
                                 withdefaults_type wdef, cxobj **xtop);
+int clixon_statedata_cache_register(clicon_handle h, plgstatedata_t *fn, cvec *nsc, char *xpath, uint32_t ttl);
+int clixon_statedata_cache_invalidate(clicon_handle h, cvec *nsc, char *xpath);
+int clixon_statedata_cache_free(clicon_handle h);
 int clixon_plugin_lockdb_all(clicon_handle h, char *db, int lock, int id);
 
 int clixon_pagination_cb_register(clicon_handle h, handler_function fn, char *path, void *arg);
@@ -90,7 +90,11 @@ You can see which CLISPEC it generates via clixon_cli -D 2:
 #include <fcntl.h>
 #include <syslog.h>
 #include <signal.h>
+#include <unistd.h>
+#include <inttypes.h>
+#include <dirent.h>
 #include <sys/param.h>
+#include <sys/stat.h>
 
 /* cligen */
 #include <cligen/cligen.h>
@@ -1298,6 +1302,175 @@ yang2cli_post(clicon_handle h,
     return retval;
 }
 
+/*! Compute autocli cache key of a YANG module set
+ *
+ * The generated clispec of a module depends on the complete module set, eg augments,
+ * deviations and imported groupings, on the autocli configuration and on the Clixon version.
+ * Module files are identified by revision, size and modification time.
+ * @param[in]  h      Clixon handle
+ * @param[in]  yspec  Top-level Yang statement of type Y_SPEC
+ * @param[out] cbkey  Cache key as hex string
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+yang2cli_cache_key(clicon_handle h,
+                   yang_stmt    *yspec,
+                   cbuf         *cbkey)
+{
+    int         retval = -1;
+    cbuf       *cb = NULL;
+    yang_stmt  *ymod;
+    yang_stmt  *yrev;
+    const char *filename;
+    struct stat st;
+    cxobj      *xautocli;
+    uint64_t    hash = 0xcbf29ce484222325ULL; /* FNV-1a */
+    char       *p;
+
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "%s\n", CLIXON_VERSION);
+    ymod = NULL;
+    while ((ymod = yn_each(yspec, ymod)) != NULL){
+        cprintf(cb, "%s", yang_argument_get(ymod));
+        if ((yrev = yang_find(ymod, Y_REVISION, NULL)) != NULL)
+            cprintf(cb, "@%s", yang_argument_get(yrev));
+        if ((filename = yang_filename_get(ymod)) != NULL &&
+            stat(filename, &st) == 0)
+            cprintf(cb, " %lld %lld", (long long)st.st_size, (long long)st.st_mtime);
+        cprintf(cb, "\n");
+    }
+    if ((xautocli = clicon_conf_autocli(h)) != NULL &&
+        clixon_xml2cbuf(cb, xautocli, 0, 0, -1, 0) < 0)
+        goto done;
+    for (p = cbuf_get(cb); *p; p++){
+        hash ^= (uint8_t)*p;
+        hash *= 0x100000001b3ULL;
+    }
+    cprintf(cbkey, "%016" PRIx64, hash);
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Read generated clispec of a module from autocli cache
+ *
+ * @param[in]  dir      Cache directory
+ * @param[in]  key      Cache key of module set, see yang2cli_cache_key
+ * @param[in]  modname  YANG module name
+ * @param[out] cb       Generated clispec (may be empty)
+ * @retval     1        OK, cache hit
+ * @retval     0        Not in cache
+ * @retval    -1        Error
+ */
+static int
+yang2cli_cache_read(char *dir,
+                    char *key,
+                    char *modname,
+                    cbuf *cb)
+{
+    int         retval = -1;
+    char        path[MAXPATHLEN];
+    struct stat st;
+    char       *buf = NULL;
+    int         fd = -1;
+
+    snprintf(path, sizeof(path), "%s/%s@%s.cli", dir, modname, key);
+    if ((fd = open(path, O_RDONLY)) < 0){
+        retval = 0;
+        goto done;
+    }
+    if (fstat(fd, &st) < 0){
+        clicon_err(OE_UNIX, errno, "fstat %s", path);
+        goto done;
+    }
+    if (st.st_size){
+        if ((buf = malloc(st.st_size)) == NULL){
+            clicon_err(OE_UNIX, errno, "malloc");
+            goto done;
+        }
+        if (read(fd, buf, st.st_size) != st.st_size){
+            retval = 0; /* Truncated, regenerate */
+            goto done;
+        }
+        cbuf_append_buf(cb, buf, st.st_size);
+    }
+    retval = 1;
+ done:
+    if (buf)
+        free(buf);
+    if (fd != -1)
+        close(fd);
+    return retval;
+}
+
+/*! Write generated clispec of a module to autocli cache
+ *
+ * The file is written under a temporary name and renamed, since several CLI processes may
+ * generate the same module concurrently.
+ * A cache that cannot be written is logged but is not an error.
+ * Files of the same module with other keys are stale and are removed.
+ * @param[in]  dir      Cache directory
+ * @param[in]  key      Cache key of module set, see yang2cli_cache_key
+ * @param[in]  modname  YANG module name
+ * @param[in]  cb       Generated clispec (may be empty)
+ * @retval     0        OK
+ */
+static int
+yang2cli_cache_write(char *dir,
+                     char *key,
+                     char *modname,
+                     cbuf *cb)
+{
+    char           path[MAXPATHLEN];
+    char           tmppath[MAXPATHLEN];
+    char           name[MAXPATHLEN];
+    int            fd;
+    ssize_t        len;
+    DIR           *dirp;
+    struct dirent *dp;
+    size_t         mlen;
+    size_t         nlen;
+
+    snprintf(path, sizeof(path), "%s/%s@%s.cli", dir, modname, key);
+    snprintf(tmppath, sizeof(tmppath), "%s.%d", path, getpid());
+    if ((fd = open(tmppath, O_WRONLY|O_CREAT|O_TRUNC, S_IRUSR|S_IWUSR|S_IRGRP|S_IROTH)) < 0){
+        clicon_log(LOG_WARNING, "%s: open %s: %s", __FUNCTION__, tmppath, strerror(errno));
+        return 0;
+    }
+    len = write(fd, cbuf_get(cb), cbuf_len(cb));
+    close(fd);
+    if (len != cbuf_len(cb) || rename(tmppath, path) < 0){
+        clicon_log(LOG_WARNING, "%s: write %s: %s", __FUNCTION__, path, strerror(errno));
+        unlink(tmppath);
+        return 0;
+    }
+    /* Remove stale <module>@<other key>.cli, but not temporary files of other processes */
+    if ((dirp = opendir(dir)) == NULL)
+        return 0;
+    snprintf(name, sizeof(name), "%s@%s.cli", modname, key);
+    mlen = strlen(modname);
+    while ((dp = readdir(dirp)) != NULL){
+        nlen = strlen(dp->d_name);
+        if (nlen <= mlen + strlen("@.cli") ||
+            strncmp(dp->d_name, modname, mlen) != 0 ||
+            dp->d_name[mlen] != '@' ||
+            strcmp(dp->d_name + nlen - strlen(".cli"), ".cli") != 0 ||
+            strcmp(dp->d_name, name) == 0)
+            continue;
+        snprintf(path, sizeof(path), "%s/%s", dir, dp->d_name);
+        if (unlink(path) < 0 && errno != ENOENT)
+            clicon_log(LOG_WARNING, "%s: unlink %s: %s", __FUNCTION__, path, strerror(errno));
+    }
+    closedir(dirp);
+    return 0;
+}
+
 /*! Generate clispec for all modules in yspec (except excluded)
  * 
  * @param[in]  h         Clixon handle
@@ -1324,6 +1497,9 @@ yang2cli_yspec(clicon_handle      h,
     cg_obj         *co;
     int             i;
     int             config;
+    char           *cachedir;
+    cbuf           *cbkey = NULL;
+    int             ret;
     
     if ((pt0 = pt_new()) == NULL){
         clicon_err(OE_UNIX, errno, "pt_new");
@@ -1333,6 +1509,15 @@ yang2cli_yspec(clicon_handle      h,
         clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
     }
+    /* Generated clispec is cached per module and module set */
+    if ((cachedir = clicon_option_str(h, "CLICON_CLI_AUTOCLI_CACHE_DIR")) != NULL){
+        if ((cbkey = cbuf_new()) == NULL){
+            clicon_err(OE_XML, errno, "cbuf_new");
+            goto done;
+        }
+        if (yang2cli_cache_key(h, yspec, cbkey) < 0)
+            goto done;
+    }
     /* Traverse YANG, loop through all modules and generate CLI */
     ymod = NULL;
     while ((ymod = yn_each(yspec, ymod)) != NULL){
@@ -1344,8 +1529,18 @@ yang2cli_yspec(clicon_handle      h,
         if (!enable)
             continue;
         cbuf_reset(cb);
-        if (yang2cli_stmt(h, ymod, 0, cb) < 0)
+        ret = 0;
+        if (cachedir &&
+            (ret = yang2cli_cache_read(cachedir, cbuf_get(cbkey), yang_argument_get(ymod), cb)) < 0)
             goto done;
+        if (ret == 0){
+            cbuf_reset(cb);
+            if (yang2cli_stmt(h, ymod, 0, cb) < 0)
+                goto done;
+            if (cachedir &&
+                yang2cli_cache_write(cachedir, cbuf_get(cbkey), yang_argument_get(ymod), cb) < 0)
+                goto done;
+        }
         if (cbuf_len(cb) == 0)
             continue;
         /* Note Tie-break of same top-level symbol: prefix is NYI
@@ -1419,11 +1614,61 @@ yang2cli_yspec(clicon_handle      h,
         pt_free(pt, 1);
     if (pt0)
         pt_free(pt0, 1);
+    if (cbkey)
+        cbuf_free(cbkey);
     if (cb)
         cbuf_free(cb);
     return retval;
 }
 
+/*! Defer generation of clispec for all modules in yspec until the tree is first used
+ *
+ * @param[in]  h         Clixon handle
+ * @param[in]  treename  Name of tree
+ * @retval     0         OK
+ * @retval    -1         Error
+ * @see yang2cli_pending  where the tree is generated
+ */
+int
+yang2cli_yspec_defer(clicon_handle h,
+                     char         *treename)
+{
+    return clicon_data_set(h, "autocli-pending", treename);
+}
+
+/*! Generate a deferred autocli tree, if any
+ *
+ * CLIgen resolves references to the autocli tree when a command is matched or completed.
+ * Therefore this is called before a command is read or parsed.
+ * @param[in]  h         Clixon handle
+ * @retval     0         OK
+ * @retval    -1         Error
+ * @see yang2cli_yspec_defer
+ */
+int
+yang2cli_pending(clicon_handle h)
+{
+    int   retval = -1;
+    char *treename = NULL;
+
+    if (clicon_data_get(h, "autocli-pending", &treename) < 0)
+        goto ok;
+    if ((treename = strdup(treename)) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    if (clicon_data_del(h, "autocli-pending") < 0)
+        goto done;
+    if (yang2cli_yspec(h, clicon_dbspec_yang(h), treename, 0) < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    if (treename)
+        free(treename);
+    return retval;
+}
+
 /*! Init yang2cli
  *
  * Initialize CLIgen generation from YANG models.
@@ -57,6 +57,8 @@
  * Prototypes
  */
 int yang2cli_yspec(clicon_handle h, yang_stmt *yspec, char *treename, int printgen);
+int yang2cli_yspec_defer(clicon_handle h, char *treename);
+int yang2cli_pending(clicon_handle h);
 int yang2cli_init(clicon_handle h);
 
 #endif  /* _CLI_GENERATE_H_ */
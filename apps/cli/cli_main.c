@@ -178,6 +178,7 @@ cli_terminate(clicon_handle h)
         xml_free(x);
     clicon_data_cvec_del(h, "cli-edit-cvv");;
     clicon_data_cvec_del(h, "cli-edit-filter");;
+    expand_dbvar_cache_clear(h);
     xpath_optimize_exit();
     /* Delete all plugins, and RPC callbacks */
     clixon_plugin_module_exit(h);
@@ -365,6 +366,7 @@ autocli_trees_default(clicon_handle h)
  * Generate clispec (basemodel) from YANG dataspec and add to the set of cligen trees 
  * This tree is referenced from the main CLI spec (CLICON_CLISPEC_DIR) using the 
  * "tree reference" syntax.
+ * Generation is deferred until a command is first read or parsed, unless it is printed.
  *
  * @param[in]  h        Clixon handle
  * @param[in]  printgen Print CLI syntax generated from dbspec
@@ -398,7 +400,11 @@ autocli_start(clicon_handle h,
         goto done;
     yspec = clicon_dbspec_yang(h);
     /* The actual generating call from yang to clispec for the complete yang spec */
-    if (yang2cli_yspec(h, yspec, AUTOCLI_TREENAME, printgen) < 0)
+    if (printgen){
+        if (yang2cli_yspec(h, yspec, AUTOCLI_TREENAME, printgen) < 0)
+            goto done;
+    }
+    else if (yang2cli_yspec_defer(h, AUTOCLI_TREENAME) < 0)
         goto done;
     /* XXX Create pre-5.5 tree-refs for backward compatibility */    
     if (autocli_trees_default(h) < 0)
@@ -68,6 +68,7 @@
 #include "cli_plugin.h"
 #include "cli_handle.h"
 #include "cli_generate.h"
+#include "cli_common.h"
 
 /*
  * Constants
@@ -567,6 +568,8 @@ clicon_parse(clicon_handle  h,
     cligen_handle     ch;
     
     ch = cli_cligen(h);
+    if (yang2cli_pending(h) < 0)
+        goto done;
     if (clicon_get_logflags()&CLICON_LOG_STDOUT)
         f = stdout;
     else
@@ -619,6 +622,9 @@ clicon_parse(clicon_handle  h,
             }
             else
                 ret = 0;
+            /* Command may have changed the datastore */
+            if (expand_dbvar_cache_clear(h) < 0)
+                goto done;
             if (evalres)
                 *evalres = ret;
             break;
@@ -759,6 +765,8 @@ clicon_cliread(clicon_handle h,
     clixon_plugin_t  *cp;
     char             *promptstr;
 
+    if (yang2cli_pending(h) < 0)
+        goto done;
     stx = cli_syntax(h);
     mode = stx->stx_active_mode;
     /* Get prompt from plugin callback? */
@@ -56,6 +56,7 @@
 #include <netinet/in.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/time.h>
 #include <fcntl.h>
 #include <sys/wait.h>
 #include <sys/param.h>
@@ -166,6 +167,194 @@ xpath_append(cbuf      *cb0,
     return retval;
 }
 
+/* Name of expand cache in clicon handle */
+#define CLI_EXPAND_CACHE "cli-expand-cache"
+
+/*! Cache of the last values read from the backend by expand_dbvar
+ *
+ * Expanding the same variable again while more characters of the value are typed is
+ * served from the cache, unless it has expired or the earlier reply was truncated.
+ */
+typedef struct {
+    char          *ec_key;      /* Datastore, xpath and exact tokens of request */
+    char          *ec_prefix;   /* Prefix of request, or NULL */
+    int            ec_complete; /* All values starting with prefix are in reply */
+    struct timeval ec_time;     /* Time of request */
+    cxobj         *ec_xt;       /* Reply: <rpc-reply><value>...</rpc-reply> */
+} expand_cache;
+
+/*! Clear expand_dbvar values cache
+ *
+ * Called when a command is executed, since it may change the datastore
+ * @param[in]  h   Clicon handle
+ * @retval     0   OK
+ */
+int
+expand_dbvar_cache_clear(clicon_handle h)
+{
+    expand_cache *ec = NULL;
+
+    if (clicon_ptr_get(h, CLI_EXPAND_CACHE, (void**)&ec) == 0 && ec != NULL){
+        if (ec->ec_key)
+            free(ec->ec_key);
+        if (ec->ec_prefix)
+            free(ec->ec_prefix);
+        if (ec->ec_xt)
+            xml_free(ec->ec_xt);
+        free(ec);
+        clicon_ptr_del(h, CLI_EXPAND_CACHE);
+    }
+    return 0;
+}
+
+/*! Split the command so far into the last (partial) token and the other tokens
+ *
+ * The last token is the typed prefix of the value being expanded. The other tokens are
+ * requested as exact values, since the expand callback is also called for earlier
+ * variables when the whole command is matched.
+ * @param[in]  cvv     The command so far, [0] is the command string
+ * @param[out] prefix  Last token or NULL if command ends with space. Free with free()
+ * @param[out] exact   Other tokens. Free with cvec_free()
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+expand_dbvar_tokens(cvec  *cvv,
+                    char **prefix,
+                    cvec **exact)
+{
+    int     retval = -1;
+    cg_var *cv;
+    char   *cmd;
+    char  **vec = NULL;
+    int     nvec = 0;
+    int     i;
+
+    *prefix = NULL;
+    if ((*exact = cvec_new(0)) == NULL){
+        clicon_err(OE_UNIX, errno, "cvec_new");
+        goto done;
+    }
+    if (cvv == NULL ||
+        (cv = cvec_i(cvv, 0)) == NULL ||
+        (cmd = cv_string_get(cv)) == NULL)
+        goto ok;
+    if ((vec = clicon_strsep(cmd, " \t", &nvec)) == NULL)
+        goto ok;
+    for (i=0; i<nvec; i++){
+        if (strlen(vec[i]) == 0)
+            continue;
+        if (i == nvec-1){
+            if (strpbrk(vec[i], "\"\\") == NULL &&
+                (*prefix = strdup(vec[i])) == NULL){
+                clicon_err(OE_UNIX, errno, "strdup");
+                goto done;
+            }
+        }
+        else if ((cv = cvec_add(*exact, CGV_STRING)) == NULL ||
+                 cv_string_set(cv, vec[i]) == NULL){
+            clicon_err(OE_UNIX, errno, "cvec_add");
+            goto done;
+        }
+    }
+ ok:
+    retval = 0;
+ done:
+    if (vec)
+        free(vec);
+    return retval;
+}
+
+/*! Get values for expansion from the backend or from the expand cache
+ *
+ * @param[in]  h       Clicon handle
+ * @param[in]  db      Name of datastore
+ * @param[in]  xpath   XPath of values
+ * @param[in]  nsc     Namespace context of xpath
+ * @param[in]  prefix  Typed prefix of value, or NULL
+ * @param[in]  exact   Other tokens of command
+ * @param[in]  limit   Max number of values, 0 is unbounded
+ * @param[out] xtp     Reply, owned by cache, do not free
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+expand_dbvar_get(clicon_handle h,
+                 char         *db,
+                 char         *xpath,
+                 cvec         *nsc,
+                 char         *prefix,
+                 cvec         *exact,
+                 uint32_t      limit,
+                 cxobj       **xtp)
+{
+    int            retval = -1;
+    expand_cache  *ec = NULL;
+    cbuf          *cbkey = NULL;
+    cg_var        *cv = NULL;
+    cxobj         *xt = NULL;
+    struct timeval now;
+    struct timeval td;
+    uint32_t       n;
+
+    if ((cbkey = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cbkey, "%s %s", db, xpath);
+    while ((cv = cvec_each(exact, cv)) != NULL)
+        cprintf(cbkey, " %s", cv_string_get(cv));
+    gettimeofday(&now, NULL);
+    if (clicon_ptr_get(h, CLI_EXPAND_CACHE, (void**)&ec) == 0 && ec != NULL){
+        timersub(&now, &ec->ec_time, &td);
+        if (td.tv_sec*1000 + td.tv_usec/1000 < CLI_EXPAND_CACHE_MS &&
+            ec->ec_complete &&
+            strcmp(ec->ec_key, cbuf_get(cbkey)) == 0 &&
+            (ec->ec_prefix == NULL ||
+             (prefix != NULL && strncmp(prefix, ec->ec_prefix, strlen(ec->ec_prefix)) == 0))){
+            clicon_debug(1, "%s cache hit: %s", __FUNCTION__, cbuf_get(cbkey));
+            *xtp = ec->ec_xt;
+            goto ok;
+        }
+    }
+    if (clicon_rpc_expand_values(h, db, xpath, nsc, prefix, exact, limit, &xt) < 0)
+        goto done;
+    if (expand_dbvar_cache_clear(h) < 0)
+        goto done;
+    if ((ec = malloc(sizeof(*ec))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(ec, 0, sizeof(*ec));
+    if ((ec->ec_key = strdup(cbuf_get(cbkey))) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        free(ec);
+        goto done;
+    }
+    if (prefix && (ec->ec_prefix = strdup(prefix)) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        free(ec->ec_key);
+        free(ec);
+        goto done;
+    }
+    n = xml_child_nr_type(xt, CX_ELMNT);
+    ec->ec_complete = (limit == 0 || n < limit) &&
+        xml_find_type(xt, NULL, "rpc-error", CX_ELMNT) == NULL;
+    ec->ec_time = now;
+    ec->ec_xt = xt;
+    clicon_ptr_set(h, CLI_EXPAND_CACHE, ec);
+    *xtp = xt;
+    xt = NULL;
+ ok:
+    retval = 0;
+ done:
+    if (xt)
+        xml_free(xt);
+    if (cbkey)
+        cbuf_free(cbkey);
+    return retval;
+}
+
 /*! Completion callback intended for automatically generated data model
  *
  * Returns an expand-type list of commands as used by cligen 'expand' 
@@ -192,16 +381,16 @@ expand_dbvar(void   *h,
     char            *api_path_fmt;
     char            *api_path = NULL;
     char            *dbstr;    
-    cxobj           *xt = NULL;
+    cxobj           *xt = NULL; /* owned by expand cache */
     char            *xpath = NULL;
-    cxobj          **xvec = NULL;
     cxobj           *xe; /* direct ptr */
     cxobj           *xerr = NULL; /* free */
-    size_t           xlen = 0;
     cxobj           *x;
     char            *bodystr;
-    int              i;
     char            *bodystr0 = NULL; /* previous */
+    char            *prefix = NULL;
+    cvec            *exact = NULL;
+    int              userorder;
     cg_var          *cv;
     yang_stmt       *yspec;
     cxobj           *xtop = NULL; /* xpath root */
@@ -314,33 +503,31 @@ expand_dbvar(void   *h,
         if (xpath_append(cbxpath, yang_argument_get(ypath), y, nsc) < 0)
             goto done;
     }
-    /* Get configuration based on cbxpath */
-    if (clicon_rpc_get_config(h, NULL, dbstr, cbuf_get(cbxpath), nsc, NULL, &xt) < 0) 
+    /* Get values based on cbxpath, filtered by the typed prefix */
+    if (expand_dbvar_tokens(cvv, &prefix, &exact) < 0)
         goto done;
-    if ((xe = xpath_first(xt, NULL, "/rpc-error")) != NULL){
+    if (expand_dbvar_get(h, dbstr, cbuf_get(cbxpath), nsc, prefix, exact,
+                         clicon_option_int(h, "CLICON_CLI_EXPAND_LIMIT"), &xt) < 0)
+        goto done;
+    if ((xe = xpath_first(xt, NULL, "rpc-error")) != NULL){
         clixon_netconf_error(xe, "Get configuration", NULL);
         goto ok; 
     }
-    if (xpath_vec(xt, nsc, "%s", &xvec, &xlen, cbuf_get(cbxpath)) < 0) 
-        goto done;
     /* Loop for inserting into commands cvec. 
      * Detect duplicates: for ordered-by system assume list is ordered, so you need
      * just remember previous
-     * but for ordered-by system, check the whole list
+     * but for ordered-by user, check the whole list
      */
+    userorder = (yp = yang_parent_get(y)) != NULL &&
+        yang_keyword_get(yp) == Y_LIST &&
+        yang_find(yp, Y_ORDERED_BY, "user") != NULL;
     bodystr0 = NULL;
-    for (i = 0; i < xlen; i++) {
-        x = xvec[i];
-        if (xml_type(x) == CX_BODY)
-            bodystr = xml_value(x);
-        else
-            bodystr = xml_body(x);
-        if (bodystr == NULL)
+    x = NULL;
+    while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
+        if (strcmp(xml_name(x), "value") != 0 ||
+            (bodystr = xml_body(x)) == NULL)
             continue; /* no body, cornercase */
-        if ((y = xml_spec(x)) != NULL &&
-            (yp = yang_parent_get(y)) != NULL &&
-            yang_keyword_get(yp) == Y_LIST &&
-            yang_find(yp, Y_ORDERED_BY, "user") != NULL){
+        if (userorder){
             /* Detect duplicates linearly in existing values */
             {
                 cg_var *cv = NULL;
@@ -362,6 +549,10 @@ expand_dbvar(void   *h,
  ok:
     retval = 0;
   done:
+    if (prefix)
+        free(prefix);
+    if (exact)
+        cvec_free(exact);
     if (cbxpath)
         cbuf_free(cbxpath);
     if (xerr)
@@ -370,12 +561,8 @@ expand_dbvar(void   *h,
         xml_nsctx_free(nsc);
     if (api_path)
         free(api_path);
-    if (xvec)
-        free(xvec);
     if (xtop)
         xml_free(xtop);
-    if (xt)
-        xml_free(xt);
     if (xpath) 
         free(xpath);
     return retval;
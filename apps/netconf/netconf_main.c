@@ -74,13 +74,31 @@
 
 #define NETCONF_LOGFILE "/tmp/clixon_netconf.log"
 
-/* clixon-data value to save buffer between invocations.
- * Saving data may be necessary if socket buffer contains partial netconf messages, such as:
+/*! Pipelined rpc forwarded to backend, reply not yet read
+ */
+struct netconf_pending {
+    qelem_t         np_qelem;  /* List header */
+    cxobj          *np_xrpc;   /* Request, attributes are copied to reply */
+};
+
+/* clixon-data pointer to save input state between invocations.
+ * Saving state may be necessary if socket buffer contains partial netconf messages, such as:
  * <foo/> ..wait 1min  ]]>]]>
  */
-#define NETCONF_HASH_BUF "netconf_input_cbuf"
-#define NETCONF_FRAME_STATE "netconf_input_frame_state"
-#define NETCONF_FRAME_SIZE "netconf_input_frame_size"
+#define NETCONF_INPUT "netconf-input"
+
+/*! Input state of netconf session: framing state and incremental parse of current frame
+ */
+typedef struct {
+    int             nf_state;  /* Framing state, chunked or end-of-message */
+    size_t          nf_size;   /* Remaining size of chunk (chunked framing) */
+    cxobj          *nf_xtop;   /* XML top of current frame */
+    clixon_xml_sax *nf_xs;     /* Push parser of current frame, NULL if no data */
+    size_t          nf_len;    /* Bytes of data in current frame */
+    char           *nf_reason; /* Parse error in current frame, reported at end of frame */
+    struct netconf_pending *nf_pending; /* Pipelined requests waiting for backend reply */
+    int             nf_pending_nr; /* Length of pending list */
+} netconf_input;
 
 /*! Ignore errors on packet errors: continue */
 static int ignore_packet_errors = 1;
@@ -178,6 +196,220 @@ netconf_hello_msg(clicon_handle h,
     return retval;
 }
 
+/*! Reset input frame state of a netconf session
+ * @param[in]  nf   Netconf input state
+ */
+static int
+netconf_input_reset(netconf_input *nf)
+{
+    if (nf->nf_xs){
+        clixon_xml_sax_free(nf->nf_xs);
+        nf->nf_xs = NULL;
+    }
+    if (nf->nf_xtop){
+        xml_free(nf->nf_xtop);
+        nf->nf_xtop = NULL;
+    }
+    if (nf->nf_reason){
+        free(nf->nf_reason);
+        nf->nf_reason = NULL;
+    }
+    nf->nf_len = 0;
+    return 0;
+}
+
+/*! Get netconf input state from handle, create if not present
+ * @param[in]  h    Clixon handle
+ * @retval     nf   Netconf input state
+ * @retval     NULL Error
+ */
+static netconf_input *
+netconf_input_get(clicon_handle h)
+{
+    netconf_input *nf = NULL;
+
+    if (clicon_ptr_get(h, NETCONF_INPUT, (void**)&nf) == 0 && nf != NULL)
+        return nf;
+    if ((nf = malloc(sizeof(*nf))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        return NULL;
+    }
+    memset(nf, 0, sizeof(*nf));
+    if (clicon_ptr_set(h, NETCONF_INPUT, nf) < 0){
+        free(nf);
+        return NULL;
+    }
+    return nf;
+}
+
+/*! Free netconf input state of handle
+ * @param[in]  h    Clixon handle
+ */
+static int
+netconf_input_free(clicon_handle h)
+{
+    netconf_input *nf = NULL;
+
+    struct netconf_pending *np;
+
+    if (clicon_ptr_get(h, NETCONF_INPUT, (void**)&nf) == 0 && nf != NULL){
+        netconf_input_reset(nf);
+        while ((np = nf->nf_pending) != NULL){
+            DELQ(np, nf->nf_pending, struct netconf_pending *);
+            xml_free(np->np_xrpc);
+            free(np);
+        }
+        free(nf);
+        clicon_ptr_del(h, NETCONF_INPUT);
+    }
+    return 0;
+}
+
+/*! Send reply of netconf rpc
+ * @param[in]   h     Clixon handle
+ * @param[in]   xrpc  Incoming request
+ * @param[in]   xret  Reply from dispatch or backend, or NULL
+ * @retval      0     OK
+ * @retval     -1     Error
+ */
+static int
+netconf_rpc_reply(clicon_handle h,
+                  cxobj        *xrpc,
+                  cxobj        *xret)
+{
+    int    retval = -1;
+    cxobj *xerr = NULL;
+    cbuf  *cbret = NULL;
+    cxobj *xc;
+    netconf_framing_type framing;
+
+    framing = clicon_option_int(h, "netconf-framing");
+    if ((cbret = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    /* Is there a return message in xret? */
+    if (xret == NULL){
+        if (netconf_operation_failed_xml(&xerr, "rpc", "Internal error: no xml return")< 0)
+            goto done;
+        if (netconf_add_request_attr(xrpc, xerr) < 0)
+            goto done;
+        if (clixon_xml2cbuf(cbret, xerr, 0, 0, -1, 0) < 0)
+            goto done;
+        if (netconf_output_framed(1, framing, cbret, "rpc-error") < 0)
+            goto done;
+        goto ok;
+    }
+    if ((xc = xml_child_i(xret, 0))!=NULL){
+        /* Copy attributes from incoming request to reply. Skip already present (dont overwrite) */
+        if (netconf_add_request_attr(xrpc, xc) < 0)
+            goto done;
+        if (clixon_xml2cbuf(cbret, xc, 0, 0, -1, 0) < 0)
+            goto done;
+        if (netconf_output_framed(1, framing, cbret, "rpc-reply") < 0)
+            goto done;
+    }
+ ok:
+    retval = 0;
+ done:
+    if (cbret)
+        cbuf_free(cbret);
+    if (xerr)
+        xml_free(xerr);
+    return retval;
+}
+
+/*! Read replies of all pipelined requests from backend and send them in request order
+ *
+ * Must be called before any other output to the client, to keep replies in order
+ * @param[in]   h     Clixon handle
+ * @retval      0     OK
+ * @retval     -1     Error
+ */
+static int
+netconf_pipeline_flush(clicon_handle h)
+{
+    int                     retval = -1;
+    netconf_input          *nf;
+    struct netconf_pending *np;
+    cxobj                  *xret = NULL;
+    cxobj                  *xe;
+
+    if ((nf = netconf_input_get(h)) == NULL)
+        goto done;
+    while ((np = nf->nf_pending) != NULL){
+        DELQ(np, nf->nf_pending, struct netconf_pending *);
+        nf->nf_pending_nr--;
+        xe = xml_child_i_type(np->np_xrpc, 0, CX_ELMNT);
+        if (clicon_rpc_netconf_xml_recv(h, xml_name(xe), &xret) < 0 ||
+            netconf_rpc_reply(h, np->np_xrpc, xret) < 0){
+            xml_free(np->np_xrpc);
+            free(np);
+            goto done;
+        }
+        if (xret){
+            xml_free(xret);
+            xret = NULL;
+        }
+        xml_free(np->np_xrpc);
+        free(np);
+    }
+    retval = 0;
+ done:
+    if (xret)
+        xml_free(xret);
+    return retval;
+}
+
+/*! Forward netconf rpc to backend and queue it if it can be pipelined
+ *
+ * The request is removed from its parent and kept until its reply is sent
+ * @param[in]   h     Clixon handle
+ * @param[in]   xrpc  Incoming request, bound and validated
+ * @retval      1     Request is pipelined
+ * @retval      0     Not pipelined, handle request synchronously
+ * @retval     -1     Error
+ */
+static int
+netconf_pipeline_send(clicon_handle h,
+                      cxobj        *xrpc)
+{
+    int                     retval = -1;
+    netconf_input          *nf;
+    struct netconf_pending *np;
+    int                     ret;
+
+    if (NETCONF_PIPELINE_NR == 0)
+        return 0;
+    if ((nf = netconf_input_get(h)) == NULL)
+        goto done;
+    if ((ret = netconf_rpc_pipeline(h, xrpc)) < 0)
+        goto done;
+    if (ret == 0){
+        retval = 0;
+        goto done;
+    }
+    if ((np = malloc(sizeof(*np))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(np, 0, sizeof(*np));
+    if (xml_rm(xrpc) < 0){
+        free(np);
+        goto done;
+    }
+    np->np_xrpc = xrpc;
+    ADDQ(np, nf->nf_pending);
+    nf->nf_pending_nr++;
+    /* Limit outstanding requests, backend replies are not read while sending */
+    if (nf->nf_pending_nr >= NETCONF_PIPELINE_NR &&
+        netconf_pipeline_flush(h) < 0)
+        goto done;
+    retval = 1;
+ done:
+    return retval;
+}
+
 /*! Process incoming Netconf RPC netconf message 
  * @param[in]   h     Clixon handle
  * @param[in]   xreq  XML tree containing netconf RPC message
@@ -196,12 +428,13 @@ netconf_rpc_message(clicon_handle h,
     cxobj *xret = NULL; /* Return (out) */
     int    ret;
     cbuf  *cbret = NULL;
-    cxobj *xc;
     netconf_framing_type framing;
 
     framing = clicon_option_int(h, "netconf-framing");
     if (_netconf_hello_nr == 0 &&
         clicon_option_bool(h, "CLICON_NETCONF_HELLO_OPTIONAL") == 0){
+        if (netconf_pipeline_flush(h) < 0)
+            goto done;
         if (netconf_operation_failed_xml(&xret, "rpc", "Client must send an hello element before any RPC")< 0)
             goto done;
         /* Copy attributes from incoming request to reply. Skip already present (dont overwrite) */
@@ -213,9 +446,7 @@ netconf_rpc_message(clicon_handle h,
         }
         if (clixon_xml2cbuf(cbret, xret, 0, 0, -1, 0) < 0)
             goto done;
-        if (netconf_output_encap(framing, cbret) < 0)
-            goto done;
-        if (netconf_output(1, cbret, "rpc-error") < 0)
+        if (netconf_output_framed(1, framing, cbret, "rpc-error") < 0)
             goto done;
         *eof = 1;
         goto ok;
@@ -226,6 +457,8 @@ netconf_rpc_message(clicon_handle h,
         (ret = xml_yang_validate_rpc(h, xrpc, 0, &xret)) < 0) 
         goto done;
     if (ret == 0){
+        if (netconf_pipeline_flush(h) < 0)
+            goto done;
         if (netconf_add_request_attr(xrpc, xret) < 0)
             goto done;
         if ((cbret = cbuf_new()) == NULL){ 
@@ -234,48 +467,22 @@ netconf_rpc_message(clicon_handle h,
         }
         if (clixon_xml2cbuf(cbret, xret, 0, 0, -1, 0) < 0)
             goto done;
-        if (netconf_output_encap(framing, cbret) < 0)
-            goto done;
-        if (netconf_output(1, cbret, "rpc-error") < 0)
+        if (netconf_output_framed(1, framing, cbret, "rpc-error") < 0)
             goto done;
         goto ok;
     }
-    if (netconf_rpc_dispatch(h, xrpc, &xret, eof) < 0){
+    /* Forward to backend without waiting for reply if possible */
+    if ((ret = netconf_pipeline_send(h, xrpc)) < 0)
         goto done;
-    }
-    /* Is there a return message in xret? */
-    if (xret == NULL){
-        if (netconf_operation_failed_xml(&xret, "rpc", "Internal error: no xml return")< 0)
-            goto done;
-        if (netconf_add_request_attr(xrpc, xret) < 0)
-            goto done;
-        if ((cbret = cbuf_new()) == NULL){ 
-            clicon_err(OE_XML, errno, "cbuf_new");
-            goto done;
-        }
-        if (clixon_xml2cbuf(cbret, xret, 0, 0, -1, 0) < 0)
-            goto done;
-        if (netconf_output_encap(framing, cbret) < 0)
-            goto done;
-        if (netconf_output(1, cbret, "rpc-error") < 0)
-            goto done;
+    if (ret == 1)
         goto ok;
+    if (netconf_pipeline_flush(h) < 0)
+        goto done;
+    if (netconf_rpc_dispatch(h, xrpc, &xret, eof) < 0){
+        goto done;
     }
-    if ((xc = xml_child_i(xret, 0))!=NULL){
-        /* Copy attributes from incoming request to reply. Skip already present (dont overwrite) */
-        if (netconf_add_request_attr(xrpc, xc) < 0)
-            goto done;
-        if ((cbret = cbuf_new()) == NULL){ 
-            clicon_err(OE_XML, errno, "cbuf_new");
-            goto done;
-        }
-        if (clixon_xml2cbuf(cbret, xml_child_i(xret,0), 0, 0, -1, 0) < 0)
-            goto done;
-        if (netconf_output_encap(framing, cbret) < 0)
-            goto done;
-        if (netconf_output(1, cbret, "rpc-reply") < 0)
-            goto done;
-    }
+    if (netconf_rpc_reply(h, xrpc, xret) < 0)
+        goto done;
  ok:
     retval = 0;
  done:
@@ -318,6 +525,8 @@ netconf_input_packet(clicon_handle h,
     if (strcmp(rpcname, "rpc") == 0){
         /* Only accept resolved NETCONF base namespace */
         if (namespace == NULL || strcmp(namespace, NETCONF_BASE_NAMESPACE) != 0){
+            if (netconf_pipeline_flush(h) < 0)
+                goto done;
             if (netconf_unknown_namespace_xml(&xret, "protocol", rpcprefix, "No appropriate namespace associated with prefix")< 0)
                 goto done;
             if (netconf_add_request_attr(xreq, xret) < 0)
@@ -328,9 +537,7 @@ netconf_input_packet(clicon_handle h,
             }
             if (clixon_xml2cbuf(cbret, xret, 0, 0, -1, 0) < 0)
                 goto done;
-            if (netconf_output_encap(framing, cbret) < 0)
-                goto done;
-            if (netconf_output(1, cbret, "rpc-error") < 0)
+            if (netconf_output_framed(1, framing, cbret, "rpc-error") < 0)
                 goto done;
             goto ok;
         }
@@ -338,6 +545,8 @@ netconf_input_packet(clicon_handle h,
             goto done;
     }
     else if (strcmp(rpcname, "hello") == 0){
+        if (netconf_pipeline_flush(h) < 0)
+            goto done;
         /* Only accept resolved NETCONF base namespace -> terminate*/
         if (namespace == NULL || strcmp(namespace, NETCONF_BASE_NAMESPACE) != 0){
             *eof = 1;
@@ -361,10 +570,67 @@ netconf_input_packet(clicon_handle h,
     return retval;
 }
 
-/*! Process incoming frame, ie a char message framed by ]]>]]>
- * Parse string to xml, check only one netconf message within a frame
+/*! Push frame payload data directly to the XML parser of the current frame
+ *
+ * The parser is created on the first data of a frame. NULL chars (eg from terminals) are
+ * skipped. A parse error is saved and reported when the frame ends, the rest of the frame
+ * is then discarded.
+ * @param[in]  h    Clixon handle
+ * @param[in]  nf   Netconf input state
+ * @param[in]  buf  Frame payload, not null-terminated
+ * @param[in]  len  Length of payload
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+netconf_input_push(clicon_handle  h,
+                   netconf_input *nf,
+                   const char    *buf,
+                   size_t         len)
+{
+    int         retval = -1;
+    const char *p;
+    size_t      n;
+
+    if (len == 0)
+        goto ok;
+    clicon_debug(2, "%s: \"%.*s\"", __FUNCTION__, (int)len, buf);
+    if (nf->nf_reason) /* Parse error earlier in frame */
+        goto ok;
+    if (nf->nf_xs == NULL){
+        if ((nf->nf_xtop = xml_new(XML_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
+            goto done;
+        if ((nf->nf_xs = clixon_xml_sax_new(YB_RPC, clicon_dbspec_yang(h), nf->nf_xtop)) == NULL)
+            goto done;
+    }
+    while (len > 0){
+        if ((p = memchr(buf, '\0', len)) != NULL)
+            n = p - buf;
+        else
+            n = len;
+        if (n && clixon_xml_sax_push(nf->nf_xs, buf, n) < 0){
+            if ((nf->nf_reason = strdup(clicon_err_reason)) == NULL){
+                clicon_err(OE_UNIX, errno, "strdup");
+                goto done;
+            }
+            break;
+        }
+        nf->nf_len += n;
+        if (p == NULL)
+            break;
+        buf += n + 1; /* Skip NULL char */
+        len -= n + 1;
+    }
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Process incoming frame, ie a message framed by ]]>]]> or chunked framing
+ * Complete parsing of the frame, check only one netconf message within a frame
  * @param[in]   h    Clixon handle
- * @param[in]   cb   Packet buffer
+ * @param[in]   nf   Netconf input state, payload of frame has been pushed to parser
  * @param[out]  eof  Set to 1 if pending close socket
  * @retval      0    OK
  * @retval     -1    Fatal error
@@ -381,98 +647,79 @@ netconf_input_packet(clicon_handle h,
  * - RPC messages: send rpc-error
  */
 static int
-netconf_input_frame(clicon_handle h, 
-                    cbuf         *cb,
-                    int          *eof)
+netconf_input_frame(clicon_handle  h,
+                    netconf_input *nf,
+                    int           *eof)
 {
     int        retval = -1;
-    char      *str = NULL;
-    cxobj     *xtop = NULL; /* Request (in) */
+    cxobj     *xtop;        /* Request (in) */
     cxobj     *xreq = NULL;
     cxobj     *xret = NULL; /* Return (out) */
     cbuf      *cbret = NULL;
     yang_stmt *yspec;
     int        ret;
     netconf_framing_type framing;
-    
+
     clicon_debug(1, "%s", __FUNCTION__);
-    clicon_debug(2, "%s: \"%s\"", __FUNCTION__, cbuf_get(cb));
     framing = clicon_option_int(h, "netconf-framing");
     yspec = clicon_dbspec_yang(h);
-    if ((str = strdup(cbuf_get(cb))) == NULL){
-        clicon_err(OE_UNIX, errno, "strdup");
+    if ((cbret = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
         goto done;
     }
     /* Special case:  */
-    if (strlen(str) == 0){
-        if ((cbret = cbuf_new()) == NULL){ 
-            clicon_err(OE_UNIX, errno, "cbuf_new");
+    if (nf->nf_len == 0 && nf->nf_reason == NULL){
+        if (netconf_pipeline_flush(h) < 0)
             goto done;
-        }
         if (netconf_operation_failed(cbret, "rpc", "Empty XML")< 0)
             goto done;
-        if (netconf_output_encap(framing, cbret) < 0)
-            goto done;
-        if (netconf_output(1, cbret, "rpc-error") < 0)
+        if (netconf_output_framed(1, framing, cbret, "rpc-error") < 0)
             goto done;
         goto ok;
     }
-    /* Parse incoming XML message */
-    if ((ret = clixon_xml_parse_string(str, YB_RPC, yspec, &xtop, &xret)) < 0){ 
-        if ((cbret = cbuf_new()) == NULL){ 
-            clicon_err(OE_UNIX, errno, "cbuf_new");
+    /* Parse error in pushed data, or incomplete XML at end of frame */
+    if (nf->nf_reason != NULL ||
+        (ret = clixon_xml_sax_end(nf->nf_xs, &xret)) < 0){
+        if (netconf_pipeline_flush(h) < 0)
             goto done;
-        }
-        if (netconf_operation_failed(cbret, "rpc", clicon_err_reason)< 0)
-            goto done;
-        if (netconf_output_encap(framing, cbret) < 0)
+        if (netconf_operation_failed(cbret, "rpc",
+                                     nf->nf_reason?nf->nf_reason:clicon_err_reason)< 0)
             goto done;
-        if (netconf_output(1, cbret, "rpc-error") < 0)
+        if (netconf_output_framed(1, framing, cbret, "rpc-error") < 0)
             goto done;
         goto ok;
     }
     if (ret == 0){
         /* Note: xtop can be "hello" in which case one (maybe) should drop the session and log
-         * However, its not until netconf_input_packet that rpc vs hello vs other identification is 
+         * However, its not until netconf_input_packet that rpc vs hello vs other identification is
          * actually made.
          * Actually, there are no error replies to hello messages according to any RFC, so
          * rpc error reply here is non-standard, but may be useful.
          */
-        if ((cbret = cbuf_new()) == NULL){ 
-            clicon_err(OE_XML, errno, "cbuf_new");
+        if (netconf_pipeline_flush(h) < 0)
             goto done;
-        }
         if (clixon_xml2cbuf(cbret, xret, 0, 0, -1, 0) < 0)
             goto done;
-        if (netconf_output_encap(framing, cbret) < 0)
-            goto done;
-        if (netconf_output(1, cbret, "rpc-error") < 0)
+        if (netconf_output_framed(1, framing, cbret, "rpc-error") < 0)
             goto done;
         goto ok;
     }
+    xtop = nf->nf_xtop;
     /* Check for empty frame (no mesaages), return empty message, not clear from RFC what to do */
     if (xml_child_nr_type(xtop, CX_ELMNT) == 0){
-        if ((cbret = cbuf_new()) == NULL){ 
-            clicon_err(OE_UNIX, errno, "cbuf_new");
-            goto done;
-        }
-        if (netconf_output_encap(framing, cbret) < 0)
+        if (netconf_pipeline_flush(h) < 0)
             goto done;
-        if (netconf_output(1, cbret, "rpc-error") < 0)
+        if (netconf_output_framed(1, framing, cbret, "rpc-error") < 0)
             goto done;
         goto ok;
     }
     /* Check for multi-messages in frame */
     if (xml_child_nr_type(xtop, CX_ELMNT) != 1){
-        if ((cbret = cbuf_new()) == NULL){ 
-            clicon_err(OE_UNIX, errno, "cbuf_new");
+        if (netconf_pipeline_flush(h) < 0)
             goto done;
-        }
         if (netconf_malformed_message(cbret, "More than one message in netconf rpc frame")< 0)
             goto done;
-        if (netconf_output_encap(framing, cbret) < 0)
-            goto done;
-        if (netconf_output(1, cbret, "rpc-error") < 0)
+        if (netconf_output_framed(1, framing, cbret, "rpc-error") < 0)
             goto done;
         goto ok;
     }
@@ -485,10 +732,7 @@ netconf_input_frame(clicon_handle h,
  ok:
     retval = 0;
  done:
-    if (str)
-        free(str);
-    if (xtop)
-        xml_free(xtop);
+    netconf_input_reset(nf);
     if (xret)
         xml_free(xret);
     if (cbret)
@@ -496,64 +740,158 @@ netconf_input_frame(clicon_handle h,
     return retval;
 }
 
-/*! Get netconf message: detect end-of-msg 
+/*! Scan input buffer with RFC6242 chunked framing
+ *
+ * Chunk headers are parsed character by character, while chunk data is pushed in bulk to the
+ * XML parser directly from the read buffer.
+ * @param[in]   h    Clixon handle
+ * @param[in]   nf   Netconf input state
+ * @param[in]   buf  Input buffer
+ * @param[in]   len  Length of input buffer
+ * @param[out]  eof  Set to 1 if pending close socket
+ * @retval      0    OK
+ * @retval     -1    Error
+ */
+static int
+netconf_input_chunked(clicon_handle  h,
+                      netconf_input *nf,
+                      char          *buf,
+                      size_t         len,
+                      int           *eof)
+{
+    int    retval = -1;
+    size_t i = 0;
+    size_t n;
+    int    ret;
+
+    while (i < len){
+        /* In chunk-data: push as much as is available of the chunk */
+        if (nf->nf_state == 4 && nf->nf_size > 0){
+            n = len - i;
+            if (n > nf->nf_size)
+                n = nf->nf_size;
+            if (netconf_input_push(h, nf, buf+i, n) < 0)
+                goto done;
+            nf->nf_size -= n;
+            i += n;
+            continue;
+        }
+        if (buf[i] == 0){
+            i++;
+            continue; /* Skip NULL chars in framing (eg from terminals) */
+        }
+        if ((ret = netconf_input_chunked_framing(buf[i], &nf->nf_state, &nf->nf_size)) < 0)
+            goto done;
+        i++;
+        if (ret == 2){ /* end-of-frame */
+            /* Somewhat complex error-handling:
+             * Ignore packet errors, UNLESS an explicit termination request (eof)
+             */
+            if (netconf_input_frame(h, nf, eof) < 0 &&
+                !ignore_packet_errors)
+                goto done;
+            if (*eof)
+                break;
+        }
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Scan input buffer with RFC6242 end-of-message framing, ie ]]>]]>
+ *
+ * Runs of data not containing ']' are pushed in bulk to the XML parser directly from the read
+ * buffer. Characters matching a prefix of the end-of-message marker are held back in the state
+ * until it is known whether they are part of the marker.
+ * @param[in]   h    Clixon handle
+ * @param[in]   nf   Netconf input state
+ * @param[in]   buf  Input buffer
+ * @param[in]   len  Length of input buffer
+ * @param[out]  eof  Set to 1 if pending close socket
+ * @retval      0    OK
+ * @retval     -1    Error
+ */
+static int
+netconf_input_eom(clicon_handle  h,
+                  netconf_input *nf,
+                  char          *buf,
+                  size_t         len,
+                  int           *eof)
+{
+    int         retval = -1;
+    const char *eom = "]]>]]>";
+    size_t      i = 0;
+    char       *p;
+    size_t      n;
+
+    while (i < len){
+        if (nf->nf_state == 0){
+            if ((p = memchr(buf+i, eom[0], len-i)) != NULL)
+                n = p - (buf+i);
+            else
+                n = len-i;
+            if (netconf_input_push(h, nf, buf+i, n) < 0)
+                goto done;
+            i += n;
+            if (p == NULL)
+                break;
+        }
+        if (buf[i] == 0){
+            i++;
+            continue; /* Skip NULL chars (eg from terminals) */
+        }
+        if (buf[i] == eom[nf->nf_state]){
+            i++;
+            if (++nf->nf_state < strlen(eom))
+                continue;
+            /* OK, we have an xml string from a client */
+            nf->nf_state = 0;
+            if (netconf_input_frame(h, nf, eof) < 0 &&
+                !ignore_packet_errors) // default is to ignore errors
+                goto done;
+            if (*eof)
+                break;
+        }
+        else { /* Held back chars were data, current char is examined again */
+            if (netconf_input_push(h, nf, eom, nf->nf_state) < 0)
+                goto done;
+            nf->nf_state = 0;
+        }
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Get netconf message: detect end-of-msg
  * @param[in]   s    Socket where input arrived. read from this.
  * @param[in]   arg  Clixon handle.
  * This routine continuously reads until no more data on s. There could
  * be risk of starvation, but the netconf client does little else than
  * read data so I do not see a danger of true starvation here.
- * @note data is saved in clicon-handle at NETCONF_HASH_BUF since there is a potential issue if data
- * is not completely present on the s, ie if eg:
+ * Frame payload is pushed directly from the read buffer to an incremental XML parser, and
+ * all frames in a read are processed, ie several pipelined messages may be handled per read.
+ * Pipelined requests are forwarded to the backend while reading, and their replies are sent
+ * when no more input is available, see netconf_pipeline_flush.
+ * @note framing and parser state is saved in clicon-handle at NETCONF_INPUT since data may not
+ * be completely present on the s, ie if eg:
  *   <a>foo ..pause.. </a>]]>]]>
- * then only "</a>" would be delivered to netconf_input_frame().
  */
 static int
-netconf_input_cb(int   s, 
+netconf_input_cb(int   s,
                  void *arg)
 {
     int            retval = -1;
-    unsigned char  buf[BUFSIZ]; /* from stdio.h, typically 8K */
+    char           buf[BUFSIZ]; /* from stdio.h, typically 8K */
     clicon_handle  h = arg;
-    cbuf          *cb=NULL;
-    void          *ptr;
-    size_t         cdatlen = 0;
-    clicon_hash_t *cdat = clicon_data(h); /* Save cbuf between calls if not done */
+    netconf_input *nf;
     int            poll;
-    int            i;
-    int            len;
-    int            frame_state;
-    size_t         frame_size;
-    int            ret;
+    ssize_t        len;
     int            eof = 0;  /* Set to 1 if pending close socket */
 
-    if (clicon_option_exists(h, NETCONF_FRAME_STATE) == 0)
-        frame_state = 0;
-    else
-        if ((frame_state = clicon_option_int(h, NETCONF_FRAME_STATE)) < 0)
-            goto done;
-    if (clicon_option_exists(h, NETCONF_FRAME_SIZE) == 0)
-        frame_size = 0;
-    else{
-        if ((ret = clicon_option_int(h, NETCONF_FRAME_SIZE)) < 0)
-            goto done;
-        frame_size = (size_t)ret;
-    }
-    if ((ptr = clicon_hash_value(cdat, NETCONF_HASH_BUF, &cdatlen)) != NULL){
-        if (cdatlen != sizeof(cb)){
-            clicon_err(OE_XML, errno, "size mismatch %lu %lu",
-                       (unsigned long)cdatlen, (unsigned long)sizeof(cb));
-            goto done;
-        }
-        cb = *(cbuf**)ptr;
-        clicon_hash_del(cdat, NETCONF_HASH_BUF);
-    }
-    else{
-        if ((cb = cbuf_new()) == NULL){
-            clicon_err(OE_XML, errno, "cbuf_new");
-            goto done;
-        }
-    }
-    memset(buf, 0, sizeof(buf));
+    if ((nf = netconf_input_get(h)) == NULL)
+        goto done;
     while (1){
         if ((len = read(s, buf, sizeof(buf))) < 0){
             if (errno == ECONNRESET)
@@ -565,73 +903,35 @@ netconf_input_cb(int   s,
         } /* read */
         if (len == 0){  /* EOF */
             clicon_debug(1, "%s len==0, closing", __FUNCTION__);
+            if (netconf_pipeline_flush(h) < 0)
+                goto done;
             clixon_event_unreg_fd(s, netconf_input_cb);
             close(s);
-            clixon_exit_set(1);     
+            clixon_exit_set(1);
             goto ok;
         }
-        for (i=0; i<len; i++){
-            if (buf[i] == 0)
-                continue; /* Skip NULL chars (eg from terminals) */
-            if (clicon_option_int(h, "netconf-framing") == NETCONF_SSH_CHUNKED){
-                /* Track chunked framing defined in RFC6242 */
-                if ((ret = netconf_input_chunked_framing(buf[i], &frame_state, &frame_size)) < 0)
-                    goto done;
-                switch (ret){
-                case 1: /* chunk-data */
-                    cprintf(cb, "%c", buf[i]);
-                    break;
-                case 2: /* end-of-data */
-                    /* Somewhat complex error-handling:
-                     * Ignore packet errors, UNLESS an explicit termination request (eof)
-                     */
-                    if (netconf_input_frame(h, cb, &eof) < 0 &&
-                        !ignore_packet_errors) 
-                        goto done; 
-                    if (eof)
-                        goto done;
-                    cbuf_reset(cb);
-                    break;
-                default:
-                    break;
-                }
-            }
-            else{
-                cprintf(cb, "%c", buf[i]);
-                if (detect_endtag("]]>]]>", buf[i], &frame_state)){
-                    frame_state = 0;
-                    /* OK, we have an xml string from a client */
-                    /* Remove trailer */
-                    *(((char*)cbuf_get(cb)) + cbuf_len(cb) - strlen("]]>]]>")) = '\0';
-                    if (netconf_input_frame(h, cb, &eof) < 0 &&
-                        !ignore_packet_errors) // default is to ignore errors
-                        goto done; 
-                    if (eof)
-                        goto done;
-                    cbuf_reset(cb);
-                }
-            }
+        if (clicon_option_int(h, "netconf-framing") == NETCONF_SSH_CHUNKED){
+            /* Track chunked framing defined in RFC6242 */
+            if (netconf_input_chunked(h, nf, buf, len, &eof) < 0)
+                goto done;
         }
+        else if (netconf_input_eom(h, nf, buf, len, &eof) < 0)
+            goto done;
+        if (eof)
+            goto done;
         /* poll==1 if more, poll==0 if none */
         if ((poll = clixon_event_poll(s)) < 0)
             goto done;
         if (poll == 0){
-            /* No data to read, save data and continue on next round */
-            if (cbuf_len(cb) != 0){
-                if (clicon_hash_add(cdat, NETCONF_HASH_BUF, &cb, sizeof(cb)) == NULL)
-                    goto done;
-                cb = NULL;
-            }
-            break; 
+            /* No data to read, send pending replies, state is saved, continue on next round */
+            if (netconf_pipeline_flush(h) < 0)
+                goto done;
+            break;
         }
     } /* while */
  ok:
-    clicon_option_int_set(h, NETCONF_FRAME_STATE, frame_state);
-    clicon_option_int_set(h, NETCONF_FRAME_SIZE, frame_size);
     retval = 0;
  done:
-    if (cb)
-        cbuf_free(cb);
     return retval;
 }
 
@@ -655,9 +955,7 @@ send_hello(clicon_handle h,
     if (netconf_hello_server(h, cb, id) < 0)
         goto done;
     framing = clicon_option_int(h, "netconf-framing");
-    if (netconf_output_encap(framing, cb) < 0)
-        goto done;
-    if (netconf_output(s, cb, "hello") < 0)
+    if (netconf_output_framed(s, framing, cb, "hello") < 0)
         goto done;
     retval = 0;
   done:
@@ -680,6 +978,7 @@ netconf_terminate(clicon_handle h)
     /* Delete all plugins, and RPC callbacks */
     clixon_plugin_module_exit(h);
     clicon_rpc_close_session(h);
+    netconf_input_free(h);
     if ((yspec = clicon_dbspec_yang(h)) != NULL)
         ys_free(yspec);
     if ((yspec = clicon_config_yang(h)) != NULL)
@@ -70,7 +70,6 @@
 /* clicon */
 #include <clixon/clixon.h>
 
-#include "netconf_filter.h"
 #include "netconf_rpc.h"
 
 /*
@@ -79,39 +78,11 @@
     </rpc> 
  */
 
-static int
-netconf_get_config_subtree(clicon_handle h, 
-                           cxobj        *xfilter, 
-                           cxobj       **xret)
-{
-    int    retval = -1;
-    cxobj *xdata;
-    
-    /* a subtree filter is comprised of zero or more element subtrees*/
-    if ((xdata = xpath_first(*xret, NULL, "/rpc-reply/data")) == NULL)
-        goto ok;
-    if (xml_filter(xfilter, xdata) < 0){
-        clixon_xml_parse_va(YB_NONE, NULL, xret, NULL, "<rpc-reply xmlns=\"%s\"><rpc-error>"
-                            "<error-tag>operation-failed</error-tag>"
-                            "<error-type>application</error-type>"
-                            "<error-severity>error</error-severity>"
-                            "<error-info>filtering</error-info>"
-                            "</rpc-error></rpc-reply>",
-                            NETCONF_BASE_NAMESPACE
-                            );
-    }
-ok:
-    retval = 0;
-    // done:
-    return retval;
-}
-
 /*! Get configuration
  * @param[in]  h       Clicon handle
  * @param[in]  xn      Sub-tree (under xorig) at <rpc>...</rpc> level.
  * @param[out] xret    Return XML, error or OK
- * @note filter type subtree and xpath is supported, but xpath is preferred, and
- *              better performance and tested. Please use xpath.
+ * @note filter type subtree and xpath is supported, both are evaluated by the backend
  *
  *     <get-config> 
  *       <source> 
@@ -176,18 +147,11 @@ netconf_get_config(clicon_handle h,
      /* ie <filter>...</filter> */
     if ((xfilter = xpath_first(xn, nsc, "%s%sfilter", prefix ? prefix : "", prefix ? ":" : "")) != NULL)
         ftype = xml_find_value(xfilter, "type");
-    if (xfilter == NULL || ftype == NULL || strcmp(ftype, "subtree") == 0) {
-        /* Get whole config first, then filter. This is suboptimal
-         */
+    /* Subtree filters are applied by the backend */
+    if (xfilter == NULL || ftype == NULL ||
+        strcmp(ftype, "subtree") == 0 || strcmp(ftype, "xpath") == 0) {
         if (clicon_rpc_netconf_xml(h, xml_parent(xn), xret, NULL) < 0)
             goto done;
-        /* Now filter on whole tree */
-        if (netconf_get_config_subtree(h, xfilter, xret) < 0)
-            goto done;
-    } else if (strcmp(ftype, "xpath") == 0) {
-        if (clicon_rpc_netconf_xml(h, xml_parent(xn), xret, NULL) < 0) {
-            goto done;
-        }
     } else {
         clixon_xml_parse_va(YB_NONE, NULL, xret, NULL, "<rpc-reply xmlns=\"%s\"><rpc-error>"
                                                        "<error-tag>operation-failed</error-tag>"
@@ -356,8 +320,7 @@ netconf_edit_config(clicon_handle h,
  * @param[in]  h       Clicon handle
  * @param[in]  xn      Sub-tree (under xorig) at <rpc>...</rpc> level.
  * @param[out] xret    Return XML, error or OK
- * @note filter type subtree and xpath is supported, but xpath is preferred, and
- *              better performance and tested. Please use xpath.
+ * @note filter type subtree and xpath is supported, both are evaluated by the backend
  *
  * @example
  *    <rpc><get><filter type="xpath" select="//SenderTwampIpv4"/>
@@ -385,15 +348,9 @@ netconf_get(clicon_handle h,
        /* ie <filter>...</filter> */
     if ((xfilter = xpath_first(xn, nsc, "%s%sfilter", prefix ? prefix : "", prefix ? ":" : "")) != NULL)
         ftype = xml_find_value(xfilter, "type");
-    if (xfilter == NULL || ftype == NULL || strcmp(ftype, "subtree") == 0) {
-        /* Get whole config + state first, then filter. This is suboptimal
-         */
-        if (clicon_rpc_netconf_xml(h, xml_parent(xn), xret, NULL) < 0)
-            goto done;
-        /* Now filter on whole tree */
-        if (netconf_get_config_subtree(h, xfilter, xret) < 0)
-            goto done;
-    } else if (strcmp(ftype, "xpath") == 0) {
+    /* Subtree filters are applied by the backend */
+    if (xfilter == NULL || ftype == NULL ||
+        strcmp(ftype, "subtree") == 0 || strcmp(ftype, "xpath") == 0) {
         if (clicon_rpc_netconf_xml(h, xml_parent(xn), xret, NULL) < 0)
             goto done;
     } else {
@@ -482,10 +439,7 @@ netconf_notification_cb(int   s,
     if (clixon_xml2cbuf(cb, xn, 0, 0, -1, 0) < 0)
         goto done;
     /* Send it to listening client on stdout */
-    if (netconf_output_encap(clicon_option_int(h, "netconf-framing"), cb) < 0){
-        goto done;
-    }
-    if (netconf_output(1, cb, "notification") < 0){
+    if (netconf_output_framed(1, clicon_option_int(h, "netconf-framing"), cb, "notification") < 0){
         clicon_err(OE_PROTO, ESHUTDOWN, "Socket unexpected close");
         close(s);
         errno = ESHUTDOWN;
@@ -778,3 +732,60 @@ netconf_rpc_dispatch(clicon_handle h,
         xml_purge(xa);
     return retval;
 }
+
+/*! Forward netconf rpc to backend without waiting for reply, if possible
+ *
+ * Only requests forwarded as-is to the backend and with small replies are pipelined, other
+ * requests are handled by netconf_rpc_dispatch.
+ * @param[in]  h       clicon handle
+ * @param[in]  xn      Sub-tree (under xorig) at <rpc>...</rpc> level.
+ * @retval     1       Sent to backend, read reply with clicon_rpc_netconf_xml_recv
+ * @retval     0       Not pipelined, use netconf_rpc_dispatch
+ * @retval    -1       Error, fatal
+ * @see netconf_rpc_dispatch
+ */
+int
+netconf_rpc_pipeline(clicon_handle h,
+                     cxobj        *xn)
+{
+    int    retval = -1;
+    cxobj *xe;
+    char  *name;
+    char  *username;
+    cxobj *xa;
+
+    if (xml_child_nr_type(xn, CX_ELMNT) != 1 ||
+        (xe = xml_child_i_type(xn, 0, CX_ELMNT)) == NULL)
+        return 0;
+    name = xml_name(xe);
+    if (strcmp(name, "edit-config") == 0){
+        /* Non-default options are rejected in netconf_edit_config */
+        if (xml_find_type(xe, NULL, "test-option", CX_ELMNT) != NULL ||
+            xml_find_type(xe, NULL, "error-option", CX_ELMNT) != NULL)
+            return 0;
+    }
+    else if (strcmp(name, "copy-config") != 0 &&
+             strcmp(name, "delete-config") != 0 &&
+             strcmp(name, "lock") != 0 &&
+             strcmp(name, "unlock") != 0 &&
+             strcmp(name, "validate") != 0 &&
+             strcmp(name, "commit") != 0 &&
+             strcmp(name, "cancel-commit") != 0 &&
+             strcmp(name, "discard-changes") != 0)
+        return 0;
+    /* Tag username as in netconf_rpc_dispatch */
+    if ((username = clicon_username_get(h)) != NULL){
+        if ((xa = xml_new("username", xn, CX_ATTR)) == NULL)
+            goto done;
+        if (xml_value_set(xa, username) < 0)
+            goto done;
+    }
+    if (clicon_rpc_netconf_xml_send(h, xn) < 0)
+        goto done;
+    retval = 1;
+ done:
+    /* Username attribute is removed, otherwise it is returned to sender */
+    if ((xa = xml_find(xn, "username")) != NULL)
+        xml_purge(xa);
+    return retval;
+}
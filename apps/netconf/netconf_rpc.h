@@ -47,5 +47,8 @@ netconf_rpc_dispatch(clicon_handle h,
                      cxobj        *xn, 
                      cxobj       **xret,
                      int          *eof);
+int
+netconf_rpc_pipeline(clicon_handle h,
+                     cxobj        *xn);
 
 #endif  /* _NETCONF_RPC_H_ */
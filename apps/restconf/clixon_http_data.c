@@ -40,6 +40,9 @@
 #include "clixon_config.h" /* generated by config & autoconf */
 #endif
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE /* for strptime */
+#endif
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
@@ -53,6 +56,8 @@
 #include <sys/time.h>
 #include <sys/wait.h>
 #include <libgen.h>
+#include <stdint.h>
+#include <sys/mman.h>
 #include <sys/stat.h> /* chmod */
 
 /* cligen */
@@ -158,35 +163,58 @@ api_http_data_err(clicon_handle  h,
     return retval;
 }
 
+/*! Cached static file with precomputed reply headers
+ * Kept open and mapped as long as it is in the cache, an entry is stale if the file 
+ * changes on disk.
+ * @see http_data_file_get
+ */
+typedef struct {
+    qelem_t     hf_qelem;       /* List header, most recently used first */
+    char       *hf_path;        /* File path, cache key */
+    struct stat hf_st;          /* File status when loaded */
+    int         hf_fd;          /* Open read-only file, or -1 */
+    char       *hf_map;         /* Read-only mapping of file, or NULL */
+    const char *hf_media;       /* Content-Type header value */
+    char        hf_etag[64];    /* ETag header value */
+    char        hf_lastmod[32]; /* Last-Modified header value */
+    int         hf_cached;      /* In cache, otherwise transient and freed after reply */
+} http_data_file;
+
+/*! Cache of hot static files, LRU list in clicon_ptr HTTP_DATA_CACHE
+ */
+typedef struct {
+    http_data_file *hc_files;   /* Files, most recently used first */
+    int             hc_nr;      /* Number of files in list */
+} http_data_cache;
+
+#define HTTP_DATA_CACHE "http-data-cache"
+
 /*! Check validity of path, may only be regular dir or file
  * No .., soft link, ~, etc
  * @param[in]      h       Clicon handle
  * @param[in]      req     Generic Www handle (can be part of clixon handle)
  * @param[in]      prefix  Prefix of path0, where to start file check
  * @param[in,out]  cbpath  Filepath as cbuf, internal redirection may change it
- * @param[out]     fp      Open file, if retval = 1
- * @param[out]     fsz     Size of file, if retval = 1
+ * @param[out]     st      File status (of link itself), if retval = 1
  * @retval        -1       Error
  * @retval         0       Invalid
- * @retval         1       OK, fp,fsz set
+ * @retval         1       OK, st set
  */
 static int
 http_data_check_file_path(clicon_handle h,
                           void         *req,
                           char         *prefix,
                           cbuf         *cbpath,
-                          FILE        **fp,
-                          off_t        *fsz)
+                          struct stat  *st)
 {
     int         retval = -1;
     struct stat fstat;
     char       *p;
     int         i;
     int         code = 0;
-    FILE       *f;
 
-    if (prefix == NULL || cbpath == NULL || fp == NULL){
-        clicon_err(OE_UNIX, EINVAL, "prefix, cbpath0 or fp is NULL");
+    if (prefix == NULL || cbpath == NULL || st == NULL){
+        clicon_err(OE_UNIX, EINVAL, "prefix, cbpath0 or st is NULL");
         goto done;
     }
     p = cbuf_get(cbpath);
@@ -246,13 +274,7 @@ http_data_check_file_path(clicon_handle h,
         code = 403;
         goto invalid;
     }
-    *fsz = fstat.st_size;
-    if ((f = fopen(p, "rb")) == NULL){
-        clicon_debug(1, "%s Error fopen(%s) %s", __FUNCTION__, p, strerror(errno));
-        code = 403;
-        goto invalid;
-    }
-    *fp = f;
+    *st = fstat;
     retval = 1; /* OK */
  done:
     return retval;
@@ -262,14 +284,280 @@ http_data_check_file_path(clicon_handle h,
     retval = 0;
     goto done;
 }
-                   
+
+/*! Free a http-data file, unmap and close it
+ */
+static int
+http_data_file_free(http_data_file *hf)
+{
+    if (hf->hf_map)
+        munmap(hf->hf_map, hf->hf_st.st_size);
+    if (hf->hf_fd != -1)
+        close(hf->hf_fd);
+    if (hf->hf_path)
+        free(hf->hf_path);
+    free(hf);
+    return 0;
+}
+
+/*! Check if file has changed since it was loaded, by comparing file status
+ * @param[in]  hf  Loaded file
+ * @param[in]  st  Current file status
+ * @retval     1   Changed (stale)
+ * @retval     0   Not changed
+ */
+static int
+http_data_file_stale(http_data_file *hf,
+                     struct stat    *st)
+{
+    return (hf->hf_st.st_dev != st->st_dev ||
+            hf->hf_st.st_ino != st->st_ino ||
+            hf->hf_st.st_size != st->st_size ||
+            hf->hf_st.st_mtim.tv_sec != st->st_mtim.tv_sec ||
+            hf->hf_st.st_mtim.tv_nsec != st->st_mtim.tv_nsec);
+}
+
+/*! Open a file and compute its reply headers, and map it if it is to be cached
+ * @param[in]  path   File path, checked by http_data_check_file_path
+ * @param[in]  st     File status from check
+ * @param[in]  media  Content-Type
+ * @param[in]  cache  If set, map the file for the cache
+ * @param[out] hfp    New file, free with http_data_file_free
+ * @retval     1      OK, hfp set
+ * @retval     0      File could not be opened or was replaced after check
+ * @retval    -1      Error
+ */
+static int
+http_data_file_load(char            *path,
+                    struct stat     *st,
+                    const char      *media,
+                    int              cache,
+                    http_data_file **hfp)
+{
+    int             retval = -1;
+    http_data_file *hf = NULL;
+    struct tm       tm;
+
+    if ((hf = malloc(sizeof(*hf))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(hf, 0, sizeof(*hf));
+    hf->hf_fd = -1;
+    if ((hf->hf_path = strdup(path)) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    /* O_NOFOLLOW and fstat close the window between lstat check and open */
+    if ((hf->hf_fd = open(path, O_RDONLY|O_NOFOLLOW|O_CLOEXEC)) < 0){
+        clicon_debug(1, "%s Error open(%s) %s", __FUNCTION__, path, strerror(errno));
+        goto fail;
+    }
+    if (fstat(hf->hf_fd, &hf->hf_st) < 0){
+        clicon_err(OE_UNIX, errno, "fstat");
+        goto done;
+    }
+    if (!S_ISREG(hf->hf_st.st_mode) ||
+        hf->hf_st.st_dev != st->st_dev ||
+        hf->hf_st.st_ino != st->st_ino){
+        clicon_debug(1, "%s Error %s replaced after check", __FUNCTION__, path);
+        goto fail;
+    }
+    if (cache && hf->hf_st.st_size > 0){
+        if ((hf->hf_map = mmap(NULL, hf->hf_st.st_size, PROT_READ, MAP_PRIVATE,
+                               hf->hf_fd, 0)) == MAP_FAILED){
+            hf->hf_map = NULL;
+            clicon_err(OE_UNIX, errno, "mmap");
+            goto done;
+        }
+    }
+    hf->hf_cached = cache;
+    hf->hf_media = media;
+    /* Validator from inode, size and modification time, see RFC 7232 Section 2.3 */
+    snprintf(hf->hf_etag, sizeof(hf->hf_etag), "\"%jx-%jx-%jx.%lx\"",
+             (uintmax_t)hf->hf_st.st_ino,
+             (uintmax_t)hf->hf_st.st_size,
+             (uintmax_t)hf->hf_st.st_mtim.tv_sec,
+             (unsigned long)hf->hf_st.st_mtim.tv_nsec);
+    if (gmtime_r(&hf->hf_st.st_mtim.tv_sec, &tm) == NULL ||
+        strftime(hf->hf_lastmod, sizeof(hf->hf_lastmod),
+                 "%a, %d %b %Y %H:%M:%S GMT", &tm) == 0){
+        clicon_err(OE_UNIX, errno, "strftime");
+        goto done;
+    }
+    *hfp = hf;
+    hf = NULL;
+    retval = 1;
+ done:
+    if (hf)
+        http_data_file_free(hf);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Get a file from the http-data cache, or load it
+ *
+ * A hit requires that the file status is unchanged, otherwise the file is reloaded.
+ * Files larger than HTTP_DATA_CACHE_FILE_MAX are loaded unmapped and are not cached.
+ * The least recently used file is evicted when there are more than HTTP_DATA_CACHE_NR.
+ * @param[in]  h      Clicon handle
+ * @param[in]  path   File path, checked by http_data_check_file_path
+ * @param[in]  st     File status from check
+ * @param[in]  media  Content-Type
+ * @param[out] hfp    File. Free with http_data_file_free if not hf_cached
+ * @retval     1      OK, hfp set
+ * @retval     0      File could not be opened
+ * @retval    -1      Error
+ */
+static int
+http_data_file_get(clicon_handle    h,
+                   char            *path,
+                   struct stat     *st,
+                   const char      *media,
+                   http_data_file **hfp)
+{
+    int              retval = -1;
+    http_data_cache *hc = NULL;
+    http_data_file  *hf;
+    int              cache;
+    int              ret;
+
+    cache = HTTP_DATA_CACHE_NR > 0 && st->st_size <= HTTP_DATA_CACHE_FILE_MAX;
+    if (cache){
+        if (clicon_ptr_get(h, HTTP_DATA_CACHE, (void**)&hc) < 0 || hc == NULL){
+            if ((hc = malloc(sizeof(*hc))) == NULL){
+                clicon_err(OE_UNIX, errno, "malloc");
+                goto done;
+            }
+            memset(hc, 0, sizeof(*hc));
+            if (clicon_ptr_set(h, HTTP_DATA_CACHE, hc) < 0){
+                free(hc);
+                goto done;
+            }
+        }
+        if ((hf = hc->hc_files) != NULL){
+            do {
+                if (strcmp(hf->hf_path, path) == 0)
+                    break;
+                hf = NEXTQ(http_data_file *, hf);
+            } while (hf != hc->hc_files);
+            if (strcmp(hf->hf_path, path) == 0){
+                DELQ(hf, hc->hc_files, http_data_file *);
+                if (http_data_file_stale(hf, st) == 0){
+                    clicon_debug(1, "%s hit %s", __FUNCTION__, path);
+                    INSQ(hf, hc->hc_files);
+                    *hfp = hf;
+                    goto ok;
+                }
+                hc->hc_nr--;
+                http_data_file_free(hf);
+            }
+        }
+    }
+    if ((ret = http_data_file_load(path, st, media, cache, &hf)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    if (cache){
+        INSQ(hf, hc->hc_files);
+        hc->hc_nr++;
+        while (hc->hc_nr > HTTP_DATA_CACHE_NR){
+            http_data_file *hl = PREVQ(http_data_file *, hc->hc_files);
+            DELQ(hl, hc->hc_files, http_data_file *);
+            hc->hc_nr--;
+            http_data_file_free(hl);
+        }
+    }
+    *hfp = hf;
+ ok:
+    retval = 1;
+ done:
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Free http-data file cache
+ * @param[in]  h      Clicon handle
+ */
+int
+http_data_cache_free(clicon_handle h)
+{
+    http_data_cache *hc = NULL;
+    http_data_file  *hf;
+
+    if (clicon_ptr_get(h, HTTP_DATA_CACHE, (void**)&hc) == 0 && hc != NULL){
+        while ((hf = hc->hc_files) != NULL){
+            DELQ(hf, hc->hc_files, http_data_file *);
+            http_data_file_free(hf);
+        }
+        free(hc);
+        clicon_ptr_del(h, HTTP_DATA_CACHE);
+    }
+    return 0;
+}
+
+/*! Check conditional request headers If-None-Match and If-Modified-Since
+ *
+ * If-None-Match takes precedence and uses weak comparison, see RFC 7232 Section 3.2 and 6.
+ * @param[in]  h      Clicon handle
+ * @param[in]  hf     Requested file
+ * @retval     1      Not modified, reply with 304
+ * @retval     0      Modified or not a conditional request
+ */
+static int
+http_data_not_modified(clicon_handle   h,
+                       http_data_file *hf)
+{
+    char     *val;
+    char     *etag;
+    size_t    len;
+    struct tm tm = {0,};
+    time_t    t;
+
+    if ((val = restconf_param_get(h, "HTTP_IF_NONE_MATCH")) != NULL){
+        len = strlen(hf->hf_etag);
+        while (*val){
+            while (*val == ' ' || *val == '\t' || *val == ',')
+                val++;
+            if (*val == '*')
+                return 1;
+            if (strncmp(val, "W/", 2) == 0)
+                val += 2;
+            etag = val;
+            while (*val && *val != ',')
+                val++;
+            while (val > etag && (val[-1] == ' ' || val[-1] == '\t'))
+                val--;
+            if (val - etag == len && strncmp(etag, hf->hf_etag, len) == 0)
+                return 1;
+            while (*val && *val != ',')
+                val++;
+        }
+        return 0;
+    }
+    if ((val = restconf_param_get(h, "HTTP_IF_MODIFIED_SINCE")) != NULL){
+        if (strptime(val, "%a, %d %b %Y %H:%M:%S GMT", &tm) == NULL)
+            return 0; /* Invalid date is ignored */
+        if ((t = timegm(&tm)) == (time_t)-1)
+            return 0;
+        if (hf->hf_st.st_mtim.tv_sec <= t)
+            return 1;
+    }
+    return 0;
+}
+
 /*! Read file data request
+ *
+ * Files are served from the http-data cache if hot, and written without copying where the
+ * http library allows it, see restconf_reply_send_file
  * @param[in]  h         Clicon handle
  * @param[in]  req       Generic Www handle (can be part of clixon handle)
  * @param[in]  pathname  With stripped prefix (eg /data), ultimately a filename
  * @param[in]  head      HEAD not GET
- * @note: primitive file handling, just check if file exists and read it all
- * XXX 1: Buffer copying once too many, see #if 0 below
  */
 static int
 api_http_data_file(clicon_handle h,
@@ -277,19 +565,16 @@ api_http_data_file(clicon_handle h,
                    char         *pathname,
                    int           head)
 {
-    int         retval = -1;
-    cbuf       *cbfile = NULL;
-    char       *filename = NULL;
-    cbuf       *cbdata = NULL;
-    FILE       *f = NULL;
-    off_t       fsz = 0;
-    long        fsize;
-    char       *www_data_root = NULL;
-    char       *suffix;
-    char       *media;
-    int         ret;
-    char       *buf = NULL;
-    size_t      sz;
+    int             retval = -1;
+    cbuf           *cbfile = NULL;
+    char           *filename = NULL;
+    struct stat     st;
+    char           *www_data_root = NULL;
+    char           *suffix;
+    char           *media;
+    int             ret;
+    http_data_file *hf = NULL;
+    int             fd;
 
     clicon_debug(1, "%s", __FUNCTION__);    
     if ((cbfile = cbuf_new()) == NULL){
@@ -312,7 +597,7 @@ api_http_data_file(clicon_handle h,
         }
         cprintf(cbfile, "%s", pathname); /* Assume pathname starts with '/' */
     }
-    if ((ret = http_data_check_file_path(h, req, www_data_root, cbfile, &f, &fsz)) < 0)
+    if ((ret = http_data_check_file_path(h, req, www_data_root, cbfile, &st)) < 0)
         goto done;
     if (ret == 0) /* Invalid, return code set */
         goto ok;
@@ -326,63 +611,45 @@ api_http_data_file(clicon_handle h,
         if ((media = clicon_str2str(mime_map, suffix)) == NULL)
             media = "application/octet-stream";
     }
-    /* Size could have been taken from stat() but this reduces the race condition interval 
-     * There is still one without flock
-     */
-    fseek(f, 0, SEEK_END);
-    fsize = ftell(f);
-    /* Extra sanity check, had some problems with wrong file types */
-    if (fsz != fsize){
-        clicon_debug(1, "%s Error file %s size mismatch sz:%zu vs %li",
-                     __FUNCTION__, filename, (size_t)fsz, fsize);
-        if (api_http_data_err(h, req, 500) < 0) /* Internal error? */
+    if ((ret = http_data_file_get(h, filename, &st, media, &hf)) < 0)
+        goto done;
+    if (ret == 0){
+        if (api_http_data_err(h, req, 403) < 0)
             goto done;
         goto ok;
     }
-    fseek(f, 0, SEEK_SET);  /* same as rewind(f); */
-    if ((cbdata = cbuf_new_alloc(fsize+1)) == NULL){
-        clicon_err(OE_UNIX, errno, "cbuf_new_alloc");
-        goto done;
-    }
-    /* Unoptimized, no direct read but requires an extra copy,
-     * the cligen buf API should have some mechanism for this case without the extra copy.
-     */
-    if ((buf = malloc(fsize)) == NULL){
-        clicon_err(OE_UNIX, errno, "malloc");
+    if (restconf_reply_header(req, "ETag", "%s", hf->hf_etag) < 0)
         goto done;
-    }
-    if ((ret = fread(buf, fsize, 1, f)) < 0){
-        clicon_err(OE_UNIX, errno, "fread");
+    if (restconf_reply_header(req, "Last-Modified", "%s", hf->hf_lastmod) < 0)
         goto done;
-    }
-    sz = (size_t)ret;
-    if (sz != 1){
-        clicon_debug(1, "%s Error fread(%s) sz:%zu", __FUNCTION__, filename, sz);
-        if (api_http_data_err(h, req, 500) < 0) /* Internal error? */
+    if (http_data_not_modified(h, hf)){
+        if (restconf_reply_send(req, 304, NULL, 0) < 0)
             goto done;
         goto ok;
     }
-    if (cbuf_append_buf(cbdata, buf, fsize) < 0){
-        clicon_err(OE_UNIX, errno, "cbuf_append_str");
+    if (restconf_reply_header(req, "Content-Type", "%s", hf->hf_media) < 0)
         goto done;
+    /* The reply consumes the fd, a cached file keeps its own */
+    if (hf->hf_cached){
+        if ((fd = dup(hf->hf_fd)) < 0){
+            clicon_err(OE_UNIX, errno, "dup");
+            goto done;
+        }
     }
-    if (restconf_reply_header(req, "Content-Type", "%s", media) < 0)
-        goto done;
-    if (restconf_reply_send(req, 200, cbdata, head) < 0)
+    else{
+        fd = hf->hf_fd;
+        hf->hf_fd = -1;
+    }
+    if (restconf_reply_send_file(req, 200, fd, hf->hf_map, hf->hf_st.st_size, head) < 0)
         goto done;
-    cbdata = NULL; /* consumed by reply-send */
     clicon_debug(1, "%s Read %s OK", __FUNCTION__, filename);
  ok:
     retval = 0;
  done:
-    if (buf)
-        free(buf);
-    if (f)
-        fclose(f);
+    if (hf && !hf->hf_cached)
+        http_data_file_free(hf);
     if (cbfile)
         cbuf_free(cbfile);
-    if (cbdata)
-        cbuf_free(cbdata);
  return retval;
 }
 
@@ -43,5 +43,6 @@
  */
 int api_path_is_data(clicon_handle h);
 int api_http_data(clicon_handle h, void *req, cvec *qvec);
+int http_data_cache_free(clicon_handle h);
 
 #endif /* _CLIXON_HTTP_DATA_H_ */
@@ -46,6 +46,9 @@ int restconf_reply_header(void *req, const char *name, const char *vfmt, ...)  _
 /* note cb is consumed dont free */
 int restconf_reply_send(void *req, int code, cbuf *cb, int head);
 
+/* note fd is consumed dont close, map is borrowed */
+int restconf_reply_send_file(void *req, int code, int fd, const char *map, size_t len, int head);
+
 cbuf *restconf_get_indata(void *req);
 
 #endif /* _RESTCONF_API_H_ */
@@ -53,6 +53,7 @@
 #include <signal.h>
 #include <dlfcn.h>
 #include <sys/param.h>
+#include <sys/mman.h>
 #include <sys/time.h>
 #include <sys/wait.h>
 
@@ -221,6 +222,60 @@ restconf_reply_send(void  *req0,
     return retval;
 }
 
+/*! Send HTTP reply with a file as message body
+ * @param[in]     req   Fastcgi request handle
+ * @param[in]     code  Status code
+ * @param[in]     fd    Open file. Note: is consumed
+ * @param[in]     map   Read-only mapping of the whole file, or NULL
+ * @param[in]     len   Length of file
+ * @param[in]     head  Only send headers, dont send body. 
+ * @note The body is written from the mapping to the FastCGI stream without a cbuf copy
+ * @see restconf_reply_send  for a body in a cbuf
+ */
+int
+restconf_reply_send_file(void       *req0,
+                         int         code,
+                         int         fd,
+                         const char *map,
+                         size_t      len,
+                         int         head)
+{
+    FCGX_Request *req = (FCGX_Request *)req0;
+    int           retval = -1;
+    const char   *reason_phrase;
+    char         *p = NULL;
+
+    FCGX_SetExitStatus(code, req->out);
+    if ((reason_phrase = restconf_code2reason(code)) == NULL)
+        reason_phrase="";
+    if (restconf_reply_header(req, "Status", "%d %s", code, reason_phrase) < 0)
+        goto done;
+    if (restconf_reply_header(req, "Content-Length", "%zu", len) < 0)
+        goto done;
+    FCGX_FPrintF(req->out, "\r\n");
+    if (!head && len){
+        if (map == NULL){
+            if ((p = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0)) == MAP_FAILED){
+                p = NULL;
+                clicon_err(OE_UNIX, errno, "mmap");
+                goto done;
+            }
+            map = p;
+        }
+        if (FCGX_PutStr(map, (int)len, req->out) != (int)len){
+            clicon_err(OE_RESTCONF, FCGX_GetError(req->out), "FCGX_PutStr");
+            goto done;
+        }
+    }
+    FCGX_FFlush(req->out);
+    retval = 0;
+ done:
+    if (p)
+        munmap(p, len);
+    close(fd);
+    return retval;
+}
+
 /*! Get input data from http request, eg such as curl -X PUT http://... <indata>
  * @param[in]  req        Fastcgi request handle
  * @retval     indata     
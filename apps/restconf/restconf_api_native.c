@@ -45,6 +45,7 @@
 #include <unistd.h>
 #include <string.h>
 #include <signal.h>
+#include <sys/mman.h>
 #include <sys/socket.h>
 #include <arpa/inet.h>
 #include <openssl/ssl.h>
@@ -166,6 +167,82 @@ restconf_reply_send(void  *req0,
     return retval;
 }
 
+/*! Send HTTP reply with a file as message body
+ *
+ * The file is not copied into a body buffer. On HTTP/1 it is written directly to the socket
+ * after the headers, see native_file_write.
+ * On HTTP/2 the body is pulled by nghttp2 under flow control, possibly after other requests
+ * have been handled, therefore it is copied once into the stream body.
+ * @param[in]     req   http request handle
+ * @param[in]     code  Status code
+ * @param[in]     fd    Open file. Note: is consumed
+ * @param[in]     map   Read-only mapping of the whole file, or NULL. Must be valid until the 
+ *                      reply has been written
+ * @param[in]     len   Length of file
+ * @param[in]     head  Only send headers, dont send body. 
+ * @see restconf_reply_send  for a body in a cbuf
+ */
+int
+restconf_reply_send_file(void       *req0,
+                         int         code,
+                         int         fd,
+                         const char *map,
+                         size_t      len,
+                         int         head)
+{
+    int                   retval = -1;
+    restconf_stream_data *sd = (restconf_stream_data *)req0;
+    cbuf                 *cb = NULL;
+    char                 *p = NULL;
+
+    clicon_debug(1, "%s code:%d len:%zu", __FUNCTION__, code, len);
+    if (sd == NULL){
+        clicon_err(OE_CFG, EINVAL, "sd is NULL");
+        goto done;
+    }
+    sd->sd_code = code;
+    sd->sd_body_len = len;
+    if (head || len == 0)
+        goto ok;
+    if (sd->sd_proto == HTTP_2){
+        if (map == NULL){
+            if ((p = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0)) == MAP_FAILED){
+                p = NULL;
+                clicon_err(OE_UNIX, errno, "mmap");
+                goto done;
+            }
+            map = p;
+        }
+        if ((cb = cbuf_new_alloc(len+1)) == NULL){
+            clicon_err(OE_UNIX, errno, "cbuf_new_alloc");
+            goto done;
+        }
+        if (cbuf_append_buf(cb, (void*)map, len) < 0){
+            clicon_err(OE_UNIX, errno, "cbuf_append_buf");
+            goto done;
+        }
+        sd->sd_body = cb;
+        sd->sd_body_offset = 0;
+        cb = NULL;
+        goto ok;
+    }
+    if (sd->sd_fd != -1)
+        close(sd->sd_fd);
+    sd->sd_fd = fd;
+    sd->sd_body_map = map;
+    fd = -1;
+ ok:
+    retval = 0;
+ done:
+    if (fd != -1)
+        close(fd);
+    if (p)
+        munmap(p, len);
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
 /*! Get input data from http request, eg such as curl -X PUT http://... <indata>
  * @param[in]  req        Request handle
  * @note: reuses cbuf from stream-data
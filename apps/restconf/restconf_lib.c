@@ -56,6 +56,7 @@
 #include <sys/param.h>
 #include <sys/time.h>
 #include <sys/wait.h>
+#include <poll.h>
 #include <arpa/inet.h>
 
 /* cligen */
@@ -360,6 +361,7 @@ restconf_terminate(clicon_handle h)
     /* Delete all plugins, and RPC callbacks */
     clixon_plugin_module_exit(h);
 
+    restconf_backend_pool_free(h);
     clicon_rpc_close_session(h);
     if ((yspec = clicon_dbspec_yang(h)) != NULL)
         ys_free(yspec);
@@ -647,6 +649,204 @@ restconf_drop_privileges(clicon_handle h)
     return retval;
 }
 
+/*! Backend session in the restconf backend session pool
+ * @see restconf_backend_select
+ */
+typedef struct {
+    qelem_t   bs_qelem;   /* List header, most recently used first */
+    char     *bs_user;    /* Username of backend session (hello username) */
+    int       bs_s;       /* Persistent socket to backend, or -1 */
+    int       bs_hello;   /* Session established, bs_id is set */
+    uint32_t  bs_id;      /* Backend session-id */
+    time_t    bs_used;    /* Time of last use */
+} restconf_backend_session;
+
+/*! Pool of backend sessions, one per user
+ * The active session is installed in the clixon handle (client socket and session-id)
+ */
+typedef struct {
+    restconf_backend_session *bp_sessions; /* List, most recently used first */
+    restconf_backend_session *bp_active;   /* Session installed in handle, or NULL */
+    int                       bp_nr;       /* Length of list */
+} restconf_backend_pool;
+
+#define RESTCONF_BACKEND_POOL "restconf-backend-pool"
+
+/*! Close and free one backend session
+ */
+static int
+restconf_backend_session_free(restconf_backend_session *bs)
+{
+    if (bs->bs_s != -1)
+        close(bs->bs_s);
+    if (bs->bs_user)
+        free(bs->bs_user);
+    free(bs);
+    return 0;
+}
+
+/*! Check that an idle backend socket is healthy
+ * No data is expected on an idle backend socket, if readable it is closed by the backend
+ * (eg restarted) or out of sync.
+ * @param[in]  s   Socket
+ * @retval     1   OK
+ * @retval     0   Not OK, close and reconnect
+ */
+static int
+restconf_backend_healthy(int s)
+{
+    struct pollfd pfd = {s, POLLIN, 0};
+
+    if (poll(&pfd, 1, 0) != 0)
+        return 0;
+    return 1;
+}
+
+/*! Select backend session of authenticated user before a request is sent to the backend
+ *
+ * Each user has its own backend session with persistent socket, established with a hello
+ * including the username, and reused for subsequent requests of that user.
+ * The state of the previous session is first saved from the handle since the rpc layer
+ * may have reconnected. Sessions idle longer than RESTCONF_BACKEND_IDLE are closed, and
+ * the least recently used session is closed when there are more than
+ * RESTCONF_BACKEND_POOL_NR. A session whose socket is not healthy is reconnected.
+ * @param[in]  h         Clixon handle
+ * @retval     0         OK, session installed in handle
+ * @retval    -1         Error
+ */
+static int
+restconf_backend_select(clicon_handle h)
+{
+    int                       retval = -1;
+    restconf_backend_pool    *bp = NULL;
+    restconf_backend_session *bs;
+    restconf_backend_session *bn;
+    char                     *username;
+    time_t                    now;
+    uint32_t                  id;
+    int                       s;
+
+    if ((username = clicon_username_get(h)) == NULL)
+        username = "";
+    if (clicon_ptr_get(h, RESTCONF_BACKEND_POOL, (void**)&bp) < 0 || bp == NULL){
+        if ((bp = malloc(sizeof(*bp))) == NULL){
+            clicon_err(OE_UNIX, errno, "malloc");
+            goto done;
+        }
+        memset(bp, 0, sizeof(*bp));
+        if (clicon_ptr_set(h, RESTCONF_BACKEND_POOL, bp) < 0){
+            free(bp);
+            goto done;
+        }
+    }
+    now = time(NULL);
+    if ((bs = bp->bp_active) != NULL){
+        bs->bs_s = clicon_client_socket_get(h);
+        bs->bs_hello = clicon_session_id_get(h, &bs->bs_id) == 0;
+        bs->bs_used = now;
+        bp->bp_active = NULL;
+    }
+    else if ((s = clicon_client_socket_get(h)) != -1){
+        /* Opened outside the pool, eg at startup */
+        close(s);
+        clicon_client_socket_set(h, -1);
+    }
+    /* Find session of user, and close idle sessions of other users */
+    bs = NULL;
+    if ((bn = bp->bp_sessions) != NULL){
+        do {
+            if (bs == NULL && strcmp(bn->bs_user, username) == 0)
+                bs = bn;
+            bn = NEXTQ(restconf_backend_session *, bn);
+        } while (bn != bp->bp_sessions);
+    }
+    while ((bn = bp->bp_sessions) != NULL){
+        bn = PREVQ(restconf_backend_session *, bn);
+        if (bn == bs || now - bn->bs_used <= RESTCONF_BACKEND_IDLE)
+            break;
+        clicon_debug(1, "%s close idle session user:%s", __FUNCTION__, bn->bs_user);
+        DELQ(bn, bp->bp_sessions, restconf_backend_session *);
+        bp->bp_nr--;
+        restconf_backend_session_free(bn);
+    }
+    if (bs != NULL){
+        DELQ(bs, bp->bp_sessions, restconf_backend_session *);
+    }
+    else {
+        if ((bs = malloc(sizeof(*bs))) == NULL){
+            clicon_err(OE_UNIX, errno, "malloc");
+            goto done;
+        }
+        memset(bs, 0, sizeof(*bs));
+        bs->bs_s = -1;
+        if ((bs->bs_user = strdup(username)) == NULL){
+            clicon_err(OE_UNIX, errno, "strdup");
+            free(bs);
+            goto done;
+        }
+        bp->bp_nr++;
+        while (bp->bp_nr > RESTCONF_BACKEND_POOL_NR && bp->bp_sessions != NULL){
+            bn = PREVQ(restconf_backend_session *, bp->bp_sessions);
+            clicon_debug(1, "%s close lru session user:%s", __FUNCTION__, bn->bs_user);
+            DELQ(bn, bp->bp_sessions, restconf_backend_session *);
+            bp->bp_nr--;
+            restconf_backend_session_free(bn);
+        }
+    }
+    INSQ(bs, bp->bp_sessions);
+    bs->bs_used = now;
+    if (bs->bs_s != -1 && !restconf_backend_healthy(bs->bs_s)){
+        clicon_debug(1, "%s reconnect session user:%s", __FUNCTION__, bs->bs_user);
+        close(bs->bs_s);
+        bs->bs_s = -1;
+        bs->bs_hello = 0;
+    }
+    /* Install session in handle */
+    bp->bp_active = bs;
+    clicon_client_socket_set(h, bs->bs_s);
+    if (bs->bs_hello)
+        clicon_session_id_set(h, bs->bs_id);
+    else {
+        clicon_session_id_del(h);
+        if (clicon_hello_req(h, &id) < 0)
+            goto done;
+        clicon_session_id_set(h, id);
+        bs->bs_id = id;
+        bs->bs_hello = 1;
+        bs->bs_s = clicon_client_socket_get(h);
+        clicon_debug(1, "%s new session user:%s session-id:%u", __FUNCTION__, bs->bs_user, id);
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Close and free the backend session pool
+ *
+ * The session installed in the handle is left open, it is closed with the handle socket,
+ * eg by clicon_rpc_close_session
+ * @param[in]  h         Clixon handle
+ * @retval     0         OK
+ */
+int
+restconf_backend_pool_free(clicon_handle h)
+{
+    restconf_backend_pool    *bp = NULL;
+    restconf_backend_session *bs;
+
+    if (clicon_ptr_get(h, RESTCONF_BACKEND_POOL, (void**)&bp) == 0 && bp != NULL){
+        while ((bs = bp->bp_sessions) != NULL){
+            DELQ(bs, bp->bp_sessions, restconf_backend_session *);
+            if (bs == bp->bp_active)
+                bs->bs_s = -1;
+            restconf_backend_session_free(bs);
+        }
+        free(bp);
+        clicon_ptr_del(h, RESTCONF_BACKEND_POOL);
+    }
+    return 0;
+}
+
 /*!
  * @param[in]  h         Clicon handle
  * @param[in]  req       Generic Www handle (can be part of clixon handle)
@@ -721,6 +921,9 @@ restconf_authentication_cb(clicon_handle  h,
         retval = 0;
         goto notauth;
     }
+    /* Use backend session of authenticated user */
+    if (restconf_backend_select(h) < 0)
+        goto done;
     /* If set but no user, set a dummy user */
     retval = 1;
  done:
@@ -86,6 +86,7 @@
 #include "restconf_methods_get.h"
 #include "restconf_methods_post.h"
 #include "restconf_stream.h"
+#include "clixon_http_data.h"
 
 /* Command line options to be passed to getopt(3) */
 #define RESTCONF_OPTS "hD:f:E:l:p:d:y:a:u:rW:R:o:"
@@ -217,12 +218,19 @@ static clicon_handle _CLICON_HANDLE = NULL;
  */
 static int _MYSOCK;
 
+/* Pids of FastCGI worker processes in the parent, see restconf_fcgi_workers
+ * Global to forward termination from signal handler
+ */
+static pid_t *_WORKERS = NULL;
+static int    _WORKERS_NR = 0;
+
 /*! Signall terminates process
  */
 static void
 restconf_sig_term(int arg)
 {
     static int i=0;
+    int        j;
 
     clicon_debug(1, "%s", __FUNCTION__);
     if (i++ == 0)
@@ -239,6 +247,10 @@ restconf_sig_term(int arg)
      */
     clixon_exit_set(1); 
     close(_MYSOCK);
+    /* Forward to workers if this is the parent of FastCGI workers */
+    for (j=0; j<_WORKERS_NR; j++)
+        if (_WORKERS[j] > 0)
+            kill(_WORKERS[j], SIGTERM);
 }
 
 /*! Reap stream child
@@ -254,6 +266,227 @@ restconf_sig_child(int arg)
         stream_child_free(_CLICON_HANDLE, pid);
 }
 
+/*! FastCGI accept loop, handle one request at a time until exit
+ * @param[in]  h     Clixon handle
+ * @param[in]  sock  FastCGI listening socket
+ * @retval     0     OK, exit
+ * @retval    -1     Error
+ */
+static int
+restconf_fcgi_loop(clicon_handle h,
+                   int           sock)
+{
+    int           retval = -1;
+    FCGX_Request  request;
+    FCGX_Request *req = &request;
+    char         *path;
+    char         *query;
+    cvec         *qvec;
+    int           finish = 0;
+    cxobj        *xerr = NULL;
+
+    if (FCGX_InitRequest(req, sock, 0) != 0){
+        clicon_err(OE_CFG, errno, "FCGX_InitRequest");
+        goto done;
+    }
+    while (1) {
+        finish = 1; /* If zero, dont finish request, initiate new */
+
+        if (FCGX_Accept_r(req) < 0) {
+            clicon_err(OE_CFG, errno, "FCGX_Accept_r");
+            goto done;
+        }
+        clicon_debug(1, "------------");
+
+        /* Translate from FCGI parameter form to Clixon runtime data 
+         * XXX: potential name collision?
+         */
+        if (fcgi_params_set(h, req->envp) < 0)
+            goto done;
+        if ((path = restconf_param_get(h, "REQUEST_URI")) == NULL){
+            clicon_debug(1, "NULL URI");
+        }
+        else {
+            /* Matching algorithm:
+             * 1. try well-known
+             * 2. try /restconf
+             * 3. try /stream
+             * 4. return error
+             */
+            query = NULL;
+            qvec = NULL;
+            if (strcmp(path, RESTCONF_WELL_KNOWN) == 0){
+                if (api_well_known(h, req) < 0)
+                    goto done;
+            }
+            else if (api_path_is_restconf(h)){
+                query = restconf_param_get(h, "QUERY_STRING");
+                if (query != NULL && strlen(query))
+                    if (uri_str2cvec(query, '&', '=', 1, &qvec) < 0)
+                        goto done;
+                if (api_root_restconf(h, req, qvec) < 0)
+                    goto done;      
+            }
+            else if (api_path_is_stream(h)){
+                query = restconf_param_get(h, "QUERY_STRING");
+                if (query != NULL && strlen(query))
+                    if (uri_str2cvec(query, '&', '=', 1, &qvec) < 0)
+                        goto done;
+                /* XXX doing goto done on error causes test errors */
+                (void)api_stream(h, req, qvec, &finish);
+            }
+            else{
+                clicon_debug(1, "top-level %s not found", path);
+                if (netconf_invalid_value_xml(&xerr, "protocol", "Top-level path not found") < 0)
+                    goto done; 
+                if (api_return_err0(h, req, xerr, 1, YANG_DATA_JSON, 0) < 0)
+                    goto done;
+                if (xerr){
+                    xml_free(xerr);
+                    xerr = NULL;
+                }
+            }
+            if (qvec){
+                cvec_free(qvec);
+                qvec = NULL;
+            }
+        }
+        if (restconf_param_del_all(h) < 0)
+            goto done;
+        if (finish)
+            FCGX_Finish_r(req);
+        else if (clixon_exit_get()){
+            FCGX_Finish_r(req);
+            break;
+        }
+        else{ /* A handler is forked so we initiate a new request after instead 
+                 of finishing the old */
+            if (FCGX_InitRequest(req, sock, 0) != 0){
+                clicon_err(OE_CFG, errno, "FCGX_InitRequest");
+                goto done;
+            }
+        }
+    } /* while */
+    retval = 0;
+ done:
+    if (xerr)
+        xml_free(xerr);
+    return retval;
+}
+
+/*! Initialize a forked FastCGI worker process
+ *
+ * The backend sessions are inherited from the parent, the worker opens its own sessions
+ * on demand, see restconf_backend_select
+ * @param[in]  h     Clixon handle
+ */
+static int
+restconf_fcgi_worker_init(clicon_handle h)
+{
+    int      retval = -1;
+    int      s;
+
+    free(_WORKERS);
+    _WORKERS = NULL;
+    _WORKERS_NR = 0;
+    if (set_signal(SIGCHLD, restconf_sig_child, NULL) < 0){
+        clicon_err(OE_DAEMON, errno, "Setting signal");
+        goto done;
+    }
+    restconf_backend_pool_free(h);
+    if ((s = clicon_client_socket_get(h)) >= 0){
+        close(s);
+        clicon_client_socket_set(h, -1);
+    }
+    clicon_session_id_del(h);
+    clicon_debug(1, "%s pid:%u", __FUNCTION__, getpid());
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Fork FastCGI worker processes and restart them if they exit
+ *
+ * The workers accept requests on the same FastCGI socket, the kernel distributes the
+ * connections. YANG specs and plugins are loaded before the fork and shared copy-on-write.
+ * The parent does not accept requests, it returns when all workers have exited after
+ * termination.
+ * @param[in]  h       Clixon handle
+ * @param[in]  nr      Number of workers
+ * @param[out] worker  Set to 1 in a worker process, which should then run the accept loop
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see CLICON_RESTCONF_FCGI_WORKERS
+ */
+static int
+restconf_fcgi_workers(clicon_handle h,
+                      int           nr,
+                      int          *worker)
+{
+    int   retval = -1;
+    int   i;
+    int   alive = 0;
+    pid_t pid;
+    int   status;
+
+    /* Workers are reaped here, not in restconf_sig_child */
+    if (set_signal(SIGCHLD, SIG_DFL, NULL) < 0){
+        clicon_err(OE_DAEMON, errno, "Setting signal");
+        goto done;
+    }
+    if ((_WORKERS = calloc(nr, sizeof(pid_t))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    _WORKERS_NR = nr;
+    while (1){
+        for (i=0; i<nr && !clixon_exit_get(); i++){
+            if (_WORKERS[i] != 0)
+                continue;
+            if ((pid = fork()) < 0){
+                clicon_err(OE_UNIX, errno, "fork");
+                goto done;
+            }
+            if (pid == 0){ /* Worker */
+                if (restconf_fcgi_worker_init(h) < 0)
+                    goto done;
+                *worker = 1;
+                goto ok;
+            }
+            clicon_debug(1, "%s worker %d pid:%u", __FUNCTION__, i, pid);
+            _WORKERS[i] = pid;
+            alive++;
+        }
+        if (alive == 0)
+            break;
+        if ((pid = waitpid(-1, &status, 0)) < 0){
+            if (errno == EINTR)
+                continue;
+            clicon_err(OE_UNIX, errno, "waitpid");
+            goto done;
+        }
+        for (i=0; i<nr; i++){
+            if (_WORKERS[i] != pid)
+                continue;
+            _WORKERS[i] = 0;
+            alive--;
+            if (!clixon_exit_get()){
+                clicon_log(LOG_WARNING, "%s: worker pid %u exited with status %d, restarting",
+                           __FUNCTION__, pid, status);
+                sleep(1); /* Avoid fork loop if worker fails directly */
+            }
+            break;
+        }
+    }
+    free(_WORKERS);
+    _WORKERS = NULL;
+    _WORKERS_NR = 0;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
 /*! Usage help routine
  * @param[in]  argv0  command line
  * @param[in]  h      Clicon handle
@@ -292,28 +525,23 @@ main(int    argc,
     int            retval = -1;
     int            sock;
     char          *argv0 = argv[0];
-    FCGX_Request   request;
-    FCGX_Request  *req = &request;
     int            c;
     char          *sockpath = NULL;
-    char          *path;
     clicon_handle  h;
     char          *dir;
     int            logdst = CLICON_LOG_SYSLOG;
     yang_stmt     *yspec = NULL;
-    char          *query;
-    cvec          *qvec;
-    int            finish = 0;
     char          *str;
     clixon_plugin_t *cp = NULL;
     cvec          *nsctx_global = NULL; /* Global namespace context */
     size_t         cligen_buflen;
     size_t         cligen_bufthreshold;
     int            dbg = 0;
-    cxobj         *xerr = NULL;
     char          *wwwuser;
     char          *inline_config = NULL;
     size_t         sz;
+    int            workers;
+    int            worker = 0;
 
     /* In the startup, logs to stderr & debug flag set later */
     clicon_log_init(__PROGRAM__, LOG_INFO, logdst); 
@@ -577,91 +805,18 @@ main(int    argc,
      */
     if (restconf_drop_privileges(h) < 0)
         goto done;
-    if (FCGX_InitRequest(req, sock, 0) != 0){
-        clicon_err(OE_CFG, errno, "FCGX_InitRequest");
-        goto done;
-    }
-    while (1) {
-        finish = 1; /* If zero, dont finish request, initiate new */
-
-        if (FCGX_Accept_r(req) < 0) {
-            clicon_err(OE_CFG, errno, "FCGX_Accept_r");
+    if ((workers = clicon_option_int(h, "CLICON_RESTCONF_FCGI_WORKERS")) > 1){
+        if (restconf_fcgi_workers(h, workers, &worker) < 0)
             goto done;
-        }
-        clicon_debug(1, "------------");
-
-        /* Translate from FCGI parameter form to Clixon runtime data 
-         * XXX: potential name collision?
-         */
-        if (fcgi_params_set(h, req->envp) < 0)
+        if (worker && restconf_fcgi_loop(h, sock) < 0)
             goto done;
-        if ((path = restconf_param_get(h, "REQUEST_URI")) == NULL){
-            clicon_debug(1, "NULL URI");
-        }
-        else {
-            /* Matching algorithm:
-             * 1. try well-known
-             * 2. try /restconf
-             * 3. try /stream
-             * 4. return error
-             */
-            query = NULL;
-            qvec = NULL;
-            if (strcmp(path, RESTCONF_WELL_KNOWN) == 0){
-                if (api_well_known(h, req) < 0)
-                    goto done;
-            }
-            else if (api_path_is_restconf(h)){
-                query = restconf_param_get(h, "QUERY_STRING");
-                if (query != NULL && strlen(query))
-                    if (uri_str2cvec(query, '&', '=', 1, &qvec) < 0)
-                        goto done;
-                if (api_root_restconf(h, req, qvec) < 0)
-                    goto done;      
-            }
-            else if (api_path_is_stream(h)){
-                query = restconf_param_get(h, "QUERY_STRING");
-                if (query != NULL && strlen(query))
-                    if (uri_str2cvec(query, '&', '=', 1, &qvec) < 0)
-                        goto done;
-                /* XXX doing goto done on error causes test errors */
-                (void)api_stream(h, req, qvec, &finish);
-            }
-            else{
-                clicon_debug(1, "top-level %s not found", path);
-                if (netconf_invalid_value_xml(&xerr, "protocol", "Top-level path not found") < 0)
-                    goto done; 
-                if (api_return_err0(h, req, xerr, 1, YANG_DATA_JSON, 0) < 0)
-                    goto done;
-                if (xerr){
-                    xml_free(xerr);
-                    xerr = NULL;
-                }
-            }
-            if (qvec){
-                cvec_free(qvec);
-                qvec = NULL;
-            }
-        }
-        if (restconf_param_del_all(h) < 0)
-            goto done;
-        if (finish)
-            FCGX_Finish_r(req);
-        else if (clixon_exit_get()){
-            FCGX_Finish_r(req);
-            break;
-        }
-        else{ /* A handler is forked so we initiate a new request after instead 
-                 of finishing the old */
-            if (FCGX_InitRequest(req, sock, 0) != 0){
-                clicon_err(OE_CFG, errno, "FCGX_InitRequest");
-                goto done;
-            }
-        }
-    } /* while */
+    }
+    else if (restconf_fcgi_loop(h, sock) < 0)
+        goto done;
     retval = 0;
  done:
     stream_child_freeall(h);
+    http_data_cache_free(h);
     restconf_terminate(h);
     return retval;
 }
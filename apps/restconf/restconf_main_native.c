@@ -158,6 +158,7 @@
 #ifdef HAVE_HTTP1
 #include "restconf_http1.h"
 #endif
+#include "clixon_http_data.h"
 
 /* Command line options to be passed to getopt(3) */
 #define RESTCONF_OPTS "hD:f:E:l:p:y:a:u:rW:R:o:"
@@ -1294,6 +1295,7 @@ main(int    argc,
     if (xrestconf)
         xml_free(xrestconf);
     restconf_native_terminate(h);
+    http_data_cache_free(h);
     restconf_terminate(h);
     return retval;
 }
@@ -675,7 +675,7 @@ api_data_patch(clicon_handle h,
     case YANG_PATCH_JSON:       /* RFC 8072 patch */
     case YANG_PATCH_XML:
 #ifdef CLIXON_YANG_PATCH
-        ret = api_data_yang_patch(h, req, api_path0, pcvec, pi, qvec, data, pretty,
+        ret = api_data_yang_patch(h, req, api_path0, pi, qvec, data, pretty,
                                   media_in, media_out, ds);
 #else
         ret = restconf_notimplemented(h, req, pretty, media_out);
@@ -99,627 +99,505 @@ yang_patch_op2int(char *op)
     return clicon_str2int(yang_patch_op_map, op);
 }
 
-/*! Add square brackets after the surrounding curly brackets in JSON
-  * Needed, in order to modify the result of clixon_json2cbuf() to be valid input
-  * to api_data_post() and api_data_write()
-  * @param[in]  x_simple_patch  a cxobj to pass to clixon_json2cbuf()
-  * @retva      cbuf            With the modified json
-  * @retva      NULL            Error
-  */
-static cbuf*
-yang_patch_xml2json_modified_cbuf(cxobj *x_simple_patch)
-{
-    cbuf *json_simple_patch = NULL;
-    cbuf *cb = NULL;
-    char *json_simple_patch_tmp;
-    int   brace_count = 0;
-    size_t len;
-        
-    json_simple_patch = cbuf_new();
-    if (json_simple_patch == NULL)
-        return NULL;
-    cb = cbuf_new();
-    if (clixon_json2cbuf(cb, x_simple_patch, 0, 0) < 0)
-        goto done;
-
-    // Insert a '[' after the first '{' to get the JSON to match what api_data_post/write() expect
-    json_simple_patch_tmp = cbuf_get(cb);
-    len = strlen(json_simple_patch_tmp);
-    for (int l = 0; l < len; l++) {
-        char c = json_simple_patch_tmp[l];
-        if (c == '{') {
-            brace_count++;
-            if (brace_count == 2) { // We've reached the second brace, insert a '[' before it
-                cbuf_append(json_simple_patch,(int)'[');
-            }
-        }
-        cbuf_append(json_simple_patch,(int)c);
-    }
-
-    // Insert a ']' before the last '}' to get the JSON to match what api_data_post() expects
-    for (int l = cbuf_len(json_simple_patch) - 1; l >= 0; l--) {
-        char c = cbuf_get(json_simple_patch)[l];
-        if (c == '}') {
-            // Truncate and add a string, as there is not a function to insert a char into a cbuf
-            cbuf_trunc(json_simple_patch, l);
-            cbuf_append_str(json_simple_patch, "]}");
-            break;
-        }
-    }
-    cbuf_free(cb);
-    return json_simple_patch;
-}
-
-/*!yang_patch_strip_after_last_slash 
+/*! Map a YANG patch operation to the netconf operation used in the combined edit-config
  *
- * Strip /... from end  of val
- * so that e.g. "/interface=eth2" becomes "/"
- * or "/interface_list=mylist/interface=eth2" becomes "/interface_list=mylist/"
- *
- * @param[in]  val     value to strip
- * @retval     cbuf    with the stripped string
- * @retval     NULL    error
+ * "insert" creates the value at the position given by point/where, and "move"
+ * merges the existing target at a new position. Both positions are given by
+ * yang:insert/key/value attributes, see yang_patch_insert_attributes
+ * @param[in]  op   YANG patch operation
+ * @retval     op   Netconf operation
  */
-static cbuf*
-yang_patch_strip_after_last_slash(char* val)
+static enum operation_type
+yang_patch_op2netconf(yang_patch_op_t op)
 {
-    cbuf *cb;
-    cbuf *val_tmp;
-    int   idx;
-    
-    cb = cbuf_new();
-    val_tmp = cbuf_new();
-    cbuf_append_str(val_tmp, val);
-    idx = cbuf_len(val_tmp);
-    for (int l = cbuf_len(val_tmp) - 1; l>= 0; l--) {
-        if (cbuf_get(val_tmp)[l] == '/') {
-            idx = l;
-            break;
-        }
+    switch (op){
+    case YANG_PATCH_OP_DELETE:
+        return OP_DELETE;
+    case YANG_PATCH_OP_REMOVE:
+        return OP_REMOVE;
+    case YANG_PATCH_OP_MERGE:
+    case YANG_PATCH_OP_MOVE:
+        return OP_MERGE;
+    case YANG_PATCH_OP_REPLACE:
+        return OP_REPLACE;
+    case YANG_PATCH_OP_CREATE:
+    case YANG_PATCH_OP_INSERT:
+    default:
+        break;
     }
-    if (idx == cbuf_len(val_tmp)) // Didn't find a slash in the loop above
-        return NULL;
-    cbuf_trunc(val_tmp, idx + 1);
-    if (cbuf_append_str(cb, cbuf_get(val_tmp)) < 0)
-        return NULL;
-    cbuf_free(val_tmp);
-    return cb;
+    return OP_CREATE;
 }
 
-/*! YANG PATCH replace method
- * @param[in]  h         Clixon handle
- * @param[in]  req       Generic Www handle
- * @param[in]  pi        Offset, where to start api-path
- * @param[in]  qvec      Vector of query string (QUERY_STRING)
- * @param[in]  pretty    Set to 1 for pretty-printed xml/json output
- * @param[in]  media_out Output media
- * @param[in]  ds       0 if "data" resource, 1 if rfc8527 "ds" resource
- * @param[in]  simplepatch_request_uri URI for patch request, e.g. "/restconf/data/ietf-interfaces:interfaces"
- * @param[in]  target_val       value in "target" field of edit in YANG patch
- * @param[in]  value_vec_len    number of elements in the "value" array of an edit in YANG patch
- * @param[in]  value_vec        pointer to the "value" array of an edit in YANG patch
- * @param[in]  x_simple_patch   pointer to XML containing module name, e.g. <ietf-interfaces:interface/>
+/*! Translate YANG patch point/where to netconf yang:insert and yang:key/value attributes
+ *
+ * @param[in]  xedit     YANG patch edit element
+ * @param[in]  api_path  Api-path of the patch target resource (point is relative to it)
+ * @param[in]  xbot      Edit target node in the combined edit-config tree
+ * @param[out] xerr      Netconf error message if retval is 0
+ * @retval     1         OK
+ * @retval     0         Invalid point/where, xerr set
+ * @retval    -1         Error
+ * @see restconf_insert_attributes  which translates the attributes
  */
 static int
-yang_patch_do_replace(clicon_handle  h,
-                      void          *req,
-                      int            pi,
-                      cvec          *qvec,
-                      int            pretty,
-                      restconf_media media_out,
-                      ietf_ds_t      ds,
-                      cbuf          *simple_patch_request_uri,
-                      char          *target_val,       
-                      int            value_vec_len,
-                      cxobj        **value_vec,
-                      cxobj         *x_simple_patch
-                      )
+yang_patch_insert_attributes(cxobj  *xedit,
+                             char   *api_path,
+                             cxobj  *xbot,
+                             cxobj **xerr)
 {
-    int    retval = -1;
-    cxobj *value_vec_tmp = NULL;
-    cbuf  *delete_req_uri = NULL;
-    cbuf  *post_req_uri = NULL;
-    cbuf  *json_simple_patch = NULL;
-    
-    if ((delete_req_uri = cbuf_new()) == NULL){
-        clicon_err(OE_UNIX, errno, "cbuf_new");
-        goto done;
-    }
-    if ((json_simple_patch = cbuf_new()) == NULL){
-        clicon_err(OE_UNIX, errno, "cbuf_new");
-        goto done;
-    }
-    // Make delete_req_uri something like "/restconf/data/ietf-interfaces:interfaces"
-    if (cbuf_append_str(delete_req_uri, cbuf_get(simple_patch_request_uri)) < 0){
-        clicon_err(OE_UNIX, errno, "cbuf_append_str");
-        goto done;
-    }
+    int   retval = -1;
+    cvec *qvec = NULL;
+    char *where;
+    char *point;
+    cbuf *cb = NULL;
 
-    // Add the target to delete_req_uri,
-    // so it's something like "/restconf/data/ietf-interfaces:interfaces/interface=eth2"
-    if (cbuf_append_str(delete_req_uri, target_val) <  0){
-        clicon_err(OE_UNIX, errno, "cbuf_append_str");
-        goto done;
+    if ((where = xml_find_body(xedit, "where")) == NULL)
+        where = "last";
+    point = xml_find_body(xedit, "point");
+    if ((strcmp(where, "before") == 0 || strcmp(where, "after") == 0) &&
+        point == NULL){
+        if (netconf_missing_element_xml(xerr, "protocol", "point", "Expected when where is before or after") < 0)
+            goto done;
+        goto fail;
     }
-
-    // Delete the object with the old values
-    if (api_data_delete(h, req, cbuf_get(delete_req_uri), pi, pretty, YANG_DATA_JSON, ds) < 0)
-        goto done;
-
-    // Now set up for the post request.
-    // Strip /... from end  of target val
-    // so that e.g. "/interface=eth2" becomes "/"
-    // or "/interface_list=mylist/interface=eth2" becomes "/interface_list=mylist/"
-    if ((post_req_uri = yang_patch_strip_after_last_slash(target_val)) == NULL)
+    if ((qvec = cvec_new(0)) == NULL){
+        clicon_err(OE_UNIX, errno, "cvec_new");
         goto done;
-
-    // Make post_req_uri something like "/restconf/data/ietf-interfaces:interfaces"
-    if (cbuf_append_str(simple_patch_request_uri, cbuf_get(post_req_uri)) < 0){
-        clicon_err(OE_UNIX, errno, "cbuf_append_str");
+    }
+    if (cvec_add_string(qvec, "insert", where) < 0){
+        clicon_err(OE_UNIX, errno, "cvec_add_string");
         goto done;
     }
-    // Now insert the new values into the data
-    // (which will include the key value and all other mandatory values)
-    for (int k = 0; k < value_vec_len; k++) {
-        if (value_vec[k] != NULL) {
-            value_vec_tmp = xml_dup(value_vec[k]);
-            xml_addsub(x_simple_patch, value_vec_tmp);
+    if (point != NULL){
+        if ((cb = cbuf_new()) == NULL){
+            clicon_err(OE_UNIX, errno, "cbuf_new");
+            goto done;
+        }
+        cprintf(cb, "%s%s", api_path?api_path:"", point);
+        if (cvec_add_string(qvec, "point", cbuf_get(cb)) < 0){
+            clicon_err(OE_UNIX, errno, "cvec_add_string");
+            goto done;
         }
     }
-    // Convert the data to json
-    if (clixon_json2cbuf(json_simple_patch, x_simple_patch, 0, 0) < 0)
-        goto done;
-
-    // Send the POST request
-    if (api_data_post(h, req, cbuf_get(simple_patch_request_uri), pi, qvec, cbuf_get(json_simple_patch), pretty, YANG_DATA_JSON, media_out, ds ) < 0)
+    if (restconf_insert_attributes(xbot, qvec) < 0)
         goto done;
-    retval = 0;
+    retval = 1;
  done:
-    if (post_req_uri)
-        cbuf_free(post_req_uri);
-    if (delete_req_uri)
-        cbuf_free(delete_req_uri);
-    if (json_simple_patch)
-        cbuf_free(json_simple_patch);
-    if (value_vec_tmp)
-        xml_free(value_vec_tmp);
+    if (cb)
+        cbuf_free(cb);
+    if (qvec)
+        cvec_free(qvec);
     return retval;
+ fail:
+    retval = 0;
+    goto done;
 }
 
-/*! YANG PATCH create method
- * @param[in]  h         Clixon handle
- * @param[in]  req       Generic Www handle
- * @param[in]  pi        Offset, where to start api-path
- * @param[in]  qvec      Vector of query string (QUERY_STRING)
- * @param[in]  pretty    Set to 1 for pretty-printed xml/json output
- * @param[in]  media_out Output media
- * @param[in]  ds       0 if "data" resource, 1 if rfc8527 "ds" resource
- * @param[in]  simplepatch_request_uri URI for patch request, e.g. "/restconf/data/ietf-interfaces:interfaces"
- * @param[in]  value_vec_len    number of elements in the "value" array of an edit in YANG patch
- * @param[in]  value_vec        pointer to the "value" array of an edit in YANG patch
- * @param[in]  x_simple_patch   pointer to XML containing module name, e.g. <ietf-interfaces:interface/>
+/*! Replace the edit target node with the value of a YANG patch edit
+ *
+ * The value is a single instance of the target resource. It is bound to the namespace of
+ * the target, which is needed since unprefixed JSON values are parsed in the namespace of
+ * the yang-patch. List keys not present in the value are taken from the target.
+ * @param[in]     xedit  YANG patch edit element
+ * @param[in,out] xbotp  Edit target node, replaced by the value on success
+ * @param[out]    xerr   Netconf error message if retval is 0
+ * @retval        1      OK
+ * @retval        0      Invalid value, xerr set
+ * @retval       -1      Error
  */
 static int
-yang_patch_do_create(clicon_handle  h,
-                     void          *req,
-                     int            pi,
-                     cvec          *qvec,
-                     int            pretty,
-                     restconf_media media_out,
-                     ietf_ds_t      ds,
-                     cbuf          *simple_patch_request_uri,
-                     int            value_vec_len,
-                     cxobj        **value_vec,
-                     cxobj         *x_simple_patch
-                     )
+yang_patch_value(cxobj  *xedit,
+                 cxobj **xbotp,
+                 cxobj **xerr)
 {
-    int    retval = -1;
-    cxobj *value_vec_tmp = NULL;
-    cbuf  *cb = NULL;
-    
-    // Send the POST request
-    if ((cb = cbuf_new()) == NULL){
-        clicon_err(OE_UNIX, errno, "cbuf_new");
-        goto done;
+    int        retval = -1;
+    cxobj     *xbot = *xbotp;
+    yang_stmt *ybot;
+    cxobj     *xvalue;
+    cxobj     *xv;
+    cxobj     *xdata = NULL;
+    cxobj     *xa;
+    cxobj     *xk;
+    cxobj     *xkd;
+    cvec      *cvk;
+    cg_var    *cvi;
+    char      *keyname;
+    char      *b1;
+    char      *b2;
+    int        ret;
+
+    ybot = xml_spec(xbot);
+    if ((xvalue = xml_find_type(xedit, NULL, "value", CX_ELMNT)) == NULL ||
+        xml_child_nr_type(xvalue, CX_ELMNT) != 1){
+        if (netconf_missing_element_xml(xerr, "protocol", "value", "Expected exactly one instance of the edit target") < 0)
+            goto done;
+        goto fail;
     }
-    for (int k = 0; k < value_vec_len; k++) {
-        if (value_vec[k] != NULL) {
-            if ((value_vec_tmp = xml_dup(value_vec[k])) == NULL)
+    xv = xml_child_i_type(xvalue, 0, CX_ELMNT);
+    if (strcmp(xml_name(xv), xml_name(xbot)) != 0){
+        if (netconf_bad_element_xml(xerr, "application", xml_name(xv), "Edit value does not match edit target") < 0)
+            goto done;
+        goto fail;
+    }
+    if ((xdata = xml_dup(xv)) == NULL)
+        goto done;
+    if (xml_prefix_set(xdata, NULL) < 0)
+        goto done;
+    if ((xa = xml_find_type(xdata, NULL, "xmlns", CX_ATTR)) != NULL)
+        xml_purge(xa);
+    if (xmlns_set(xdata, NULL, yang_find_mynamespace(ybot)) < 0)
+        goto done;
+    switch (yang_keyword_get(ybot)){
+    case Y_LIST:
+        cvk = yang_cvec_get(ybot);
+        cvi = NULL;
+        while ((cvi = cvec_each(cvk, cvi)) != NULL) {
+            keyname = cv_string_get(cvi);
+            if ((xk = xml_find_type(xbot, NULL, keyname, CX_ELMNT)) == NULL)
+                continue;
+            if ((xkd = xml_find_type(xdata, NULL, keyname, CX_ELMNT)) == NULL){
+                if ((xkd = xml_dup(xk)) == NULL)
+                    goto done;
+                if (xml_addsub(xdata, xkd) < 0)
+                    goto done;
+                continue;
+            }
+            b1 = xml_body(xk);
+            b2 = xml_body(xkd);
+            if (b1 == NULL || b2 == NULL || strcmp(b1, b2) != 0){
+                if (netconf_operation_failed_xml(xerr, "protocol", "Edit target keys do not match value keys") < 0)
+                    goto done;
+                goto fail;
+            }
+        }
+        break;
+    case Y_LEAF_LIST:
+        b1 = xml_body(xbot);
+        b2 = xml_body(xdata);
+        if (b1 == NULL || b2 == NULL || strcmp(b1, b2) != 0){
+            if (netconf_operation_failed_xml(xerr, "protocol", "Edit target does not match value") < 0)
                 goto done;
-            xml_addsub(x_simple_patch, value_vec_tmp);
+            goto fail;
         }
+        break;
+    default:
+        break;
     }
-    if (clixon_json2cbuf(cb, x_simple_patch, 0, 0) < 0)
-        goto done;
-    if (api_data_post(h, req, cbuf_get(simple_patch_request_uri),
-                      pi, qvec,
-                      cbuf_get(cb), pretty, YANG_DATA_JSON, media_out, ds) < 0)
-        goto done;
-     retval = 0;
+    if (xml_addsub(xml_parent(xbot), xdata) < 0)
+        goto done;
+    xml_purge(xbot);
+    *xbotp = xdata;
+    xdata = NULL;
+    /* Top-level targets have no yang parent to bind from */
+    if (xml_spec(xml_parent(*xbotp)) == NULL)
+        ret = xml_bind_yang0(*xbotp, YB_MODULE, ys_spec(ybot), xerr);
+    else
+        ret = xml_bind_yang0(*xbotp, YB_PARENT, NULL, xerr);
+    if (ret < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    retval = 1;
  done:
-     if (cb)
-         cbuf_free(cb);
+    if (xdata)
+        xml_free(xdata);
     return retval;
-}
-
-/*! YANG PATCH insert method
- * @param[in]  h         Clixon handle
- * @param[in]  req       Generic Www handle
- * @param[in]  pi        Offset, where to start api-path
- * @param[in]  pretty    Set to 1 for pretty-printed xml/json output
- * @param[in]  media_out Output media
- * @param[in]  ds       0 if "data" resource, 1 if rfc8527 "ds" resource
- * @param[in]  simple_patch_request_uri URI for patch request, e.g. "/restconf/data/ietf-interfaces:interfaces"
- * @param[in]  value_vec_len    number of elements in the "value" array of an edit in YANG patch
- * @param[in]  value_vec        pointer to the "value" array of an edit in YANG patch
- * @param[in]  x_simple_patch   pointer to XML containing module name, e.g. <ietf-interfaces:interface/>
- * @param[in]  where_val       value in "where" field of edit in YANG patch
- * @param[in]  api_path        full API path, e.g. "/restconf/data/example-jukebox:jukebox/playlist=Foo-One" 
- * @param[in]  point_val       value in "point" field of edit in YANG patch
- */
-static int
-yang_patch_do_insert(clicon_handle  h,
-                     void          *req,
-                     int            pi,
-                     int            pretty,
-                     restconf_media media_out,
-                     ietf_ds_t      ds,
-                     cbuf          *simple_patch_request_uri,
-                     int            value_vec_len,
-                     cxobj        **value_vec,
-                     cxobj         *x_simple_patch,
-                     char          *where_val,
-                     char          *api_path,
-                     char          *point_val
-                     )
-{
-    int     retval = -1;
-    cxobj  *value_vec_tmp = NULL;
-    cbuf   *json_simple_patch;
-    cg_var *cv;
-    cbuf   *point_str = NULL;
-    cvec   *qvec_tmp = NULL;
-    
-    if ((point_str = cbuf_new()) == NULL){
-        clicon_err(OE_UNIX, errno, "cbuf_new");
-        goto done;
-    }
-    if ((qvec_tmp = cvec_new(0)) == NULL){
-        clicon_err(OE_UNIX, errno, "cbuf_new");
-        goto done;
-    }
-    // Loop through the XML, and get each value
-    for (int k = 0; k < value_vec_len; k++) {
-        if (value_vec[k] != NULL) {
-            value_vec_tmp = xml_dup(value_vec[k]);
-            xml_addsub(x_simple_patch, value_vec_tmp);
-        }
-    }
-    if ((json_simple_patch = yang_patch_xml2json_modified_cbuf(x_simple_patch)) == NULL)
-        goto done;
-
-    // Set the insert attributes
-    if ((cv = cvec_add(qvec_tmp, CGV_STRING)) == NULL){
-        clicon_err(OE_UNIX, errno, "cvec_add");
-        goto done;
-    }
-    cv_name_set(cv, "insert");
-    if (where_val)
-        cv_string_set(cv, where_val);
-    cbuf_append_str(point_str, api_path);
-    if (point_val)
-        cbuf_append_str(point_str, point_val);
-    if ((cv = cvec_add(qvec_tmp, CGV_STRING)) == NULL){
-        clicon_err(OE_UNIX, errno, "cvec_add");
-        goto done;
-    }
-    cv_name_set(cv, "point");
-    cv_string_set(cv, cbuf_get(point_str));
-
-    // Send the POST request
-    if (api_data_post(h, req, cbuf_get(simple_patch_request_uri), pi, qvec_tmp, cbuf_get(json_simple_patch), pretty, YANG_DATA_JSON, media_out, ds)<  0)
-        goto done;
+ fail:
     retval = 0;
- done:
-    if (qvec_tmp)
-        cvec_free(qvec_tmp);
-    if (point_str)
-        cbuf_free(point_str);
-    if (json_simple_patch)
-        cbuf_free(json_simple_patch);
-    return retval;
+    goto done;
 }
 
-/*! YANG PATCH merge method
- * @param[in]  h         Clixon handle
- * @param[in]  req       Generic Www handle
- * @param[in]  pi        Offset, where to start api-path
- * @param[in]  qvec      Vector of query string (QUERY_STRING)
- * @param[in]  pretty    Set to 1 for pretty-printed xml/json output
- * @param[in]  media_out Output media
- * @param[in]  ds       0 if "data" resource, 1 if rfc8527 "ds" resource
- * @param[in]  simple_patch_request_uri URI for patch request, e.g. "/restconf/data/ietf-interfaces:interfaces"
- * @param[in]  value_vec_len    number of elements in the "value" array of an edit in YANG patch
- * @param[in]  value_vec        pointer to the "value" array of an edit in YANG patch
- * @param[in]  x_simple_patch   pointer to XML containing module name, e.g. "<ietf-interfaces:interface/>"
- * @param[in]  where_val       value in "where" field of edit in YANG patch
- * @param[in]  key_xn          XML with key tag and value, e.g. "<name>Foo-One</name>"
+/*! Move a single-edit tree into the combined edit-config tree
+ *
+ * Ancestors of the edit target are shared with earlier edits if they are the last
+ * matching node in the combined tree and carry no operation themselves. This keeps
+ * edits on the same instance in patch order after the backend has sorted the tree.
+ * @param[in]  xt    Combined edit-config tree
+ * @param[in]  xt1   Single-edit tree, its content is moved into xt
+ * @param[in]  xbot  Edit target node in xt1
+ * @retval     0     OK
+ * @retval    -1     Error
  */
 static int
-yang_patch_do_merge(clicon_handle  h,
-                    void          *req,
-                    int            pi,
-                    cvec          *qvec,
-                    int            pretty,
-                    restconf_media media_out,
-                    ietf_ds_t      ds,
-                    cbuf          *simple_patch_request_uri,
-                    int            value_vec_len,
-                    cxobj        **value_vec,
-                    cxobj         *x_simple_patch,
-                    cxobj         *key_xn
-                    )
+yang_patch_graft(cxobj *xt,
+                 cxobj *xt1,
+                 cxobj *xbot)
 {
-    int    retval = -1;
-    cxobj *value_vec_tmp = NULL;
-    cbuf  *cb = NULL;
-    cbuf  *json_simple_patch = NULL;
-        
-    if ((cb = cbuf_new()) == NULL){
-        clicon_err(OE_UNIX, errno, "cbuf_new");
-        goto done;
-    }
-    if (key_xn != NULL)
-        xml_addsub(x_simple_patch, key_xn);
-    
-    // Loop through the XML, create JSON from each one, and submit a simple patch
-    for (int k = 0; k < value_vec_len; k++) {
-        if (value_vec[k] != NULL) {
-            value_vec_tmp = xml_dup(value_vec[k]);
-            xml_addsub(x_simple_patch, value_vec_tmp);
-        }
-        cbuf_reset(cb); /* reuse cb */
-        if (clixon_json2cbuf(cb, x_simple_patch, 0, 0) < 0)
-            goto done;
+    int          retval = -1;
+    clixon_xvec *xv = NULL;
+    cxobj       *x;
+    cxobj       *xc;
+    cxobj       *xmatch;
+    int          i;
 
-        if ((json_simple_patch = yang_patch_xml2json_modified_cbuf(x_simple_patch)) == NULL)
-            goto done;
-        // Send the simple patch request
-        if (api_data_write(h, req, cbuf_get(simple_patch_request_uri), pi, qvec, cbuf_get(json_simple_patch), pretty, YANG_DATA_JSON, media_out, 1, ds ) < 0)
+    if ((xv = clixon_xvec_new()) == NULL)
+        goto done;
+    for (x = xbot; x != xt1; x = xml_parent(x))
+        if (clixon_xvec_prepend(xv, x) < 0)
             goto done;
-        if (json_simple_patch){
-            cbuf_free(json_simple_patch);
-            json_simple_patch = NULL;
+    for (i = 0; i < clixon_xvec_len(xv); i++){
+        x = clixon_xvec_i(xv, i);
+        xmatch = NULL;
+        if (x != xbot){
+            xc = NULL;
+            while ((xc = xml_child_each(xt, xc, CX_ELMNT)) != NULL)
+                if (xml_spec(xc) == xml_spec(x) && xml_cmp(xc, x, 0, 0, NULL) == 0)
+                    xmatch = xc;
+            if (xmatch &&
+                xml_find_type(xmatch, NETCONF_BASE_PREFIX, "operation", CX_ATTR) != NULL)
+                xmatch = NULL;
+        }
+        if (xmatch == NULL){
+            if (xml_rm(x) < 0)
+                goto done;
+            if (xml_addsub(xt, x) < 0)
+                goto done;
+            break;
         }
+        xt = xmatch;
     }
     retval = 0;
  done:
-    if (cb)
-        cbuf_free(cb);
-    if (json_simple_patch)
-        cbuf_free(json_simple_patch);
+    if (xv)
+        clixon_xvec_free(xv);
     return retval;
 }
 
-/*! Process a single yang patch "edit/value" element
+/*! Translate one YANG patch edit and add it to the combined edit-config tree
  *
- * @param[in]  xn        XML value element
- * @retval     0         OK
+ * @param[in]  yspec     Yang spec
+ * @param[in]  api_path  Api-path of the patch target resource
+ * @param[in]  xedit     YANG patch edit element
+ * @param[in]  xt        Combined edit-config tree
+ * @param[out] xpath     XPath of the edit target, used to map errors. Free with free()
+ * @param[out] xerr      Netconf error message if retval is 0
+ * @retval     1         OK
+ * @retval     0         Invalid edit, xerr set
  * @retval    -1         Error
  */
 static int
-yang_patch_do_value(clicon_handle  h,
-                    void          *req,
-                    int            pi,
-                    cvec          *qvec,
-                    int            pretty,
-                    restconf_media media_out,
-                    ietf_ds_t      ds,
-                    cxobj         *xn,
-                    char          *modname,
-                    yang_patch_op_t operation,
-                    char          *where_val,
-                    char          *point_val,
-                    cbuf          *simple_patch_request_uri,
-                    char          *target_val,
-                    char          *api_path,
-                    cxobj         *key_xn
-                    )
+yang_patch_edit2xml(yang_stmt *yspec,
+                    char      *api_path,
+                    cxobj     *xedit,
+                    cxobj     *xt,
+                    char     **xpath,
+                    cxobj    **xerr)
 {
-    int     retval = -1;
-    cxobj **values_child_vec;
-    char   *key_node_id;
-    cbuf   *patch_header = NULL;
-    cxobj  *x_simple_patch = NULL;
-    int     value_vec_len;
-    cxobj **value_vec;
-
-    values_child_vec = xml_childvec_get(xn);
-    key_node_id = xml_name(*values_child_vec);
-    /* Create cbufs:s */
-    if ((patch_header = cbuf_new()) == NULL){
+    int             retval = -1;
+    char           *target;
+    char           *opstr;
+    yang_patch_op_t op;
+    cbuf           *cb = NULL;
+    cxobj          *xt1 = NULL;
+    cxobj          *xbot = NULL;
+    yang_stmt      *ybot = NULL;
+    cxobj          *xa;
+    int             ret;
+
+    if ((target = xml_find_body(xedit, "target")) == NULL){
+        if (netconf_missing_element_xml(xerr, "protocol", "target", NULL) < 0)
+            goto done;
+        goto fail;
+    }
+    if ((opstr = xml_find_body(xedit, "operation")) == NULL){
+        if (netconf_missing_element_xml(xerr, "protocol", "operation", NULL) < 0)
+            goto done;
+        goto fail;
+    }
+    if ((int)(op = yang_patch_op2int(opstr)) == -1){
+        if (netconf_bad_element_xml(xerr, "protocol", "operation", "Unknown YANG patch operation") < 0)
+            goto done;
+        goto fail;
+    }
+    if ((cb = cbuf_new()) == NULL){
         clicon_err(OE_UNIX, errno, "cbuf_new");
         goto done;
     }
-    cprintf(patch_header, "%s:%s", modname, key_node_id);
-    if ((x_simple_patch = xml_new(cbuf_get(patch_header), NULL, CX_ELMNT)) == NULL)
+    cprintf(cb, "%s%s", api_path?api_path:"", target);
+    if ((xt1 = xml_new(NETCONF_INPUT_CONFIG, NULL, CX_ELMNT)) == NULL)
         goto done;
-    value_vec_len = xml_child_nr(*values_child_vec);
-    value_vec = xml_childvec_get(*values_child_vec);
-    switch (operation){
-    case YANG_PATCH_OP_REPLACE:
-        if (yang_patch_do_replace(h, req, pi, qvec, pretty, media_out, ds, simple_patch_request_uri, target_val, value_vec_len, value_vec, x_simple_patch) < 0)
+    xbot = xt1;
+    if ((ret = api_path2xml(cbuf_get(cb), yspec, xt1, YC_DATANODE, 1, &xbot, &ybot, xerr)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    if (xbot == xt1){
+        if (netconf_invalid_value_xml(xerr, "protocol", "Edit target must be a data resource") < 0)
             goto done;
-        break;
+        goto fail;
+    }
+    switch (op){
     case YANG_PATCH_OP_CREATE:
-        if (yang_patch_do_create(h, req, pi, qvec, pretty, media_out, ds, simple_patch_request_uri, value_vec_len, value_vec, x_simple_patch) < 0)
-            goto done;
-        break;
     case YANG_PATCH_OP_INSERT:
-        if (yang_patch_do_insert(h, req, pi, pretty, media_out, ds, simple_patch_request_uri, value_vec_len, value_vec, x_simple_patch, where_val, api_path, point_val) < 0)
-            goto done;
-        break;
     case YANG_PATCH_OP_MERGE:
-        if (yang_patch_do_merge(h, req, pi, qvec, pretty, media_out, ds, simple_patch_request_uri, value_vec_len, value_vec, x_simple_patch, key_xn) < 0)
+    case YANG_PATCH_OP_REPLACE:
+        if ((ret = yang_patch_value(xedit, &xbot, xerr)) < 0)
             goto done;
+        if (ret == 0)
+            goto fail;
         break;
-    default:
+    default: /* delete, remove and move do not use value */
         break;
     }
-    retval = 0;
+    if ((xa = xml_new("operation", xbot, CX_ATTR)) == NULL)
+        goto done;
+    if (xml_prefix_set(xa, NETCONF_BASE_PREFIX) < 0)
+        goto done;
+    if (xml_value_set(xa, xml_operation2str(yang_patch_op2netconf(op))) < 0)
+        goto done;
+    if (op == YANG_PATCH_OP_INSERT || op == YANG_PATCH_OP_MOVE){
+        if ((ret = yang_patch_insert_attributes(xedit, api_path, xbot, xerr)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+    }
+    if (xml2xpath(xbot, NULL, xpath) < 0)
+        goto done;
+    if (yang_patch_graft(xt, xt1, xbot) < 0)
+        goto done;
+    retval = 1;
  done:
-    if (x_simple_patch)
-        xml_free(x_simple_patch);
-    if (patch_header)
-        cbuf_free(patch_header);
+    if (cb)
+        cbuf_free(cb);
+    if (xt1)
+        xml_free(xt1);
     return retval;
+ fail:
+    retval = 0;
+    goto done;
 }
 
-/*! Process a single yang patch "edit" element
+/*! Find the edit an error from the backend refers to
+ *
+ * The edit whose target is the longest prefix of the error-path is chosen.
+ * @param[in]  paths   Edit-id and target xpath of each edit, in patch order
+ * @param[in]  xerr    rpc-error
+ * @retval     editid  Edit-id of the failing edit
+ * @retval     NULL    Error not related to a single edit
+ */
+static char *
+yang_patch_error_edit(cvec  *paths,
+                      cxobj *xerr)
+{
+    char   *editid = NULL;
+    char   *errpath;
+    char   *xpath;
+    size_t  len;
+    size_t  maxlen = 0;
+    cg_var *cv = NULL;
+
+    if ((errpath = xml_find_body(xerr, "error-path")) == NULL)
+        return NULL;
+    while ((cv = cvec_each(paths, cv)) != NULL){
+        xpath = cv_string_get(cv);
+        len = strlen(xpath);
+        if (strncmp(errpath, xpath, len) == 0 &&
+            (errpath[len] == '\0' || errpath[len] == '/') &&
+            len >= maxlen){
+            maxlen = len;
+            editid = cv_name_get(cv);
+        }
+    }
+    return editid;
+}
+
+/*! Reply with a yang-patch-status
  *
- * @param[in]  h         Clixon handle
  * @param[in]  req       Generic Www handle
- * @param[in]  pi        Offset, where to start api-path
- * @param[in]  qvec      Vector of query string (QUERY_STRING)
+ * @param[in]  patchid   Patch-id of the YANG patch
+ * @param[in]  editid    Edit-id of the failing edit, or NULL for a global error
+ * @param[in]  xerr      rpc-error, or NULL if the patch was applied
  * @param[in]  pretty    Set to 1 for pretty-printed xml/json output
  * @param[in]  media_out Output media
- * @param[in]  xn        XML edit element
  * @retval     0         OK
  * @retval    -1         Error
+ * @see RFC 8072 Sec 2.3 yang-patch-status
  */
 static int
-yang_patch_do_edit(clicon_handle  h,
-                   void          *req,
-                   int            pi,
-                   cvec          *qvec,
-                   int            pretty,
-                   restconf_media media_out,
-                   ietf_ds_t      ds,
-                   yang_stmt     *yspec,
-                   cxobj         *xn,
-                   char          *uripath0,
-                   char          *api_path
-                   )
+yang_patch_status_reply(void          *req,
+                        char          *patchid,
+                        char          *editid,
+                        cxobj         *xerr,
+                        int            pretty,
+                        restconf_media media_out)
 {
-    int        retval = -1;
-    cxobj    **vec = NULL;
-    size_t     veclen = 0;
-    int        ret;
-    cxobj     *xerr = NULL;    /* malloced must be freed */
-    cxobj     *xtop; 
-    cxobj     *xbot = NULL;
-    yang_patch_op_t operation;
-    char      *where_val = NULL;
-    char      *point_val = NULL;
-    char      *target_val = NULL;
-    char      *modname;
-    cxobj    **key_vec = NULL;
-    cxobj     *key_xn = NULL;
-    int        i;
-    cxobj     *x; /* general purpose xml-tree pointer */
-    cbuf      *simple_patch_request_uri = NULL;
-    cbuf      *api_path_target = NULL;
-    yang_stmt *ybot = NULL;
-    yang_stmt *ymod;
-
-    
-    clicon_log_xml(LOG_DEBUG, xn, "%s %d xn:", __FUNCTION__, __LINE__);
-    /* Create cbufs:s */
-    if ((simple_patch_request_uri = cbuf_new()) == NULL){
-        clicon_err(OE_UNIX, errno, "cbuf_new");
+    int    retval = -1;
+    cxobj *xs = NULL;
+    cxobj *x;
+    cxobj *xerrs;
+    cxobj *xtag;
+    cbuf  *cb = NULL;
+    int    code = 200;
+
+    if ((xs = xml_new("yang-patch-status", NULL, CX_ELMNT)) == NULL)
         goto done;
-    }
-    if ((api_path_target = cbuf_new()) == NULL){
-        clicon_err(OE_UNIX, errno, "cbuf_new");
+    if (xmlns_set(xs, NULL, "urn:ietf:params:xml:ns:yang:ietf-yang-patch") < 0)
         goto done;
-    }
-    if ((x = xpath_first(xn, NULL, "target")) == NULL){
-        clicon_err(OE_YANG, 0, "target mandatory element not found");
+    if (patchid && (x = xml_new_body("patch-id", xs, patchid)) == NULL)
         goto done;
+    if (xerr == NULL){
+        if (xml_new("ok", xs, CX_ELMNT) == NULL)
+            goto done;
     }
-    target_val = xml_body(x);
-    if ((x = xpath_first(xn, NULL, "operation")) == NULL){
-        clicon_err(OE_YANG, 0, "operation mandatory element not found");
-        goto done;
+    else {
+        if ((xtag = xml_find_type(xerr, NULL, "error-tag", CX_ELMNT)) == NULL ||
+            (code = restconf_err2code(xml_body(xtag))) < 0)
+            code = 500; /* internal server error */
+        x = xs;
+        if (editid){
+            if ((x = xml_new("edit-status", x, CX_ELMNT)) == NULL)
+                goto done;
+            if ((x = xml_new("edit", x, CX_ELMNT)) == NULL)
+                goto done;
+            if (xml_new_body("edit-id", x, editid) == NULL)
+                goto done;
+        }
+        if ((xerrs = xml_new("errors", x, CX_ELMNT)) == NULL)
+            goto done;
+        if ((x = xml_dup(xerr)) == NULL)
+            goto done;
+        if (xml_name_set(x, "error") < 0)
+            goto done;
+        if (xml_addsub(xerrs, x) < 0)
+            goto done;
     }
-    operation = yang_patch_op2int(xml_body(x));
-    /* target and operation are mandatory */
-    if (target_val == NULL){
-        clicon_err(OE_YANG, 0, "operation/target: mandatory element not found");
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
         goto done;
     }
-    if (operation == YANG_PATCH_OP_INSERT){
-        if ((x = xpath_first(xn, NULL, "point")) != NULL)
-            point_val = xml_body(x);
-        if ((x = xpath_first(xn, NULL, "where")) != NULL)
-            where_val = xml_body(x);
-        if (point_val == NULL || where_val == NULL){
-            clicon_err(OE_YANG, 0, "point/where: expected element not found");
+    switch (media_out){
+    case YANG_DATA_XML:
+    case YANG_PATCH_XML:
+        if (restconf_reply_header(req, "Content-Type", "%s", restconf_media_int2str(YANG_DATA_XML)) < 0)
             goto done;
-        }       
-    }
-    // Construct request URI
-    cprintf(simple_patch_request_uri, "%s", uripath0);
-    cprintf(api_path_target, "%s", api_path);
-    if (operation == YANG_PATCH_OP_MERGE) {
-        cbuf_append_str(api_path_target, target_val);
-        cbuf_append_str(simple_patch_request_uri, target_val);
-    }
-
-    if ((xtop = xml_new(NETCONF_INPUT_CONFIG, NULL, CX_ELMNT)) == NULL)
-        goto done;
-
-    // Get key field
-    /* Translate api_path to xml in the form of xtop/xbot */
-    xbot = xtop;
-    if ((ret = api_path2xml(cbuf_get(api_path_target), yspec, xtop, YC_DATANODE, 1, &xbot, &ybot, &xerr)) < 0)
-        goto done;
-    if (ret == 0){ /* validation failed */
-        if (api_return_err0(h, req, xerr, pretty, media_out, 0) < 0)
+        if (clixon_xml2cbuf(cb, xs, 0, pretty, -1, 0) < 0)
             goto done;
-        goto ok;
-    }
-    /* Get module name */
-    if (ys_real_module(ybot, &ymod) < 0)
+        break;
+    case YANG_DATA_JSON:
+    case YANG_PATCH_JSON:
+        if (restconf_reply_header(req, "Content-Type", "%s", restconf_media_int2str(YANG_DATA_JSON)) < 0)
+            goto done;
+        /* Unbound tree: qualify the top-level name explicitly */
+        if (xml_name_set(xs, "ietf-yang-patch:yang-patch-status") < 0)
+            goto done;
+        if (clixon_json2cbuf(cb, xs, pretty, 0, 0) < 0)
+            goto done;
+        break;
+    default:
+        clicon_err(OE_YANG, EINVAL, "Invalid media type %d", media_out);
         goto done;
-    modname = yang_argument_get(ymod);
-    // XXX this seems to be hardcoded to a yang list?
-    if ((key_vec = xml_childvec_get(xbot)) != NULL)
-        key_xn = key_vec[0];
-    // Get values (for "delete" and "remove", there are no values)
-    xpath_vec(xn, NULL, "value", &vec, &veclen);
-
-    // Loop through the values
-    for (i = 0; i < veclen; i++) {
-        if (yang_patch_do_value(h, req, pi, qvec, pretty, media_out, ds,
-                                vec[i], modname,
-                                operation, where_val, point_val, simple_patch_request_uri, target_val,
-                                api_path, key_xn) < 0)
-            goto done;
-    }
-    if (operation == YANG_PATCH_OP_DELETE ||
-        operation == YANG_PATCH_OP_REMOVE){
-        cbuf_append_str(simple_patch_request_uri, target_val);
-        if (operation == YANG_PATCH_OP_DELETE) {
-            // TODO - send error
-        } else {
-            // TODO - do not send error
-        }
-        api_data_delete(h, req, cbuf_get(simple_patch_request_uri), pi, pretty, YANG_DATA_JSON, ds); 
+        break;
     }
- ok:
+    cprintf(cb, "\r\n");
+    if (restconf_reply_send(req, code, cb, 0) < 0)
+        goto done;
+    cb = NULL;
     retval = 0;
  done:
-    if (vec)
-        free(vec);
-    if (simple_patch_request_uri)
-        cbuf_free(simple_patch_request_uri);
-    if (api_path_target)
-        cbuf_free(api_path_target);
-    if (xtop)
-        xml_free(xtop);
-    if (xerr)
-        xml_free(xerr);
+    if (cb)
+        cbuf_free(cb);
+    if (xs)
+        xml_free(xs);
     return retval;
 }
 
@@ -736,11 +614,17 @@ yang_patch_do_edit(clicon_handle  h,
  * @param[in]  ds       0 if "data" resource, 1 if rfc8527 "ds" resource
  * @retval     0         OK
  * @retval    -1         Error
- * Netconf:  <edit-config> (nc:operation="merge")
+ * Netconf:  <edit-config>
  * @see RFC8072
- * YANG patch can be used to "create", "delete", "insert", "merge", "move", "replace", and/or
-   "remove" a resource within the target resource.
- * Currently "move" not supported
+ * All edits are translated into a single edit-config tree which is sent to the backend in one
+ * request, so that the patch is applied and committed as one transaction: either all edits
+ * are applied or none. Each edit target carries its own nc:operation:
+ *   create, delete, merge, replace, remove  ->  same netconf operation
+ *   insert  ->  create with yang:insert and yang:key/value attributes from point/where
+ *   move    ->  merge of the existing target with yang:insert and yang:key/value attributes
+ * The reply is a yang-patch-status. A failing edit is identified by its edit-id if the error
+ * can be related to it, ie if the edit itself is invalid or the error-path of the backend
+ * error is within its target. Otherwise the error is reported as a global error.
  */
 int
 api_data_yang_patch(clicon_handle  h,
@@ -756,14 +640,22 @@ api_data_yang_patch(clicon_handle  h,
 {
     int            retval = -1;
     int            i;
-    cxobj         *xpatch = NULL; 
+    cxobj         *xpatch = NULL;
     yang_stmt     *yspec;
     char          *api_path;
     cxobj         *xerr = NULL;    /* malloced must be freed */
     int            ret;
-    char          *uripath0 = NULL;
-    size_t         veclen;
-    cxobj        **vec = NULL;
+    cxobj         *xyp;
+    cxobj         *xedit;
+    cxobj         *xtop = NULL;
+    cxobj         *xret = NULL;
+    cxobj         *xe;
+    char          *patchid;
+    char          *editid;
+    char          *xpath = NULL;
+    cvec          *paths = NULL;
+    char          *username;
+    cbuf          *cbx = NULL;
 
     clicon_debug(1, "%s api_path:\"%s\"",  __FUNCTION__, api_path0);
     if ((yspec = clicon_dbspec_yang(h)) == NULL){
@@ -806,37 +698,99 @@ api_data_yang_patch(clicon_handle  h,
             goto done;
         goto ok;
     }
-    /* 
+    /*
      * RFC 8072 2.1: The message-body MUST identify exactly one resource instance
      */
-    if (xml_child_nr_type(xpatch, CX_ELMNT) != 1){
+    if (xml_child_nr_type(xpatch, CX_ELMNT) != 1 ||
+        strcmp(xml_name(xyp = xml_child_i_type(xpatch, 0, CX_ELMNT)), "yang-patch") != 0){
         if (netconf_malformed_message_xml(&xerr, "The message-body MUST contain exactly one instance of the expected data resource") < 0)
             goto done;
         if (api_return_err0(h, req, xerr, pretty, media_out, 0) < 0)
             goto done;
         goto ok;
     }
-    /* Save original uripath (will be changed by sub-calls) */
-    if ((uripath0 = restconf_uripath(h)) == NULL)
+    patchid = xml_find_body(xyp, "patch-id");
+    if ((paths = cvec_new(0)) == NULL){
+        clicon_err(OE_UNIX, errno, "cvec_new");
+        goto done;
+    }
+    /* Translate all edits, in order, into one edit-config tree */
+    if ((xtop = xml_new(NETCONF_INPUT_CONFIG, NULL, CX_ELMNT)) == NULL)
         goto done;
-    /* Find all edit operations and loop over them
-     */    
-    if (xpath_vec(xpatch, NULL, "yang-patch/edit", &vec, &veclen) < 0)
+    xedit = NULL;
+    while ((xedit = xml_child_each(xyp, xedit, CX_ELMNT)) != NULL) {
+        if (strcmp(xml_name(xedit), "edit") != 0)
+            continue;
+        editid = xml_find_body(xedit, "edit-id");
+        if ((ret = yang_patch_edit2xml(yspec, api_path, xedit, xtop, &xpath, &xerr)) < 0)
+            goto done;
+        if (ret == 0){
+            if ((xe = xpath_first(xerr, NULL, "rpc-error")) == NULL){
+                clicon_err(OE_XML, 0, "rpc-error not found (internal error)");
+                goto done;
+            }
+            if (yang_patch_status_reply(req, patchid, editid, xe, pretty, media_out) < 0)
+                goto done;
+            goto ok;
+        }
+        if (cvec_add_string(paths, editid?editid:"", xpath) < 0){
+            clicon_err(OE_UNIX, errno, "cvec_add_string");
+            goto done;
+        }
+        free(xpath);
+        xpath = NULL;
+    }
+    /* For internal XML protocol: add username attribute for access control
+     */
+    username = clicon_username_get(h);
+    /* Create text buffer for transfer to backend */
+    if ((cbx = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
         goto done;
-    for (i = 0; i < veclen; i++) {
-        if (yang_patch_do_edit(h, req, pi, qvec, pretty, media_out, ds,
-                               yspec,
-                               vec[i],
-                               uripath0, api_path) < 0)
+    }
+    cprintf(cbx, "<rpc xmlns=\"%s\" username=\"%s\" xmlns:%s=\"%s\" %s>",
+            NETCONF_BASE_NAMESPACE,
+            username?username:"",
+            NETCONF_BASE_PREFIX,
+            NETCONF_BASE_NAMESPACE,  /* bind nc to netconf namespace */
+            NETCONF_MESSAGE_ID_ATTR);
+    cprintf(cbx, "<edit-config");
+    /* RFC8040 Sec 1.4: update startup after running has been altered, see api_data_write */
+    if ((IETF_DS_NONE == ds) &&
+        if_feature(yspec, "ietf-netconf", "startup") &&
+        !clicon_option_bool(h, "CLICON_RESTCONF_STARTUP_DONTUPDATE")){
+        cprintf(cbx, " copystartup=\"true\"");
+    }
+    cprintf(cbx, " autocommit=\"true\"");
+    cprintf(cbx, "><target><candidate /></target>");
+    cprintf(cbx, "<default-operation>none</default-operation>");
+    if (clixon_xml2cbuf(cbx, xtop, 0, 0, -1, 0) < 0)
+        goto done;
+    cprintf(cbx, "</edit-config></rpc>");
+    clicon_debug(1, "%s xml: %s api_path:%s",__FUNCTION__, cbuf_get(cbx), api_path);
+    if (clicon_rpc_netconf(h, cbuf_get(cbx), &xret, NULL) < 0)
+        goto done;
+    if ((xe = xpath_first(xret, NULL, "//rpc-error")) != NULL){
+        if (yang_patch_status_reply(req, patchid, yang_patch_error_edit(paths, xe), xe,
+                                    pretty, media_out) < 0)
             goto done;
+        goto ok;
     }
+    if (yang_patch_status_reply(req, patchid, NULL, NULL, pretty, media_out) < 0)
+        goto done;
  ok:
     retval = 0;
  done:
-    if (uripath0)
-        free(uripath0);
-    if (vec)
-        free(vec);
+    if (xpath)
+        free(xpath);
+    if (paths)
+        cvec_free(paths);
+    if (cbx)
+        cbuf_free(cbx);
+    if (xtop)
+        xml_free(xtop);
+    if (xret)
+        xml_free(xret);
     if (xerr)
         xml_free(xerr);
     if (xpatch)
@@ -46,9 +46,13 @@
 #include <ctype.h>
 #include <signal.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <sys/socket.h>
 #include <arpa/inet.h>
 #include <sys/resource.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
 
 #include <openssl/ssl.h>
 #include <openssl/rand.h>
@@ -468,6 +472,101 @@ native_buf_write(clicon_handle    h,
     goto done;
 }
 
+/*! Write a file body to socket, after headers have been written with native_buf_write
+ *
+ * Plain TCP uses sendfile() so that the data is not copied to user space.
+ * With TLS (or without sendfile) the mapping is written in chunks of at most one TLS record.
+ * @param[in]  h        Clixon handle
+ * @param[in]  fd       Open file
+ * @param[in]  map      Read-only mapping of the whole file, or NULL: map it here
+ * @param[in]  len      Length of file, already sent as Content-Length
+ * @param[in]  rc       Connection struct
+ * @param[in]  callfn   For debug
+ * @retval  1  OK
+ * @retval  0  OK, but socket write returned error or file was truncated, caller should close rc
+ * @retval -1  Error
+ * @see native_buf_write
+ */
+static int
+native_file_write(clicon_handle    h,
+                  int              fd,
+                  const char      *map,
+                  size_t           len,
+                  restconf_conn   *rc,
+                  const char      *callfn)
+{
+    int     retval = -1;
+    char   *p = NULL;
+    size_t  off;
+    size_t  chunk;
+    int     ret;
+#ifdef __linux__
+    off_t   offset = 0;
+    ssize_t n;
+#endif
+
+    clicon_debug(1, "%s %s len:%zu", __FUNCTION__, callfn, len);
+    if (rc == NULL){
+        clicon_err(OE_RESTCONF, EINVAL, "rc is NULL");
+        goto done;
+    }
+#ifdef __linux__
+    if (rc->rc_ssl == NULL){
+        while (offset < len){
+            if ((n = sendfile(rc->rc_s, fd, &offset, len - offset)) < 0){
+                switch (errno){
+                case EAGAIN:     /* Operation would block */
+                    clicon_debug(1, "%s sendfile EAGAIN", __FUNCTION__);
+                    usleep(10000);
+                    continue;
+                    break;
+                case ECONNRESET: /* Connection reset by peer */
+                case EPIPE:   /* Broken pipe */
+                    goto closed; /* Close socket */
+                    break;
+                default:
+                    clicon_err(OE_UNIX, errno, "sendfile");
+                    goto done;
+                    break;
+                }
+            }
+            if (n == 0){ /* File shrunk after Content-Length was sent */
+                clicon_log(LOG_WARNING, "%s: file truncated while sending", __FUNCTION__);
+                goto closed;
+            }
+        }
+        goto ok;
+    }
+#endif
+    if (map == NULL){
+        if ((p = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0)) == MAP_FAILED){
+            p = NULL;
+            clicon_err(OE_UNIX, errno, "mmap");
+            goto done;
+        }
+        map = p;
+    }
+    for (off = 0; off < len; off += chunk){
+        chunk = len - off;
+        if (chunk > RESTCONF_FILE_CHUNK)
+            chunk = RESTCONF_FILE_CHUNK;
+        if ((ret = native_buf_write(h, (char*)map + off, chunk, rc, callfn)) < 0)
+            goto done;
+        if (ret == 0)
+            goto closed;
+    }
+ ok:
+    retval = 1;
+ done:
+    if (p)
+        munmap(p, len);
+    clicon_debug(1, "%s retval:%d", __FUNCTION__, retval);
+    return retval;
+ closed:
+    retval = 0;
+    goto done;
+}
+
 /*! Send early handcoded bad request reply before actual packet received, just after accept
  * @param[in]  h    Clixon handle
  * @param[in]  media
@@ -761,6 +860,16 @@ restconf_http1_process(restconf_conn *rc,
     if ((ret = native_buf_write(h, cbuf_get(sd->sd_outp_buf), cbuf_len(sd->sd_outp_buf),
                                 rc, __FUNCTION__)) < 0)
         goto done;
+    /* File body, see restconf_reply_send_file */
+    if (sd->sd_fd != -1){
+        if (ret == 1 &&
+            (ret = native_file_write(h, sd->sd_fd, sd->sd_body_map, sd->sd_body_len,
+                                     rc, __FUNCTION__)) < 0)
+            goto done;
+        close(sd->sd_fd);
+        sd->sd_fd = -1;
+        sd->sd_body_map = NULL;
+    }
     cvec_reset(sd->sd_outp_hdrs); /* Can be done in native_send_reply */
     cbuf_reset(sd->sd_outp_buf);
     cbuf_reset(sd->sd_inbuf);
@@ -473,7 +473,7 @@ http2_exec(restconf_conn        *rc,
     }
     if ((sd->sd_path = restconf_uripath(rc->rc_h)) == NULL)
         goto done;
-    sd->sd_proto = HTTP_2; /* XXX is this necessary? */
+    sd->sd_proto = HTTP_2; /* Used by restconf_reply_send_file */
     if (strcmp(sd->sd_path, RESTCONF_WELL_KNOWN) == 0
         || api_path_is_restconf(rc->rc_h)
         || api_path_is_data(rc->rc_h)){
@@ -493,7 +493,7 @@ http2_exec(restconf_conn        *rc,
      * (Successful) response to a CONNECT request (Section 4.3.6 of
      * [RFC7231]).
      */
-    if (sd->sd_code != 204 && sd->sd_code > 199 && sd->sd_body_len)
+    if (sd->sd_code != 204 && sd->sd_code != 304 && sd->sd_code > 199 && sd->sd_body_len)
         if (restconf_reply_header(sd, "Content-Length", "%zu", sd->sd_body_len) < 0)
             goto done;  
     if (sd->sd_code){
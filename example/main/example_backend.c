@@ -68,7 +68,7 @@
 #include <clixon/clixon_backend.h> 
 
 /* Command line options to be passed to getopt(3) */
-#define BACKEND_EXAMPLE_OPTS "a:nrsS:x:iuUtV:"
+#define BACKEND_EXAMPLE_OPTS "a:nrsS:x:ic:uUtV:"
 
 /*! Yang action
  * Start backend with -- -a <instance-id>
@@ -115,6 +115,13 @@ static char *_state_xpath = NULL;
  */
 static int _state_file_cached = 0;
 
+/*! Cache state read from file in the system state cache for this many milliseconds
+ * Primarily for testing: -c <ms>
+ * Start backend with -- -sS <file> -c <ms>
+ * @see clixon_statedata_cache_register
+ */
+static uint32_t _state_cache_ttl = 0;
+
 /*! Cache control of read state file pagination example,
  * keep xml tree cache as long as db is locked
  */
@@ -1349,6 +1356,9 @@ clixon_plugin_init(clicon_handle h)
         case 'i': /* read state file on init not by request (requires -sS <file> */
             _state_file_cached = 1;
             break;
+        case 'c': /* system state cache ttl in ms (requires -sS <file> */
+            _state_cache_ttl = atoi(optarg);
+            break;
        case 'u': /* module-specific upgrade */
            _module_upgrade = 1;
            break;
@@ -1373,6 +1383,10 @@ clixon_plugin_init(clicon_handle h)
                                               NULL) < 0)
                 goto done;
         }
+        /* Let the system cache the whole state tree */
+        if (_state_cache_ttl &&
+            clixon_statedata_cache_register(h, example_statefile, NULL, "/", _state_cache_ttl) < 0)
+            goto done;
     }
         
     if (_notification_stream){
@@ -67,6 +67,22 @@
  */
 #define XPATH_LIST_OPTIMIZE
 
+/*! Compile YANG must and when xpaths when the YANG spec is loaded
+ * Expressions in a supported subset (no predicates, // or unions) are compiled to a typed
+ * expression tree evaluated without allocation. Other expressions are parsed once and
+ * evaluated by the regular xpath interpreter.
+ * @see xpath_compile
+ */
+#define XPATH_COMPILE
+
+/*! Prune subtrees in descendant xpath axes ("//") using YANG
+ * A subtree of a YANG-bound node is skipped if no element with the name of the node test
+ * may occur below it. If the only match is a list directly below a node, the list key
+ * binary search of XPATH_LIST_OPTIMIZE is used.
+ * @see yang_descendant_name
+ */
+#define XPATH_DESCENDANT_PRUNE
+
 /*! Add explicit search indexes, so that binary search can be made for non-key list indexes
  * This also applies if there are multiple keys and you want to search on only the second for 
  * example.
@@ -93,6 +109,14 @@
  */
 #define DATASTORE_TOP_SYMBOL "config"
 
+/*! Minimum number of children in an edit for the merge fast path of datastore writes
+ * New entries of system-ordered lists and leaf-lists are collected and merged with the
+ * existing children in one pass, instead of inserted one by one. 
+ * Set to 0 to disable.
+ * @see xml_insert_vec
+ */
+#define DATASTORE_MERGE_MIN 256
+
 /*! Name of default netns for clixon-restconf.yang socket/namespace field
  * Restconf allows opening sockets in different network namespaces. This is teh name of 
  * "host"/"default" namespace. Unsure what to really label this but seems like there is differing
@@ -107,6 +131,35 @@
  */
 #define HTTP_DATA_INTERNAL_REDIRECT "index.html"
 
+/*! Max number of static files kept open and mapped in the http-data cache
+ * Hot files are served from the mapping with ETag/Last-Modified headers precomputed.
+ * Set to 0 to disable the cache
+ */
+#define HTTP_DATA_CACHE_NR 64
+
+/*! Files larger than this (in bytes) are served but not kept in the http-data cache
+ */
+#define HTTP_DATA_CACHE_FILE_MAX (1024*1024)
+
+/*! Chunk size when writing a file body with TLS, ie max TLS record size
+ */
+#define RESTCONF_FILE_CHUNK 16384
+
+/*! Max number of backend sessions kept open by the restconf daemon, one per user
+ * The least recently used session is closed when a new user exceeds the limit.
+ */
+#define RESTCONF_BACKEND_POOL_NR 16
+
+/*! Backend sessions of the restconf pool idle longer than this (in seconds) are closed
+ */
+#define RESTCONF_BACKEND_IDLE 300
+
+/*! Max number of pipelined NETCONF requests forwarded to the backend before replies are read
+ * Only requests with small replies, such as edit-config and commit, are pipelined.
+ * Set to 0 to disable pipelining.
+ */
+#define NETCONF_PIPELINE_NR 32
+
 /*! Set a temporary parent for use in special case "when" xpath calls
  * Problem is when changing an existing (candidate) in-memory datastore that yang "when" conditionals
  * should be changed in clixon_datastore_write.c:text_modify().
@@ -127,6 +180,25 @@
  */
 #undef LIST_PAGINATION_REMAINING
 
+/*! Max number of sort-by permutations of config lists kept by list pagination
+ * A permutation is reused when paging with the same sort-by until the datastore changes.
+ * Set to 0 to sort on every request.
+ */
+#define LIST_PAGINATION_SORT_NR 8
+
+/*! Minimum number of XML nodes for validation with worker processes
+ * Smaller trees are validated in the backend process even if CLICON_VALIDATE_WORKERS is set,
+ * since forking the workers costs more than the validation.
+ */
+#define VALIDATE_WORKERS_MIN 10000
+
+/*! Time-to-live in milliseconds of the CLI expansion cache
+ * expand_dbvar keeps the values of the last expansion request. Expanding the same variable
+ * while more characters are typed is served from the cache instead of the backend.
+ * The cache is also cleared when a CLI command is executed.
+ */
+#define CLI_EXPAND_CACHE_MS 2000
+
 /*! Use Ancestor config cache 
  * The cache uses two yang stmt flag bits. One to say it is active, the second its value
  */
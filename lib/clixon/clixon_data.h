@@ -57,6 +57,7 @@ typedef struct {
     cxobj    *de_xml;      /* cache */
     int       de_modified; /* Dirty since loaded/copied/committed/etc XXX:nocache? */
     int       de_empty;    /* Empty on read from file, xmldb_readfile and xmldb_put sets it */
+    uint64_t  de_gen;      /* Generation, new on every set, ie cache load or change */
 } db_elmnt;
 
 /*
@@ -135,6 +136,7 @@ int clicon_argv_set(clicon_handle h, char *argv0, int argc, char **argv);
 /*! Set and get (client/backend) session id */
 int clicon_session_id_set(clicon_handle h, uint32_t id);
 int clicon_session_id_get(clicon_handle h, uint32_t *id);
+int clicon_session_id_del(clicon_handle h);
 
 /* If set, quit startup directly after upgrade */
 int clicon_quit_upgrade_get(clicon_handle h);
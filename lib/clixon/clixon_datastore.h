@@ -56,6 +56,8 @@ int xmldb_get0(clicon_handle h, const char *db, yang_bind yb,
                cxobj **xtop, modstate_diff_t *msd, cxobj **xerr); 
 int xmldb_get0_clear(clicon_handle h, cxobj *x);
 int xmldb_get0_free(clicon_handle h, cxobj **xp);
+int xmldb_cache_load(clicon_handle h, const char *db, cxobj **xtp, cxobj **xerr);
+int xmldb_get_vec(clicon_handle h, cxobj *xt, cxobj **xvec, size_t xlen, withdefaults_type wdef, cxobj **xret);
 int xmldb_put(clicon_handle h, const char *db, enum operation_type op, cxobj *xt, char *username, cbuf *cbret); /* in clixon_datastore_write.[ch] */
 int xmldb_copy(clicon_handle h, const char *from, const char *to);
 int xmldb_lock(clicon_handle h, const char *db, uint32_t id);
@@ -208,6 +208,7 @@ int netconf_framing_preamble(netconf_framing_type framing, cbuf *cb);
 int netconf_framing_postamble(netconf_framing_type framing, cbuf *cb);
 int netconf_output(int s, cbuf *xf, char *msg);
 int netconf_output_encap(netconf_framing_type framing, cbuf *cb);
+int netconf_output_framed(int s, netconf_framing_type framing, cbuf *cb, char *msg);
 int netconf_input_chunked_framing(char ch, int *state, size_t *size);
 
 #endif /* _CLIXON_NETCONF_LIB_H */
@@ -43,6 +43,8 @@
 /*
  * Types
  */
+struct iovec;
+
 enum format_enum{
     FORMAT_XML,  
     FORMAT_JSON,  
@@ -65,6 +67,8 @@ char *format_int2str(enum format_enum showas);
 enum format_enum format_str2int(char *str);
 
 struct clicon_msg *clicon_msg_encode(uint32_t id, const char *format, ...) __attribute__ ((format (printf, 2, 3)));
+struct clicon_msg *clicon_msg_encode_bin(uint32_t id, cxobj *xml);
+int clicon_msg_binary(struct clicon_msg *msg);
 int clicon_msg_decode(struct clicon_msg *msg, yang_stmt *yspec, uint32_t *id, cxobj **xml, cxobj **xerr);
 
 int clicon_connect_unix(clicon_handle h, char *sockpath);
@@ -85,6 +89,10 @@ int clicon_rpc1(int sock, cbuf *msgin, cbuf *msgret, int *eof);
 
 int clicon_msg_send(int s, struct clicon_msg *msg);
 
+int clicon_msg_send_buf(int s, uint32_t id, const char *body, size_t bodylen);
+
+int clixon_writev(int fd, struct iovec *iov, int iovcnt);
+
 int clicon_msg_send1(int s, cbuf *cb);
 
 int clicon_msg_rcv(int s, struct clicon_msg **msg, int *eof);
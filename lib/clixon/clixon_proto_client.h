@@ -47,6 +47,8 @@ int clicon_rpc_msg(clicon_handle h, struct clicon_msg *msg, cxobj **xret0);
 int clicon_rpc_msg_persistent(clicon_handle h, struct clicon_msg *msg, cxobj **xret0, int *sock0);
 int clicon_rpc_netconf(clicon_handle h, char *xmlst, cxobj **xret, int *sp);
 int clicon_rpc_netconf_xml(clicon_handle h, cxobj *xml, cxobj **xret, int *sp);
+int clicon_rpc_netconf_xml_send(clicon_handle h, cxobj *xml);
+int clicon_rpc_netconf_xml_recv(clicon_handle h, char *rpcname, cxobj **xret);
 int clicon_rpc_get_config(clicon_handle h, char *username, char *db, char *xpath, cvec *nsc, char *defaults, cxobj **xret);
 int clicon_rpc_edit_config(clicon_handle h, char *db, enum operation_type op, 
                            char *xml);
@@ -60,6 +62,8 @@ int clicon_rpc_get_pageable_list(clicon_handle h, char *datastore, char *xpath,
                                  uint32_t offset, uint32_t limit,
                                  char *direction, char *sort, char *where,
                                  cxobj **xt);
+int clicon_rpc_expand_values(clicon_handle h, char *db, char *xpath, cvec *nsc,
+                             char *prefix, cvec *exact, uint32_t limit, cxobj **xt);
 int clicon_rpc_close_session(clicon_handle h);
 int clicon_rpc_kill_session(clicon_handle h, uint32_t session_id);
 int clicon_rpc_validate(clicon_handle h, char *db);
@@ -93,6 +93,8 @@ char  *clixon_string_del_join(char *str1, char *del, char *str2);
 int    clixon_strsplit(char *nodeid, const int delim, char **prefix, char **id);
 int    uri_str2cvec(char *string, char delim1, char delim2, int decode, cvec **cvp);
 int    uri_percent_encode(char **encp, const char *fmt, ...) __attribute__ ((format (printf, 2, 3)));
+size_t clixon_str_span(const char *str, size_t len, const char *stop, int ctrl);
+size_t clixon_str_ws_span(const char *str, size_t len, int *nl);
 int    xml_chardata_encode(char **escp, const char *fmt, ... ) __attribute__ ((format (printf, 2, 3)));
 int    xml_chardata_cbuf_append(cbuf *cb, char *str);
 int    uri_percent_decode(char *enc, char **str);
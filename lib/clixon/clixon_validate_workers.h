@@ -34,14 +34,15 @@
   ***** END LICENSE BLOCK *****
 
  *
- *  netconf match & selection: get and edit operations
- *****************************************************************************/
-#ifndef _NETCONF_FILTER_H_
-#define _NETCONF_FILTER_H_
+ * Full validation of large XML trees using worker processes
+ */
+
+#ifndef _CLIXON_VALIDATE_WORKERS_H_
+#define _CLIXON_VALIDATE_WORKERS_H_
 
 /*
  * Prototypes
- */ 
-int xml_filter(cxobj *xf, cxobj *xn);
+ */
+int xml_yang_validate_workers(clicon_handle h, cxobj *xt, int workers, cxobj **xret);
 
-#endif  /* _NETCONF_FILTER_H_ */
+#endif  /* _CLIXON_VALIDATE_WORKERS_H_ */
@@ -0,0 +1,65 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+ * Compact binary encoding of XML trees for the internal protocol between clixon clients
+ * and backend, as alternative to XML text.
+ * @see clixon_xml_bin.c for the format
+ */
+#ifndef _CLIXON_XML_BIN_H_
+#define _CLIXON_XML_BIN_H_
+
+/*
+ * Constants
+ */
+/* Capability announced in internal hello if binary encoding is supported */
+#define CLIXON_BIN_CAPABILITY "http://clicon.org/binary-encoding/1.0"
+
+/*
+ * Types
+ */
+/*! Opaque binary encoder handle */
+typedef struct clixon_bin_enc clixon_bin_enc;
+
+/*
+ * Prototypes
+ */
+int   clixon_bin_magic(const char *buf, size_t len);
+clixon_bin_enc *clixon_bin_enc_new(cbuf *cb);
+int   clixon_bin_enc_elmnt(clixon_bin_enc *be, const char *prefix, const char *name);
+int   clixon_bin_enc_attr(clixon_bin_enc *be, const char *prefix, const char *name, const char *value);
+int   clixon_bin_enc_end(clixon_bin_enc *be);
+int   clixon_bin_enc_xml(clixon_bin_enc *be, cxobj *x, int32_t depth);
+int   clixon_bin_enc_free(clixon_bin_enc *be);
+int   clixon_xml2bin(cbuf *cb, cxobj *xn, int32_t depth, int skiptop);
+int   clixon_bin_parse(const char *buf, size_t len, cxobj *xt);
+
+#endif  /* _CLIXON_XML_BIN_H_ */
@@ -33,44 +33,39 @@
 
   ***** END LICENSE BLOCK *****
 
- * XML parser
- * @see https://www.w3.org/TR/2008/REC-xml-20081126
- *      https://www.w3.org/TR/2009/REC-xml-names-20091208
+ * Streaming (push) XML parser with SAX-style callbacks
+ * Input is pushed in arbitrary chunks and elements are built and yang-bound as they are
+ * completed, so that large documents need not be held in a single contiguous buffer.
+ * @see clixon_xml_io.h for the string parser
  */
-#ifndef _CLIXON_XML_PARSE_H_
-#define _CLIXON_XML_PARSE_H_
+#ifndef _CLIXON_XML_SAX_H_
+#define _CLIXON_XML_SAX_H_
 
 /*
  * Types
  */
-/*! XML parser yacc handler struct */
-struct clixon_xml_parse_yacc {
-    char       *xy_parse_string; /* original (copy of) parse string */
-    int         xy_linenum;      /* Number of \n in parsed buffer */
-    void       *xy_lexbuf;       /* internal parse buffer from lex */
-    cxobj      *xy_xtop;         /* cxobj top element (fixed) */
-    cxobj      *xy_xelement;     /* cxobj active element (changes with parse context) */
-    cxobj      *xy_xparent;      /* cxobj parent element (changes with parse context) */
-    yang_stmt  *xy_yspec;        /* If set, top-level yang-spec */
-    int         xy_lex_state;    /* lex return state */
-    cxobj     **xy_xvec;         /* Vector of created top-level nodes (to know which are created) */
-    int         xy_xlen;         /* Length of xy_xvec */
-};
-typedef struct clixon_xml_parse_yacc clixon_xml_yacc;
+/*! Opaque push parser handle */
+typedef struct clixon_xml_sax clixon_xml_sax;
 
-/*
- * Variables
+/*! SAX element callback
+ *
+ * Start callback is called when a start-tag is complete (attributes are set, no children)
+ * End callback is called when the element is complete (bodies and children are set)
+ * @param[in]  x    XML element
+ * @param[in]  arg  User argument given in clixon_xml_sax_callbacks
+ * @retval     1    (end callback only) Element consumed: the parser purges it
+ * @retval     0    OK, element is kept in the tree
+ * @retval    -1    Error, parsing is aborted
  */
-extern char *clixon_xml_parsetext;
+typedef int (clixon_xml_sax_cb)(cxobj *x, void *arg);
 
 /*
  * Prototypes
  */
-int clixon_xml_parsel_init(clixon_xml_yacc *ya);
-int clixon_xml_parsel_exit(clixon_xml_yacc *ya);
-
-int clixon_xml_parsel_linenr(void);
-int clixon_xml_parselex(void *);
-int clixon_xml_parseparse(void *);
+clixon_xml_sax *clixon_xml_sax_new(yang_bind yb, yang_stmt *yspec, cxobj *xtop);
+int   clixon_xml_sax_callbacks(clixon_xml_sax *xs, clixon_xml_sax_cb *startfn, clixon_xml_sax_cb *endfn, void *arg);
+int   clixon_xml_sax_push(clixon_xml_sax *xs, const char *buf, size_t len);
+int   clixon_xml_sax_end(clixon_xml_sax *xs, cxobj **xerr);
+int   clixon_xml_sax_free(clixon_xml_sax *xs);
 
-#endif  /* _CLIXON_XML_PARSE_H_ */
+#endif  /* _CLIXON_XML_SAX_H_ */
@@ -45,6 +45,7 @@ int xml_cmp(cxobj *x1, cxobj *x2, int same, int skip1, char *expl);
 int xml_sort(cxobj *x0);
 int xml_sort_recurse(cxobj *xn);
 int xml_insert(cxobj *xp, cxobj *xc, enum insert_type ins, char *key_val, cvec *nsckey);
+int xml_insert_vec(cxobj *xp, cxobj **xvec, int xlen);
 int xml_sort_verify(cxobj *x, void *arg);
 #ifdef XML_EXPLICIT_INDEX
 int xml_search_indexvar_binary_pos(cxobj *xp, char *indexvar, clixon_xvec *xvec,
@@ -54,5 +55,8 @@ int match_base_child(cxobj *x0, cxobj *x1c, yang_stmt *yc, cxobj **x0cp);
 int clixon_xml_find_index(cxobj *xp, yang_stmt *yp, char *ns, char *name,
                           cvec *cvk, clixon_xvec *xvec);
 int clixon_xml_find_pos(cxobj *xp, yang_stmt *yc, uint32_t pos, clixon_xvec *xvec);
+int clixon_xml_find_prefix(cxobj *xp, yang_stmt *yc, char *prefix, uint32_t limit,
+                           clixon_xvec *xvec);
+int clixon_xml_find_range(cxobj *xp, yang_stmt *yc, int *lowp, int *upperp);
 
 #endif /* _CLIXON_XML_SORT_H */
@@ -2,8 +2,9 @@
  *
   ***** BEGIN LICENSE BLOCK *****
  
-  Copyright (C) 2009-2019 Olof Hagsand
-  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC (Netgate)
 
   This file is part of CLIXON.
 
@@ -32,41 +33,24 @@
 
   ***** END LICENSE BLOCK *****
 
- */
-#ifndef _CLIXON_JSON_PARSE_H_
-#define _CLIXON_JSON_PARSE_H_
-
-/*
- * Types
+ *
+ * Compiled XPATH expressions for YANG must and when statements
  */
 
-struct clixon_json_yacc { 
-    int        jy_linenum;      /* Number of \n in parsed buffer */
-    char      *jy_parse_string; /* original (copy of) parse string */
-    void      *jy_lexbuf;       /* internal parse buffer from lex */
-    cxobj     *jy_xtop;         /* cxobj top element (fixed) */
-    cxobj     *jy_current;      /* cxobj active element (changes with parse context) */
-    cxobj    **jy_xvec;         /* Vector of created top-level nodes (to know which are created) */
-    int        jy_xlen;         /* Length of jy_xvec */
-};
-typedef struct clixon_json_yacc clixon_json_yacc;
+#ifndef _CLIXON_XPATH_COMPILE_H_
+#define _CLIXON_XPATH_COMPILE_H_
 
 /*
- * Variables
+ * Types
  */
-extern char *clixon_json_parsetext;
+typedef struct xpath_compiled xpath_compiled;
 
 /*
  * Prototypes
  */
-int json_scan_init(clixon_json_yacc *jy);
-int json_scan_exit(clixon_json_yacc *jy);
-
-int json_parse_init(clixon_json_yacc *jy);
-int json_parse_exit(clixon_json_yacc *jy);
-
-int clixon_json_parselex(void *);
-int clixon_json_parseparse(void *);
-void clixon_json_parseerror(void *, char*);
+int xpath_compile(const char *xpath, cvec *nsc, xpath_compiled **xpcp);
+int xpath_compiled_free(xpath_compiled *xpc);
+int xpath_compiled_native(xpath_compiled *xpc);
+int xpath_compiled_bool(xpath_compiled *xpc, cxobj *xcur);
 
-#endif  /* _CLIXON_JSON_PARSE_H_ */
+#endif  /* _CLIXON_XPATH_COMPILE_H_ */
@@ -70,6 +70,9 @@
                                       * Transformed to ANYDATA but some code may need to check
                                       * why it is an ANYDATA
                                       */
+#define YANG_FLAG_DESC_CACHE   0x80  /* Descendant element names computed, see yang_descendant_name */
+#define YANG_FLAG_DESC_ANY     0x100 /* Any element name may occur as descendant, eg anydata */
+#define YANG_FLAG_SORTKEY_NO   0x200 /* List/leaf-list key types have no memcmp sort key, see xml_cmp */
 
 /*
  * Types
@@ -221,6 +224,7 @@ char      *yang_when_xpath_get(yang_stmt *ys);
 int        yang_when_xpath_set(yang_stmt *ys, char *xpath);
 cvec      *yang_when_nsc_get(yang_stmt *ys);
 int        yang_when_nsc_set(yang_stmt *ys, cvec *nsc);
+struct xpath_compiled *yang_xpath_compiled_get(yang_stmt *ys);
 const char *yang_filename_get(yang_stmt *ys);
 int        yang_filename_set(yang_stmt *ys, const char *filename);
 int        yang_linenum_get(yang_stmt *ys);
@@ -271,6 +275,7 @@ int        ys_populate(yang_stmt *ys, void *arg);
 int        ys_populate2(yang_stmt *ys, void *arg);
 int        yang_apply(yang_stmt *yn, enum rfc_6020 key, yang_applyfn_t fn, int from, void *arg);
 int        yang_datanode(yang_stmt *ys);
+int        yang_descendant_name(yang_stmt *ys, char *name);
 int        yang_abs_schema_nodeid(yang_stmt *ys, char *schema_nodeid, yang_stmt **yres);
 int        yang_desc_schema_nodeid(yang_stmt *yn, char *schema_nodeid, yang_stmt **yres);
 int        yang_config(yang_stmt *ys);
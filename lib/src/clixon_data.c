@@ -788,6 +788,9 @@ clicon_db_elmnt_get(clicon_handle h,
 }
 
 /*! Set xml database element including id, xml cache, empty on startup and dirty bit
+ *
+ * A new generation is set in the element, which invalidates state derived from the cache,
+ * such as sorted views of lists
  * @param[in] h   Clicon handle
  * @param[in] db  Name of database
  * @param[in] de  Database element
@@ -801,7 +804,9 @@ clicon_db_elmnt_set(clicon_handle h,
                     db_elmnt     *de)
 {
     clicon_hash_t  *cdat = clicon_db_elmnt(h);
+    static uint64_t gen = 0;
 
+    de->de_gen = ++gen; /* Unique over all databases, also if deleted and re-created */
     if (clicon_hash_add(cdat, db, de, sizeof(*de))==NULL)
         return -1;
     return 0;
@@ -845,6 +850,19 @@ clicon_session_id_set(clicon_handle h,
     return 0;
 }
 
+/*! Delete session id, a new session is then established with hello on next request
+ * @param[in]  h   Clicon handle
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+int
+clicon_session_id_del(clicon_handle h)
+{
+    clicon_hash_t  *cdat = clicon_data(h);
+
+    return clicon_hash_del(cdat, "session-id");
+}
+
 /*! Get quit-after-upgrade flag
  * @param[in]  h    Clicon handle
  * @retval     1    Flag set: quit startup directly after upgrade
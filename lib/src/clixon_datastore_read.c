@@ -816,46 +816,34 @@ xmldb_get_nocache(clicon_handle    h,
     goto done;
 }
 
-/*! Get content of database using xpath. return a set of matching sub-trees
- * The function returns a minimal tree that includes all sub-trees that match
- * xpath.
- * This is a clixon datastore plugin of the the xmldb api
+/*! Get datastore cache, read from file on cache miss, and bind yang on first access
+ *
  * @param[in]  h      Clicon handle
- * @param[in]  db     Name of database to search in (filename including dir path
+ * @param[in]  db     Name of database
  * @param[in]  yb     How to bind yang to XML top-level when parsing
  * @param[in]  nsc    External XML namespace context, or NULL
- * @param[in]  xpath  String with XPATH syntax. or NULL for all
- * @param[in]  wdef   With-defaults parameter, see RFC 6243
- * @param[out] xtop   Single return XML tree. Free with xml_free()
+ * @param[in]  xpath  String with XPATH syntax, used for adding global defaults, or NULL
+ * @param[out] x0tp   Cached top of tree
  * @param[out] msdiff If set, return modules-state differences
  * @param[out] xerr   XML error if retval is 0
  * @retval     -1     General error, check specific clicon_errno, clicon_suberrno
  * @retval     0      Parse OK but yang assigment not made (or only partial) and xerr set
  * @retval     1      OK
- * @note Use of 1 for OK
- * @see xmldb_get  the generic API function
  */
 static int
-xmldb_get_cache(clicon_handle     h,
-                const char       *db, 
-                yang_bind         yb,
-                cvec             *nsc,
-                const char       *xpath,
-                withdefaults_type wdef,
-                cxobj           **xtop,
-                modstate_diff_t  *msdiff,
-                cxobj           **xerr)
-
+xmldb_cache_bind(clicon_handle     h,
+                 const char       *db,
+                 yang_bind         yb,
+                 cvec             *nsc,
+                 const char       *xpath,
+                 cxobj           **x0tp,
+                 modstate_diff_t  *msdiff,
+                 cxobj           **xerr)
 {
     int        retval = -1;
     yang_stmt *yspec;
     cxobj     *x0t = NULL; /* (cached) top of tree */
-    cxobj     *x0;
-    cxobj    **xvec = NULL;
-    size_t     xlen;
-    int        i;
     db_elmnt  *de = NULL;
-    cxobj     *x1t = NULL;
     db_elmnt   de0 = {0,};
     int        ret;
 
@@ -896,25 +884,53 @@ xmldb_get_cache(clicon_handle     h,
                 goto done;
         }
     }
-    /* Here x0t looks like: <config>...</config> */
-    /* Given the xpath, return a vector of matches in xvec 
-     * Can we do everything in one go?
-     * 0) Make a new tree
-     * 1) make the xpath check 
-     * 2) iterate thru matches (maybe this can be folded into the xpath_vec?)
-     *   a) for every node that is found, copy to new tree
-     *   b) if config dont dont state data
-     */
-    if (xpath_vec(x0t, nsc, "%s", &xvec, &xlen, xpath?xpath:"/") < 0)
-        goto done;
+    *x0tp = x0t;
+    retval = 1;
+ done:
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
 
+/*! Copy a vector of nodes in the datastore cache to a new tree and apply with-defaults
+ *
+ * @param[in]  h      Clicon handle
+ * @param[in]  x0t    Cached top of tree
+ * @param[in]  xvec   Nodes in x0t to copy
+ * @param[in]  xlen   Length of xvec
+ * @param[in]  ordered If set, nodes are added to their copied parents in vector order
+ * @param[in]  wdef   With-defaults parameter, see RFC 6243
+ * @param[out] xtop   Single return XML tree. Free with xml_free()
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+xmldb_copy_vec(clicon_handle     h,
+               cxobj            *x0t,
+               cxobj           **xvec,
+               size_t            xlen,
+               int               ordered,
+               withdefaults_type wdef,
+               cxobj           **xtop)
+{
+    int        retval = -1;
+    yang_stmt *yspec;
+    cxobj     *x0;
+    int        i;
+    cxobj     *x1t = NULL;
+
+    if ((yspec = clicon_dbspec_yang(h)) == NULL){
+        clicon_err(OE_YANG, ENOENT, "No yang spec");
+        goto done;
+    }
     /* Make new tree by copying top-of-tree from x0t to x1t */
     if ((x1t = xml_new(xml_name(x0t), NULL, CX_ELMNT)) == NULL)
         goto done;
     xml_flag_set(x1t, XML_FLAG_TOP);    
     xml_spec_set(x1t, xml_spec(x0t));
     
-    if (xlen < 1000){
+    if (ordered || xlen < 1000){
         /* This is optimized for the case when the tree is large and xlen is small
          * If the tree is large and xlen too, then the other is better.
          * This only works if yang bind
@@ -1001,6 +1017,70 @@ xmldb_get_cache(clicon_handle     h,
         if (clixon_xml2file(stderr, x1t, 0, 1, fprintf, 0, 0) < 0)
             goto done;
     *xtop = x1t;
+    x1t = NULL;
+    retval = 0;
+ done:
+    if (x1t)
+        xml_free(x1t);
+    return retval;
+}
+
+/*! Get content of database using xpath. return a set of matching sub-trees
+ * The function returns a minimal tree that includes all sub-trees that match
+ * xpath.
+ * This is a clixon datastore plugin of the the xmldb api
+ * @param[in]  h      Clicon handle
+ * @param[in]  db     Name of database to search in (filename including dir path
+ * @param[in]  yb     How to bind yang to XML top-level when parsing
+ * @param[in]  nsc    External XML namespace context, or NULL
+ * @param[in]  xpath  String with XPATH syntax. or NULL for all
+ * @param[in]  wdef   With-defaults parameter, see RFC 6243
+ * @param[out] xtop   Single return XML tree. Free with xml_free()
+ * @param[out] msdiff If set, return modules-state differences
+ * @param[out] xerr   XML error if retval is 0
+ * @retval     -1     General error, check specific clicon_errno, clicon_suberrno
+ * @retval     0      Parse OK but yang assigment not made (or only partial) and xerr set
+ * @retval     1      OK
+ * @note Use of 1 for OK
+ * @see xmldb_get  the generic API function
+ */
+static int
+xmldb_get_cache(clicon_handle     h,
+                const char       *db, 
+                yang_bind         yb,
+                cvec             *nsc,
+                const char       *xpath,
+                withdefaults_type wdef,
+                cxobj           **xtop,
+                modstate_diff_t  *msdiff,
+                cxobj           **xerr)
+
+{
+    int        retval = -1;
+    cxobj     *x0t = NULL; /* (cached) top of tree */
+    cxobj    **xvec = NULL;
+    size_t     xlen;
+    cxobj     *x1t = NULL;
+    int        ret;
+
+    if ((ret = xmldb_cache_bind(h, db, yb, nsc, xpath, &x0t, msdiff, xerr)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    /* Here x0t looks like: <config>...</config> */
+    /* Given the xpath, return a vector of matches in xvec 
+     * Can we do everything in one go?
+     * 0) Make a new tree
+     * 1) make the xpath check 
+     * 2) iterate thru matches (maybe this can be folded into the xpath_vec?)
+     *   a) for every node that is found, copy to new tree
+     *   b) if config dont dont state data
+     */
+    if (xpath_vec(x0t, nsc, "%s", &xvec, &xlen, xpath?xpath:"/") < 0)
+        goto done;
+    if (xmldb_copy_vec(h, x0t, xvec, xlen, 0, wdef, &x1t) < 0)
+        goto done;
+    *xtop = x1t;
     retval = 1;
  done:
     clicon_debug(2, "%s retval:%d", __FUNCTION__, retval);
@@ -1289,6 +1369,61 @@ xmldb_get0(clicon_handle    h,
     return retval;
 }
 
+/*! Get datastore cache for direct read access, read from file if not cached
+ *
+ * Used for optimized access where the caller selects nodes itself, eg list pagination
+ * @param[in]  h      Clicon handle
+ * @param[in]  db     Name of datastore, eg "running"
+ * @param[out] xtp    Cached top of tree. Must not be modified or freed
+ * @param[out] xerr   XML error if retval is 0
+ * @retval     -1     General error, check specific clicon_errno, clicon_suberrno
+ * @retval     0      Parse OK but yang assigment not made (or only partial) and xerr set
+ * @retval     1      OK
+ * @note Only for cached datastores, see CLICON_DATASTORE_CACHE
+ * @see xmldb_get_vec  Make a copy of selected nodes
+ */
+int
+xmldb_cache_load(clicon_handle h,
+                 const char   *db,
+                 cxobj       **xtp,
+                 cxobj       **xerr)
+{
+    if (clicon_datastore_cache(h) == DATASTORE_NOCACHE){
+        clicon_err(OE_DB, EINVAL, "Datastore %s is not cached", db);
+        return -1;
+    }
+    return xmldb_cache_bind(h, db, YB_MODULE, NULL, NULL, xtp, NULL, xerr);
+}
+
+/*! Get a copy of selected nodes of datastore cache
+ *
+ * Same result as xmldb_get0 with an xpath matching the nodes, but nodes are added in vector
+ * order to their parents. The result is therefore not necessarily sorted.
+ * @param[in]  h      Clicon handle
+ * @param[in]  xt     Top of sorted tree, from xmldb_cache_load or a copy from xmldb_get0
+ * @param[in]  xvec   Nodes in xt to copy
+ * @param[in]  xlen   Length of xvec
+ * @param[in]  wdef   With-defaults parameter, see RFC 6243
+ * @param[out] xret   Single return XML tree. Free with xml_free()
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @see xmldb_cache_load
+ */
+int
+xmldb_get_vec(clicon_handle     h,
+              cxobj            *xt,
+              cxobj           **xvec,
+              size_t            xlen,
+              withdefaults_type wdef,
+              cxobj           **xret)
+{
+    if (xret == NULL){
+        clicon_err(OE_DB, EINVAL, "xret is NULL");
+        return -1;
+    }
+    return xmldb_copy_vec(h, xt, xvec, xlen, 1, wdef, xret);
+}
+
 /*! Clear cached xml tree obtained with xmldb_get0, if zerocopy
  *
  * @param[in]  h    Clicon handle
@@ -65,6 +65,7 @@
 #include "clixon_file.h"
 #include "clixon_yang.h"
 #include "clixon_xml.h"
+#include "clixon_xml_vec.h"
 #include "clixon_xml_sort.h"
 #include "clixon_options.h"
 #include "clixon_data.h"
@@ -437,6 +438,25 @@ choice_delete_other(cxobj     *x0,
     return retval;
 }
 
+/*! Check if new entries of a yang list or leaf-list are ordered by system
+ *
+ * Same ordering as in xml_insert, ie entries may be inserted with xml_insert_vec
+ * @param[in]  y  Yang node
+ * @retval     1  System-ordered list or leaf-list
+ * @retval     0  Other node, or ordered by user
+ */
+static int
+text_modify_system_ordered(yang_stmt *y)
+{
+    if (yang_keyword_get(y) != Y_LIST && yang_keyword_get(y) != Y_LEAF_LIST)
+        return 0;
+#ifndef STATE_ORDERED_BY_SYSTEM
+    if (yang_config_ancestor(y) == 0)
+        return 0;
+#endif
+    return yang_find(y, Y_ORDERED_BY, "user") == NULL;
+}
+
 /*! Modify a base tree x0 with x1 with yang spec y according to operation op
  * @param[in]  h        Clicon handle
  * @param[in]  x0       Base xml tree (can be NULL in add scenarios)
@@ -449,6 +469,8 @@ choice_delete_other(cxobj     *x0,
  * @param[in]  username User name of requestor for nacm
  * @param[in]  xnacm    NACM XML tree (only if !permit)
  * @param[in]  permit   If set, no NACM tests using xnacm required
+ * @param[out] x0pnew   If set, a new system-ordered list/leaf-list entry x0 is appended here
+ *                      instead of inserted in x0p. Caller inserts with xml_insert_vec
  * @param[out] cbret    Initialized cligen buffer. Contains return XML if retval is 0.
  * @retval    -1        Error
  * @retval     0        Failed (cbret set)
@@ -472,6 +494,7 @@ text_modify(clicon_handle       h,
             char               *username,
             cxobj              *xnacm,
             int                 permit,
+            clixon_xvec        *x0pnew,
             cbuf               *cbret)
 {
     int        retval = -1;
@@ -481,10 +504,15 @@ text_modify(clicon_handle       h,
     cxobj     *x0c;     /* base child */
     cxobj     *x0b;     /* base body */
     cxobj     *x1c;     /* mod child */
+    cxobj     *x1cprev; /* previous mod child */
     char      *x0bstr;  /* mod body string */
     char      *x1bstr;  /* mod body string */
     yang_stmt *yc;      /* yang child */
     cxobj    **x0vec = NULL;
+    int        x1len;
+    clixon_xvec *x0new = NULL; /* New entries of x0, inserted in one pass */
+    cxobj    **xvec = NULL;
+    int        xlen = 0;
     int        i;
     int        ret;
     char      *instr = NULL;
@@ -693,7 +721,12 @@ text_modify(clicon_handle       h,
                 }
             } /* x1bstr */
             if (changed){ 
-                if (xml_insert(x0p, x0, insert, valstr, NULL) < 0) 
+                if (x0pnew && text_modify_system_ordered(y0)){
+                    if (clixon_xvec_append(x0pnew, x0) < 0)
+                        goto done;
+                    x0 = NULL; /* Inserted by caller */
+                }
+                else if (xml_insert(x0p, x0, insert, valstr, NULL) < 0) 
                     goto done;
             }
             break;
@@ -854,11 +887,19 @@ text_modify(clicon_handle       h,
             /* First pass: Loop through children of the x1 modification tree 
              * collect matching nodes from x0 in x0vec (no changes to x0 children)
              */
-            if ((x0vec = calloc(xml_child_nr_type(x1, CX_ELMNT), sizeof(x1))) == NULL){
+            x1len = xml_child_nr_type(x1, CX_ELMNT);
+            if ((x0vec = calloc(x1len, sizeof(x1))) == NULL){
                 clicon_err(OE_UNIX, errno, "calloc");
                 goto done;
             }
+            /* Large edits: new list entries are collected and merged with existing children
+             * in one pass, see xml_insert_vec
+             */
+            if (DATASTORE_MERGE_MIN && x1len >= DATASTORE_MERGE_MIN &&
+                (x0new = clixon_xvec_new()) == NULL)
+                goto done;
             x1c = NULL; 
+            x1cprev = NULL;
             i = 0;
             while ((x1c = xml_child_each(x1, x1c, CX_ELMNT)) != NULL) { 
                 x1cname = xml_name(x1c);
@@ -897,30 +938,64 @@ text_modify(clicon_handle       h,
                 if (match_base_child(x0, x1c, yc, &x0c) < 0)
                     goto done;
                 x0vec[i++] = x0c; /* != NULL if x0c is matching x1c */
+                /* Several entries for the same instance need to be matched again in the
+                 * second pass, which requires all new entries to be inserted
+                 */
+                if (x0new && x1cprev != NULL &&
+                    xml_spec(x1cprev) == xml_spec(x1c) &&
+                    xml_cmp(x1cprev, x1c, 0, 0, NULL) == 0){
+                    clixon_xvec_free(x0new);
+                    x0new = NULL;
+                }
+                x1cprev = x1c;
             }
             /* Second pass: Loop through children of the x1 modification tree again
              * Now potentially modify x0:s children 
              * Here x0vec contains one-to-one matching nodes of x1:s children.
              */
             x1c = NULL;
+            x1cprev = NULL;
             i = 0;
             while ((x1c = xml_child_each(x1, x1c, CX_ELMNT)) != NULL) {
                 x0c = x0vec[i++];
                 x1cname = xml_name(x1c);
                 yc = yang_find_datanode(y0, x1cname);
+                /* Several entries for the same instance (adjacent since x1 is sorted) are
+                 * applied in order, eg a combined YANG patch. The previous entry may have
+                 * created or removed the base node, so match again.
+                 */
+                if (x1cprev != NULL &&
+                    xml_spec(x1cprev) == xml_spec(x1c) &&
+                    xml_cmp(x1cprev, x1c, 0, 0, NULL) == 0){
+                    x0c = NULL;
+                    if (match_base_child(x0, x1c, yc, &x0c) < 0)
+                        goto done;
+                }
+                x1cprev = x1c;
                 if ((ret = text_modify(h, x0c, x0, x0t, x1c, x1t,
                                        yc, op,
-                                       username, xnacm, permit, cbret)) < 0)
+                                       username, xnacm, permit, x0new, cbret)) < 0)
                     goto done;
                 /* If xml return - ie netconf error xml tree, then stop and return OK */
                 if (ret == 0)
                     goto fail;
             }
+            if (x0new && clixon_xvec_len(x0new)){
+                if (clixon_xvec_extract(x0new, &xvec, &xlen, NULL) < 0)
+                    goto done;
+                if (xml_insert_vec(x0, xvec, xlen) < 0)
+                    goto done;
+            }
             if (changed){
 #ifdef XML_PARENT_CANDIDATE
                 xml_parent_candidate_set(x0, NULL);
 #endif
-                if (xml_insert(x0p, x0, insert, keystr, nscx1) < 0)
+                if (x0pnew && text_modify_system_ordered(y0)){
+                    if (clixon_xvec_append(x0pnew, x0) < 0)
+                        goto done;
+                    x0 = NULL; /* Inserted by caller */
+                }
+                else if (xml_insert(x0p, x0, insert, keystr, nscx1) < 0)
                     goto done;
             }
             break;
@@ -965,6 +1040,19 @@ text_modify(clicon_handle       h,
         xml_purge(x0);
     if (x0vec)
         free(x0vec);
+    if (xvec){
+        /* Remove extracted entries not inserted due to error */
+        for (i=0; i<xlen; i++)
+            if (xml_parent(xvec[i]) == NULL)
+                xml_free(xvec[i]);
+        free(xvec);
+    }
+    if (x0new){
+        /* Remove new entries not inserted due to error */
+        for (i=0; i<clixon_xvec_len(x0new); i++)
+            xml_free(clixon_xvec_i(x0new, i));
+        clixon_xvec_free(x0new);
+    }
     return retval;
  fail: /* cbret set */
     retval = 0;
@@ -1121,7 +1209,7 @@ text_modify_top(clicon_handle       h,
         }
         if ((ret = text_modify(h, x0c, x0, x0t, x1c, x1t,
                                yc, op,
-                               username, xnacm, permit, cbret)) < 0)
+                               username, xnacm, permit, NULL, cbret)) < 0)
             goto done;
         /* If xml return - ie netconf error xml tree, then stop and return OK */
         if (ret == 0)
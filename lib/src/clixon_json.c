@@ -75,7 +75,6 @@
 #include "clixon_xml_nsctx.h" /* namespace context */
 #include "clixon_netconf_lib.h"
 #include "clixon_json.h"
-#include "clixon_json_parse.h"
 
 /* Let xml2json_cbuf_vec() return json array: [a,b].
    ALternative is to create a pseudo-object and return that: {top:{a,b}}
@@ -83,7 +82,10 @@
 #define VEC_ARRAY 1
 
 /* Size of json read buffer when reading from file*/
-#define BUFLEN 1024
+#define BUFLEN 8192
+
+/* Max nesting of JSON objects and arrays */
+#define JSON_PARSE_MAXDEPTH 1024
 
 /* Name of xml top object created by parse functions */
 #define JSON_TOP_SYMBOL "top"
@@ -201,11 +203,11 @@ array_eval(cxobj *xprev,
     char                   *nsx; /* namespace of x */
     char                   *ns2;
 
-    nsx = xml_find_type_value(x, NULL, "xmlns", CX_ATTR);
     if (xml_type(x) != CX_ELMNT){
         arraytype = BODY_ARRAY;
         goto done;
     }
+    nsx = xml_find_type_value(x, NULL, "xmlns", CX_ATTR);
     if (xnext && 
         xml_type(xnext)==CX_ELMNT &&
         strcmp(xml_name(x), xml_name(xnext))==0){
@@ -241,38 +243,100 @@ array_eval(cxobj *xprev,
 }
 
 /*! Escape a json string as well as decode xml cdata
+ *
+ * Runs of characters that need no escaping are found with vectorized scan and appended in bulk
  * @param[out] cb   cbuf   (encoded)
  * @param[in]  str  string (unencoded)
+ * @see RFC 8259 Sec 7
  */
 static int
 json_str_escape_cdata(cbuf *cb,
                       char *str)
 {
-    int   retval = -1;
-    int   i;
+    int    retval = -1;
+    char  *p = str;
+    char  *end;
     size_t len;
     
-    len = strlen(str);
-    for (i=0; i<len; i++)
-        switch (str[i]){
+    end = str + strlen(str);
+    while (p < end){
+        /* Quote, backslash and control characters */
+        if ((len = clixon_str_span(p, end-p, "\"\\", 1)) > 0){
+            if (cbuf_append_buf(cb, p, len) < 0){
+                clicon_err(OE_JSON, errno, "cbuf_append_buf");
+                goto done;
+            }
+            if ((p += len) == end)
+                break;
+        }
+        switch (*p){
         case '\n':
-            cprintf(cb, "\\n");
+            cbuf_append_str(cb, "\\n");
             break;
         case '\"':
-            cprintf(cb, "\\\"");
+            cbuf_append_str(cb, "\\\"");
             break;
         case '\\':
-            cprintf(cb, "\\\\");
+            cbuf_append_str(cb, "\\\\");
+            break;
+        case '\t':
+            cbuf_append_str(cb, "\\t");
+            break;
+        case '\r':
+            cbuf_append_str(cb, "\\r");
+            break;
+        case '\b':
+            cbuf_append_str(cb, "\\b");
             break;
-        default: /* fall thru */
-            cprintf(cb, "%c", str[i]);
+        case '\f':
+            cbuf_append_str(cb, "\\f");
+            break;
+        default: /* Other control characters */
+            cprintf(cb, "\\u%04x", (unsigned char)*p);
             break;
         }
+        p++;
+    }
     retval = 0;
-    // done:
+ done:
     return retval;
 }
 
+/*! Append indentation if pretty-printing
+ */
+static void
+json_indent(cbuf *cb,
+            int   pretty,
+            int   level)
+{
+    if (pretty)
+        cprintf(cb, "%*s", level*PRETTYPRINT_INDENT, "");
+}
+
+/*! Append JSON member name: "module:name":
+ * @param[out] cb       cbuf
+ * @param[in]  pretty   Pretty-print output
+ * @param[in]  level    Indentation level
+ * @param[in]  modname  Module name, or NULL if same as parent
+ * @param[in]  name     Member name
+ */
+static void
+json_name_encode(cbuf *cb,
+                 int   pretty,
+                 int   level,
+                 char *modname,
+                 char *name)
+{
+    json_indent(cb, pretty, level);
+    cbuf_append(cb, '"');
+    if (modname){
+        cbuf_append_str(cb, modname);
+        cbuf_append(cb, ':');
+    }
+    cbuf_append_str(cb, name);
+    cbuf_append_str(cb, pretty?"\": ":"\":");
+}
+
 /*! Decode types from JSON to XML identityrefs
  * Assume an xml tree where prefix:name have been split into "module":"name"
  * In other words, from JSON RFC7951 to XML namespace trees
@@ -520,15 +584,13 @@ xml2json_encode_leafs(cxobj     *xb,
     char         *body;
     enum cv_type  cvtype;
     int           quote = 1; /* Quote value w string: "val" */
-    cbuf         *cb = NULL; /* the variable itself */
+    int           array = 0; /* Enclose value in [] */
+    char         *str = NULL; /* the variable itself, written directly to cb0 */
+    cbuf         *cb = NULL; /* Encoded identityref */
 
-    if ((cb = cbuf_new()) ==NULL){
-        clicon_err(OE_XML, errno, "cbuf_new");
-        goto done;
-    }
     body = xb?xml_value(xb):NULL;
     if (yp == NULL){
-        cprintf(cb, "%s", body?body:"null"); 
+        str = body?body:"null"; 
         goto ok; /* unknown */
     }
     keyword = yang_keyword_get(yp);
@@ -544,29 +606,26 @@ xml2json_encode_leafs(cxobj     *xb,
         case CGV_REST:
             if (body==NULL)
                 ; /* empty: "" */
-            else if (ytype){
-                if (strcmp(restype, "identityref")==0){
-                    if (xml2json_encode_identityref(xb, body, yp, cb) < 0)
-                        goto done;
-                }
-                else{
-                    cprintf(cb, "%s", body);
+            else if (ytype && strcmp(restype, "identityref")==0){
+                if ((cb = cbuf_new()) ==NULL){
+                    clicon_err(OE_XML, errno, "cbuf_new");
+                    goto done;
                 }
+                if (xml2json_encode_identityref(xb, body, yp, cb) < 0)
+                    goto done;
+                str = cbuf_get(cb);
             }
             else
-                cprintf(cb, "%s", body);
+                str = body;
             break;
         case CGV_INT64:
         case CGV_UINT64:
         case CGV_DEC64:
                 // [RFC7951] JSON Encoding of YANG Data
                 // 6.1 Numeric Types - A value of the "int64", "uint64", or "decimal64" type is represented as a JSON string
-                if (yang_keyword_get(yp) == Y_LEAF_LIST && xml_child_nr_type(xml_parent(xp), CX_ELMNT) == 1) {
-                        cprintf(cb, "[%s]", body);
-                }
-                else {
-                        cprintf(cb, "%s", body);
-                }
+                if (yang_keyword_get(yp) == Y_LEAF_LIST && xml_child_nr_type(xml_parent(xp), CX_ELMNT) == 1)
+                        array = 1;
+                str = body;
                 quote = 1;
                 break;
         case CGV_INT8:
@@ -576,7 +635,7 @@ xml2json_encode_leafs(cxobj     *xb,
         case CGV_UINT16:
         case CGV_UINT32:
         case CGV_BOOL:
-            cprintf(cb, "%s", body);
+            str = body;
             quote = 0;
             break;
         case CGV_VOID:
@@ -584,22 +643,19 @@ xml2json_encode_leafs(cxobj     *xb,
             if (body == NULL && strcmp(restype, "empty")==0){
                 quote = 0;
                 if (keyword == Y_LEAF)
-                    cprintf(cb, "[null]");
+                    str = "[null]";
                 else if (keyword == Y_LEAF_LIST && strcmp(restype, "empty") == 0)
-                    cprintf(cb, "[null]");
+                    str = "[null]";
                 else
-                    cprintf(cb, "null");
+                    str = "null";
             }
             break;
         default:
-            if (body)
-                cprintf(cb, "%s", body);
-            else
-                cprintf(cb, "{}"); /* dont know */
+            str = body?body:"{}"; /* dont know */
         }
         break;
     default:
-        cprintf(cb, "%s", body);
+        str = body;
         break;
     }
  ok:
@@ -607,13 +663,17 @@ xml2json_encode_leafs(cxobj     *xb,
      * includign quoting and encoding 
      */
     if (quote){
-        cprintf(cb0, "\"");
-        json_str_escape_cdata(cb0, cbuf_get(cb));
+        cbuf_append(cb0, '"');
+        if (array)
+            cbuf_append(cb0, '[');
+        if (str && json_str_escape_cdata(cb0, str) < 0)
+            goto done;
+        if (array)
+            cbuf_append(cb0, ']');
+        cbuf_append(cb0, '"');
     }
-    else
-        cprintf(cb0, "%s", cbuf_get(cb));
-    if (quote)
-        cprintf(cb0, "\"");
+    else if (str)
+        cbuf_append_str(cb0, str);
     retval = 0;
  done:
     if (cb)
@@ -723,7 +783,7 @@ json_metadata_encoding(cbuf  *cb,
  * @param[in]     level    Indentation level
  * @param[in]     pretty   Pretty-print output (2 means debug)
  * @param[in]     modname  Name of yang module
- * @param[in,out] metacb   Encode into cbuf
+ * @param[in,out] metacbp  Encode into cbuf, created if NULL
  * @see RFC7952
  */
 static int
@@ -733,44 +793,49 @@ xml2json_encode_attr(cxobj     *xa,
                      int        level,
                      int        pretty,
                      char      *modname,
-                     cbuf      *metacb)
+                     cbuf     **metacbp)
 {
     int           retval = -1;
     int           ismeta = 0;
     char         *namespace = NULL;
     yang_stmt    *ymod;
     enum rfc_6020 ykeyw;
+    char         *modname2 = NULL; /* Module of meta-data */
     
     if (xml2ns(xa, xml_prefix(xa), &namespace) < 0)
         goto done;
+    if (namespace == NULL || yp == NULL)
+        goto ok;
+    ykeyw = yang_keyword_get(yp);
     /* Check for (1) registered meta-data */
-    if (namespace != NULL && yp){
-        ykeyw = yang_keyword_get(yp);
-        if ((ymod = yang_find_module_by_namespace(ys_spec(yp), namespace)) != NULL){
-            if (yang_metadata_annotation_check(xa, ymod, &ismeta) < 0)
-                goto done;
-            if (ismeta)
-                if (json_metadata_encoding(metacb, xp, level, pretty,
-                                           modname, xml_name(xp),
-                                           yang_argument_get(ymod),
-                                           xml_name(xa),
-                                           xml_value(xa),
-                                           ykeyw == Y_LEAF_LIST || ykeyw == Y_LIST) < 0)
-                    goto done;
-        }
-        /* Check for (2) assigned - hardcoded for now */
-        else if (strcmp(namespace, "urn:ietf:params:xml:ns:netconf:default:1.0") == 0 &&
-                 strcmp(xml_name(xa), "default") == 0){
-            /* RFC 7952 / RFC 8040 defaults attribute */
-            if (json_metadata_encoding(metacb, xp, level, pretty,
-                                       modname, xml_name(xp),
-                                       "ietf-netconf-with-defaults",
-                                       xml_name(xa),
-                                       xml_value(xa),
-                                       ykeyw == Y_LEAF_LIST || ykeyw == Y_LIST) < 0)
-                goto done;
-        }
+    if ((ymod = yang_find_module_by_namespace(ys_spec(yp), namespace)) != NULL){
+        if (yang_metadata_annotation_check(xa, ymod, &ismeta) < 0)
+            goto done;
+        if (ismeta)
+            modname2 = yang_argument_get(ymod);
+    }
+    /* Check for (2) assigned - hardcoded for now */
+    else if (strcmp(namespace, "urn:ietf:params:xml:ns:netconf:default:1.0") == 0 &&
+             strcmp(xml_name(xa), "default") == 0){
+        /* RFC 7952 / RFC 8040 defaults attribute */
+        modname2 = "ietf-netconf-with-defaults";
     }
+    if (modname2 == NULL)
+        goto ok;
+    /* Meta-data is rare: create buffer on demand */
+    if (*metacbp == NULL &&
+        (*metacbp = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (json_metadata_encoding(*metacbp, xp, level, pretty,
+                               modname, xml_name(xp),
+                               modname2,
+                               xml_name(xa),
+                               xml_value(xa),
+                               ykeyw == Y_LEAF_LIST || ykeyw == Y_LIST) < 0)
+        goto done;
+ ok:
     retval = 0;
  done:
     return retval;
@@ -784,7 +849,7 @@ xml2json_encode_attr(cxobj     *xa,
  * @param[in]    pretty    Pretty-print output (2 means debug)
  * @param[in]    flat      Dont print NO_ARRAY object name (for _vec call)
  * @param[in]    modname0
- * @param[out]   metacbp   Meta encoding of attribute
+ * @param[out]   metacbp   Meta encoding of attribute, created on demand
  *
  * @note Does not work with XML attributes
  * The following matrix explains how the mapping is done.
@@ -822,7 +887,7 @@ xml2json1_cbuf(cbuf                   *cb,
                int                     pretty,
                int                     flat,
                char                   *modname0,
-               cbuf                   *metacbp)
+               cbuf                  **metacbp)
 {
     int              retval = -1;
     int              i;
@@ -842,7 +907,7 @@ xml2json1_cbuf(cbuf                   *cb,
         modname = yang_argument_get(ymod);
         /* Special case for ietf-netconf -> ietf-restconf translation 
          * A special case is for return data on the form {"data":...}
-         * See also json_xmlns_translate()
+         * See also json_parse_namespace()
          */
         if (strcmp(modname, "ietf-netconf") == 0)
             modname = "ietf-restconf";
@@ -863,12 +928,8 @@ xml2json1_cbuf(cbuf                   *cb,
             goto done;
         break;
     case NO_ARRAY:
-        if (!flat){
-            cprintf(cb, "%*s\"", pretty?(level*PRETTYPRINT_INDENT):0, "");
-            if (modname) 
-                cprintf(cb, "%s:", modname);
-            cprintf(cb, "%s\":%s", xml_name(x), pretty?" ":"");
-        }
+        if (!flat)
+            json_name_encode(cb, pretty, level, modname, xml_name(x));
         switch (childt){
         case NULL_CHILD:
             if (nullchild(cb, x, ys) < 0)
@@ -877,7 +938,7 @@ xml2json1_cbuf(cbuf                   *cb,
         case BODY_CHILD:
             break;
         case ANY_CHILD:
-            cprintf(cb, "{%s", pretty?"\n":"");
+            cbuf_append_str(cb, pretty?"{\n":"{");
             break;
         default:
             break;
@@ -885,14 +946,10 @@ xml2json1_cbuf(cbuf                   *cb,
         break;
     case FIRST_ARRAY:
     case SINGLE_ARRAY:
-        cprintf(cb, "%*s\"", pretty?(level*PRETTYPRINT_INDENT):0, "");
-        if (modname)
-            cprintf(cb, "%s:", modname);
-        cprintf(cb, "%s\":%s", xml_name(x), pretty?" ":"");
+        json_name_encode(cb, pretty, level, modname, xml_name(x));
         level++;
-        cprintf(cb, "[%s%*s", 
-                pretty?"\n":"",
-                pretty?(level*PRETTYPRINT_INDENT):0, "");
+        cbuf_append_str(cb, pretty?"[\n":"[");
+        json_indent(cb, pretty, level);
         switch (childt){
         case NULL_CHILD:
             if (nullchild(cb, x, ys) < 0)
@@ -901,7 +958,7 @@ xml2json1_cbuf(cbuf                   *cb,
         case BODY_CHILD:
             break;
         case ANY_CHILD:
-            cprintf(cb, "{%s", pretty?"\n":"");
+            cbuf_append_str(cb, pretty?"{\n":"{");
             break;
         default:
             break;
@@ -910,8 +967,7 @@ xml2json1_cbuf(cbuf                   *cb,
     case MIDDLE_ARRAY:
     case LAST_ARRAY:
         level++;
-        cprintf(cb, "%*s", 
-                pretty?(level*PRETTYPRINT_INDENT):0, "");
+        json_indent(cb, pretty, level);
         switch (childt){
         case NULL_CHILD:
             if (nullchild(cb, x, ys) < 0)
@@ -920,7 +976,7 @@ xml2json1_cbuf(cbuf                   *cb,
         case BODY_CHILD:
             break;
         case ANY_CHILD:
-            cprintf(cb, "{%s", pretty?"\n":"");
+            cbuf_append_str(cb, pretty?"{\n":"{");
             break;
         default:
             break;
@@ -929,10 +985,6 @@ xml2json1_cbuf(cbuf                   *cb,
     default:
         break;
     }
-    if ((metacbc = cbuf_new()) == NULL){
-        clicon_err(OE_UNIX, errno, "cbuf_new");
-        goto done;
-    }
     /* Check for typed sub-body if:
      * arraytype=* but child-type is BODY_CHILD 
      * This is code for writing <a>42</a> as "a":42 and not "a":"42"
@@ -953,16 +1005,15 @@ xml2json1_cbuf(cbuf                   *cb,
                            xc, 
                            xc_arraytype,
                            level+1, pretty, 0, modname0,
-                           metacbc) < 0)
+                           &metacbc) < 0)
             goto done;
         if (commas > 0) {
-            cprintf(cb, ",%s", pretty?"\n":"");
+            cbuf_append_str(cb, pretty?",\n":",");
             --commas;
         }
     }
-    if (cbuf_len(metacbc)){
-        cprintf(cb, "%s", cbuf_get(metacbc));
-    }
+    if (metacbc && cbuf_len(metacbc))
+        cbuf_append_str(cb, cbuf_get(metacbc));
 
     switch (arraytype){
     case BODY_ARRAY:
@@ -973,9 +1024,10 @@ xml2json1_cbuf(cbuf                   *cb,
         case BODY_CHILD:
             break;
         case ANY_CHILD:
-            cprintf(cb, "%s%*s}", 
-                    pretty?"\n":"",
-                    pretty?(level*PRETTYPRINT_INDENT):0, "");
+            if (pretty)
+                cbuf_append(cb, '\n');
+            json_indent(cb, pretty, level);
+            cbuf_append(cb, '}');
             break;
         default:
             break;
@@ -989,9 +1041,10 @@ xml2json1_cbuf(cbuf                   *cb,
         case BODY_CHILD:
             break;
         case ANY_CHILD:
-            cprintf(cb, "%s%*s}", 
-                    pretty?"\n":"",
-                    pretty?(level*PRETTYPRINT_INDENT):0, "");
+            if (pretty)
+                cbuf_append(cb, '\n');
+            json_indent(cb, pretty, level);
+            cbuf_append(cb, '}');
             level--;
             break;
         default:
@@ -1003,20 +1056,23 @@ xml2json1_cbuf(cbuf                   *cb,
         switch (childt){
         case NULL_CHILD:
         case BODY_CHILD:
-            cprintf(cb, "%s",pretty?"\n":"");
+            if (pretty)
+                cbuf_append(cb, '\n');
             break;
         case ANY_CHILD:
-            cprintf(cb, "%s%*s}", 
-                    pretty?"\n":"",
-                    pretty?(level*PRETTYPRINT_INDENT):0, "");
-            cprintf(cb, "%s",pretty?"\n":"");
+            if (pretty)
+                cbuf_append(cb, '\n');
+            json_indent(cb, pretty, level);
+            cbuf_append(cb, '}');
+            if (pretty)
+                cbuf_append(cb, '\n');
             level--;
             break;
         default:
             break;
         }
-        cprintf(cb, "%*s]",
-                pretty?(level*PRETTYPRINT_INDENT):0,"");
+        json_indent(cb, pretty, level);
+        cbuf_append(cb, ']');
         break;
     default:
         break;
@@ -1321,75 +1377,669 @@ xml2json_vec(FILE      *f,
     return retval;
 }
 
-/*! Translate from JSON module:name to XML default ns: xmlns="uri" recursively
- * Assume an xml tree where prefix:name have been split into "module":"name"
- * In other words, from JSON to XML namespace trees
- * 
- * @param[in]     yspec Yang spec
- * @param[in,out] x     XML tree. Translate it in-line
- * @param[out]    xerr  Reason for invalid tree returned as netconf err msg or NULL
- * @retval        1     OK 
- * @retval        0     Invalid, wrt namespace.  xerr set
- * @retval       -1     Error
- * @note the opposite - xml2ns is made inline in xml2json1_cbuf
- * Example: <top><module:input> --> <top><input xmlns="">
+/*! Hand-written JSON parser state
+ *
+ * The parser reads the input in a single pass and builds the XML tree directly. While
+ * parsing, member names are split into module:name, modules are translated to XML
+ * namespaces, nodes are bound to yang when created, and identityref values are decoded
+ * when a leaf is complete. There is no intermediate tree and no post-pass.
+ */
+typedef struct {
+    char       *jp_p;        /* Current position in null-terminated input */
+    char       *jp_end;      /* End of input */
+    int         jp_linenum;  /* Line number, for error messages */
+    int         jp_rfc7951;  /* Do sanity checks according to RFC 7951 */
+    yang_bind   jp_yb;       /* How to bind yang to top-level members */
+    yang_stmt  *jp_yspec;    /* Yang spec, or NULL */
+    cxobj      *jp_xtop;     /* Top of XML tree */
+    cbuf       *jp_cb;       /* Scratch buffer for decoded strings */
+    char       *jp_modname;  /* Cache: last module name resolved */
+    char       *jp_ns;       /* Cache: namespace of jp_modname */
+    int         jp_skip;     /* Yang bind of current top-level member failed */
+    int         jp_failed;   /* Number of yang bind failures */
+    int         jp_invalid;  /* Invalid wrt RFC 7951 or namespaces, stop yang processing */
+    cxobj     **jp_xerr;     /* Reason for invalid returned as netconf err msg, or NULL */
+} json_parser;
+
+static int json_parse_value(json_parser *jp, cxobj **xp, char *prefix, int depth);
+
+/*! Report JSON syntax error at current position
+ */
+static int
+json_parse_error(json_parser *jp)
+{
+    char tok[2] = {0,};
+
+    tok[0] = *jp->jp_p;
+    clicon_log(LOG_NOTICE, "JSON error: line %d", jp->jp_linenum);
+    clicon_err(OE_JSON, XMLPARSE_ERRNO, "json_parse: line %d: syntax error at or before: '%s'",
+               jp->jp_linenum, tok);
+    return -1;
+}
+
+/*! Skip JSON whitespace and count lines
+ */
+static void
+json_parse_ws(json_parser *jp)
+{
+    char *p = jp->jp_p;
+
+    while (1){
+        switch (*p){
+        case '\n':
+            jp->jp_linenum++;
+            /* fall thru */
+        case ' ':
+        case '\t':
+        case '\r':
+            p++;
+            continue;
+        default:
+            break;
+        }
+        break;
+    }
+    jp->jp_p = p;
+}
+
+/*! Decode four hex digits of a \uXXXX escape
+ * @retval   0   OK
+ * @retval  -1   Not four hex digits
+ */
+static int
+json_parse_hex4(char     *p,
+                uint32_t *cp)
+{
+    int  i;
+    char c;
+
+    *cp = 0;
+    for (i=0; i<4; i++){
+        c = p[i];
+        if (c >= '0' && c <= '9')
+            *cp = (*cp << 4) | (c - '0');
+        else if (c >= 'a' && c <= 'f')
+            *cp = (*cp << 4) | (c - 'a' + 10);
+        else if (c >= 'A' && c <= 'F')
+            *cp = (*cp << 4) | (c - 'A' + 10);
+        else
+            return -1;
+    }
+    return 0;
+}
+
+/*! Encode a unicode code point as UTF-8 and append to buffer
+ */
+static int
+json_utf8_append(cbuf    *cb,
+                 uint32_t cp)
+{
+    char   buf[4];
+    size_t len;
+
+    if (cp < 0x80){
+        buf[0] = cp;
+        len = 1;
+    }
+    else if (cp < 0x800){
+        buf[0] = 0xC0 | (cp >> 6);
+        buf[1] = 0x80 | (cp & 0x3F);
+        len = 2;
+    }
+    else if (cp < 0x10000){
+        buf[0] = 0xE0 | (cp >> 12);
+        buf[1] = 0x80 | ((cp >> 6) & 0x3F);
+        buf[2] = 0x80 | (cp & 0x3F);
+        len = 3;
+    }
+    else {
+        buf[0] = 0xF0 | (cp >> 18);
+        buf[1] = 0x80 | ((cp >> 12) & 0x3F);
+        buf[2] = 0x80 | ((cp >> 6) & 0x3F);
+        buf[3] = 0x80 | (cp & 0x3F);
+        len = 4;
+    }
+    return cbuf_append_buf(cb, buf, len);
+}
+
+/*! Parse a JSON string and decode it into the scratch buffer
+ *
+ * Unescaped runs are copied in bulk. Escapes are decoded according to RFC 8259 Sec 7,
+ * including \uXXXX with surrogate pairs which are encoded as UTF-8.
+ * Position is at the opening quote on entry and after the closing quote on exit
+ * @param[in]  jp   JSON parser
+ * @retval     0    OK, string in jp->jp_cb
+ * @retval    -1    Error
+ */
+static int
+json_parse_str(json_parser *jp)
+{
+    cbuf    *cb = jp->jp_cb;
+    char    *p = jp->jp_p + 1;
+    size_t   len;
+    uint32_t cp;
+    uint32_t cp2;
+    char     c;
+
+    cbuf_reset(cb);
+    while (1){
+        if ((len = clixon_str_span(p, jp->jp_end - p, "\"\\\n", 0)) > 0){
+            if (cbuf_append_buf(cb, p, len) < 0){
+                clicon_err(OE_JSON, errno, "cbuf_append_buf");
+                return -1;
+            }
+            p += len;
+        }
+        if (*p == '"')
+            break;
+        if (*p == '\0')
+            goto err;
+        if (*p == '\n'){
+            jp->jp_linenum++;
+            cbuf_append(cb, '\n');
+            p++;
+            continue;
+        }
+        /* Escape */
+        p++;
+        switch (*p){
+        case '"':
+        case '\\':
+        case '/':
+            c = *p;
+            break;
+        case 'b':
+            c = '\b';
+            break;
+        case 'f':
+            c = '\f';
+            break;
+        case 'n':
+            c = '\n';
+            break;
+        case 'r':
+            c = '\r';
+            break;
+        case 't':
+            c = '\t';
+            break;
+        case 'u':
+            if (json_parse_hex4(p+1, &cp) < 0)
+                goto err;
+            p += 4;
+            if (cp >= 0xD800 && cp <= 0xDBFF){ /* High surrogate: low must follow */
+                if (p[1] != '\\' || p[2] != 'u' ||
+                    json_parse_hex4(p+3, &cp2) < 0 ||
+                    cp2 < 0xDC00 || cp2 > 0xDFFF)
+                    goto err;
+                cp = 0x10000 + ((cp - 0xD800) << 10) + (cp2 - 0xDC00);
+                p += 6;
+            }
+            else if (cp == 0 || (cp >= 0xDC00 && cp <= 0xDFFF))
+                goto err;
+            if (json_utf8_append(cb, cp) < 0){
+                clicon_err(OE_JSON, errno, "cbuf_append_buf");
+                return -1;
+            }
+            p++;
+            continue;
+        default:
+            goto err;
+        }
+        cbuf_append(cb, c);
+        p++;
+    }
+    jp->jp_p = p + 1;
+    return 0;
+ err:
+    jp->jp_p = p;
+    return json_parse_error(jp);
+}
+
+/*! Add body to XML element, unless yang says it is a container or list
+ * @see strip_body_objects
+ */
+static int
+json_parse_body(json_parser *jp,
+                cxobj       *x,
+                char        *value)
+{
+    yang_stmt    *y;
+    enum rfc_6020 keyword;
+    cxobj        *xb;
+
+    if ((y = xml_spec(x)) != NULL){
+        keyword = yang_keyword_get(y);
+        if (keyword == Y_CONTAINER || keyword == Y_LIST)
+            return 0;
+    }
+    if ((xb = xml_new("body", x, CX_BODY)) == NULL)
+        return -1;
+    if (value && xml_value_set(xb, value) < 0)
+        return -1;
+    return 0;
+}
+
+/*! Parse JSON number and add it as body
+ */
+static int
+json_parse_number(json_parser *jp,
+                  cxobj       *x)
+{
+    char *p = jp->jp_p;
+    int   digits = 0;
+
+    if (*p == '-')
+        p++;
+    while (isdigit((unsigned char)*p)){
+        p++;
+        digits++;
+    }
+    if (*p == '.'){
+        p++;
+        while (isdigit((unsigned char)*p)){
+            p++;
+            digits++;
+        }
+    }
+    if (digits == 0){
+        jp->jp_p = p;
+        return json_parse_error(jp);
+    }
+    if (*p == 'e' || *p == 'E'){
+        p++;
+        if (*p == '+' || *p == '-')
+            p++;
+        if (!isdigit((unsigned char)*p)){
+            jp->jp_p = p;
+            return json_parse_error(jp);
+        }
+        while (isdigit((unsigned char)*p))
+            p++;
+    }
+    cbuf_reset(jp->jp_cb);
+    if (cbuf_append_buf(jp->jp_cb, jp->jp_p, p - jp->jp_p) < 0){
+        clicon_err(OE_JSON, errno, "cbuf_append_buf");
+        return -1;
+    }
+    jp->jp_p = p;
+    return json_parse_body(jp, x, cbuf_get(jp->jp_cb));
+}
+
+/*! Parse JSON literal true, false or null and add it as body
+ * @param[in]  jp     JSON parser
+ * @param[in]  x      XML element
+ * @param[in]  lit    Literal
+ * @param[in]  value  Body value, NULL for null
+ */
+static int
+json_parse_literal(json_parser *jp,
+                   cxobj       *x,
+                   char        *lit,
+                   char        *value)
+{
+    size_t len = strlen(lit);
+
+    if (strncmp(jp->jp_p, lit, len) != 0)
+        return json_parse_error(jp);
+    jp->jp_p += len;
+    return json_parse_body(jp, x, value);
+}
+
+/*! Translate JSON module name of a member to XML default namespace
+ *
+ * The last module found is cached since consecutive members usually share module.
+ * @param[in]  jp       JSON parser
+ * @param[in]  x        XML element
+ * @param[in]  modname  JSON module name (prefix)
+ * @retval     1        OK
+ * @retval     0        Invalid, no such module. jp_xerr set
+ * @retval    -1        Error
  * @see RFC7951 Sec 4
  */
 static int
-json_xmlns_translate(yang_stmt *yspec,
-                     cxobj     *x,
-                     cxobj    **xerr)
+json_parse_namespace(json_parser *jp,
+                     cxobj       *x,
+                     char        *modname)
 {
-    int        retval = -1;
     yang_stmt *ymod;
-    char      *namespace;
-    char      *modname = NULL;
-    cxobj     *xc;
-    int        ret;
-    
-    if ((modname = xml_prefix(x)) != NULL){ /* prefix is here module name */
-        /* Special case for ietf-netconf -> ietf-restconf translation 
-         * A special case is for return data on the form {"data":...}
-         * See also xml2json1_cbuf
-         */
-        if (strcmp(modname, "ietf-restconf") == 0)
-            modname = "ietf-netconf";
-        if ((ymod = yang_find_module_by_name(yspec, modname)) == NULL){
-            if (xerr &&
-                netconf_unknown_namespace_xml(xerr, "application",
+
+    /* Special case for ietf-netconf -> ietf-restconf translation 
+     * A special case is for return data on the form {"data":...}
+     * See also xml2json1_cbuf
+     */
+    if (strcmp(modname, "ietf-restconf") == 0)
+        modname = "ietf-netconf";
+    if (jp->jp_modname == NULL || strcmp(jp->jp_modname, modname) != 0){
+        if ((ymod = yang_find_module_by_name(jp->jp_yspec, modname)) == NULL){
+            if (jp->jp_xerr &&
+                netconf_unknown_namespace_xml(jp->jp_xerr, "application",
                                               modname,
                                               "No yang module found corresponding to prefix") < 0)
-                goto done;
-            goto fail;
+                return -1;
+            return 0;
         }
-        namespace = yang_find_mynamespace(ymod);
-        /* It would be possible to use canonical prefixes here, but probably not
-         * necessary or even right. Therefore, the namespace given by the JSON prefix / module
-         * is always the default namespace with prefix NULL.
-         * If not, this would be the prefix to pass instead of NULL
-         * prefix = yang_find_myprefix(ymod);
-         */
-        if (xml_namespace_change(x, namespace, NULL) < 0)
+        jp->jp_modname = yang_argument_get(ymod);
+        jp->jp_ns = yang_find_mynamespace(ymod);
+    }
+    /* The namespace given by the JSON module is always the default namespace */
+    if (xml_namespace_change(x, jp->jp_ns, NULL) < 0)
+        return -1;
+    return 1;
+}
+
+/*! Create XML element from JSON member, translate its namespace and bind it to yang
+ *
+ * @param[in]  jp       JSON parser
+ * @param[in]  xp       XML parent
+ * @param[in]  prefix   JSON module name, or NULL
+ * @param[in]  name     Member name
+ * @param[in]  xsibling Previous element of same array used as yang role model, or NULL
+ * @param[out] xret     Created XML element
+ * @retval     0        OK
+ * @retval    -1        Error
+ */
+static int
+json_member_new(json_parser *jp,
+                cxobj       *xp,
+                char        *prefix,
+                char        *name,
+                cxobj       *xsibling,
+                cxobj      **xret)
+{
+    int        retval = -1;
+    cxobj     *x;
+    cbuf      *cberr = NULL;
+    yang_bind  yb = YB_NONE;
+    int        ret;
+
+    if ((x = xml_new(name, xp, CX_ELMNT)) == NULL)
+        goto done;
+    *xret = x;
+    if (xml_prefix_set(x, prefix) < 0)
+        goto done;
+    if (xp == jp->jp_xtop)
+        jp->jp_skip = 0;
+    if (jp->jp_invalid)
+        goto ok;
+    /* RFC 7951 Section 4: A namespace-qualified member name MUST be used for all 
+     * members of a top-level JSON object 
+     */
+    if (xp == jp->jp_xtop && jp->jp_rfc7951 && prefix == NULL &&
+        /* XXX: For top-level config file: */
+        (jp->jp_yb != YB_NONE || strcmp(name, DATASTORE_TOP_SYMBOL) != 0)){
+        if ((cberr = cbuf_new()) == NULL){
+            clicon_err(OE_UNIX, errno, "cbuf_new");
+            goto done;
+        }
+        cprintf(cberr, "Top-level JSON object %s is not qualified with namespace which is a MUST according to RFC 7951", name);
+        if (jp->jp_xerr && netconf_malformed_message_xml(jp->jp_xerr, cbuf_get(cberr)) < 0)
             goto done;
+        jp->jp_invalid++;
+        goto ok;
     }
-    xc = NULL;
-    while ((xc = xml_child_each(x, xc, CX_ELMNT)) != NULL){
-        if ((ret = json_xmlns_translate(yspec, xc, xerr)) < 0)
+    /* Names are split into name/prefix, now add namespace info */
+    if (prefix){
+        if ((ret = json_parse_namespace(jp, x, prefix)) < 0)
             goto done;
-        if (ret == 0)
-            goto fail;
+        if (ret == 0){
+            jp->jp_invalid++;
+            goto ok;
+        }
     }
-    retval = 1;
+    if (jp->jp_skip)
+        goto ok;
+    /* Assign yang stmt: YB_RPC is bound when the top-level member is complete */
+    if (xp == jp->jp_xtop){
+        if (jp->jp_yb == YB_MODULE || jp->jp_yb == YB_PARENT)
+            yb = jp->jp_yb;
+    }
+    else if (jp->jp_yb == YB_MODULE_NEXT && xml_parent(xp) == jp->jp_xtop)
+        yb = YB_MODULE;
+    else if (jp->jp_yb != YB_RPC && xml_spec(xp) != NULL)
+        yb = YB_PARENT;
+    if (yb != YB_NONE){
+        if ((ret = xml_bind_yang_node(x, yb, jp->jp_yspec, xsibling, jp->jp_xerr)) < 0)
+            goto done;
+        if (ret == 0){ /* Stop binding this top-level member */
+            jp->jp_failed++;
+            jp->jp_skip++;
+        }
+    }
+ ok:
+    retval = 0;
  done:
+    if (cberr)
+        cbuf_free(cberr);
     return retval;
- fail:
+}
+
+/*! JSON member value is complete: decode identityrefs, index and sort
+ *
+ * @param[in]  jp    JSON parser
+ * @param[in]  x     XML element
+ * @retval     0     OK
+ * @retval    -1    Error
+ */
+static int
+json_member_end(json_parser *jp,
+                cxobj       *x)
+{
+    yang_stmt    *y;
+    enum rfc_6020 keyword;
+    int           ret;
+
+    if (jp->jp_invalid)
+        return 0;
+    if (xml_parent(x) == jp->jp_xtop && jp->jp_yb == YB_RPC){
+        if ((ret = xml_bind_yang_rpc(x, jp->jp_yspec, jp->jp_xerr)) < 0)
+            return -1;
+        if (ret == 0)
+            jp->jp_failed++;
+        /* Find leafs with identityrefs and translate prefixes in values to XML namespaces */
+        if ((ret = json2xml_decode(x, jp->jp_xerr)) < 0)
+            return -1;
+        if (ret == 0){
+            jp->jp_invalid++;
+            return 0;
+        }
+        return xml_sort_recurse(x);
+    }
+    if ((y = xml_spec(x)) != NULL){
+        keyword = yang_keyword_get(y);
+        if (keyword == Y_LEAF || keyword == Y_LEAF_LIST){
+            if ((ret = json2xml_decode(x, jp->jp_xerr)) < 0)
+                return -1;
+            if (ret == 0){
+                jp->jp_invalid++;
+                return 0;
+            }
+        }
+#ifdef XML_EXPLICIT_INDEX
+        /* Index value is known first when body is set */
+        if (xml_search_index_p(x) &&
+            xml_search_child_insert(xml_parent(x), x) < 0)
+            return -1;
+#endif
+    }
+    /* Sorting is not really meaningful if yang not bound */
+    if (jp->jp_yb != YB_NONE &&
+        xml_sort_verify(x, NULL) < 0 && xml_sort(x) < 0)
+        return -1;
+    return 0;
+}
+
+/*! Parse JSON object: {"name":value,...}
+ * @param[in]  jp     JSON parser
+ * @param[in]  xp     XML element of the object, members are added as children
+ * @param[in]  depth  Nesting depth
+ */
+static int
+json_parse_object(json_parser *jp,
+                  cxobj       *xp,
+                  int          depth)
+{
+    int    retval = -1;
+    cxobj *x;
+    char  *name;
+    char  *id;
+    char  *prefix = NULL;
+
+    jp->jp_p++; /* { */
+    json_parse_ws(jp);
+    if (*jp->jp_p == '}'){
+        jp->jp_p++;
+        goto ok;
+    }
+    while (1){
+        json_parse_ws(jp);
+        if (*jp->jp_p != '"'){
+            json_parse_error(jp);
+            goto done;
+        }
+        if (json_parse_str(jp) < 0)
+            goto done;
+        /* Split into module:name (RFC 7951) */
+        name = cbuf_get(jp->jp_cb);
+        if ((id = strchr(name, ':')) != NULL){
+            *id++ = '\0';
+            if ((prefix = strdup(name)) == NULL){
+                clicon_err(OE_JSON, errno, "strdup");
+                goto done;
+            }
+        }
+        else
+            id = name;
+        if (json_member_new(jp, xp, prefix, id, NULL, &x) < 0)
+            goto done;
+        json_parse_ws(jp);
+        if (*jp->jp_p != ':'){
+            json_parse_error(jp);
+            goto done;
+        }
+        jp->jp_p++;
+        if (json_parse_value(jp, &x, prefix, depth) < 0)
+            goto done;
+        if (json_member_end(jp, x) < 0)
+            goto done;
+        if (prefix){
+            free(prefix);
+            prefix = NULL;
+        }
+        json_parse_ws(jp);
+        if (*jp->jp_p == ','){
+            jp->jp_p++;
+            continue;
+        }
+        if (*jp->jp_p == '}'){
+            jp->jp_p++;
+            break;
+        }
+        json_parse_error(jp);
+        goto done;
+    }
+ ok:
     retval = 0;
-    goto done;
+ done:
+    if (prefix)
+        free(prefix);
+    return retval;
+}
+
+/*! Parse JSON array: [value,...]
+ *
+ * The first value is added to the current element, and each following value to a new 
+ * sibling with the same name. Empty array leaves the element empty.
+ * @param[in]     jp     JSON parser
+ * @param[in,out] xp     Current XML element, last array element on exit
+ * @param[in]     prefix JSON module name of the member, or NULL
+ * @param[in]     depth  Nesting depth
+ */
+static int
+json_parse_array(json_parser *jp,
+                 cxobj      **xp,
+                 char        *prefix,
+                 int          depth)
+{
+    cxobj *x0;
+
+    jp->jp_p++; /* [ */
+    json_parse_ws(jp);
+    if (*jp->jp_p == ']'){
+        jp->jp_p++;
+        return 0;
+    }
+    while (1){
+        if (json_parse_value(jp, xp, prefix, depth) < 0)
+            return -1;
+        json_parse_ws(jp);
+        if (*jp->jp_p == ']'){
+            jp->jp_p++;
+            break;
+        }
+        x0 = *xp;
+        if (*jp->jp_p != ',' || x0 == jp->jp_xtop) /* No siblings of top */
+            return json_parse_error(jp);
+        jp->jp_p++;
+        if (json_member_end(jp, x0) < 0)
+            return -1;
+        /* Use previous element as role model for massive lists */
+        if (json_member_new(jp, xml_parent(x0), prefix, xml_name(x0), x0, xp) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+/*! Parse JSON value
+ * @param[in]     jp     JSON parser
+ * @param[in,out] xp     Current XML element, may be changed by arrays
+ * @param[in]     prefix JSON module name of the member, or NULL
+ * @param[in]     depth  Nesting depth
+ * @retval        0      OK
+ * @retval       -1      Error
+ */
+static int
+json_parse_value(json_parser *jp,
+                 cxobj      **xp,
+                 char        *prefix,
+                 int          depth)
+{
+    json_parse_ws(jp);
+    switch (*jp->jp_p){
+    case '{':
+    case '[':
+        if (depth >= JSON_PARSE_MAXDEPTH){
+            clicon_err(OE_JSON, XMLPARSE_ERRNO, "json_parse: line %d: nesting deeper than %d",
+                       jp->jp_linenum, JSON_PARSE_MAXDEPTH);
+            return -1;
+        }
+        if (*jp->jp_p == '{')
+            return json_parse_object(jp, *xp, depth+1);
+        return json_parse_array(jp, xp, prefix, depth+1);
+    case '"':
+        if (json_parse_str(jp) < 0)
+            return -1;
+        return json_parse_body(jp, *xp, cbuf_get(jp->jp_cb));
+    case 't':
+        return json_parse_literal(jp, *xp, "true", "true");
+    case 'f':
+        return json_parse_literal(jp, *xp, "false", "false");
+    case 'n':
+        return json_parse_literal(jp, *xp, "null", NULL);
+    case '-':
+    case '.':
+    case '0': case '1': case '2': case '3': case '4':
+    case '5': case '6': case '7': case '8': case '9':
+        return json_parse_number(jp, *xp);
+    default:
+        break;
+    }
+    return json_parse_error(jp);
 }
 
 /*! Parse a string containing JSON and return an XML tree
  *
- * Parsing using yacc according to JSON syntax. Names with <prefix>:<id>
+ * Single-pass parser according to JSON syntax. Names with <prefix>:<id>
  * are split and interpreted as in RFC7951
  *
  * @param[in]  str    Input string containing JSON
@@ -1414,107 +2064,41 @@ _json_parse(char      *str,
             cxobj     *xt,
             cxobj    **xerr)
 {
-    int              retval = -1;
-    clixon_json_yacc jy = {0,};
-    int              ret;
-    cxobj           *x;
-    cbuf            *cberr = NULL;
-    int              i;
-    int              failed = 0; /* yang assignment */
+    int         retval = -1;
+    json_parser jp = {0,};
+    cxobj      *x = xt;
     
     clicon_debug(1, "%s %d %s", __FUNCTION__, yb, str);
-    jy.jy_parse_string = str;
-    jy.jy_linenum = 1;
-    jy.jy_current = xt;
-    jy.jy_xtop = xt;
-    if (json_scan_init(&jy) < 0)
+    jp.jp_p = str;
+    jp.jp_end = str + strlen(str);
+    jp.jp_linenum = 1;
+    jp.jp_rfc7951 = rfc7951;
+    jp.jp_yb = yb;
+    jp.jp_yspec = yspec;
+    jp.jp_xtop = xt;
+    jp.jp_xerr = xerr;
+    if ((jp.jp_cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
         goto done;
-    if (json_parse_init(&jy) < 0)
+    }
+    if (json_parse_value(&jp, &x, NULL, 0) < 0)
         goto done;
-    if (clixon_json_parseparse(&jy) != 0) { /* yacc returns 1 on error */
-        clicon_log(LOG_NOTICE, "JSON error: line %d", jy.jy_linenum);
-        if (clicon_errno == 0)
-            clicon_err(OE_JSON, 0, "JSON parser error with no error code (should not happen)");
+    json_parse_ws(&jp);
+    if (*jp.jp_p != '\0'){
+        json_parse_error(&jp);
         goto done;
     }
-    /* Traverse new objects */
-    for (i = 0; i < jy.jy_xlen; i++) {
-        x = jy.jy_xvec[i];
-        /* RFC 7951 Section 4: A namespace-qualified member name MUST be used for all 
-         * members of a top-level JSON object 
-         */
-        if (rfc7951 && xml_prefix(x) == NULL){
-            /* XXX: For top-level config file: */
-            if (yb != YB_NONE || strcmp(xml_name(x),DATASTORE_TOP_SYMBOL)!=0){
-                if ((cberr = cbuf_new()) == NULL){
-                    clicon_err(OE_UNIX, errno, "cbuf_new");
-                    goto done;
-                }
-                cprintf(cberr, "Top-level JSON object %s is not qualified with namespace which is a MUST according to RFC 7951", xml_name(x));
-                if (xerr && netconf_malformed_message_xml(xerr, cbuf_get(cberr)) < 0)
-                    goto done;
-                goto fail;
-            }
-        }
-        /* Names are split into name/prefix, but now add namespace info */
-        if ((ret = json_xmlns_translate(yspec, x, xerr)) < 0)
-            goto done;
-        if (ret == 0)
-            goto fail;
-        /* Now assign yang stmts to each XML node 
-         * XXX should be xml_bind_yang0_parent() sometimes.
-         */
-        switch (yb){
-        case YB_PARENT:
-            if ((ret = xml_bind_yang0(x, yb, yspec, xerr)) < 0)
-                    goto done;
-            if (ret == 0)
-                failed++;
-            break;
-        case YB_MODULE_NEXT:
-            if ((ret = xml_bind_yang(x, YB_MODULE, yspec, xerr)) < 0)
-                goto done;
-            if (ret == 0)
-                failed++;
-            break;
-        case YB_MODULE:
-            if ((ret = xml_bind_yang0(x, yb, yspec, xerr)) < 0)
-                goto done;
-            if (ret == 0)
-                failed++;
-            break;
-        case YB_NONE:
-            break;
-        case YB_RPC: 
-            if ((ret = xml_bind_yang_rpc(x, yspec, xerr)) < 0)
-                goto done;
-            if (ret == 0)
-                failed++;
-            break;
-        }
-        /* Now find leafs with identityrefs (+transitive) and translate 
-         * prefixes in values to XML namespaces */
-        if ((ret = json2xml_decode(x, xerr)) < 0)
-            goto done;
-        if (ret == 0) /* XXX necessary? */
-            goto fail;
-    }
-    if (failed)
+    if (jp.jp_invalid || jp.jp_failed)
         goto fail;
-    /* Sort the complete tree after parsing. Sorting is not really meaningful if Yang 
-       not bound */
-    if (yb != YB_NONE)
-        if (xml_sort_recurse(xt) < 0)
-            goto done;
+    /* Members are sorted as they complete, remains the top */
+    if (yb != YB_NONE &&
+        xml_sort_verify(xt, NULL) < 0 && xml_sort(xt) < 0)
+        goto done;
     retval = 1;
  done:
     clicon_debug(1, "%s retval:%d", __FUNCTION__, retval);
-    if (cberr)
-        cbuf_free(cberr);
-    json_parse_exit(&jy);
-    json_scan_exit(&jy);
-    if (jy.jy_xvec)
-        free(jy.jy_xvec);
+    if (jp.jp_cb)
+        cbuf_free(jp.jp_cb);
     return retval; 
  fail: /* invalid */
     retval = 0;
@@ -1609,61 +2193,44 @@ clixon_json_parse_file(FILE      *fp,
 {
     int       retval = -1;
     int       ret;
-    char     *jsonbuf = NULL;
-    int       jsonbuflen = BUFLEN; /* start size */
-    int       oldjsonbuflen;
-    char     *ptr;
-    char      ch;
-    int       len = 0;
+    cbuf     *cb = NULL;
+    char      buf[BUFLEN];
+    size_t    len;
 
     if (xt==NULL){
         clicon_err(OE_JSON, EINVAL, "xt is NULL");
         return -1;
     }
-    if ((jsonbuf = malloc(jsonbuflen)) == NULL){
-        clicon_err(OE_JSON, errno, "malloc");
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_JSON, errno, "cbuf_new");
         goto done;
     }
-    memset(jsonbuf, 0, jsonbuflen);
-    ptr = jsonbuf;
-    while (1){
-        if ((ret = fread(&ch, 1, 1, fp)) < 0){
-            clicon_err(OE_JSON, errno, "read");
-            break;
-        }
-        if (ret != 0)
-            jsonbuf[len++] = ch;
-        if (ret == 0){
-            if (*xt == NULL)
-                if ((*xt = xml_new(JSON_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
-                    goto done;
-            if (len){
-                if ((ret = _json_parse(ptr, rfc7951, yb, yspec, *xt, xerr)) < 0)
-                    goto done;
-                if (ret == 0)
-                    goto fail;
-            }
-            break;
-        }
-        if (len >= jsonbuflen-1){ /* Space: one for the null character */
-            oldjsonbuflen = jsonbuflen;
-            jsonbuflen *= 2;
-            if ((jsonbuf = realloc(jsonbuf, jsonbuflen)) == NULL){
-                clicon_err(OE_JSON, errno, "realloc");
-                goto done;
-            }
-            memset(jsonbuf+oldjsonbuflen, 0, jsonbuflen-oldjsonbuflen);
-            ptr = jsonbuf;
+    while ((len = fread(buf, 1, sizeof(buf), fp)) > 0)
+        if (cbuf_append_buf(cb, buf, len) < 0){
+            clicon_err(OE_JSON, errno, "cbuf_append_buf");
+            goto done;
         }
+    if (ferror(fp)){
+        clicon_err(OE_JSON, errno, "read");
+        goto done;
+    }
+    if (*xt == NULL)
+        if ((*xt = xml_new(JSON_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
+            goto done;
+    if (cbuf_len(cb)){
+        if ((ret = _json_parse(cbuf_get(cb), rfc7951, yb, yspec, *xt, xerr)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
     }
     retval = 1;
  done:
     if (retval < 0 && *xt){
-        free(*xt);
+        xml_free(*xt);
         *xt = NULL;
     }
-    if (jsonbuf)
-        free(jsonbuf);
+    if (cb)
+        cbuf_free(cb);
     return retval;    
  fail:
     retval = 0;
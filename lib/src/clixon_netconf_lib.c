@@ -51,6 +51,8 @@
 #include <stdint.h>
 #include <syslog.h>
 #include <sys/param.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
 
 /* cligen */
 #include <cligen/cligen.h>
@@ -74,6 +76,7 @@
 #include "clixon_yang_module.h"
 #include "clixon_yang_parse_lib.h"
 #include "clixon_plugin.h"
+#include "clixon_proto.h"
 
 #include "clixon_netconf_lib.h"
 
@@ -2096,36 +2099,40 @@ netconf_parse_uint32_xml(char     *name,
     goto done;
 }
 
-/*! Add netconf xml postamble of message. I.e, xml after the body of the message.
+/*! Add netconf xml preamble of message. I.e, xml before the body of the message.
  *
+ * The body is moved within the buffer, not copied to a new buffer
  * @param[in]      framing Netconf framing
  * @param[in,out]  cb  Netconf packet (cligen buffer)
- * XXX: copies body
+ * @see netconf_output_framed  which does not modify the buffer
  */
 int
 netconf_framing_preamble(netconf_framing_type framing,
                          cbuf                *cb)
 {
-    int   retval = -1;
-    char *body = NULL;
+    int    retval = -1;
+    char   hdr[32];
+    size_t hlen;
+    size_t len;
+    char  *p;
 
     switch (framing){
     case NETCONF_SSH_EOM:
         break;
     case NETCONF_SSH_CHUNKED:
-        if ((body = strdup(cbuf_get(cb))) == NULL){
-            clicon_err(OE_UNIX, errno, "strdup");
+        len = cbuf_len(cb);
+        hlen = snprintf(hdr, sizeof(hdr), "\n#%zu\n", len); /* Add RFC6242 chunk header */
+        if (cbuf_append_buf(cb, hdr, hlen) < 0){ /* Grow buffer */
+            clicon_err(OE_UNIX, errno, "cbuf_append_buf");
             goto done;
         }
-        cbuf_reset(cb);
-        cprintf(cb, "\n#%zu\n", strlen(body));     /* Add RFC6242 chunked-end */
-        cbuf_append_str(cb, body);
+        p = cbuf_get(cb);
+        memmove(p + hlen, p, len);
+        memcpy(p, hdr, hlen);
         break;
     }
     retval = 0;
  done:
-    if (body)
-        free(body);
     return retval;
 }
 
@@ -2188,6 +2195,67 @@ netconf_output(int   s,
     return retval;
 }
             
+/*! Send netconf message from cbuf on socket with framing, without copying the message
+ *
+ * Chunk header, message and end-of-message marker are written from separate buffers
+ * with writev, cb is not modified.
+ * @param[in]   s       Socket / file descriptor
+ * @param[in]   framing Framing type, ie EOM(1.0) or chunked (1.1)
+ * @param[in]   cb      Cligen buffer that contains the XML message
+ * @param[in]   msg     Only for debug
+ * @retval      0       OK
+ * @retval     -1       Error
+ * @see netconf_output_encap and netconf_output  copying variant
+ */
+int
+netconf_output_framed(int                  s,
+                      netconf_framing_type framing,
+                      cbuf                *cb,
+                      char                *msg)
+{
+    int          retval = -1;
+    char         hdr[32];
+    struct iovec iov[3];
+    int          i = 0;
+
+    clicon_debug(1, "SEND %s", msg);
+    if (clicon_debug_get() > 1){ /* XXX: below only works to stderr, clicon_debug may log to syslog */
+        cxobj *xt = NULL;
+        if (clixon_xml_parse_string(cbuf_get(cb), YB_NONE, NULL, &xt, NULL) == 0){
+            if (clixon_xml2file(stderr, xml_child_i(xt, 0), 0, 0, fprintf, 0, 0) < 0)
+                goto done;
+            fprintf(stderr, "\n");
+            xml_free(xt);
+        }
+    }
+    if (framing == NETCONF_SSH_CHUNKED){
+        iov[i].iov_base = hdr;
+        iov[i++].iov_len = snprintf(hdr, sizeof(hdr), "\n#%zu\n", (size_t)cbuf_len(cb));
+    }
+    iov[i].iov_base = cbuf_get(cb);
+    iov[i++].iov_len = cbuf_len(cb);
+    switch (framing){
+    case NETCONF_SSH_EOM:
+        iov[i].iov_base = "]]>]]>";     /* RFC4742 end-of-message marker */
+        iov[i++].iov_len = strlen("]]>]]>");
+        break;
+    case NETCONF_SSH_CHUNKED:
+        iov[i].iov_base = "\n##\n";     /* RFC6242 chunked-end */
+        iov[i++].iov_len = strlen("\n##\n");
+        break;
+    }
+    if (clixon_writev(s, iov, i) < 0){
+        if (errno == EPIPE)
+            clicon_debug(1, "%s write err SIGPIPE", __FUNCTION__);
+        else
+            clicon_log(LOG_ERR, "%s: write: %s", __FUNCTION__, strerror(errno));
+        goto done;
+    }
+    retval = 0;
+  done:
+    return retval;
+}
+
 /*! Encapsulate and send outgoing netconf packet as cbuf on socket
  *
  * @param[in]   framing Framing type, ie EOM(1.0) or chunked (1.1)
@@ -55,6 +55,7 @@
 #include <sys/types.h>
 #include <sys/time.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <sys/stat.h>
 #include <netinet/in.h>
 #include <sys/un.h>
@@ -75,6 +76,10 @@
 #include "clixon_sig.h"
 #include "clixon_xml.h"
 #include "clixon_xml_io.h"
+#include "clixon_xml_bin.h"
+#include "clixon_xml_bind.h"
+#include "clixon_xml_sort.h"
+#include "clixon_xml_nsctx.h"
 #include "clixon_netconf_lib.h"
 #include "clixon_options.h"
 #include "clixon_proto.h"
@@ -145,9 +150,15 @@ clicon_msg_encode(uint32_t      id,
     uint32_t           len;
     struct clicon_msg *msg = NULL;
     int                hdrlen = sizeof(*msg);
+    const char        *str = NULL;
 
     va_start(args, format);
-    xmllen = vsnprintf(NULL, 0, format, args) + 1;
+    if (strcmp(format, "%s") == 0){ /* Common case: copy string without format passes */
+        str = va_arg(args, const char *);
+        xmllen = strlen(str) + 1;
+    }
+    else
+        xmllen = vsnprintf(NULL, 0, format, args) + 1;
     va_end(args);
 
     len = hdrlen + xmllen;
@@ -155,21 +166,116 @@ clicon_msg_encode(uint32_t      id,
         clicon_err(OE_PROTO, errno, "malloc");
         return NULL;
     }
-    memset(msg, 0, len);
     /* hdr */
     msg->op_len = htonl(len);
     msg->op_id = htonl(id);
     
     /* body */
-    va_start(args, format);
-    vsnprintf(msg->op_body, xmllen, format, args);
-    va_end(args);
+    if (str)
+        memcpy(msg->op_body, str, xmllen);
+    else {
+        va_start(args, format);
+        vsnprintf(msg->op_body, xmllen, format, args);
+        va_end(args);
+    }
+    return msg;
+}
 
+/*! Encode a clicon netconf message from an XML tree using binary encoding
+ * @param[in] id      Session id of client
+ * @param[in] xml     XML netconf tree, eg <rpc>, including the top node
+ * @retval    NULL    Error
+ * @retval    msg     Clicon message to send to eg clicon_msg_send()
+ * Use only if the peer has announced CLIXON_BIN_CAPABILITY in hello
+ * @see clicon_msg_encode  XML text encoding
+ */
+struct clicon_msg *
+clicon_msg_encode_bin(uint32_t id,
+                      cxobj   *xml)
+{
+    struct clicon_msg *msg = NULL;
+    cbuf              *cb = NULL;
+    uint32_t           len;
+
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_PROTO, errno, "cbuf_new");
+        goto done;
+    }
+    if (clixon_xml2bin(cb, xml, -1, 0) < 0)
+        goto done;
+    len = sizeof(*msg) + cbuf_len(cb);
+    if ((msg = (struct clicon_msg *)malloc(len)) == NULL){
+        clicon_err(OE_PROTO, errno, "malloc");
+        goto done;
+    }
+    msg->op_len = htonl(len);
+    msg->op_id = htonl(id);
+    memcpy(msg->op_body, cbuf_get(cb), cbuf_len(cb));
+ done:
+    if (cb)
+        cbuf_free(cb);
     return msg;
 }
 
-/*! Decode a clicon netconf message
+/*! Check if the body of a clicon message is binary encoded
  * @param[in]  msg    CLICON msg
+ * @retval     1      Binary encoding
+ * @retval     0      XML text
+ */
+int
+clicon_msg_binary(struct clicon_msg *msg)
+{
+    return clixon_bin_magic(msg->op_body, ntohl(msg->op_len) - sizeof(*msg));
+}
+
+/*! Decode a binary encoded clicon netconf message
+ * @see clicon_msg_decode
+ */
+static int
+clicon_msg_decode_bin(struct clicon_msg *msg, 
+                      yang_stmt         *yspec,
+                      cxobj            **xml,
+                      cxobj            **xerr)
+{
+    int    retval = -1;
+    cxobj *x;
+    int    failed = 0;
+    int    ret;
+
+    clicon_debug(1, "%s binary len:%u", __FUNCTION__, ntohl(msg->op_len));
+    if (*xml == NULL &&
+        (*xml = xml_new(XML_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
+        goto done;
+    if (clixon_bin_parse(msg->op_body, ntohl(msg->op_len) - sizeof(*msg), *xml) < 0)
+        goto done;
+    x = NULL;
+    while ((x = xml_child_each(*xml, x, CX_ELMNT)) != NULL){
+        if (xml2ns_recurse(x) < 0)
+            goto done;
+        if (yspec == NULL)
+            continue;
+        if ((ret = xml_bind_yang_rpc(x, yspec, xerr)) < 0)
+            goto done;
+        if (ret == 0){
+            if (*xerr && clixon_xml_attr_copy(x, *xerr, "message-id") < 0)
+                goto done;
+            failed++;
+        }
+    }
+    if (failed)
+        goto fail;
+    if (yspec && xml_sort_recurse(*xml) < 0)
+        goto done;
+    retval = 1;
+ done:
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Decode a clicon netconf message
+ * @param[in]  msg    CLICON msg, XML text or binary encoded
  * @param[in]  yspec  Yang specification, (can be NULL)
  * @param[out] id     Session id
  * @param[out] xml    XML parse tree
@@ -193,9 +299,11 @@ clicon_msg_decode(struct clicon_msg *msg,
     if (id)
         *id = ntohl(msg->op_id);
     /* body */
+    if (clicon_msg_binary(msg))
+        return clicon_msg_decode_bin(msg, yspec, xml, xerr);
     xmlstr = msg->op_body;
     clicon_debug(1, "%s %s", __FUNCTION__, xmlstr);
-    if ((ret = clixon_xml_parse_string(xmlstr, yspec?YB_RPC:YB_NONE, yspec, xml, xerr)) < 0)
+    if ((ret = clixon_xml_parse_buf(xmlstr, strlen(xmlstr), yspec?YB_RPC:YB_NONE, yspec, xml, xerr)) < 0)
         goto done;
     if (ret == 0)
         goto fail;
@@ -292,6 +400,54 @@ atomicio(ssize_t (*fn) (int, void *, size_t),
     return (pos);
 }
 
+/*! Ensure all of an I/O vector is written, gather version of atomicio
+ *
+ * Partial writes are continued from where they stopped, iov is modified.
+ * @param[in]  fd      File descriptor, eg socket
+ * @param[in]  iov     I/O vector, modified
+ * @param[in]  iovcnt  Number of elements in iov
+ * @retval     0       OK, or peer closed as in atomicio (ECONNRESET/EPIPE/EBADF)
+ * @retval    -1       Error
+ * @see atomicio
+ */
+int
+clixon_writev(int           fd,
+              struct iovec *iov,
+              int           iovcnt)
+{
+    ssize_t res;
+
+    while (iovcnt > 0){
+        if (iov->iov_len == 0){
+            iov++;
+            iovcnt--;
+            continue;
+        }
+        _atomicio_sig = 0;
+        if ((res = writev(fd, iov, iovcnt)) < 0){
+            if (errno == EINTR){
+                if (!_atomicio_sig)
+                    continue;
+            }
+            else if (errno == EAGAIN)
+                continue;
+            else if (errno == ECONNRESET || errno == EPIPE || errno == EBADF)
+                return 0;
+            return -1;
+        }
+        while (iovcnt > 0 && res >= (ssize_t)iov->iov_len){
+            res -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0){
+            iov->iov_base = (char*)iov->iov_base + res;
+            iov->iov_len -= res;
+        }
+    }
+    return 0;
+}
+
 /*! Print message on debug. Log if syslog, stderr if not
  * @param[in]  msg    CLICON msg
  */
@@ -683,6 +839,48 @@ clicon_rpc1(int   sock,
     return retval;
 }
 
+/*! Send a clicon_msg message with header and body from separate buffers
+ *
+ * The header is built on the stack and written together with the body using writev,
+ * the body is not copied.
+ * @param[in]  s       Socket to communicate with peer
+ * @param[in]  id      Session id
+ * @param[in]  body    Message body, XML string including NUL, or binary encoded
+ * @param[in]  bodylen Length of body
+ * @retval     0       OK
+ * @retval     -1      Error
+ * @see clicon_msg_send  with message in one buffer
+ */
+int
+clicon_msg_send_buf(int         s,
+                    uint32_t    id,
+                    const char *body,
+                    size_t      bodylen)
+{
+    int               retval = -1;
+    struct clicon_msg hdr;
+    struct iovec      iov[2];
+    int               e;
+
+    hdr.op_len = htonl(sizeof(hdr) + bodylen);
+    hdr.op_id = htonl(id);
+    clicon_debug(2, "%s: send msg len=%zu", __FUNCTION__, sizeof(hdr) + bodylen);
+    iov[0].iov_base = &hdr;
+    iov[0].iov_len = sizeof(hdr);
+    iov[1].iov_base = (void*)body;
+    iov[1].iov_len = bodylen;
+    if (clixon_writev(s, iov, 2) < 0){
+        e = errno;
+        clicon_err(OE_CFG, e, "writev");
+        clicon_log(LOG_WARNING, "%s: write: %s len:%zu", __FUNCTION__,
+                   strerror(e), bodylen);
+        goto done;
+    }
+    retval = 0;
+  done:
+    return retval;
+}
+
 /*! Send a clicon_msg message as reply to a clicon rpc request
  *
  * @param[in]  s       Socket to communicate with client
@@ -696,24 +894,7 @@ send_msg_reply(int      s,
                char    *data, 
                uint32_t datalen)
 {
-    int                retval = -1;
-    struct clicon_msg *reply = NULL;
-    uint32_t           len;
-
-    len = sizeof(*reply) + datalen;
-    if ((reply = (struct clicon_msg *)malloc(len)) == NULL)
-        goto done;
-    memset(reply, 0, len);
-    reply->op_len = htonl(len);
-    if (datalen > 0)
-      memcpy(reply->op_body, data, datalen);
-    if (clicon_msg_send(s, reply) < 0)
-        goto done;
-    retval = 0;
-  done:
-    if (reply)
-        free(reply);
-    return retval;
+    return clicon_msg_send_buf(s, 0, data, datalen);
 }
 
 /*! Send a clicon_msg NOTIFY message asynchronously to client
@@ -729,18 +910,7 @@ static int
 send_msg_notify(int           s, 
                 char         *event)
 {
-    int                retval = -1;
-    struct clicon_msg *msg = NULL;
-
-    if ((msg=clicon_msg_encode(0, "%s", event)) == NULL)
-        goto done;
-    if (clicon_msg_send(s, msg) < 0)
-        goto done;
-    retval = 0;
-  done:
-    if (msg)
-        free(msg);
-    return retval;
+    return clicon_msg_send_buf(s, 0, event, strlen(event)+1);
 }
 
 /*! Send a clicon_msg NOTIFY message asynchronously to client
@@ -80,6 +80,7 @@
 #include "clixon_xml_bind.h"
 #include "clixon_xml_sort.h"
 #include "clixon_xml_io.h"
+#include "clixon_xml_bin.h"
 #include "clixon_netconf_lib.h"
 #include "clixon_proto_client.h"
 
@@ -132,18 +133,30 @@ clicon_rpc_connect(clicon_handle h,
     return retval;
 }
     
+/*! Check if binary encoding is negotiated with backend in hello
+ * @param[in]  h     Clixonhandle
+ * @retval     1     Yes, send binary encoded requests
+ * @retval     0     No, send XML text
+ * @see CLICON_SOCK_BINARY
+ */
+static int
+clicon_rpc_binary(clicon_handle h)
+{
+    return clicon_data_get(h, "sock-binary", NULL) == 0;
+}
+
 /*! Connect to backend or use cached socket and send RPC
  * @param[in]  h     Clixonhandle
  * @param[in]  msg   Encoded message
- * @param[out] xret  Returned data as netconf xml tree.
+ * @param[out] reply Reply message, XML text or binary encoded. Free with free()
  * @param[out] eof   Set if eof encountered
  */
 static int
-clicon_rpc_msg_once(clicon_handle      h,
-                    struct clicon_msg *msg, 
-                    char             **retdata,
-                    int               *eof,
-                    int               *sp)
+clicon_rpc_msg_once(clicon_handle       h,
+                    struct clicon_msg  *msg, 
+                    struct clicon_msg **reply,
+                    int                *eof,
+                    int                *sp)
 {
     int retval = -1;
     int s;
@@ -153,7 +166,8 @@ clicon_rpc_msg_once(clicon_handle      h,
             goto done;
         clicon_client_socket_set(h, s);
     }
-    if (clicon_rpc(s, msg, retdata, eof) < 0){
+    if (clicon_msg_send(s, msg) < 0 ||
+        clicon_msg_rcv(s, reply, eof) < 0){
         /* 2. check socket shutdown AFTER rpc */
         close(s);
         s = -1;
@@ -181,18 +195,18 @@ clicon_rpc_msg(clicon_handle      h,
                struct clicon_msg *msg, 
                cxobj            **xret0)
 {
-    int     retval = -1;
-    char   *retdata = NULL;
-    cxobj  *xret = NULL;
-    int     s = -1;
-    int     eof = 0;
+    int                retval = -1;
+    struct clicon_msg *reply = NULL;
+    cxobj             *xret = NULL;
+    int                s = -1;
+    int                eof = 0;
 
 #ifdef RPC_USERNAME_ASSERT
-    assert(strstr(msg->op_body, "username")!=NULL); /* XXX */
+    assert(clicon_msg_binary(msg) || strstr(msg->op_body, "username")!=NULL); /* XXX */
 #endif
-    clicon_debug(2, "%s request:%s", __FUNCTION__, msg->op_body);
+    clicon_debug(2, "%s request:%s", __FUNCTION__, clicon_msg_binary(msg)?"(binary)":msg->op_body);
     /* Create a socket and connect to it, either UNIX, IPv4 or IPv6 per config options */
-    if (clicon_rpc_msg_once(h, msg, &retdata, &eof, &s) < 0)
+    if (clicon_rpc_msg_once(h, msg, &reply, &eof, &s) < 0)
         goto done;
     if (eof){
         /* 2. check socket shutdown AFTER rpc */
@@ -201,7 +215,9 @@ clicon_rpc_msg(clicon_handle      h,
         clicon_client_socket_set(h, -1);
 #ifdef PROTO_RESTART_RECONNECT
         if (!clixon_exit_get()) { /* May be part of termination */
-            if (clicon_rpc_msg_once(h, msg, &retdata, &eof, NULL) < 0)
+            /* Binary encoding is negotiated per connection */
+            clicon_data_del(h, "sock-binary");
+            if (clicon_rpc_msg_once(h, msg, &reply, &eof, NULL) < 0)
                 goto done;
             if (eof){
                 close(s);
@@ -219,13 +235,11 @@ clicon_rpc_msg(clicon_handle      h,
         goto done;
 #endif
     }
-    clicon_debug(2, "%s retdata:%s", __FUNCTION__, retdata);
-
-    if (retdata){
+    if (reply){
         /* Cannot populate xret here because need to know RPC name (eg "lock") in order to associate yang
          * to reply.
          */
-        if (clixon_xml_parse_string(retdata, YB_NONE, NULL, &xret, NULL) < 0)
+        if (clicon_msg_decode(reply, NULL, NULL, &xret, NULL) < 0)
             goto done;
     }
     if (xret0){
@@ -234,8 +248,8 @@ clicon_rpc_msg(clicon_handle      h,
     }
     retval = 0;
  done:
-    if (retdata)
-        free(retdata);
+    if (reply)
+        free(reply);
     if (xret)
         xml_free(xret);
     return retval;
@@ -255,22 +269,22 @@ clicon_rpc_msg_persistent(clicon_handle      h,
                           cxobj            **xret0,
                           int               *sock0)
 {
-    int     retval = -1;
-    char   *retdata = NULL;
-    cxobj  *xret = NULL;
-    int     s = -1;
-    int     eof = 0;
+    int                retval = -1;
+    struct clicon_msg *reply = NULL;
+    cxobj             *xret = NULL;
+    int                s = -1;
+    int                eof = 0;
 
     if (sock0 == NULL){
         clicon_err(OE_NETCONF, EINVAL, "Missing socket pointer");
         goto done;
     }
 #ifdef RPC_USERNAME_ASSERT
-    assert(strstr(msg->op_body, "username")!=NULL); /* XXX */
+    assert(clicon_msg_binary(msg) || strstr(msg->op_body, "username")!=NULL); /* XXX */
 #endif
-    clicon_debug(1, "%s request:%s", __FUNCTION__, msg->op_body);
+    clicon_debug(1, "%s request:%s", __FUNCTION__, clicon_msg_binary(msg)?"(binary)":msg->op_body);
     /* Create a socket and connect to it, either UNIX, IPv4 or IPv6 per config options */
-    if (clicon_rpc_msg_once(h, msg, &retdata, &eof, &s) < 0)
+    if (clicon_rpc_msg_once(h, msg, &reply, &eof, &s) < 0)
         goto done;
     if (eof){
         /* 2. check socket shutdown AFTER rpc */
@@ -283,13 +297,11 @@ clicon_rpc_msg_persistent(clicon_handle      h,
         clicon_err(OE_PROTO, ESHUTDOWN, "Unexpected close of CLICON_SOCK. Clixon backend daemon may have crashed.");
         goto done;
     }
-    clicon_debug(1, "%s retdata:%s", __FUNCTION__, retdata);
-
-    if (retdata){
+    if (reply){
         /* Cannot populate xret here because need to know RPC name (eg "lock") in order to associate yang
          * to reply.
          */
-        if (clixon_xml_parse_string(retdata, YB_NONE, NULL, &xret, NULL) < 0)
+        if (clicon_msg_decode(reply, NULL, NULL, &xret, NULL) < 0)
             goto done;
     }
     if (xret0){
@@ -303,8 +315,8 @@ clicon_rpc_msg_persistent(clicon_handle      h,
  done:
     if (s >= 0)
         close(s);
-    if (retdata)
-        free(retdata);
+    if (reply)
+        free(reply);
     if (xret)
         xml_free(xret);
     return retval;
@@ -382,6 +394,48 @@ clicon_rpc_netconf(clicon_handle  h,
     return retval;
 }
 
+/*! Bind yang to reply of netconf rpc, replace reply with error if binding fails
+ * @param[in]     h       clicon handle
+ * @param[in]     rpcname Name of rpc of request
+ * @param[in,out] xret    Return XML netconf tree
+ * @retval        0       OK
+ * @retval       -1       Error
+ */
+static int
+clicon_rpc_reply_bind(clicon_handle h,
+                      char         *rpcname,
+                      cxobj        *xret)
+{
+    int        retval = -1;
+    cxobj     *xreply;
+    cxobj     *xerr = NULL;
+    cxobj     *xc;
+    yang_stmt *yspec;
+    int        ret;
+
+    if (xret != NULL &&
+        (xreply = xml_find_type(xret, NULL, "rpc-reply", CX_ELMNT)) != NULL &&
+        xml_find_type(xreply, NULL, "rpc-error", CX_ELMNT) == NULL){
+        yspec = clicon_dbspec_yang(h);
+        /* Here use rpc name to bind to yang */
+        if ((ret = xml_bind_yang_rpc_reply(xreply, rpcname, yspec, &xerr)) < 0)
+            goto done;
+        if (ret == 0){
+            /* Replace reply with error */
+            if ((xc = xml_child_i(xret, 0)) != NULL)
+                xml_purge(xc);
+            if (xml_addsub(xret, xerr) < 0)
+                goto done;
+            xerr = NULL;
+        }
+    }
+    retval = 0;
+ done:
+    if (xerr)
+        xml_free(xerr);
+    return retval;
+}
+
 /*! Generic xml netconf clicon rpc
  * Want to go over to use netconf directly between client and server,...
  * @param[in]  h       clicon handle
@@ -410,10 +464,8 @@ clicon_rpc_netconf_xml(clicon_handle  h,
     cbuf      *cb = NULL;
     cxobj     *xname;
     char      *rpcname;
-    cxobj     *xreply;
-    yang_stmt *yspec;
-    cxobj     *xerr = NULL;
-    int        ret;
+    uint32_t   session_id;
+    struct clicon_msg *msg = NULL;
 
     if ((cb = cbuf_new()) == NULL){
         clicon_err(OE_XML, errno, "cbuf_new");
@@ -424,37 +476,137 @@ clicon_rpc_netconf_xml(clicon_handle  h,
         goto done;
     }
     rpcname = xml_name(xname); /* Store rpc name and use in yang binding after reply */
-    if (clixon_xml2cbuf(cb, xml, 0, 0, -1, 0) < 0)
+    if (session_id_check(h, &session_id) < 0)
         goto done;
-    if (clicon_rpc_netconf(h, cbuf_get(cb), xret, sp) < 0)
+    if (clicon_rpc_binary(h)){ /* Send tree as is, no XML print and parse */
+        if ((msg = clicon_msg_encode_bin(session_id, xml)) == NULL)
+            goto done;
+        if (sp){
+            if (clicon_rpc_msg_persistent(h, msg, xret, sp) < 0)
+                goto done;
+        }
+        else if (clicon_rpc_msg(h, msg, xret) < 0)
+            goto done;
+    }
+    else {
+        if (clixon_xml2cbuf(cb, xml, 0, 0, -1, 0) < 0)
+            goto done;
+        if (clicon_rpc_netconf(h, cbuf_get(cb), xret, sp) < 0)
+            goto done;
+    }
+    if (clicon_rpc_reply_bind(h, rpcname, *xret) < 0)
         goto done;
-    if ((xreply = xml_find_type(*xret, NULL, "rpc-reply", CX_ELMNT)) != NULL &&
-        xml_find_type(xreply, NULL, "rpc-error", CX_ELMNT) == NULL){
-        yspec = clicon_dbspec_yang(h);
-        /* Here use rpc name to bind to yang */
-        if ((ret = xml_bind_yang_rpc_reply(xreply, rpcname, yspec, &xerr)) < 0) 
+    retval = 0;
+ done:
+    if (msg)
+        free(msg);
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Send xml netconf rpc to backend without waiting for reply
+ *
+ * Used for pipelining: several requests may be sent before the replies are read with
+ * clicon_rpc_netconf_xml_recv. The backend handles requests of a session in order, so
+ * the replies are received in the same order as the requests are sent.
+ * @param[in]  h       clicon handle
+ * @param[in]  xml     XML netconf tree
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @note Replies must be small, or the backend may block on sending replies while the client
+ *       blocks on sending requests. Limit the number of outstanding requests.
+ * @see clicon_rpc_netconf_xml_recv
+ */
+int
+clicon_rpc_netconf_xml_send(clicon_handle h,
+                            cxobj        *xml)
+{
+    int                retval = -1;
+    cbuf              *cb = NULL;
+    uint32_t           session_id;
+    struct clicon_msg *msg = NULL;
+    int                s;
+
+    if (session_id_check(h, &session_id) < 0)
+        goto done;
+    if (clicon_rpc_binary(h)){
+        if ((msg = clicon_msg_encode_bin(session_id, xml)) == NULL)
+            goto done;
+    }
+    else {
+        if ((cb = cbuf_new()) == NULL){
+            clicon_err(OE_XML, errno, "cbuf_new");
             goto done;
-        if (ret == 0){
-            /* Replace reply with error */
-            if (*xret) {
-                cxobj *xc;
-                if ((xc = xml_child_i(*xret, 0)) != NULL)
-                    xml_purge(xc);
-                if (xml_addsub(*xret, xerr) < 0)
-                    goto done;
-                xerr = NULL;
-            }
         }
+        if (clixon_xml2cbuf(cb, xml, 0, 0, -1, 0) < 0)
+            goto done;
+        if ((msg = clicon_msg_encode(session_id, "%s", cbuf_get(cb))) == NULL)
+            goto done;
+    }
+    if ((s = clicon_client_socket_get(h)) < 0){
+        if (clicon_rpc_connect(h, &s) < 0)
+            goto done;
+        clicon_client_socket_set(h, s);
+    }
+    if (clicon_msg_send(s, msg) < 0){
+        close(s);
+        clicon_client_socket_set(h, -1);
+        goto done;
     }
     retval = 0;
  done:
-    if (xerr)
-        xml_free(xerr);
+    if (msg)
+        free(msg);
     if (cb)
         cbuf_free(cb);
     return retval;
 }
 
+/*! Receive reply of xml netconf rpc sent with clicon_rpc_netconf_xml_send
+ *
+ * @param[in]  h       clicon handle
+ * @param[in]  rpcname Name of rpc of request, used to bind yang to reply
+ * @param[out] xret    Return XML netconf tree, error or OK
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @note There is no reconnect if the backend has closed the socket, since outstanding requests
+ *       are lost.
+ * @see clicon_rpc_netconf_xml_send
+ */
+int
+clicon_rpc_netconf_xml_recv(clicon_handle h,
+                            char         *rpcname,
+                            cxobj       **xret)
+{
+    int                retval = -1;
+    struct clicon_msg *reply = NULL;
+    int                eof = 0;
+    int                s;
+
+    if ((s = clicon_client_socket_get(h)) < 0){
+        clicon_err(OE_PROTO, ENOTCONN, "No outstanding request");
+        goto done;
+    }
+    if (clicon_msg_rcv(s, &reply, &eof) < 0 || eof){
+        close(s);
+        clicon_client_socket_set(h, -1);
+        clicon_data_del(h, "sock-binary");
+        if (eof)
+            clicon_err(OE_PROTO, ESHUTDOWN, "Unexpected close of CLICON_SOCK. Clixon backend daemon may have crashed.");
+        goto done;
+    }
+    if (clicon_msg_decode(reply, NULL, NULL, xret, NULL) < 0)
+        goto done;
+    if (clicon_rpc_reply_bind(h, rpcname, *xret) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (reply)
+        free(reply);
+    return retval;
+}
+
 /*! Get database configuration
  * Same as clicon_proto_change just with a cvec instead of lvec
  * @param[in]  h        CLICON handle
@@ -1134,6 +1286,110 @@ clicon_rpc_get_pageable_list(clicon_handle   h,
     return retval;
 }
 
+/*! Get values of a leaf or leaf-list in a datastore, eg for CLI expansion
+ *
+ * Only values starting with prefix are returned, and at most limit values. Values in
+ * exact are also returned if they exist.
+ * @param[in]  h         Clicon handle
+ * @param[in]  db        Name of datastore, eg "running"
+ * @param[in]  xpath     XPath selecting leaf or leaf-list nodes
+ * @param[in]  nsc       Namespace context for xpath
+ * @param[in]  prefix    Value prefix, or NULL
+ * @param[in]  exact     Vector of string values, or NULL
+ * @param[in]  limit     Max number of values, 0 means unbounded
+ * @param[out] xt        XML tree. Free with xml_free. 
+ *                       Either <rpc-reply> with <value> children or <rpc-error>. 
+ * @retval     0         OK
+ * @retval    -1         Error, fatal or xml
+ * @code
+ *   cxobj *xt = NULL;
+ *   cxobj *x = NULL;
+ *   if (clicon_rpc_expand_values(h, "running", "/ex:a/ex:b", nsc, "x", NULL, 100, &xt) < 0)
+ *      err;
+ *   if ((xerr = xpath_first(xt, NULL, "rpc-error")) != NULL)
+ *      err;
+ *   while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL)
+ *      value = xml_body(x);
+ *   xml_free(xt);
+ * @endcode
+ */
+int
+clicon_rpc_expand_values(clicon_handle h, 
+                         char         *db,
+                         char         *xpath,
+                         cvec         *nsc,
+                         char         *prefix,
+                         cvec         *exact,
+                         uint32_t      limit,
+                         cxobj       **xt)
+{
+    int                retval = -1;
+    struct clicon_msg *msg = NULL;
+    cbuf              *cb = NULL;
+    cxobj             *xret = NULL;
+    cxobj             *xd;
+    cg_var            *cv = NULL;
+    char              *username;
+    uint32_t           session_id;
+    
+    if (session_id_check(h, &session_id) < 0)
+        goto done;
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "<rpc xmlns=\"%s\"", NETCONF_BASE_NAMESPACE);
+    if ((username = clicon_username_get(h)) != NULL)
+        cprintf(cb, " username=\"%s\"", username);
+    cprintf(cb, " %s", NETCONF_MESSAGE_ID_ATTR);
+    cprintf(cb, "><expand-values xmlns=\"%s\">", CLIXON_LIB_NS);
+    cprintf(cb, "<datastore>%s</datastore>", db);
+    cprintf(cb, "<xpath");
+    if (xml_nsctx_cbuf(cb, nsc) < 0)
+        goto done;
+    cprintf(cb, ">");
+    if (xml_chardata_cbuf_append(cb, xpath) < 0)
+        goto done;
+    cprintf(cb, "</xpath>");
+    if (prefix && strlen(prefix)){
+        cprintf(cb, "<prefix>");
+        if (xml_chardata_cbuf_append(cb, prefix) < 0)
+            goto done;
+        cprintf(cb, "</prefix>");
+    }
+    while (exact && (cv = cvec_each(exact, cv)) != NULL){
+        cprintf(cb, "<exact>");
+        if (xml_chardata_cbuf_append(cb, cv_string_get(cv)) < 0)
+            goto done;
+        cprintf(cb, "</exact>");
+    }
+    if (limit)
+        cprintf(cb, "<limit>%u</limit>", limit);
+    cprintf(cb, "</expand-values></rpc>");
+    if ((msg = clicon_msg_encode(session_id, "%s", cbuf_get(cb))) == NULL)
+        goto done;
+    if (clicon_rpc_msg(h, msg, &xret) < 0)
+        goto done;
+    if ((xd = xpath_first(xret, NULL, "/rpc-reply")) == NULL){
+        clicon_err(OE_XML, 0, "rpc-reply expected"); 
+        goto done;
+    }
+    if (xt){
+        if (xml_rm(xd) < 0)
+            goto done;
+        *xt = xd;
+    }
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    if (xret)
+        xml_free(xret);
+    if (msg)
+        free(msg);
+    return retval;
+}
+
 /*! Send a close a netconf user session. Socket is also closed if still open
  *
  * @param[in] h        CLICON handle
@@ -1585,12 +1841,17 @@ clicon_hello_req(clicon_handle h,
     char              *username;
     char              *b;
     int                ret;
+    int                binary;
 
     username = clicon_username_get(h);
-    if ((msg = clicon_msg_encode(0, "<hello username=\"%s\" xmlns=\"%s\"><capabilities><capability>%s</capability></capabilities></hello>",
+    binary = clicon_option_bool(h, "CLICON_SOCK_BINARY");
+    if ((msg = clicon_msg_encode(0, "<hello username=\"%s\" xmlns=\"%s\"><capabilities><capability>%s</capability>%s%s%s</capabilities></hello>",
                                  username?username:"",
                                  NETCONF_BASE_NAMESPACE,
-                                 NETCONF_BASE_CAPABILITY_1_1)) == NULL)
+                                 NETCONF_BASE_CAPABILITY_1_1,
+                                 binary?"<capability>":"",
+                                 binary?CLIXON_BIN_CAPABILITY:"",
+                                 binary?"</capability>":"")) == NULL)
         goto done;
     if (clicon_rpc_msg(h, msg, &xret) < 0)
         goto done;
@@ -1598,6 +1859,11 @@ clicon_hello_req(clicon_handle h,
         clixon_netconf_error(xerr, "Hello", NULL);
         goto done;
     }
+    /* Binary encoding if backend also announces it */
+    clicon_data_del(h, "sock-binary");
+    if (binary &&
+        xpath_first(xret, NULL, "hello/capabilities[capability='%s']", CLIXON_BIN_CAPABILITY) != NULL)
+        clicon_data_set(h, "sock-binary", "1");
     if ((x = xpath_first(xret, NULL, "hello/session-id")) == NULL){
         clicon_err(OE_XML, 0, "hello session-id");
         goto done;
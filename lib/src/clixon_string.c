@@ -387,6 +387,264 @@ uri_percent_decode(char  *enc,
     return retval;
 }
 
+/*
+ * Vectorized scanning of character data
+ * Find the first character in a small stop-set, or the first non-whitespace character,
+ * 16 (SSE2) or 32 (AVX2) bytes at a time. SSE2 is baseline on x86-64, AVX2 is selected at
+ * runtime if the CPU supports it. Other architectures use the scalar loop.
+ */
+#if defined(__SSE2__) && (defined(__GNUC__) || defined(__clang__))
+#define CLIXON_SPAN_SSE2
+#include <emmintrin.h>
+#ifdef __x86_64__
+#define CLIXON_SPAN_AVX2
+#include <immintrin.h>
+#endif
+#endif
+
+/* Shorter strings are always scanned with the scalar loop */
+#define SPAN_VECTOR_MIN 16
+
+typedef size_t (str_span_fn)(const char *str, size_t len, const unsigned char *stop, int ctrl);
+typedef size_t (str_ws_span_fn)(const char *str, size_t len, int *nl);
+
+static size_t
+str_span_scalar(const char          *str,
+                size_t               len,
+                const unsigned char *stop,
+                int                  ctrl)
+{
+    size_t        i;
+    unsigned char c;
+
+    for (i=0; i<len; i++){
+        c = str[i];
+        if (c == stop[0] || c == stop[1] || c == stop[2] || c == stop[3] ||
+            (ctrl && c < 0x20))
+            break;
+    }
+    return i;
+}
+
+static size_t
+str_ws_span_scalar(const char *str,
+                   size_t      len,
+                   int        *nl)
+{
+    size_t i;
+
+    for (i=0; i<len; i++){
+        if (str[i] == '\n')
+            (*nl)++;
+        else if (str[i] != ' ' && str[i] != '\t' && str[i] != '\r')
+            break;
+    }
+    return i;
+}
+
+#ifdef CLIXON_SPAN_SSE2
+static size_t
+str_span_sse2(const char          *str,
+              size_t               len,
+              const unsigned char *stop,
+              int                  ctrl)
+{
+    size_t  i;
+    __m128i s0 = _mm_set1_epi8(stop[0]);
+    __m128i s1 = _mm_set1_epi8(stop[1]);
+    __m128i s2 = _mm_set1_epi8(stop[2]);
+    __m128i s3 = _mm_set1_epi8(stop[3]);
+    __m128i c1f = _mm_set1_epi8(0x1f);
+    __m128i v;
+    __m128i m;
+    int     mask;
+
+    for (i=0; i+16 <= len; i+=16){
+        v = _mm_loadu_si128((const __m128i *)(str+i));
+        m = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, s0), _mm_cmpeq_epi8(v, s1)),
+                         _mm_or_si128(_mm_cmpeq_epi8(v, s2), _mm_cmpeq_epi8(v, s3)));
+        if (ctrl) /* unsigned v <= 0x1f */
+            m = _mm_or_si128(m, _mm_cmpeq_epi8(_mm_min_epu8(v, c1f), v));
+        if ((mask = _mm_movemask_epi8(m)) != 0)
+            return i + __builtin_ctz(mask);
+    }
+    return i + str_span_scalar(str+i, len-i, stop, ctrl);
+}
+
+static size_t
+str_ws_span_sse2(const char *str,
+                 size_t      len,
+                 int        *nl)
+{
+    size_t   i;
+    __m128i  sp = _mm_set1_epi8(' ');
+    __m128i  ht = _mm_set1_epi8('\t');
+    __m128i  lf = _mm_set1_epi8('\n');
+    __m128i  cr = _mm_set1_epi8('\r');
+    __m128i  v;
+    __m128i  l;
+    unsigned ws;
+    unsigned lines;
+    unsigned mask;
+
+    for (i=0; i+16 <= len; i+=16){
+        v = _mm_loadu_si128((const __m128i *)(str+i));
+        l = _mm_cmpeq_epi8(v, lf);
+        ws = _mm_movemask_epi8(_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, sp), _mm_cmpeq_epi8(v, ht)),
+                                            _mm_or_si128(_mm_cmpeq_epi8(v, cr), l)));
+        lines = _mm_movemask_epi8(l);
+        if ((mask = ~ws & 0xffff) != 0){
+            mask = __builtin_ctz(mask);
+            *nl += __builtin_popcount(lines & ((1U << mask) - 1));
+            return i + mask;
+        }
+        *nl += __builtin_popcount(lines);
+    }
+    return i + str_ws_span_scalar(str+i, len-i, nl);
+}
+#endif /* CLIXON_SPAN_SSE2 */
+
+#ifdef CLIXON_SPAN_AVX2
+__attribute__((target("avx2")))
+static size_t
+str_span_avx2(const char          *str,
+              size_t               len,
+              const unsigned char *stop,
+              int                  ctrl)
+{
+    size_t   i;
+    __m256i  s0 = _mm256_set1_epi8(stop[0]);
+    __m256i  s1 = _mm256_set1_epi8(stop[1]);
+    __m256i  s2 = _mm256_set1_epi8(stop[2]);
+    __m256i  s3 = _mm256_set1_epi8(stop[3]);
+    __m256i  c1f = _mm256_set1_epi8(0x1f);
+    __m256i  v;
+    __m256i  m;
+    unsigned mask;
+
+    for (i=0; i+32 <= len; i+=32){
+        v = _mm256_loadu_si256((const __m256i *)(str+i));
+        m = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, s0), _mm256_cmpeq_epi8(v, s1)),
+                            _mm256_or_si256(_mm256_cmpeq_epi8(v, s2), _mm256_cmpeq_epi8(v, s3)));
+        if (ctrl)
+            m = _mm256_or_si256(m, _mm256_cmpeq_epi8(_mm256_min_epu8(v, c1f), v));
+        if ((mask = _mm256_movemask_epi8(m)) != 0)
+            return i + __builtin_ctz(mask);
+    }
+    return i + str_span_sse2(str+i, len-i, stop, ctrl);
+}
+
+__attribute__((target("avx2")))
+static size_t
+str_ws_span_avx2(const char *str,
+                 size_t      len,
+                 int        *nl)
+{
+    size_t   i;
+    __m256i  sp = _mm256_set1_epi8(' ');
+    __m256i  ht = _mm256_set1_epi8('\t');
+    __m256i  lf = _mm256_set1_epi8('\n');
+    __m256i  cr = _mm256_set1_epi8('\r');
+    __m256i  v;
+    __m256i  l;
+    unsigned ws;
+    unsigned lines;
+    unsigned mask;
+
+    for (i=0; i+32 <= len; i+=32){
+        v = _mm256_loadu_si256((const __m256i *)(str+i));
+        l = _mm256_cmpeq_epi8(v, lf);
+        ws = _mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, sp), _mm256_cmpeq_epi8(v, ht)),
+                                                  _mm256_or_si256(_mm256_cmpeq_epi8(v, cr), l)));
+        lines = _mm256_movemask_epi8(l);
+        if ((mask = ~ws) != 0){
+            mask = __builtin_ctz(mask);
+            *nl += __builtin_popcount(lines & ((1U << mask) - 1));
+            return i + mask;
+        }
+        *nl += __builtin_popcount(lines);
+    }
+    return i + str_ws_span_sse2(str+i, len-i, nl);
+}
+#endif /* CLIXON_SPAN_AVX2 */
+
+static str_span_fn    *str_span_impl = NULL;
+static str_ws_span_fn *str_ws_span_impl = NULL;
+
+/*! Select scan functions for this CPU
+ */
+static void
+str_span_init(void)
+{
+#if defined(CLIXON_SPAN_AVX2)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")){
+        str_ws_span_impl = str_ws_span_avx2;
+        str_span_impl = str_span_avx2;
+        return;
+    }
+#endif
+#ifdef CLIXON_SPAN_SSE2
+    str_ws_span_impl = str_ws_span_sse2;
+    str_span_impl = str_span_sse2;
+#else
+    str_ws_span_impl = str_ws_span_scalar;
+    str_span_impl = str_span_scalar;
+#endif
+}
+
+/*! Return length of initial segment of a string not containing any stop character
+ *
+ * Used to find runs of characters needing no escaping or special treatment, which can then
+ * be copied in bulk.
+ * @param[in]  str   String, not necessarily null-terminated
+ * @param[in]  len   Length of string
+ * @param[in]  stop  Stop characters, at most 4
+ * @param[in]  ctrl  If set, also stop at control characters (< 0x20)
+ * @retval     n     Index of first stop character, or len if none
+ * @code
+ *   n = clixon_str_span(str, strlen(str), "&<>", 0);
+ * @endcode
+ */
+size_t
+clixon_str_span(const char *str,
+                size_t      len,
+                const char *stop,
+                int         ctrl)
+{
+    unsigned char s[4];
+    int           i;
+
+    for (i=0; i<4 && stop[i]; i++)
+        s[i] = stop[i];
+    for (; i<4; i++) /* Pad with first stop character */
+        s[i] = stop[0];
+    if (len < SPAN_VECTOR_MIN)
+        return str_span_scalar(str, len, s, ctrl);
+    if (str_span_impl == NULL)
+        str_span_init();
+    return str_span_impl(str, len, s, ctrl);
+}
+
+/*! Return length of initial whitespace (space, tab, CR, LF) segment of a string
+ *
+ * @param[in]  str   String, not necessarily null-terminated
+ * @param[in]  len   Length of string
+ * @param[out] nl    Incremented with number of newlines in the segment
+ * @retval     n     Index of first non-whitespace character, or len if none
+ */
+size_t
+clixon_str_ws_span(const char *str,
+                   size_t      len,
+                   int        *nl)
+{
+    if (len < SPAN_VECTOR_MIN)
+        return str_ws_span_scalar(str, len, nl);
+    if (str_ws_span_impl == NULL)
+        str_span_init();
+    return str_ws_span_impl(str, len, nl);
+}
+
 /*! Escape characters according to XML definition
  * @param[out]  encp   Encoded malloced output string
  * @param[in]   fmt    Not-encoded input string (stdarg format string)
@@ -408,7 +666,7 @@ uri_percent_decode(char  *enc,
  *     " -> "&quot;"  may
  * @see https://www.w3.org/TR/2008/REC-xml-20081126/#syntax chapter 2.6
  * @see uri_percent_encode
- * @see AMPERSAND mode in clixon_xml_parse.l, implicit decoding
+ * @see xml_sax_entity in clixon_xml_sax.c, implicit decoding
  * @see xml_chardata_cbuf_append for a specialized version
  */
 int
@@ -419,12 +677,8 @@ xml_chardata_encode(char      **escp,
     char   *str = NULL;  /* Expanded format string w stdarg */
     int     fmtlen;
     char   *esc = NULL;
-    int     l;
-    int     len;
-    int     i, j;
-    int     cdata; /* when set, skip encoding */
+    cbuf   *cb = NULL;
     va_list args;
-    size_t  slen;
     
     /* Two steps: (1) read in the complete format string */
     va_start(args, fmt); /* dryrun */
@@ -441,94 +695,23 @@ xml_chardata_encode(char      **escp,
     /* Now str is the combined fmt + ... */
 
     /* Step (2) encode and expand str --> enc */
-    /* First compute length (do nothing) */
-    len = 0; cdata = 0;
-    slen = strlen(str);
-    for (i=0; i<slen; i++){
-        if (cdata){
-            if (strncmp(&str[i], "]]>", strlen("]]>")) == 0)
-                cdata = 0;
-            len++;
-        }
-        else
-            switch (str[i]){
-            case '&':
-                len += strlen("&amp;");
-                break;
-            case '<':
-                if (strncmp(&str[i], "<![CDATA[", strlen("<![CDATA[")) == 0){
-                    len++;
-                    cdata++;
-                }
-                else
-                    len += strlen("&lt;");
-                break;
-            case '>':
-                len += strlen("&gt;");
-                break;
-            default:
-                len++;
-            }
-    }
-    len++; /* trailing \0 */
-    /* We know length, allocate encoding buffer  */
-    if ((esc = malloc(len)) == NULL){
-        clicon_err(OE_UNIX, errno, "malloc"); 
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
         goto done;
     }
-    memset(esc, 0, len);
-
-    /* Same code again, but now actually encode into output buffer */
-    j = 0; cdata = 0;
-    slen = strlen(str);
-    for (i=0; i<slen; i++){
-        if (cdata){
-            if (strncmp(&str[i], "]]>", strlen("]]>")) == 0){
-                cdata = 0;
-                esc[j++] = str[i++];
-                esc[j++] = str[i++];
-            }
-            esc[j++] = str[i];
-        }
-        else
-        switch (str[i]){
-        case '&':
-            if ((l=snprintf(&esc[j], 6, "&amp;")) < 0){
-                clicon_err(OE_UNIX, errno, "snprintf");
-                goto done;
-            }
-            j += l;
-            break;
-        case '<':
-            if (strncmp(&str[i], "<![CDATA[", strlen("<![CDATA[")) == 0){
-                esc[j++] = str[i];
-                cdata++;
-                break;
-            }
-            if ((l=snprintf(&esc[j], 5, "&lt;")) < 0){
-                clicon_err(OE_UNIX, errno, "snprintf");
-                goto done;
-            }
-            j += l;
-            break;
-        case '>':
-            if ((l=snprintf(&esc[j], 5, "&gt;")) < 0){
-                clicon_err(OE_UNIX, errno, "snprintf");
-                goto done;
-            }
-            j += l;
-            break;
-        default:
-            esc[j++] = str[i];
-        }
+    if (xml_chardata_cbuf_append(cb, str) < 0)
+        goto done;
+    if ((esc = strdup(cbuf_get(cb))) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto done;
     }
     *escp = esc;
     retval = 0;
  done:
     if (str)
         free(str);
-    if (retval < 0 && esc)
-        free(esc);
+    if (cb)
+        cbuf_free(cb);
     return retval;
 }
 
@@ -542,48 +725,51 @@ int
 xml_chardata_cbuf_append(cbuf *cb,
                          char *str)
 {
-    int  retval = -1;
-    int  i;
-    int  cdata; /* when set, skip encoding */
+    int    retval = -1;
+    char  *p = str;
+    char  *end;
+    char  *s;
     size_t len;
 
-    /* The orignal of this code is in xml_chardata_encode */
-    /* Step: encode and expand str --> enc */
-    /* Same code again, but now actually encode into output buffer */
-    cdata = 0;
-
-    len = strlen(str);
-    for (i=0; i<len; i++){
-        if (cdata){
-            if (strncmp(&str[i], "]]>", strlen("]]>")) == 0){
-                cdata = 0;
-                cbuf_append(cb, str[i++]);
-                cbuf_append(cb, str[i++]);
+    end = str + strlen(str);
+    while (p < end){
+        /* Copy run of characters needing no encoding in bulk */
+        if ((len = clixon_str_span(p, end-p, "&<>", 0)) > 0){
+            if (cbuf_append_buf(cb, p, len) < 0){
+                clicon_err(OE_UNIX, errno, "cbuf_append_buf");
+                goto done;
             }
-            cbuf_append(cb, str[i]);
+            if ((p += len) == end)
+                break;
         }
-        else
-        switch (str[i]){
+        switch (*p){
         case '&':
             cbuf_append_str(cb, "&amp;");
             break;
         case '<':
-            if (strncmp(&str[i], "<![CDATA[", strlen("<![CDATA[")) == 0){
-                cbuf_append(cb, str[i]);
-                cdata++;
-                break;
+            if (strncmp(p, "<![CDATA[", strlen("<![CDATA[")) == 0){
+                /* Skip encoding of CDATA section */
+                if ((s = strstr(p, "]]>")) != NULL)
+                    s += strlen("]]>");
+                else
+                    s = end;
+                if (cbuf_append_buf(cb, p, s-p) < 0){
+                    clicon_err(OE_UNIX, errno, "cbuf_append_buf");
+                    goto done;
+                }
+                p = s;
+                continue;
             }
             cbuf_append_str(cb, "&lt;");
             break;
         case '>':
             cbuf_append_str(cb, "&gt;");
             break;
-        default:
-            cbuf_append(cb, str[i]);
         }
+        p++;
     }
     retval = 0;
-    // done:
+ done:
     return retval;
 }
 
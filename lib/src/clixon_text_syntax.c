@@ -377,7 +377,7 @@ text_populate_list(cxobj *xn)
  * @retval        1   OK and valid
  * @retval        0   Invalid (only if yang spec)
  * @retval       -1   Error with clicon_err called
- * @see _xml_parse for XML variant
+ * @see clixon_xml_parse_buf for XML variant
  * @note Parsing requires YANG, which means yb must be YB_MODULE/_NEXT
  */
 static int 
@@ -73,12 +73,14 @@
 #include "clixon_xml_io.h"
 #include "clixon_xpath_ctx.h"
 #include "clixon_xpath.h"
+#include "clixon_xpath_compile.h"
 #include "clixon_yang_module.h"
 #include "clixon_yang_type.h"
 #include "clixon_xml_default.h"
 #include "clixon_xml_map.h"
 #include "clixon_xml_bind.h"
 #include "clixon_validate_minmax.h"
+#include "clixon_validate_workers.h"
 #include "clixon_validate.h"
 
 /*! Validate xml node of type leafref, ensure the value is one of that path's reference
@@ -1161,29 +1163,23 @@ xml_yang_validate_leaf_union(clicon_handle h,
     goto done;
 }
 
-/*! Validate a single XML node with yang specification for all (not only added) entries
- * 1. Check leafrefs. Eg you delete a leaf and a leafref references it.
- * @param[in]  xt  XML node to be validated
+/*! Validate a single XML node with yang specification, not its children
+ *
+ * Checks when, mandatory children, leafref, identityref, union and must of the node itself.
+ * Used for full validation, and to revalidate nodes affected by a change
+ * @param[in]  h     Clicon handle
+ * @param[in]  xt    XML node to be validated
  * @param[out] xret  Error XML tree (if retval=0). Free with xml_free after use
+ * @retval     2     Validation OK, but do not descend into children (eg anydata)
  * @retval     1     Validation OK
- * @retval     0     Validation failed (cbret set)
+ * @retval     0     Validation failed (xret set)
  * @retval    -1     Error
- * @code
- *   cxobj *x;
- *   cbuf *xret = NULL;
- *   if ((ret = xml_yang_validate_all(h, x, &xret)) < 0)
- *      err;
- *   if (ret == 0)
- *      fail;
- *   xml_free(xret);
- * @endcode
- * @see xml_yang_validate_add
- * @see xml_yang_validate_rpc
+ * @see xml_yang_validate_all  Recursive validation
  */
 int
-xml_yang_validate_all(clicon_handle h,
-                      cxobj        *xt, 
-                      cxobj       **xret)
+xml_yang_validate_node(clicon_handle h,
+                       cxobj        *xt, 
+                       cxobj       **xret)
 {
     int        retval = -1;
     yang_stmt *yt;  /* yang node associated with xt */
@@ -1192,12 +1188,12 @@ xml_yang_validate_all(clicon_handle h,
     char      *xpath;
     int        nr;
     int        ret;
-    cxobj     *x;
     cxobj     *xp;
     char      *ns = NULL;
     cbuf      *cb = NULL;
     cvec      *nsc = NULL;
     int        hit = 0;
+    xpath_compiled *xpc;
 
     /* if not given by argument (overide) use default link 
        and !Node has a config sub-statement and it is false */
@@ -1206,7 +1202,7 @@ xml_yang_validate_all(clicon_handle h,
             clicon_log(LOG_WARNING,
                        "%s: %d: No YANG spec for %s, validation skipped",
                        __FUNCTION__, __LINE__, xml_name(xt));
-            goto ok;
+            goto skip;
         }
         if ((cb = cbuf_new()) == NULL){
             clicon_err(OE_UNIX, errno, "cbuf_new");
@@ -1248,7 +1244,7 @@ xml_yang_validate_all(clicon_handle h,
         switch (yang_keyword_get(yt)){
         case Y_ANYXML:
         case Y_ANYDATA:
-            goto ok;
+            goto skip;
             break;
         case Y_LEAF:
             /* fall thru */
@@ -1292,10 +1288,16 @@ xml_yang_validate_all(clicon_handle h,
              * which the "must" statement is defined. 
              * The set of namespace declarations is the set of all "import" statements' 
              */
-           if (xml_nsctx_yang(yc, &nsc) < 0)
-               goto done;
-            if ((nr = xpath_vec_bool(xt, nsc, "%s", xpath)) < 0)
-                goto done;
+            if ((xpc = yang_xpath_compiled_get(yc)) != NULL){
+                if ((nr = xpath_compiled_bool(xpc, xt)) < 0)
+                    goto done;
+            }
+            else {
+                if (xml_nsctx_yang(yc, &nsc) < 0)
+                    goto done;
+                if ((nr = xpath_vec_bool(xt, nsc, "%s", xpath)) < 0)
+                    goto done;
+            }
             if (!nr){
                 ye = yang_find(yc, Y_ERROR_MESSAGE, NULL);
                 if ((cb = cbuf_new()) == NULL){
@@ -1315,6 +1317,56 @@ xml_yang_validate_all(clicon_handle h,
             }
         }
     }
+    retval = 1;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    if (nsc)
+        xml_nsctx_free(nsc);
+    return retval;
+ skip:
+    retval = 2;
+    goto done;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Validate a single XML node with yang specification for all (not only added) entries
+ * 1. Check leafrefs. Eg you delete a leaf and a leafref references it.
+ * Node checks are made by xml_yang_validate_node, then children are validated recursively.
+ * @param[in]  xt  XML node to be validated
+ * @param[out] xret  Error XML tree (if retval=0). Free with xml_free after use
+ * @retval     1     Validation OK
+ * @retval     0     Validation failed (cbret set)
+ * @retval    -1     Error
+ * @code
+ *   cxobj *x;
+ *   cbuf *xret = NULL;
+ *   if ((ret = xml_yang_validate_all(h, x, &xret)) < 0)
+ *      err;
+ *   if (ret == 0)
+ *      fail;
+ *   xml_free(xret);
+ * @endcode
+ * @see xml_yang_validate_add
+ * @see xml_yang_validate_rpc
+ */
+int
+xml_yang_validate_all(clicon_handle h,
+                      cxobj        *xt, 
+                      cxobj       **xret)
+{
+    int        retval = -1;
+    int        ret;
+    cxobj     *x;
+
+    if ((ret = xml_yang_validate_node(h, xt, xret)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    if (ret == 2)
+        goto ok;
     x = NULL;
     while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
         if ((ret = xml_yang_validate_all(h, x, xret)) < 0)
@@ -1323,7 +1375,7 @@ xml_yang_validate_all(clicon_handle h,
             goto fail;
     }
     /* Check unique and min-max after choice test for example*/
-    if (yang_config(yt) != 0){
+    if (yang_config(xml_spec(xt)) != 0){
         /* Checks if next level contains any unique list constraints */
         if ((ret = xml_yang_minmax_recurse(xt, xret)) < 0)
             goto done;
@@ -1333,10 +1385,6 @@ xml_yang_validate_all(clicon_handle h,
  ok:
     retval = 1;
  done:
-    if (cb)
-        cbuf_free(cb);
-    if (nsc)
-        xml_nsctx_free(nsc);
     return retval;
  fail:
     retval = 0;
@@ -1348,6 +1396,7 @@ xml_yang_validate_all(clicon_handle h,
  * @retval     1     Validation OK
  * @retval     0     Validation failed (xret set)
  * @retval    -1     Error
+ * If CLICON_VALIDATE_WORKERS is larger than one, large trees are validated by worker processes
  */
 int
 xml_yang_validate_all_top(clicon_handle h,
@@ -1356,7 +1405,10 @@ xml_yang_validate_all_top(clicon_handle h,
 {
     int    ret;
     cxobj *x;
+    int    workers;
 
+    if ((workers = clicon_option_int(h, "CLICON_VALIDATE_WORKERS")) > 1)
+        return xml_yang_validate_workers(h, xt, workers, xret);
     x = NULL;
     while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
         if ((ret = xml_yang_validate_all(h, x, xret)) < 1)
@@ -0,0 +1,827 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ *
+ * Incremental validation using a dependency graph of YANG constraints
+ * The graph is computed from the YANG specification and maps the names of schema nodes to
+ * constraints (must, when, leafref, unique) whose xpaths read such nodes. At commit, only
+ * constraints that may be affected by the changed nodes are revalidated.
+ * The dependencies are name-based and conservative: a constraint may be revalidated even if
+ * it is not affected, but never the reverse.
+ */
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <syslog.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clicon */
+#include "clixon_string.h"
+#include "clixon_queue.h"
+#include "clixon_hash.h"
+#include "clixon_handle.h"
+#include "clixon_err.h"
+#include "clixon_log.h"
+#include "clixon_yang.h"
+#include "clixon_xml.h"
+#include "clixon_data.h"
+#include "clixon_options.h"
+#include "clixon_xpath_ctx.h"
+#include "clixon_xpath.h"
+#include "clixon_yang_type.h"
+#include "clixon_xml_sort.h"
+#include "clixon_validate_minmax.h"
+#include "clixon_validate.h"
+#include "clixon_validate_deps.h"
+
+/* Name of dependency graph in clixon handle */
+#define VALIDATE_DEPS "validate-deps"
+
+/*! Constraint kind: what to revalidate when a dependency is touched
+ */
+enum validate_dep_kind{
+    VD_NODE,     /* Instances of the schema node: xml_yang_validate_node */
+    VD_CHILDREN, /* Parents of list instances: min/max and unique, xml_yang_minmax_recurse */
+};
+
+/*! A single constraint
+ */
+typedef struct {
+    yang_stmt *vd_ys;   /* Schema node of constraint (list for VD_CHILDREN) */
+    int        vd_kind; /* enum validate_dep_kind */
+} validate_dep;
+
+/*! Vector of constraints, value of name hash
+ */
+typedef struct {
+    validate_dep *dv_vec;
+    int           dv_len;
+} validate_depvec;
+
+/*! Dependency graph, stored in clixon handle
+ */
+typedef struct {
+    clicon_hash_t  *vg_names;  /* Name of schema node -> validate_depvec */
+    validate_depvec vg_global; /* Constraints that cannot be resolved by name, always checked */
+} validate_graph;
+
+/*! Add constraint to vector, unless it is already last
+ */
+static int
+depvec_add(validate_depvec *dv,
+           yang_stmt       *ys,
+           int              kind)
+{
+    int           retval = -1;
+    validate_dep *vd;
+
+    if (dv->dv_len > 0){
+        vd = &dv->dv_vec[dv->dv_len-1];
+        if (vd->vd_ys == ys && vd->vd_kind == kind)
+            goto ok;
+    }
+    if ((dv->dv_vec = realloc(dv->dv_vec, (dv->dv_len+1)*sizeof(validate_dep))) == NULL){
+        clicon_err(OE_UNIX, errno, "realloc");
+        goto done;
+    }
+    vd = &dv->dv_vec[dv->dv_len++];
+    vd->vd_ys = ys;
+    vd->vd_kind = kind;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Add constraint as dependent of a schema node name
+ */
+static int
+graph_name_add(validate_graph *vg,
+               const char     *name,
+               yang_stmt      *ys,
+               int             kind)
+{
+    int              retval = -1;
+    validate_depvec *dv;
+    validate_depvec  dv0 = {NULL, 0};
+
+    if ((dv = clicon_hash_value(vg->vg_names, name, NULL)) == NULL){
+        if (clicon_hash_add(vg->vg_names, name, &dv0, sizeof(dv0)) == NULL)
+            goto done;
+        if ((dv = clicon_hash_value(vg->vg_names, name, NULL)) == NULL){
+            clicon_err(OE_UNIX, ENOENT, "hash value %s not found", name);
+            goto done;
+        }
+    }
+    if (depvec_add(dv, ys, kind) < 0)
+        goto done;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Add constraint as dependent of all node names in a parsed xpath
+ *
+ * Wildcards, node() and deref() cannot be resolved by name, then global is set
+ */
+static int
+graph_xpath_add(validate_graph *vg,
+                xpath_tree     *xpt,
+                yang_stmt      *ys,
+                int             kind,
+                int            *global)
+{
+    int retval = -1;
+
+    if (xpt == NULL)
+        goto ok;
+    switch (xpt->xs_type){
+    case XP_NODE:
+        if (xpt->xs_s1 == NULL || strcmp(xpt->xs_s1, "*") == 0)
+            *global = 1;
+        else if (graph_name_add(vg, xpt->xs_s1, ys, kind) < 0)
+            goto done;
+        break;
+    case XP_NODE_FN:
+        if (xpt->xs_s0 == NULL || strcmp(xpt->xs_s0, "text") != 0)
+            *global = 1;
+        break;
+    case XP_PRIME_FN:
+        if (xpt->xs_s0 && strcmp(xpt->xs_s0, "deref") == 0)
+            *global = 1;
+        break;
+    default:
+        break;
+    }
+    if (graph_xpath_add(vg, xpt->xs_c0, ys, kind, global) < 0)
+        goto done;
+    if (graph_xpath_add(vg, xpt->xs_c1, ys, kind, global) < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Add constraint as dependent of an xpath string
+ */
+static int
+graph_xpath_str_add(validate_graph *vg,
+                    char           *xpath,
+                    yang_stmt      *ys,
+                    int             kind)
+{
+    int         retval = -1;
+    xpath_tree *xpt = NULL;
+    int         global = 0;
+
+    if (xpath_parse(xpath, &xpt) < 0)
+        goto done;
+    if (graph_xpath_add(vg, xpt, ys, kind, &global) < 0)
+        goto done;
+    if (global && depvec_add(&vg->vg_global, ys, kind) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (xpt)
+        xpath_tree_free(xpt);
+    return retval;
+}
+
+/*! Add leafref paths of a resolved type, also in unions
+ */
+static int
+graph_type_add(validate_graph *vg,
+               yang_stmt      *ys,
+               yang_stmt      *yrestype)
+{
+    int        retval = -1;
+    yang_stmt *ypath;
+    yang_stmt *ytsub = NULL;
+    yang_stmt *ytype;
+    char      *restype;
+
+    if (yrestype == NULL)
+        goto ok;
+    restype = yang_argument_get(yrestype);
+    if (strcmp(restype, "leafref") == 0){
+        if ((ypath = yang_find(yrestype, Y_PATH, NULL)) != NULL &&
+            graph_xpath_str_add(vg, yang_argument_get(ypath), ys, VD_NODE) < 0)
+            goto done;
+    }
+    else if (strcmp(restype, "union") == 0){
+        while ((ytsub = yn_each(yrestype, ytsub)) != NULL){
+            if (yang_keyword_get(ytsub) != Y_TYPE)
+                continue;
+            if (yang_type_resolve(ys, ys, ytsub, &ytype, NULL, NULL, NULL, NULL, NULL) < 0)
+                goto done;
+            if (graph_type_add(vg, ys, ytype) < 0)
+                goto done;
+        }
+    }
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Add when xpath of ys as dependency of ys and of all its data node ancestors
+ *
+ * A when condition is checked by the node itself, but also by mandatory checks of ancestors
+ */
+static int
+graph_when_add(validate_graph *vg,
+               yang_stmt      *ys,
+               char           *xpath)
+{
+    int        retval = -1;
+    yang_stmt *yp;
+
+    for (yp = ys; yp != NULL; yp = yang_parent_get(yp)){
+        if (yang_keyword_get(yp) == Y_MODULE || yang_keyword_get(yp) == Y_SUBMODULE)
+            break;
+        if (!yang_datanode(yp))
+            continue;
+        if (graph_xpath_str_add(vg, xpath, yp, VD_NODE) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Add unique constraint of a list: all names in unique schema node ids
+ */
+static int
+graph_unique_add(validate_graph *vg,
+                 yang_stmt      *ylist,
+                 yang_stmt      *yu)
+{
+    int     retval = -1;
+    cg_var *cv = NULL;
+    char  **vec = NULL;
+    int     nvec;
+    int     i;
+    char   *name;
+    char   *p;
+
+    while ((cv = cvec_each(yang_cvec_get(yu), cv)) != NULL){
+        if ((vec = clicon_strsep(cv_string_get(cv), "/", &nvec)) == NULL)
+            goto done;
+        for (i=0; i<nvec; i++){
+            name = vec[i];
+            if ((p = strchr(name, ':')) != NULL)
+                name = p+1;
+            if (strlen(name) && graph_name_add(vg, name, ylist, VD_CHILDREN) < 0)
+                goto done;
+        }
+        free(vec);
+        vec = NULL;
+    }
+    retval = 0;
+ done:
+    if (vec)
+        free(vec);
+    return retval;
+}
+
+/*! Recursively add constraints of a yang statement and its data children
+ */
+static int
+graph_yang_add(validate_graph *vg,
+               yang_stmt      *ys)
+{
+    int           retval = -1;
+    yang_stmt    *yc;
+    yang_stmt    *yrestype;
+    enum rfc_6020 keyw;
+    char         *xpath;
+
+    keyw = yang_keyword_get(ys);
+    switch (keyw){
+    case Y_CONTAINER:
+    case Y_LIST:
+    case Y_LEAF:
+    case Y_LEAF_LIST:
+    case Y_ANYXML:
+    case Y_ANYDATA:
+        if (yang_config(ys) == 0)
+            goto ok;
+        break;
+    case Y_CHOICE:
+    case Y_CASE:
+    case Y_MODULE:
+    case Y_SUBMODULE:
+        break;
+    default:
+        goto ok;
+        break;
+    }
+    if ((xpath = yang_when_xpath_get(ys)) != NULL &&
+        graph_when_add(vg, ys, xpath) < 0)
+        goto done;
+    if (keyw == Y_LEAF || keyw == Y_LEAF_LIST){
+        if (yang_type_get(ys, NULL, &yrestype, NULL, NULL, NULL, NULL, NULL) < 0)
+            goto done;
+        if (graph_type_add(vg, ys, yrestype) < 0)
+            goto done;
+    }
+    yc = NULL;
+    while ((yc = yn_each(ys, yc)) != NULL) {
+        switch (yang_keyword_get(yc)){
+        case Y_MUST:
+            if (graph_xpath_str_add(vg, yang_argument_get(yc), ys, VD_NODE) < 0)
+                goto done;
+            break;
+        case Y_WHEN:
+            if (graph_when_add(vg, ys, yang_argument_get(yc)) < 0)
+                goto done;
+            break;
+        case Y_UNIQUE:
+            if (graph_unique_add(vg, ys, yc) < 0)
+                goto done;
+            break;
+        default:
+            if (graph_yang_add(vg, yc) < 0)
+                goto done;
+            break;
+        }
+    }
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Free dependency graph
+ */
+static int
+validate_graph_free(validate_graph *vg)
+{
+    char           **keys = NULL;
+    size_t           klen = 0;
+    size_t           i;
+    validate_depvec *dv;
+
+    if (vg->vg_names){
+        if (clicon_hash_keys(vg->vg_names, &keys, &klen) == 0){
+            for (i=0; i<klen; i++){
+                dv = clicon_hash_value(vg->vg_names, keys[i], NULL);
+                if (dv && dv->dv_vec)
+                    free(dv->dv_vec);
+            }
+        }
+        if (keys)
+            free(keys);
+        clicon_hash_free(vg->vg_names);
+    }
+    if (vg->vg_global.dv_vec)
+        free(vg->vg_global.dv_vec);
+    free(vg);
+    return 0;
+}
+
+/*! Compute dependency graph of constraints from YANG spec and store it in handle
+ *
+ * Should be called when all YANG modules are loaded.
+ * @param[in]  h      Clicon handle
+ * @param[in]  yspec  Top-level YANG spec
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @see xml_yang_validate_changes  Uses the graph
+ * @see xml_yang_validate_deps_free
+ */
+int
+xml_yang_validate_deps_init(clicon_handle h,
+                            yang_stmt    *yspec)
+{
+    int             retval = -1;
+    validate_graph *vg = NULL;
+    yang_stmt      *ymod = NULL;
+
+    if ((vg = malloc(sizeof(*vg))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(vg, 0, sizeof(*vg));
+    if ((vg->vg_names = clicon_hash_init()) == NULL)
+        goto done;
+    while ((ymod = yn_each(yspec, ymod)) != NULL)
+        if (graph_yang_add(vg, ymod) < 0)
+            goto done;
+    if (xml_yang_validate_deps_free(h) < 0)
+        goto done;
+    if (clicon_ptr_set(h, VALIDATE_DEPS, vg) < 0)
+        goto done;
+    clicon_debug(1, "%s global:%d", __FUNCTION__, vg->vg_global.dv_len);
+    vg = NULL;
+    retval = 0;
+ done:
+    if (vg)
+        validate_graph_free(vg);
+    return retval;
+}
+
+/*! Free dependency graph of constraints in handle
+ * @param[in]  h      Clicon handle
+ */
+int
+xml_yang_validate_deps_free(clicon_handle h)
+{
+    validate_graph *vg = NULL;
+
+    if (clicon_ptr_get(h, VALIDATE_DEPS, (void**)&vg) == 0 && vg != NULL){
+        validate_graph_free(vg);
+        clicon_ptr_del(h, VALIDATE_DEPS);
+    }
+    return 0;
+}
+
+/*! Collect constraints depending on names of x and (optionally) its descendants
+ *
+ * Constraints are marked with YANG_FLAG_MARK (VD_NODE) or YANG_FLAG_TMP (VD_CHILDREN) to 
+ * avoid duplicates. Marks are reset by the caller
+ */
+static int
+changes_deps_collect(validate_graph  *vg,
+                     cxobj           *x,
+                     int              recurse,
+                     validate_depvec *deps)
+{
+    int              retval = -1;
+    validate_depvec *dv;
+    validate_dep    *vd;
+    uint16_t         flag;
+    cxobj           *xc;
+    int              i;
+
+    if ((dv = clicon_hash_value(vg->vg_names, xml_name(x), NULL)) != NULL){
+        for (i=0; i<dv->dv_len; i++){
+            vd = &dv->dv_vec[i];
+            flag = vd->vd_kind==VD_NODE?YANG_FLAG_MARK:YANG_FLAG_TMP;
+            if (yang_flag_get(vd->vd_ys, flag))
+                continue;
+            yang_flag_set(vd->vd_ys, flag);
+            if (depvec_add(deps, vd->vd_ys, vd->vd_kind) < 0)
+                goto done;
+        }
+    }
+    if (recurse){
+        xc = NULL;
+        while ((xc = xml_child_each(x, xc, CX_ELMNT)) != NULL)
+            if (changes_deps_collect(vg, xc, recurse, deps) < 0)
+                goto done;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Find all instances of schema node ys in a sorted target tree
+ *
+ * Descends the data node ancestors of ys from the top using binary search.
+ * @param[in]  xt      Top of target tree, sorted
+ * @param[in]  ys      Schema node. If no data node ancestor, the top node itself
+ * @param[out] vecp    Vector of instances, free with free()
+ * @param[out] veclenp Length of vec
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+changes_instances(cxobj      *xt,
+                  yang_stmt  *ys,
+                  cxobj    ***vecp,
+                  int        *veclenp)
+{
+    int          retval = -1;
+    yang_stmt   *yp;
+    yang_stmt  **chain = NULL;
+    int          chainlen = 0;
+    cxobj      **vec = NULL;
+    int          veclen = 0;
+    cxobj      **vec1;
+    int          veclen1;
+    int          i;
+    int          j;
+    int          low;
+    int          upper;
+
+    /* Data node ancestors of ys, innermost first */
+    for (yp = ys; yp != NULL; yp = yang_parent_get(yp)){
+        if (yang_keyword_get(yp) == Y_MODULE || yang_keyword_get(yp) == Y_SUBMODULE)
+            break;
+        if (!yang_datanode(yp))
+            continue;
+        if ((chain = realloc(chain, (chainlen+1)*sizeof(yang_stmt*))) == NULL){
+            clicon_err(OE_UNIX, errno, "realloc");
+            goto done;
+        }
+        chain[chainlen++] = yp;
+    }
+    if (cxvec_append(xt, &vec, &veclen) < 0)
+        goto done;
+    for (i=chainlen-1; i>=0 && veclen; i--){
+        vec1 = NULL;
+        veclen1 = 0;
+        for (j=0; j<veclen; j++){
+            if (clixon_xml_find_range(vec[j], chain[i], &low, &upper) < 0){
+                if (vec1)
+                    free(vec1);
+                goto done;
+            }
+            for (; low<upper; low++)
+                if (cxvec_append(xml_child_i(vec[j], low), &vec1, &veclen1) < 0){
+                    if (vec1)
+                        free(vec1);
+                    goto done;
+                }
+        }
+        free(vec);
+        vec = vec1;
+        veclen = veclen1;
+    }
+    *vecp = vec;
+    *veclenp = veclen;
+    vec = NULL;
+    retval = 0;
+ done:
+    if (chain)
+        free(chain);
+    if (vec)
+        free(vec);
+    return retval;
+}
+
+/*! Map a node in the source tree to the corresponding node in the target tree
+ * @param[in]  xt    Top of target tree
+ * @param[in]  xs    Node in source tree
+ * @param[out] xtp   Corresponding target node, or NULL if it does not exist
+ */
+static int
+changes_target(cxobj  *xt,
+               cxobj  *xs,
+               cxobj **xtp)
+{
+    int        retval = -1;
+    cxobj     *xp = NULL;
+    yang_stmt *y;
+
+    *xtp = NULL;
+    if (xml_parent(xs) == NULL)
+        *xtp = xt;
+    else {
+        if (changes_target(xt, xml_parent(xs), &xp) < 0)
+            goto done;
+        if (xp != NULL && (y = xml_spec(xs)) != NULL)
+            if (match_base_child(xp, xs, y, xtp) < 0)
+                goto done;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Revalidate a node whose children have been added or deleted
+ *
+ * Mandatory children of the node, and min/max-elements and unique of its lists
+ */
+static int
+changes_parent(clicon_handle h,
+               cxobj        *xp,
+               cxobj       **xret)
+{
+    int        retval = -1;
+    yang_stmt *yp;
+    int        ret;
+
+    if ((yp = xml_spec(xp)) != NULL){
+        if ((ret = xml_yang_validate_node(h, xp, xret)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+        if (ret == 2 || yang_config(yp) == 0)
+            goto ok;
+    }
+    if ((ret = xml_yang_minmax_recurse(xp, xret)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+ ok:
+    retval = 1;
+ done:
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Revalidate all instances of a constraint in the target tree
+ */
+static int
+changes_dep(clicon_handle h,
+            cxobj        *xt,
+            validate_dep *vd,
+            cxobj       **xret)
+{
+    int        retval = -1;
+    cxobj    **vec = NULL;
+    int        veclen = 0;
+    yang_stmt *ys;
+    int        i;
+    int        ret;
+
+    ys = vd->vd_ys;
+    if (vd->vd_kind == VD_CHILDREN)
+        ys = yang_parent_get(ys);
+    if (changes_instances(xt, ys, &vec, &veclen) < 0)
+        goto done;
+    for (i=0; i<veclen; i++){
+        if (vd->vd_kind == VD_NODE)
+            ret = xml_yang_validate_node(h, vec[i], xret);
+        else
+            ret = xml_yang_minmax_recurse(vec[i], xret);
+        if (ret < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+    }
+    retval = 1;
+ done:
+    if (vec)
+        free(vec);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Validate a target tree incrementally given the changes from a valid source tree
+ *
+ * Added subtrees are validated fully, parents of added and deleted nodes are checked for
+ * mandatory, min/max-elements and unique, and changed nodes are validated.
+ * Then all constraints in the dependency graph that depend on a name of any added, deleted
+ * or changed node are revalidated in the target tree.
+ * If no dependency graph is computed, or if the whole tree is added, the whole target tree is
+ * validated.
+ * @param[in]  h     Clicon handle
+ * @param[in]  xt    Top of target tree, sorted
+ * @param[in]  dvec  Deleted nodes (in source tree)
+ * @param[in]  dlen  Length of dvec
+ * @param[in]  avec  Added nodes (in target tree)
+ * @param[in]  alen  Length of avec
+ * @param[in]  cvec  Changed nodes (in target tree)
+ * @param[in]  clen  Length of cvec
+ * @param[out] xret  Error XML tree (if retval=0). Free with xml_free after use
+ * @retval     1     Validation OK
+ * @retval     0     Validation failed (xret set)
+ * @retval    -1     Error
+ * @note The source tree is assumed to be valid
+ * @see xml_yang_validate_all_top  Full validation
+ * @see xml_yang_validate_deps_init  Computes the dependency graph
+ */
+int
+xml_yang_validate_changes(clicon_handle h,
+                          cxobj        *xt,
+                          cxobj       **dvec,
+                          int           dlen,
+                          cxobj       **avec,
+                          int           alen,
+                          cxobj       **cvec,
+                          int           clen,
+                          cxobj       **xret)
+{
+    int              retval = -1;
+    validate_graph  *vg = NULL;
+    validate_depvec  deps = {NULL, 0};
+    validate_dep    *vd;
+    cxobj           *xp;
+    cxobj           *xprev;
+    int              i;
+    int              ret;
+
+    if (clicon_ptr_get(h, VALIDATE_DEPS, (void**)&vg) < 0 || vg == NULL)
+        return xml_yang_validate_all_top(h, xt, xret);
+    /* Whole tree added, eg at startup: validate all, possibly with worker processes */
+    if (dlen == 0 && clen == 0 && alen > 0 && alen == xml_child_nr_type(xt, CX_ELMNT))
+        return xml_yang_validate_all_top(h, xt, xret);
+    /* Collect affected constraints */
+    for (i=0; i<vg->vg_global.dv_len; i++){
+        vd = &vg->vg_global.dv_vec[i];
+        if (yang_flag_get(vd->vd_ys, YANG_FLAG_MARK))
+            continue;
+        yang_flag_set(vd->vd_ys, YANG_FLAG_MARK);
+        if (depvec_add(&deps, vd->vd_ys, vd->vd_kind) < 0)
+            goto done;
+    }
+    for (i=0; i<alen; i++)
+        if (changes_deps_collect(vg, avec[i], 1, &deps) < 0)
+            goto done;
+    for (i=0; i<dlen; i++)
+        if (changes_deps_collect(vg, dvec[i], 1, &deps) < 0)
+            goto done;
+    for (i=0; i<clen; i++)
+        if (changes_deps_collect(vg, cvec[i], 0, &deps) < 0)
+            goto done;
+    /* Reset marks before validation, which also uses them */
+    for (i=0; i<deps.dv_len; i++){
+        yang_flag_reset(deps.dv_vec[i].vd_ys, YANG_FLAG_MARK);
+        yang_flag_reset(deps.dv_vec[i].vd_ys, YANG_FLAG_TMP);
+    }
+    /* Added subtrees */
+    xprev = NULL;
+    for (i=0; i<alen; i++){
+        if ((ret = xml_yang_validate_all(h, avec[i], xret)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+        if ((xp = xml_parent(avec[i])) == NULL || xp == xprev)
+            continue;
+        if ((ret = changes_parent(h, xp, xret)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+        xprev = xp;
+    }
+    /* Parents of deleted nodes */
+    xprev = NULL;
+    for (i=0; i<dlen; i++){
+        if (xml_parent(dvec[i]) == NULL)
+            continue;
+        if (changes_target(xt, xml_parent(dvec[i]), &xp) < 0)
+            goto done;
+        if (xp == NULL || xp == xprev)
+            continue;
+        if ((ret = changes_parent(h, xp, xret)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+        xprev = xp;
+    }
+    /* Changed nodes */
+    for (i=0; i<clen; i++){
+        if ((ret = xml_yang_validate_node(h, cvec[i], xret)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+    }
+    /* Affected constraints */
+    for (i=0; i<deps.dv_len; i++){
+        if ((ret = changes_dep(h, xt, &deps.dv_vec[i], xret)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+    }
+    retval = 1;
+ done:
+    if (deps.dv_vec){
+        for (i=0; i<deps.dv_len; i++){
+            yang_flag_reset(deps.dv_vec[i].vd_ys, YANG_FLAG_MARK);
+            yang_flag_reset(deps.dv_vec[i].vd_ys, YANG_FLAG_TMP);
+        }
+        free(deps.dv_vec);
+    }
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
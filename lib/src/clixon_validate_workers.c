@@ -0,0 +1,531 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ *
+ * Full validation of large XML trees using worker processes
+ * The tree is partitioned into work units: subtrees that are validated independently with
+ * xml_yang_validate_all(). Large subtrees are split into their children, and the checks of
+ * the split node itself are made separately. Units are assigned to forked worker processes,
+ * which validate a copy-on-write snapshot of the tree and return the first failure on a pipe.
+ * The failure with lowest unit number, ie first in document order, is reported, which gives
+ * the same result as sequential validation.
+ * Processes are used instead of threads since validation uses global state, such as yang
+ * flags, errors and temporary XML nodes.
+ */
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <syslog.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clicon */
+#include "clixon_queue.h"
+#include "clixon_hash.h"
+#include "clixon_handle.h"
+#include "clixon_err.h"
+#include "clixon_log.h"
+#include "clixon_yang.h"
+#include "clixon_xml.h"
+#include "clixon_xml_io.h"
+#include "clixon_options.h"
+#include "clixon_validate_minmax.h"
+#include "clixon_validate.h"
+#include "clixon_validate_workers.h"
+
+/*! Number of work units per worker process, for load balance */
+#define VALIDATE_UNITS_PER_WORKER 4
+
+/*! Work unit type
+ */
+enum vunit_type{
+    VU_ALL,    /* Validate subtree: xml_yang_validate_all, made by a worker */
+    VU_NODE,   /* Validate node of split subtree: xml_yang_validate_node */
+    VU_MINMAX, /* Validate lists of split subtree: xml_yang_minmax_recurse */
+};
+
+/*! Work unit, in document order
+ */
+typedef struct {
+    enum vunit_type vu_type;
+    cxobj          *vu_x;
+    size_t          vu_size;   /* Number of element nodes in subtree */
+    int             vu_worker; /* Assigned worker process (VU_ALL) */
+} vunit;
+
+/*! Number of element nodes in a tree, stop counting at max (if > 0)
+ */
+static size_t
+vunit_size(cxobj *x,
+           size_t max)
+{
+    size_t n = 1;
+    cxobj *xc = NULL;
+
+    while ((xc = xml_child_each(x, xc, CX_ELMNT)) != NULL){
+        n += vunit_size(xc, max?max-n:0);
+        if (max && n >= max)
+            break;
+    }
+    return n;
+}
+
+/*! Add a work unit
+ */
+static int
+vunit_add(vunit          **vec,
+          int             *len,
+          enum vunit_type  type,
+          cxobj           *x,
+          size_t           size)
+{
+    vunit *vu;
+
+    /* Grow to next power of two */
+    if ((*len & (*len - 1)) == 0 &&
+        (*vec = realloc(*vec, (*len?2*(*len):1)*sizeof(vunit))) == NULL){
+        clicon_err(OE_UNIX, errno, "realloc");
+        return -1;
+    }
+    vu = &(*vec)[(*len)++];
+    memset(vu, 0, sizeof(*vu));
+    vu->vu_type = type;
+    vu->vu_x = x;
+    vu->vu_size = size;
+    return 0;
+}
+
+/*! Partition a subtree into work units in document order
+ *
+ * A subtree larger than target is split into a node unit, its children, and a min/max
+ * unit, in the same order as in xml_yang_validate_all
+ */
+static int
+vunit_build(cxobj  *x,
+            size_t  size,
+            size_t  target,
+            vunit **vec,
+            int    *len)
+{
+    int        retval = -1;
+    yang_stmt *y;
+    cxobj     *xc;
+
+    y = xml_spec(x);
+    if (size <= target || y == NULL ||
+        yang_keyword_get(y) == Y_ANYXML || yang_keyword_get(y) == Y_ANYDATA){
+        if (vunit_add(vec, len, VU_ALL, x, size) < 0)
+            goto done;
+        goto ok;
+    }
+    if (vunit_add(vec, len, VU_NODE, x, 1) < 0)
+        goto done;
+    xc = NULL;
+    while ((xc = xml_child_each(x, xc, CX_ELMNT)) != NULL)
+        if (vunit_build(xc, vunit_size(xc, 0), target, vec, len) < 0)
+            goto done;
+    if (yang_config(y) != 0 &&
+        vunit_add(vec, len, VU_MINMAX, x, 1) < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Sort work units by decreasing size, then document order
+ */
+static int
+vunit_cmp(const void *a,
+          const void *b)
+{
+    vunit *va = *(vunit **)a;
+    vunit *vb = *(vunit **)b;
+
+    if (va->vu_size != vb->vu_size)
+        return va->vu_size > vb->vu_size ? -1 : 1;
+    return va < vb ? -1 : (va > vb);
+}
+
+/*! Assign subtree units to workers, largest first to least loaded worker
+ * @retval  n   Number of workers with units
+ */
+static int
+vunit_assign(vunit *vec,
+             int    len,
+             int    workers)
+{
+    int     retval = -1;
+    vunit **sorted = NULL;
+    size_t *load = NULL;
+    int     nsorted = 0;
+    int     i;
+    int     w;
+    int     wmin;
+
+    if ((sorted = calloc(len, sizeof(vunit *))) == NULL ||
+        (load = calloc(workers, sizeof(size_t))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    for (i=0; i<len; i++)
+        if (vec[i].vu_type == VU_ALL)
+            sorted[nsorted++] = &vec[i];
+    qsort(sorted, nsorted, sizeof(vunit *), vunit_cmp);
+    for (i=0; i<nsorted; i++){
+        wmin = 0;
+        for (w=1; w<workers; w++)
+            if (load[w] < load[wmin])
+                wmin = w;
+        sorted[i]->vu_worker = wmin;
+        load[wmin] += sorted[i]->vu_size;
+    }
+    retval = nsorted < workers ? nsorted : workers;
+ done:
+    if (sorted)
+        free(sorted);
+    if (load)
+        free(load);
+    return retval;
+}
+
+/*! Validate one unit
+ */
+static int
+vunit_validate(clicon_handle h,
+               vunit        *vu,
+               cxobj       **xret)
+{
+    int ret;
+
+    switch (vu->vu_type){
+    case VU_ALL:
+        return xml_yang_validate_all(h, vu->vu_x, xret);
+        break;
+    case VU_NODE:
+        if ((ret = xml_yang_validate_node(h, vu->vu_x, xret)) == 2)
+            ret = 1;
+        return ret;
+        break;
+    case VU_MINMAX:
+        return xml_yang_minmax_recurse(vu->vu_x, xret);
+        break;
+    }
+    return 1;
+}
+
+/*! Worker process: validate assigned units in order and write first failure to fd
+ *
+ * Result is "<unit> <retval>\n" followed by error XML (retval 0) or error reason (retval -1)
+ * Unit is -1 if all units are valid.
+ */
+static void
+vunit_worker(clicon_handle h,
+             vunit        *vec,
+             int           len,
+             int           worker,
+             int           fd)
+{
+    cxobj *xerr = NULL;
+    cbuf  *cb = NULL;
+    int    i;
+    int    ret = 1;
+    int    unit = -1;
+    char  *p;
+    size_t n;
+    ssize_t w;
+
+    for (i=0; i<len; i++){
+        if (vec[i].vu_type != VU_ALL || vec[i].vu_worker != worker)
+            continue;
+        if ((ret = vunit_validate(h, &vec[i], &xerr)) < 1){
+            unit = i;
+            break;
+        }
+    }
+    if ((cb = cbuf_new()) == NULL)
+        goto done;
+    cprintf(cb, "%d %d\n", unit, ret);
+    if (ret == 0 && xerr != NULL)
+        clixon_xml2cbuf(cb, xerr, 0, 0, -1, 0);
+    else if (ret < 0)
+        cprintf(cb, "%s", clicon_err_reason);
+    p = cbuf_get(cb);
+    n = cbuf_len(cb);
+    while (n > 0){
+        if ((w = write(fd, p, n)) < 0){
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        p += w;
+        n -= w;
+    }
+ done:
+    close(fd);
+    _exit(0);
+}
+
+/*! Read result of worker process
+ * @param[in]  fd     Read end of pipe, closed by caller
+ * @param[out] unit   First failing unit of worker, or -1
+ * @param[out] ret    Validation result of unit
+ * @param[out] cbp    Result payload. Free with cbuf_free
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+vunit_result(int    fd,
+             int   *unit,
+             int   *ret,
+             cbuf **cbp)
+{
+    int     retval = -1;
+    cbuf   *cb = NULL;
+    char    buf[4096];
+    ssize_t n;
+    char   *s;
+
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    while (1){
+        if ((n = read(fd, buf, sizeof(buf))) < 0){
+            if (errno == EINTR)
+                continue;
+            clicon_err(OE_UNIX, errno, "read");
+            goto done;
+        }
+        if (n == 0)
+            break;
+        cprintf(cb, "%.*s", (int)n, buf);
+    }
+    s = cbuf_get(cb);
+    if (sscanf(s, "%d %d", unit, ret) != 2){
+        clicon_err(OE_XML, 0, "Validation worker exited without result");
+        goto done;
+    }
+    *cbp = cb;
+    cb = NULL;
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Validate a whole XML tree in parallel using worker processes
+ *
+ * Same result as validating the children of xt with xml_yang_validate_all() followed by
+ * xml_yang_minmax_recurse() of xt. Trees smaller than VALIDATE_WORKERS_MIN nodes are
+ * validated sequentially.
+ * @param[in]  h       Clicon handle
+ * @param[in]  xt      Top of XML tree
+ * @param[in]  workers Number of worker processes
+ * @param[out] xret    Error XML tree (if retval=0). Free with xml_free after use
+ * @retval     1       Validation OK
+ * @retval     0       Validation failed (xret set)
+ * @retval    -1       Error
+ * @see xml_yang_validate_all_top  Uses this function if CLICON_VALIDATE_WORKERS > 1
+ */
+int
+xml_yang_validate_workers(clicon_handle h,
+                          cxobj        *xt,
+                          int           workers,
+                          cxobj       **xret)
+{
+    int     retval = -1;
+    vunit  *vec = NULL;
+    int     len = 0;
+    size_t  size;
+    cxobj  *xc;
+    pid_t  *pids = NULL;
+    int    *fds = NULL;
+    int     nworkers = 0;
+    int     fd[2];
+    int     i;
+    int     w;
+    int     ret;
+    int     unit;
+    int     best = -1;     /* Unit of first failure */
+    cxobj  *xerr = NULL;   /* Error of first failure */
+    cbuf   *cbbest = NULL; /* Worker payload of first failure */
+    cbuf   *cb = NULL;
+    cxobj  *xtop = NULL;
+    char   *s;
+
+    /* Small trees are validated sequentially */
+    if ((size = vunit_size(xt, VALIDATE_WORKERS_MIN)) < VALIDATE_WORKERS_MIN || workers < 2){
+        xc = NULL;
+        while ((xc = xml_child_each(xt, xc, CX_ELMNT)) != NULL) {
+            if ((ret = xml_yang_validate_all(h, xc, xret)) < 1)
+                return ret;
+        }
+        return xml_yang_minmax_recurse(xt, xret);
+    }
+    size = vunit_size(xt, 0);
+    xc = NULL;
+    while ((xc = xml_child_each(xt, xc, CX_ELMNT)) != NULL)
+        if (vunit_build(xc, vunit_size(xc, 0), size/(workers*VALIDATE_UNITS_PER_WORKER),
+                        &vec, &len) < 0)
+            goto done;
+    if (vunit_add(&vec, &len, VU_MINMAX, xt, 1) < 0)
+        goto done;
+    if ((nworkers = vunit_assign(vec, len, workers)) < 0)
+        goto done;
+    if ((pids = calloc(nworkers, sizeof(pid_t))) == NULL ||
+        (fds = calloc(nworkers, sizeof(int))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    for (w=0; w<nworkers; w++)
+        fds[w] = -1;
+    clicon_debug(1, "%s units:%d workers:%d", __FUNCTION__, len, nworkers);
+    /* Fork workers. If fork fails, remaining units are validated here */
+    for (w=0; w<nworkers; w++){
+        if (pipe(fd) < 0){
+            clicon_err(OE_UNIX, errno, "pipe");
+            goto done;
+        }
+        if ((pids[w] = fork()) < 0){
+            clicon_log(LOG_WARNING, "%s: fork: %s", __FUNCTION__, strerror(errno));
+            close(fd[0]);
+            close(fd[1]);
+            pids[w] = 0;
+            break;
+        }
+        if (pids[w] == 0){ /* child */
+            close(fd[0]);
+            for (i=0; i<w; i++)
+                close(fds[i]);
+            vunit_worker(h, vec, len, w, fd[1]); /* Does not return */
+        }
+        close(fd[1]);
+        fds[w] = fd[0];
+    }
+    /* Validate split nodes, and units of workers that could not be forked */
+    for (i=0; i<len; i++){
+        if (vec[i].vu_type == VU_ALL && vec[i].vu_worker < nworkers && pids[vec[i].vu_worker])
+            continue;
+        if ((ret = vunit_validate(h, &vec[i], &xerr)) < 0)
+            goto done;
+        if (ret == 0){
+            best = i;
+            break;
+        }
+    }
+    /* Collect results of workers, first failure in document order wins */
+    for (w=0; w<nworkers && pids[w]; w++){
+        if (vunit_result(fds[w], &unit, &ret, &cb) < 0)
+            goto done;
+        if (ret < 0){
+            s = strchr(cbuf_get(cb), '\n');
+            clicon_err(OE_XML, 0, "Validation worker: %s", s?s+1:"");
+            goto done;
+        }
+        if (ret == 0 && (best == -1 || unit < best)){
+            best = unit;
+            if (xerr){
+                xml_free(xerr);
+                xerr = NULL;
+            }
+            if (cbbest)
+                cbuf_free(cbbest);
+            cbbest = cb;
+            cb = NULL;
+        }
+        if (cb){
+            cbuf_free(cb);
+            cb = NULL;
+        }
+    }
+    if (best != -1){
+        if (cbbest){
+            s = strchr(cbuf_get(cbbest), '\n');
+            if (clixon_xml_parse_string(s?s+1:"", YB_NONE, NULL, &xtop, NULL) < 0)
+                goto done;
+            if (xml_rootchild(xtop, 0, &xerr) < 0)
+                goto done;
+            xtop = NULL;
+        }
+        if (xret){
+            if (*xret == NULL){
+                *xret = xerr;
+                xerr = NULL;
+            }
+            else
+                while ((xc = xml_child_i_type(xerr, 0, CX_ELMNT)) != NULL)
+                    if (xml_addsub(*xret, xc) < 0)
+                        goto done;
+        }
+        retval = 0;
+        goto done;
+    }
+    retval = 1;
+ done:
+    if (fds){
+        for (w=0; w<nworkers; w++)
+            if (fds[w] != -1)
+                close(fds[w]);
+        free(fds);
+    }
+    if (pids){
+        for (w=0; w<nworkers; w++)
+            if (pids[w] > 0)
+                waitpid(pids[w], NULL, 0);
+        free(pids);
+    }
+    if (xtop)
+        xml_free(xtop);
+    if (xerr)
+        xml_free(xerr);
+    if (cb)
+        cbuf_free(cb);
+    if (cbbest)
+        cbuf_free(cbbest);
+    if (vec)
+        free(vec);
+    return retval;
+}
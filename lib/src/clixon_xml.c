@@ -72,7 +72,6 @@
 #include "clixon_xml_vec.h"
 #include "clixon_xml_sort.h"
 #include "clixon_xml_io.h"
-#include "clixon_xml_parse.h"
 #include "clixon_xml_nsctx.h"
 
 /*
@@ -185,6 +184,8 @@ struct xml{
     yang_stmt        *x_spec;       /* Pointer to specification, eg yang, 
                                        by reference, dont free */
     cg_var           *x_cv;         /* Cached value as cligen variable (set by xml_cmp) */
+    uint8_t          *x_sortkey;    /* Cached sort key of list/leaf-list entry (set by xml_cmp) */
+    size_t            x_sortkey_len;/* Length of x_sortkey */
 #ifdef XML_EXPLICIT_INDEX
     struct search_index *x_search_index; /* explicit search index vectors */
 #endif
@@ -246,6 +247,34 @@ xml_stats_global(uint64_t *nr)
     return 0;
 }
 
+/*! Clear cached sort information of an XML node after a change
+ *
+ * A sort key of a list entry depends on the bodies of its key leafs, ie on nodes
+ * two levels down. Therefore clear the sort key of both the changed node and its parent.
+ * The sorted flag of a node implies that its whole subtree is sorted, therefore clear the
+ * flag of the changed node and all its ancestors. Stop at the first node without the flag,
+ * since none of its ancestors can have it.
+ * @param[in]  x   XML node (or NULL)
+ * @see xml_sortkey_set
+ * @see XML_FLAG_SORTED
+ */
+static void
+xml_sort_reset(cxobj *x)
+{
+    cxobj *xs;
+    int    i;
+
+    for (xs=x, i=0; i<2 && xs != NULL; i++, xs = xs->x_up){
+        if (xs->x_type == CX_ELMNT && xs->x_sortkey){
+            free(xs->x_sortkey);
+            xs->x_sortkey = NULL;
+            xs->x_sortkey_len = 0;
+        }
+    }
+    for (xs=x; xs != NULL && (xs->x_flags & XML_FLAG_SORTED); xs = xs->x_up)
+        xs->x_flags &= ~XML_FLAG_SORTED;
+}
+
 /*! Return the alloced memory of a single XML obj 
  * @param[in]   x    XML object
  * @param[out]  szp  Size of this XML obj
@@ -270,6 +299,7 @@ xml_stats_one(cxobj    *x,
             sz += cvec_size(x->x_ns_cache);
         if (x->x_cv)
             sz += cv_size(x->x_cv);
+        sz += x->x_sortkey_len;
 #ifdef XML_EXPLICIT_INDEX
         if (x->x_search_index){
             /* XXX: only one */
@@ -658,6 +688,7 @@ xml_value_set(cxobj *xn,
     else
         cbuf_reset(xn->x_value_cb);
     cbuf_append_str(xn->x_value_cb, val);
+    xml_sort_reset(xn->x_up);
     retval = 0;
  done:
     return retval;
@@ -693,6 +724,7 @@ xml_value_append(cxobj *xn,
         clicon_err(OE_XML, errno, "cprintf");
         goto done;
     }
+    xml_sort_reset(xn->x_up);
     retval = 0;
  done:
     return retval;
@@ -846,8 +878,10 @@ xml_child_i_set(cxobj *xt,
 {
     if (!is_element(xt))
         return NULL;
-    if (i < xt->x_childvec_len)
+    if (i < xt->x_childvec_len){
         xt->x_childvec[i] = xc;
+        xml_sort_reset(xt);
+    }
     return 0;
 }
 
@@ -968,6 +1002,7 @@ xml_child_append(cxobj *xp,
         }
     }
     xp->x_childvec[xp->x_childvec_len-1] = xc;
+    xml_sort_reset(xp);
     return 0;
 }
 
@@ -1000,6 +1035,7 @@ xml_child_insert_pos(cxobj *xp,
     size = (xml_child_nr(xp) - i - 1)*sizeof(cxobj *);
     memmove(&xp->x_childvec[i+1], &xp->x_childvec[i], size);
     xp->x_childvec[i] = xc;
+    xml_sort_reset(xp);
     return 0;
 }
 
@@ -1018,6 +1054,7 @@ xml_childvec_set(cxobj *x,
         return 0;
     x->x_childvec_len = len;
     x->x_childvec_max = len;
+    xml_sort_reset(x);
     if (x->x_childvec)
         free(x->x_childvec);
     if ((x->x_childvec = calloc(len, sizeof(cxobj*))) == NULL){
@@ -1173,7 +1210,10 @@ xml_spec_set(cxobj     *x,
 {
     if (!is_element(x))
         return 0;
-    x->x_spec = spec;
+    if (x->x_spec != spec){
+        x->x_spec = spec;
+        xml_sort_reset(x);
+    }
     return 0;
 }
 
@@ -1213,6 +1253,49 @@ xml_cv_set(cxobj  *x,
     return 0;
 }
 
+/*! Return (cached) sort key of list or leaf-list entry
+ * @param[in]  x     XML node, list or leaf-list entry
+ * @param[out] lenp  Length of sort key
+ * @retval     key   Sort key, compare with memcmp
+ * @retval     NULL  No sort key cached
+ * Only accessed by xml_cmp
+ * @see xml_sortkey_get
+ */
+uint8_t *
+xml_sortkey(cxobj  *x,
+            size_t *lenp)
+{
+    if (!is_element(x))
+        return NULL;
+    *lenp = x->x_sortkey_len;
+    return x->x_sortkey;
+}
+
+/*! Set (cached) sort key of list or leaf-list entry
+ * @param[in]  x    XML node, list or leaf-list entry
+ * @param[in]  key  Malloced sort key, consumed by this function. NULL clears the cache
+ * @param[in]  len  Length of key
+ * @retval     0    OK
+ * The key is cleared when children, body values or yang spec of the entry change
+ * @see xml_sortkey_get
+ */
+int
+xml_sortkey_set(cxobj   *x,
+                uint8_t *key,
+                size_t   len)
+{
+    if (!is_element(x)){
+        if (key)
+            free(key);
+        return 0;
+    }
+    if (x->x_sortkey)
+        free(x->x_sortkey);
+    x->x_sortkey = key;
+    x->x_sortkey_len = key?len:0;
+    return 0;
+}
+
 /*! Find an XML node matching name among a parent's children.
  *
  * Get first XML node directly under x_up in the xml hierarchy with
@@ -1422,6 +1505,7 @@ xml_child_rm(cxobj *xp,
     xml_parent_set(xc, NULL);
     xp->x_childvec[i] = NULL;
     xp->x_childvec_len--;
+    xml_sort_reset(xp);
     if (i<xp->x_childvec_len)
         memmove(&xp->x_childvec[i], &xp->x_childvec[i+1], (xp->x_childvec_len-i)*sizeof(cxobj*));
 #ifdef XML_EXPLICIT_INDEX
@@ -1871,6 +1955,8 @@ xml_free(cxobj *x)
             free(x->x_childvec);
         if (x->x_cv)
             cv_free(x->x_cv);
+        if (x->x_sortkey)
+            free(x->x_sortkey);
         if (x->x_ns_cache)
             xml_nsctx_free(x->x_ns_cache);
 #ifdef XML_EXPLICIT_INDEX
@@ -0,0 +1,558 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+ * Compact binary encoding of XML trees
+ *
+ * Used in the internal protocol between clixon clients and backend as an alternative to
+ * XML text, if negotiated in hello, see CLICON_SOCK_BINARY. The encoding is a pre-order
+ * walk of the tree with names interned in a per-message string table, so that repeated
+ * names of eg list entries are sent once. Values are sent as-is without XML character
+ * encoding, so decoding is a single pass without lexing or entity translation.
+ *
+ * Format:
+ *   message := magic version node* END
+ *   magic   := 0x00 'C' 'X' 'B'
+ *   version := 0x01
+ *   node    := ELMNT str:prefix str:name (node)* END
+ *            | ATTR str:prefix str:name str:value
+ *            | BODY len bytes
+ *   str     := 0                 No string (NULL)
+ *            | 1 len bytes       New string, appended to string table
+ *            | n                 String number n-2 in string table
+ * where len and n are unsigned LEB128 varints, and END=0, ELMNT=1, ATTR=2, BODY=3.
+ * Text messages never start with a NUL byte, which is used to tell the encodings apart.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <string.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon_err.h"
+#include "clixon_queue.h"
+#include "clixon_hash.h"
+#include "clixon_handle.h"
+#include "clixon_log.h"
+#include "clixon_yang.h"
+#include "clixon_xml.h"
+#include "clixon_xml_bin.h"
+
+#define CXB_MAGIC     "\0CXB"
+#define CXB_MAGIC_LEN 4
+#define CXB_VERSION   1
+
+/* Node opcodes */
+#define CXB_END       0
+#define CXB_ELMNT     1
+#define CXB_ATTR      2
+#define CXB_BODY      3
+
+/* String references */
+#define CXB_STR_NULL  0
+#define CXB_STR_NEW   1
+
+/*! Binary encoder handle
+ */
+struct clixon_bin_enc {
+    cbuf          *be_cb;    /* Output buffer */
+    clicon_hash_t *be_strs;  /* Interned strings -> string number */
+    uint32_t       be_nr;    /* Number of interned strings */
+};
+
+/*! Check if a buffer starts with binary encoding magic
+ * @param[in]  buf   Buffer
+ * @param[in]  len   Length of buffer
+ * @retval     1     Binary encoding
+ * @retval     0     Not binary, eg XML text
+ */
+int
+clixon_bin_magic(const char *buf,
+                 size_t      len)
+{
+    return len > CXB_MAGIC_LEN && memcmp(buf, CXB_MAGIC, CXB_MAGIC_LEN) == 0;
+}
+
+/*! Append unsigned varint
+ */
+static int
+bin_enc_uint(cbuf    *cb,
+             uint32_t u)
+{
+    uint8_t b[5];
+    int     i = 0;
+
+    do {
+        b[i] = u & 0x7f;
+        u >>= 7;
+        if (u)
+            b[i] |= 0x80;
+        i++;
+    } while (u);
+    return cbuf_append_buf(cb, b, i);
+}
+
+/*! Append length-prefixed bytes
+ */
+static int
+bin_enc_bytes(cbuf       *cb,
+              const char *s)
+{
+    size_t len = strlen(s);
+
+    if (bin_enc_uint(cb, len) < 0)
+        return -1;
+    return cbuf_append_buf(cb, (void*)s, len);
+}
+
+/*! Append string reference, intern new strings
+ */
+static int
+bin_enc_str(clixon_bin_enc *be,
+            const char     *s)
+{
+    uint32_t *np;
+
+    if (s == NULL)
+        return bin_enc_uint(be->be_cb, CXB_STR_NULL);
+    if ((np = clicon_hash_value(be->be_strs, s, NULL)) != NULL)
+        return bin_enc_uint(be->be_cb, *np + 2);
+    if (clicon_hash_add(be->be_strs, s, &be->be_nr, sizeof(be->be_nr)) == NULL)
+        return -1;
+    be->be_nr++;
+    if (bin_enc_uint(be->be_cb, CXB_STR_NEW) < 0)
+        return -1;
+    return bin_enc_bytes(be->be_cb, s);
+}
+
+/*! Create binary encoder and write header
+ * @param[in]  cb    Output buffer
+ * @retval     be    Encoder, free with clixon_bin_enc_free
+ * @retval     NULL  Error
+ * @code
+ *   clixon_bin_enc *be;
+ *   if ((be = clixon_bin_enc_new(cb)) == NULL)
+ *     err;
+ *   clixon_bin_enc_elmnt(be, NULL, "rpc-reply");
+ *   clixon_bin_enc_xml(be, xdata, -1);
+ *   clixon_bin_enc_end(be);
+ *   clixon_bin_enc_free(be);
+ * @endcode
+ */
+clixon_bin_enc *
+clixon_bin_enc_new(cbuf *cb)
+{
+    clixon_bin_enc *be;
+
+    if ((be = malloc(sizeof(*be))) == NULL){
+        clicon_err(OE_XML, errno, "malloc");
+        return NULL;
+    }
+    memset(be, 0, sizeof(*be));
+    be->be_cb = cb;
+    if ((be->be_strs = clicon_hash_init()) == NULL){
+        free(be);
+        return NULL;
+    }
+    cbuf_append_buf(cb, CXB_MAGIC, CXB_MAGIC_LEN);
+    cbuf_append(cb, CXB_VERSION);
+    return be;
+}
+
+/*! Start an element, end it with clixon_bin_enc_end
+ * @param[in]  be      Encoder
+ * @param[in]  prefix  Namespace prefix, or NULL
+ * @param[in]  name    Element name
+ */
+int
+clixon_bin_enc_elmnt(clixon_bin_enc *be,
+                     const char     *prefix,
+                     const char     *name)
+{
+    if (cbuf_append(be->be_cb, CXB_ELMNT) < 0)
+        return -1;
+    if (bin_enc_str(be, prefix) < 0)
+        return -1;
+    return bin_enc_str(be, name);
+}
+
+/*! Add attribute to current element
+ * @param[in]  be      Encoder
+ * @param[in]  prefix  Namespace prefix, or NULL
+ * @param[in]  name    Attribute name
+ * @param[in]  value   Attribute value
+ */
+int
+clixon_bin_enc_attr(clixon_bin_enc *be,
+                    const char     *prefix,
+                    const char     *name,
+                    const char     *value)
+{
+    if (cbuf_append(be->be_cb, CXB_ATTR) < 0)
+        return -1;
+    if (bin_enc_str(be, prefix) < 0)
+        return -1;
+    if (bin_enc_str(be, name) < 0)
+        return -1;
+    return bin_enc_str(be, value?value:"");
+}
+
+/*! End current element, or the message if no element is open
+ * @param[in]  be      Encoder
+ */
+int
+clixon_bin_enc_end(clixon_bin_enc *be)
+{
+    return cbuf_append(be->be_cb, CXB_END);
+}
+
+/*! Encode an XML tree
+ *
+ * As the XML text parser, bodies of elements with element children (mixed content) and
+ * empty bodies are not encoded.
+ * @param[in]  be      Encoder
+ * @param[in]  x       XML tree
+ * @param[in]  depth   Limit levels of child resources: -1: all, 0: none, 1: node itself
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see clixon_xml2cbuf
+ */
+int
+clixon_bin_enc_xml(clixon_bin_enc *be,
+                   cxobj          *x,
+                   int32_t         depth)
+{
+    int    retval = -1;
+    cxobj *xc;
+    char  *val;
+    int    haselement;
+
+    if (depth == 0)
+        goto ok;
+    switch (xml_type(x)){
+    case CX_BODY:
+        if ((val = xml_value(x)) == NULL || *val == '\0')
+            break;
+        if (cbuf_append(be->be_cb, CXB_BODY) < 0)
+            goto done;
+        if (bin_enc_bytes(be->be_cb, val) < 0)
+            goto done;
+        break;
+    case CX_ATTR:
+        if (clixon_bin_enc_attr(be, xml_prefix(x), xml_name(x), xml_value(x)) < 0)
+            goto done;
+        break;
+    case CX_ELMNT:
+        if (clixon_bin_enc_elmnt(be, xml_prefix(x), xml_name(x)) < 0)
+            goto done;
+        haselement = xml_child_nr_type(x, CX_ELMNT) > 0;
+        xc = NULL;
+        while ((xc = xml_child_each(x, xc, -1)) != NULL){
+            switch (xml_type(xc)){
+            case CX_ATTR:
+                if (clixon_bin_enc_xml(be, xc, -1) < 0)
+                    goto done;
+                break;
+            case CX_BODY:
+                if (haselement)
+                    break;
+                /* fall through */
+            default:
+                if (clixon_bin_enc_xml(be, xc, depth-1) < 0)
+                    goto done;
+                break;
+            }
+        }
+        if (clixon_bin_enc_end(be) < 0)
+            goto done;
+        break;
+    default:
+        break;
+    }
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Free binary encoder, the output buffer is not freed
+ * @param[in]  be      Encoder
+ */
+int
+clixon_bin_enc_free(clixon_bin_enc *be)
+{
+    if (be->be_strs)
+        clicon_hash_free(be->be_strs);
+    free(be);
+    return 0;
+}
+
+/*! Encode an XML tree as a complete binary message
+ * @param[in,out] cb      Cligen buffer to write to
+ * @param[in]     xn      Top-level xml object
+ * @param[in]     depth   Limit levels of child resources: -1: all, 0: none, 1: node itself
+ * @param[in]     skiptop 0: Include top object 1: Skip top-object, only children
+ * @retval        0       OK
+ * @retval       -1       Error
+ * @see clixon_xml2cbuf   XML text encoding
+ * @see clixon_bin_parse  Decoding
+ */
+int
+clixon_xml2bin(cbuf   *cb,
+               cxobj  *xn,
+               int32_t depth,
+               int     skiptop)
+{
+    int             retval = -1;
+    clixon_bin_enc *be = NULL;
+    cxobj          *xc;
+
+    if ((be = clixon_bin_enc_new(cb)) == NULL)
+        goto done;
+    if (skiptop){
+        xc = NULL;
+        while ((xc = xml_child_each(xn, xc, CX_ELMNT)) != NULL)
+            if (clixon_bin_enc_xml(be, xc, depth) < 0)
+                goto done;
+    }
+    else if (clixon_bin_enc_xml(be, xn, depth) < 0)
+        goto done;
+    if (clixon_bin_enc_end(be) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (be)
+        clixon_bin_enc_free(be);
+    return retval;
+}
+
+/*! Binary decoder state
+ */
+typedef struct {
+    const uint8_t *bd_p;     /* Current position */
+    const uint8_t *bd_end;   /* End of buffer */
+    char         **bd_strs;  /* String table */
+    uint32_t       bd_nr;    /* Number of strings */
+    uint32_t       bd_max;   /* Allocated length of string table */
+} bin_dec;
+
+/*! Read unsigned varint
+ * @retval  0  OK
+ * @retval -1  Truncated or too long
+ */
+static int
+bin_dec_uint(bin_dec  *bd,
+             uint32_t *u)
+{
+    uint32_t v = 0;
+    int      shift = 0;
+    uint8_t  b;
+
+    do {
+        if (bd->bd_p >= bd->bd_end || shift > 28)
+            return -1;
+        b = *bd->bd_p++;
+        v |= (uint32_t)(b & 0x7f) << shift;
+        shift += 7;
+    } while (b & 0x80);
+    *u = v;
+    return 0;
+}
+
+/*! Read length-prefixed bytes, returned as pointer into buffer (not NUL-terminated)
+ */
+static int
+bin_dec_bytes(bin_dec     *bd,
+              const char **s,
+              uint32_t    *len)
+{
+    if (bin_dec_uint(bd, len) < 0)
+        return -1;
+    if (*len > bd->bd_end - bd->bd_p)
+        return -1;
+    *s = (const char*)bd->bd_p;
+    bd->bd_p += *len;
+    return 0;
+}
+
+/*! Read string reference
+ * @param[in]  bd  Decoder
+ * @param[out] s   String (in string table) or NULL
+ * @retval     0   OK
+ * @retval    -1   Malformed, or memory error
+ */
+static int
+bin_dec_str(bin_dec *bd,
+            char   **s)
+{
+    uint32_t    n;
+    uint32_t    len;
+    const char *b;
+    char      **strs;
+
+    if (bin_dec_uint(bd, &n) < 0)
+        return -1;
+    switch (n){
+    case CXB_STR_NULL:
+        *s = NULL;
+        break;
+    case CXB_STR_NEW:
+        if (bin_dec_bytes(bd, &b, &len) < 0)
+            return -1;
+        if (bd->bd_nr == bd->bd_max){
+            bd->bd_max = bd->bd_max ? 2*bd->bd_max : 64;
+            if ((strs = realloc(bd->bd_strs, bd->bd_max*sizeof(char*))) == NULL)
+                return -1;
+            bd->bd_strs = strs;
+        }
+        if ((*s = strndup(b, len)) == NULL)
+            return -1;
+        bd->bd_strs[bd->bd_nr++] = *s;
+        break;
+    default:
+        if (n - 2 >= bd->bd_nr)
+            return -1;
+        *s = bd->bd_strs[n-2];
+        break;
+    }
+    return 0;
+}
+
+/*! Decode binary encoded XML and add the nodes as children of xt
+ *
+ * The tree is not bound to YANG and namespaces are not checked.
+ * @param[in]  buf   Binary encoded message, starting with magic
+ * @param[in]  len   Length of buf
+ * @param[in]  xt    Top of XML parse tree, decoded top-level nodes are added to it
+ * @retval     0     OK
+ * @retval    -1     Error or malformed message, clicon_err called
+ * @see clixon_xml2bin  Encoding
+ */
+int
+clixon_bin_parse(const char *buf,
+                 size_t      len,
+                 cxobj      *xt)
+{
+    int         retval = -1;
+    bin_dec     bd = {0,};
+    cxobj      *xp = xt;
+    cxobj      *x;
+    uint8_t     op;
+    char       *prefix;
+    char       *name;
+    char       *val;
+    const char *b;
+    uint32_t    blen;
+    uint32_t    i;
+    cbuf       *cbv = NULL; /* Body value */
+
+    if (!clixon_bin_magic(buf, len) || (uint8_t)buf[CXB_MAGIC_LEN] != CXB_VERSION){
+        clicon_err(OE_XML, EINVAL, "Not a binary encoded message or wrong version");
+        goto done;
+    }
+    if ((cbv = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    bd.bd_p = (const uint8_t*)buf + CXB_MAGIC_LEN + 1;
+    bd.bd_end = (const uint8_t*)buf + len;
+    while (1){
+        if (bd.bd_p >= bd.bd_end)
+            goto malformed;
+        op = *bd.bd_p++;
+        switch (op){
+        case CXB_END:
+            if (xp == xt)
+                goto ok;
+            xp = xml_parent(xp);
+            break;
+        case CXB_ELMNT:
+            if (bin_dec_str(&bd, &prefix) < 0 || bin_dec_str(&bd, &name) < 0 || name == NULL)
+                goto malformed;
+            if ((x = xml_new(name, xp, CX_ELMNT)) == NULL)
+                goto done;
+            if (prefix && xml_prefix_set(x, prefix) < 0)
+                goto done;
+            xp = x;
+            break;
+        case CXB_ATTR:
+            if (xp == xt)
+                goto malformed;
+            if (bin_dec_str(&bd, &prefix) < 0 || bin_dec_str(&bd, &name) < 0 ||
+                bin_dec_str(&bd, &val) < 0 || name == NULL || val == NULL)
+                goto malformed;
+            if ((x = xml_new(name, xp, CX_ATTR)) == NULL)
+                goto done;
+            if (prefix && xml_prefix_set(x, prefix) < 0)
+                goto done;
+            if (xml_value_set(x, val) < 0)
+                goto done;
+            break;
+        case CXB_BODY:
+            if (xp == xt || bin_dec_bytes(&bd, &b, &blen) < 0)
+                goto malformed;
+            if ((x = xml_new("body", xp, CX_BODY)) == NULL)
+                goto done;
+            cbuf_reset(cbv);
+            if (cbuf_append_buf(cbv, (void*)b, blen) < 0){
+                clicon_err(OE_XML, errno, "cbuf_append_buf");
+                goto done;
+            }
+            if (xml_value_set(x, cbuf_get(cbv)) < 0)
+                goto done;
+            break;
+        default:
+            goto malformed;
+        }
+    }
+ ok:
+    retval = 0;
+ done:
+    for (i = 0; i < bd.bd_nr; i++)
+        free(bd.bd_strs[i]);
+    if (bd.bd_strs)
+        free(bd.bd_strs);
+    if (cbv)
+        cbuf_free(cbv);
+    return retval;
+ malformed:
+    clicon_err(OE_XML, EINVAL, "Malformed binary encoded message");
+    goto done;
+}
@@ -135,8 +135,10 @@ strip_body_objects(cxobj *xt)
 
 /*! Associate XML node x with x:s parents yang:s matching child
  *
- * @param[in]   xt     XML tree node
- * @param[out]  xerr   Reason for failure, or NULL
+ * @param[in]   xt       XML tree node
+ * @param[in]   xsibling Previous sibling with same name used as role model, or NULL
+ * @param[in]   index    Insert xt in search index of grand-parent (if index variable)
+ * @param[out]  xerr     Reason for failure, or NULL
  * @retval      1      OK Yang assignment made
  * @retval      2      OK Yang assignment not made because yang parent is anyxml or anydata
  * @retval      0      Yang assigment not made and xerr set
@@ -147,6 +149,7 @@ strip_body_objects(cxobj *xt)
 static int
 populate_self_parent(cxobj  *xt,
                      cxobj  *xsibling,
+                     int     index,
                      cxobj **xerr)
 {
     int        retval = -1;
@@ -228,7 +231,7 @@ populate_self_parent(cxobj  *xt,
  set:
     xml_spec_set(xt, y);
 #ifdef XML_EXPLICIT_INDEX
-    if (xml_search_index_p(xt))
+    if (index && xml_search_index_p(xt))
         xml_search_child_insert(xp, xt);
 #endif
     retval = 1;
@@ -411,7 +414,7 @@ xml_bind_yang0_opt(cxobj     *xt,
 
     switch (yb){
     case YB_PARENT:
-        if ((ret = populate_self_parent(xt, xsibling, xerr)) < 0)
+        if ((ret = populate_self_parent(xt, xsibling, 1, xerr)) < 0)
             goto done;
         break;
     default:
@@ -487,7 +490,7 @@ xml_bind_yang0(cxobj     *xt,
             goto done;
         break;
     case YB_PARENT:
-        if ((ret = populate_self_parent(xt, NULL, xerr)) < 0)
+        if ((ret = populate_self_parent(xt, NULL, 1, xerr)) < 0)
             goto done;
         break;
     case YB_NONE:
@@ -519,6 +522,45 @@ xml_bind_yang0(cxobj     *xt,
     goto done;
 }
 
+/*! Find yang spec association of a single XML node, not its children
+ *
+ * Used by incremental parsers where a node is bound when its start-tag is complete, ie
+ * before its bodies and children are parsed. Therefore bodies are not stripped and the
+ * node is not inserted in any search index, this is left to the caller.
+ * @param[in]   xt       XML tree node
+ * @param[in]   yb       How to bind yang to XML node: YB_MODULE or YB_PARENT
+ * @param[in]   yspec    Yang spec (for YB_MODULE)
+ * @param[in]   xsibling Previous sibling with same name used as role model, or NULL
+ * @param[out]  xerr     Reason for failure, or NULL
+ * @retval      2        OK Yang assignment not made because yang parent is anyxml or anydata
+ * @retval      1        OK yang assignment made
+ * @retval      0        Yang assigment not made and xerr set
+ * @retval     -1        Error
+ * @see xml_bind_yang0  Bind a complete tree
+ */
+int
+xml_bind_yang_node(cxobj     *xt, 
+                   yang_bind  yb,
+                   yang_stmt *yspec,
+                   cxobj     *xsibling,
+                   cxobj    **xerr)
+{
+    int retval = -1;
+
+    switch (yb){
+    case YB_MODULE:
+        retval = populate_self_top(xt, yspec, xerr);
+        break;
+    case YB_PARENT:
+        retval = populate_self_parent(xt, xsibling, 0, xerr);
+        break;
+    default:
+        clicon_err(OE_XML, EINVAL, "Invalid yang binding: %d", yb);
+        break;
+    }
+    return retval;
+}
+
 /*! RPC-specific
  */
 static int
@@ -0,0 +1,703 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+
+ * NETCONF subtree filtering, RFC 6241 Section 6
+ *
+ * A subtree filter is compiled into a tree of match nodes, each bound to its YANG data node:
+ * - selection node:   empty leaf element, selects the node and its complete subtree
+ * - content match:    leaf element with a value, all content match siblings must be equal
+ * - containment node: element with element children, evaluated recursively
+ * Attribute match expressions are kept as name/value pairs on the node.
+ * If all keys of a list are content match nodes, the list entry is found by binary search
+ * on the keys, other nodes are looked up by name, which is also binary search if the data
+ * is yang-bound and sorted.
+ * The compiled filter is applied to a tree by copying only the selected nodes (and their
+ * ancestors) to a new result tree.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <string.h>
+#include <ctype.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon_err.h"
+#include "clixon_string.h"
+#include "clixon_queue.h"
+#include "clixon_hash.h"
+#include "clixon_handle.h"
+#include "clixon_log.h"
+#include "clixon_yang.h"
+#include "clixon_xml.h"
+#include "clixon_yang_module.h"
+#include "clixon_xml_vec.h"
+#include "clixon_xml_sort.h"
+#include "clixon_xml_nsctx.h"
+#include "clixon_xml_filter.h"
+
+/*
+ * Types
+ */
+/* Subtree filter node type, RFC 6241 Sec 6.2 */
+enum filter_type{
+    FILTER_SELECTION,   /* Empty leaf: select node and its subtree */
+    FILTER_CONTENT,     /* Leaf with value: content match */
+    FILTER_CONTAINMENT, /* Element with element children */
+};
+
+/* Compiled subtree filter node */
+struct clixon_xml_filter{
+    clixon_xml_filter *xf_next;    /* Next sibling */
+    clixon_xml_filter *xf_child;   /* First child */
+    enum filter_type   xf_type;    /* Selection, content match or containment */
+    char              *xf_name;    /* Element name */
+    char              *xf_ns;      /* Namespace, NULL matches any */
+    yang_stmt         *xf_yang;    /* YANG data node, NULL if not found */
+    yang_stmt         *xf_yparent; /* YANG module or data node where xf_yang was found */
+    char              *xf_value;   /* Content match value */
+    cvec              *xf_attrs;   /* Attribute match name/value pairs, or NULL */
+    cvec              *xf_keys;    /* List key values if all keys are content match nodes */
+    int                xf_nselect; /* Number of selection and containment children */
+};
+
+/*! Check if string only contains whitespace
+ */
+static int
+filter_isspace(char *str)
+{
+    char *s;
+
+    for (s = str; *s; s++)
+        if (!isspace(*s))
+            return 0;
+    return 1;
+}
+
+/*! If all keys of a list node are content match children, make a key vector for index search
+ * @param[in]  xf    Containment filter node bound to a YANG list
+ * @retval     0     OK, xf_keys set if all keys were found
+ * @retval    -1     Error
+ */
+static int
+filter_compile_keys(clixon_xml_filter *xf)
+{
+    int                retval = -1;
+    cvec              *cvv;
+    cvec              *cvk = NULL;
+    cg_var            *cvi;
+    clixon_xml_filter *xfc;
+    char              *keyname;
+
+    if ((cvv = yang_cvec_get(xf->xf_yang)) == NULL || cvec_len(cvv) == 0)
+        goto ok;
+    if ((cvk = cvec_new(0)) == NULL){
+        clicon_err(OE_UNIX, errno, "cvec_new");
+        goto done;
+    }
+    cvi = NULL;
+    while ((cvi = cvec_each(cvv, cvi)) != NULL) {
+        keyname = cv_string_get(cvi);
+        for (xfc = xf->xf_child; xfc != NULL; xfc = xfc->xf_next)
+            if (xfc->xf_type == FILTER_CONTENT && strcmp(xfc->xf_name, keyname) == 0)
+                break;
+        if (xfc == NULL)
+            goto ok;
+        if (cvec_add_string(cvk, keyname, xfc->xf_value) < 0){
+            clicon_err(OE_UNIX, errno, "cvec_add_string");
+            goto done;
+        }
+    }
+    xf->xf_keys = cvk;
+    cvk = NULL;
+ ok:
+    retval = 0;
+ done:
+    if (cvk)
+        cvec_free(cvk);
+    return retval;
+}
+
+/*! Compile one subtree filter element recursively
+ * @param[in]  yspec  YANG spec
+ * @param[in]  yp     YANG parent of x, or NULL
+ * @param[in]  top    Set if x is a top-level filter element
+ * @param[in]  x      Filter element
+ * @param[out] xfp    Compiled filter node
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+filter_compile1(yang_stmt          *yspec,
+                yang_stmt          *yp,
+                int                 top,
+                cxobj              *x,
+                clixon_xml_filter **xfp)
+{
+    int                 retval = -1;
+    clixon_xml_filter  *xf = NULL;
+    clixon_xml_filter **xfcp;
+    cxobj              *xc;
+    yang_stmt          *ymod;
+    yang_stmt          *y = NULL;
+    char               *ns = NULL;
+    char               *body;
+
+    if ((xf = malloc(sizeof(*xf))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(xf, 0, sizeof(*xf));
+    if ((xf->xf_name = strdup(xml_name(x))) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    if (xml2ns(x, xml_prefix(x), &ns) < 0)
+        goto done;
+    if (top){ /* Module given by namespace, or first module defining the node */
+        ymod = NULL;
+        if (ns != NULL){
+            if ((ymod = yang_find_module_by_namespace(yspec, ns)) != NULL)
+                y = yang_find_datanode(ymod, xf->xf_name);
+        }
+        else while ((ymod = yn_each(yspec, ymod)) != NULL)
+            if (yang_keyword_get(ymod) == Y_MODULE &&
+                (y = yang_find_datanode(ymod, xf->xf_name)) != NULL)
+                break;
+        xf->xf_yparent = ymod;
+    }
+    else if (yp != NULL &&
+             yang_keyword_get(yp) != Y_ANYDATA && yang_keyword_get(yp) != Y_ANYXML){
+        y = yang_find_datanode(yp, xf->xf_name);
+        xf->xf_yparent = yp;
+    }
+    if ((xf->xf_yang = y) != NULL && ns == NULL)
+        ns = yang_find_mynamespace(y);
+    if (ns && (xf->xf_ns = strdup(ns)) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    /* Attribute match expressions, skip namespace declarations */
+    xc = NULL;
+    while ((xc = xml_child_each(x, xc, CX_ATTR)) != NULL) {
+        if (strcmp(xml_name(xc), "xmlns") == 0 ||
+            (xml_prefix(xc) && strcmp(xml_prefix(xc), "xmlns") == 0))
+            continue;
+        if (xf->xf_attrs == NULL &&
+            (xf->xf_attrs = cvec_new(0)) == NULL){
+            clicon_err(OE_UNIX, errno, "cvec_new");
+            goto done;
+        }
+        if (cvec_add_string(xf->xf_attrs, xml_name(xc), xml_value(xc)?xml_value(xc):"") < 0){
+            clicon_err(OE_UNIX, errno, "cvec_add_string");
+            goto done;
+        }
+    }
+    if (xml_child_nr_type(x, CX_ELMNT) > 0){
+        xf->xf_type = FILTER_CONTAINMENT;
+        xfcp = &xf->xf_child;
+        xc = NULL;
+        while ((xc = xml_child_each(x, xc, CX_ELMNT)) != NULL) {
+            if (filter_compile1(yspec, y, 0, xc, xfcp) < 0)
+                goto done;
+            if ((*xfcp)->xf_type != FILTER_CONTENT)
+                xf->xf_nselect++;
+            xfcp = &(*xfcp)->xf_next;
+        }
+        if (y && yang_keyword_get(y) == Y_LIST &&
+            filter_compile_keys(xf) < 0)
+            goto done;
+    }
+    else if ((body = xml_body(x)) != NULL && !filter_isspace(body)){
+        xf->xf_type = FILTER_CONTENT;
+        if ((xf->xf_value = strdup(body)) == NULL){
+            clicon_err(OE_UNIX, errno, "strdup");
+            goto done;
+        }
+    }
+    else
+        xf->xf_type = FILTER_SELECTION;
+    *xfp = xf;
+    xf = NULL;
+    retval = 0;
+ done:
+    if (xf)
+        clixon_xml_filter_free(xf);
+    return retval;
+}
+
+/*! Compile a NETCONF subtree filter
+ *
+ * @param[in]  yspec    YANG spec
+ * @param[in]  xfilter  The <filter> element, its element children are the filter
+ * @param[out] xfp      Compiled filter, NULL if filter is empty. Free with clixon_xml_filter_free
+ * @retval     0        OK
+ * @retval    -1        Error
+ * @code
+ *   clixon_xml_filter *xf = NULL;
+ *   if (clixon_xml_filter_compile(yspec, xfilter, &xf) < 0)
+ *      err;
+ *   if (xf && clixon_xml_filter_apply(xf, xt, &xret) < 0)
+ *      err;
+ *   clixon_xml_filter_free(xf);
+ * @endcode
+ * @note Elements not found in YANG are kept and matched by name, which means they only match
+ *       unbound data, such as anydata content
+ */
+int
+clixon_xml_filter_compile(yang_stmt          *yspec,
+                          cxobj              *xfilter,
+                          clixon_xml_filter **xfp)
+{
+    int                 retval = -1;
+    clixon_xml_filter  *xf = NULL;
+    clixon_xml_filter **xfcp = &xf;
+    cxobj              *x;
+
+    x = NULL;
+    while ((x = xml_child_each(xfilter, x, CX_ELMNT)) != NULL) {
+        if (filter_compile1(yspec, NULL, 1, x, xfcp) < 0)
+            goto done;
+        xfcp = &(*xfcp)->xf_next;
+    }
+    *xfp = xf;
+    xf = NULL;
+    retval = 0;
+ done:
+    if (xf)
+        clixon_xml_filter_free(xf);
+    return retval;
+}
+
+/*! Make an xpath selecting the top-level nodes of a compiled subtree filter
+ *
+ * Used to narrow datastore and state data retrieval before the filter is applied
+ * @param[in]  xf     Compiled filter
+ * @param[out] xpath  Union of top-level paths, or NULL for all. Free after use
+ * @param[out] nsc    Namespace context of xpath, or NULL. Free with xml_nsctx_free
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+int
+clixon_xml_filter_xpath(clixon_xml_filter *xf,
+                        char             **xpath,
+                        cvec             **nsc)
+{
+    int    retval = -1;
+    cbuf  *cb = NULL;
+    cvec  *nsc1 = NULL;
+    char  *prefix;
+    char  *ns;
+    char  *ns1;
+
+    *xpath = NULL;
+    *nsc = NULL;
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if ((nsc1 = xml_nsctx_init(NULL, NULL)) == NULL)
+        goto done;
+    for (; xf != NULL; xf = xf->xf_next){
+        if (xf->xf_type == FILTER_CONTENT || xf->xf_yang == NULL)
+            continue; /* Matches nothing in yang-bound data */
+        if ((prefix = yang_find_myprefix(xf->xf_yang)) == NULL ||
+            (ns = yang_find_mynamespace(xf->xf_yang)) == NULL)
+            goto ok;
+        if ((ns1 = xml_nsctx_get(nsc1, prefix)) == NULL){
+            if (xml_nsctx_add(nsc1, prefix, ns) < 0)
+                goto done;
+        }
+        else if (strcmp(ns, ns1) != 0)
+            goto ok; /* Prefix clash between modules: do not narrow */
+        cprintf(cb, "%s/%s:%s", cbuf_len(cb)?" | ":"", prefix, xf->xf_name);
+    }
+    if (cbuf_len(cb) == 0)
+        goto ok;
+    if ((*xpath = strdup(cbuf_get(cb))) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    *nsc = nsc1;
+    nsc1 = NULL;
+ ok:
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    if (nsc1)
+        xml_nsctx_free(nsc1);
+    return retval;
+}
+
+/*! Copy a selected node to the result tree unless already copied
+ *
+ * Source nodes are flagged: XML_FLAG_MARK if copied, and also XML_FLAG_CHANGE if the complete
+ * subtree was copied. Flagged nodes are added to xmark so that flags can be reset afterwards.
+ * @param[in]  x0     Source node
+ * @param[in]  x1p    Result parent
+ * @param[in]  whole  Copy complete subtree, else the node and its attributes only
+ * @param[in]  xmark  Vector of flagged source nodes
+ * @param[out] x1pp   Result node, NULL if complete subtree was already copied
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+filter_copy(cxobj       *x0,
+            cxobj       *x1p,
+            int          whole,
+            clixon_xvec *xmark,
+            cxobj      **x1pp)
+{
+    int    retval = -1;
+    cxobj *x1 = NULL;
+    cxobj *xa;
+    cxobj *x1a;
+
+    *x1pp = NULL;
+    if (xml_flag(x0, XML_FLAG_CHANGE))
+        goto ok;
+    if (xml_flag(x0, XML_FLAG_MARK)){ /* Find earlier partial copy */
+        while ((x1 = xml_child_each(x1p, x1, CX_ELMNT)) != NULL)
+            if (strcmp(xml_name(x1), xml_name(x0)) == 0 &&
+                xml_cmp(x1, x0, 0, 0, NULL) == 0)
+                break;
+    }
+    else if (clixon_xvec_append(xmark, x0) < 0)
+        goto done;
+    if (whole){
+        if (x1 && xml_purge(x1) < 0)
+            goto done;
+        if ((x1 = xml_new(xml_name(x0), x1p, CX_ELMNT)) == NULL)
+            goto done;
+        if (xml_copy(x0, x1) < 0)
+            goto done;
+        xml_flag_set(x0, XML_FLAG_MARK|XML_FLAG_CHANGE);
+    }
+    else if (x1 == NULL){
+        if ((x1 = xml_new(xml_name(x0), x1p, CX_ELMNT)) == NULL)
+            goto done;
+        if (xml_copy_one(x0, x1) < 0)
+            goto done;
+        xa = NULL;
+        while ((xa = xml_child_each(x0, xa, CX_ATTR)) != NULL) {
+            if ((x1a = xml_new(xml_name(xa), x1, CX_ATTR)) == NULL)
+                goto done;
+            if (xml_copy_one(xa, x1a) < 0)
+                goto done;
+        }
+        xml_flag_set(x0, XML_FLAG_MARK);
+    }
+    *x1pp = x1;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Match a content match node against the children of a source node
+ *
+ * @param[in]  xf     Content match filter node
+ * @param[in]  x0     Source parent node
+ * @param[in]  x1     Result parent node. If set, matching children are copied
+ * @param[in]  xmark  Vector of flagged source nodes
+ * @retval     1      Match
+ * @retval     0      No match
+ * @retval    -1      Error
+ */
+static int
+filter_content(clixon_xml_filter *xf,
+               cxobj             *x0,
+               cxobj             *x1,
+               clixon_xvec       *xmark)
+{
+    cxobj *xc = NULL;
+    cxobj *x1c;
+    char  *body;
+    int    match = 0;
+
+    while ((xc = xml_child_each(x0, xc, CX_ELMNT)) != NULL) {
+        if (strcmp(xml_name(xc), xf->xf_name) != 0 ||
+            (body = xml_body(xc)) == NULL ||
+            strcmp(body, xf->xf_value) != 0)
+            continue;
+        match++;
+        if (x1 == NULL)
+            break;
+        if (filter_copy(xc, x1, 1, xmark, &x1c) < 0)
+            return -1;
+    }
+    return match?1:0;
+}
+
+static int filter_apply_children(clixon_xml_filter *xf, cxobj *x0, cxobj *x1,
+                                 clixon_xvec *xmark, int *nr);
+
+/*! Apply a selection or containment filter node to a matching source node
+ *
+ * @param[in]  xf     Filter node
+ * @param[in]  x0     Source node with same name as xf
+ * @param[in]  x1p    Result parent
+ * @param[in]  xmark  Vector of flagged source nodes
+ * @param[out] nr     Incremented if x0 was selected
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+filter_node(clixon_xml_filter *xf,
+            cxobj             *x0,
+            cxobj             *x1p,
+            clixon_xvec       *xmark,
+            int               *nr)
+{
+    int                retval = -1;
+    clixon_xml_filter *xfc;
+    cg_var            *cvi;
+    cvec              *cvk;
+    cxobj             *x1 = NULL;
+    cxobj             *xk;
+    cxobj             *x1k;
+    char              *val;
+    int                created;
+    int                ncontent = 0;
+    int                n = 0;
+    int                ret;
+
+    /* Attribute match */
+    if (xf->xf_attrs){
+        cvi = NULL;
+        while ((cvi = cvec_each(xf->xf_attrs, cvi)) != NULL) {
+            if ((val = xml_find_type_value(x0, NULL, cv_name_get(cvi), CX_ATTR)) == NULL ||
+                strcmp(val, cv_string_get(cvi)) != 0)
+                goto ok;
+        }
+    }
+    /* Content match: all content match children must match */
+    for (xfc = xf->xf_child; xfc != NULL; xfc = xfc->xf_next){
+        if (xfc->xf_type != FILTER_CONTENT)
+            continue;
+        ncontent++;
+        if ((ret = filter_content(xfc, x0, NULL, xmark)) < 0)
+            goto done;
+        if (ret == 0)
+            goto ok;
+    }
+    (*nr)++;
+    /* Selection node, or only content match children: select complete subtree */
+    if (xf->xf_type == FILTER_SELECTION || xf->xf_nselect == 0){
+        if (filter_copy(x0, x1p, 1, xmark, &x1) < 0)
+            goto done;
+        goto ok;
+    }
+    created = !xml_flag(x0, XML_FLAG_MARK);
+    if (filter_copy(x0, x1p, 0, xmark, &x1) < 0)
+        goto done;
+    if (x1 == NULL) /* Already copied */
+        goto ok;
+    /* Copy matching content nodes */
+    for (xfc = xf->xf_child; xfc != NULL; xfc = xfc->xf_next)
+        if (xfc->xf_type == FILTER_CONTENT &&
+            filter_content(xfc, x0, x1, xmark) < 0)
+            goto done;
+    if (filter_apply_children(xf->xf_child, x0, x1, xmark, &n) < 0)
+        goto done;
+    /* Containment node without content match that selects nothing is removed */
+    if (n == 0 && ncontent == 0 && created){
+        (*nr)--;
+        if (xml_purge(x1) < 0)
+            goto done;
+        xml_flag_reset(x0, XML_FLAG_MARK);
+        goto ok;
+    }
+    /* Copy list keys */
+    if (xf->xf_yang && yang_keyword_get(xf->xf_yang) == Y_LIST &&
+        (cvk = yang_cvec_get(xf->xf_yang)) != NULL){
+        cvi = NULL;
+        while ((cvi = cvec_each(cvk, cvi)) != NULL) {
+            if ((xk = xml_find_type(x0, NULL, cv_string_get(cvi), CX_ELMNT)) != NULL &&
+                filter_copy(xk, x1, 1, xmark, &x1k) < 0)
+                goto done;
+        }
+    }
+    if (xml_sort(x1) < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Apply a list of sibling filter nodes to the children of a source node
+ *
+ * @param[in]  xf     First filter node in sibling list
+ * @param[in]  x0     Source parent
+ * @param[in]  x1     Result parent
+ * @param[in]  xmark  Vector of flagged source nodes
+ * @param[out] nr     Incremented for every selected source child
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+filter_apply_children(clixon_xml_filter *xf,
+                      cxobj             *x0,
+                      cxobj             *x1,
+                      clixon_xvec       *xmark,
+                      int               *nr)
+{
+    int          retval = -1;
+    clixon_xvec *xv = NULL;
+    cxobj       *xc;
+    char        *ns;
+    int          i;
+
+    for (; xf != NULL; xf = xf->xf_next){
+        if (xf->xf_type == FILTER_CONTENT)
+            continue;
+        if ((xv = clixon_xvec_new()) == NULL)
+            goto done;
+        if (xf->xf_yang != NULL && yang_keyword_get(xf->xf_yang) != Y_LEAF_LIST){
+            /* Binary search on list keys if given, otherwise on name */
+            if (clixon_xml_find_index(x0, xf->xf_yparent, xf->xf_ns, xf->xf_name,
+                                      xf->xf_keys, xv) < 0)
+                goto done;
+        }
+        else {
+            xc = NULL;
+            while ((xc = xml_child_each(x0, xc, CX_ELMNT)) != NULL) {
+                if (strcmp(xml_name(xc), xf->xf_name) != 0)
+                    continue;
+                if (xf->xf_ns){
+                    ns = NULL;
+                    if (xml2ns(xc, xml_prefix(xc), &ns) < 0)
+                        goto done;
+                    if (ns == NULL || strcmp(ns, xf->xf_ns) != 0)
+                        continue;
+                }
+                if (clixon_xvec_append(xv, xc) < 0)
+                    goto done;
+            }
+        }
+        for (i=0; i<clixon_xvec_len(xv); i++)
+            if (filter_node(xf, clixon_xvec_i(xv, i), x1, xmark, nr) < 0)
+                goto done;
+        clixon_xvec_free(xv);
+        xv = NULL;
+    }
+    retval = 0;
+ done:
+    if (xv)
+        clixon_xvec_free(xv);
+    return retval;
+}
+
+/*! Apply a compiled subtree filter to an XML tree and return a new tree with selected nodes
+ *
+ * @param[in]  xf    Compiled filter
+ * @param[in]  xt    Top of source tree, eg datastore top. Not modified.
+ * @param[out] xret  New top with copies of the selected nodes. Free with xml_free
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @note XML_FLAG_MARK and XML_FLAG_CHANGE are used transiently in the source tree
+ */
+int
+clixon_xml_filter_apply(clixon_xml_filter *xf,
+                        cxobj             *xt,
+                        cxobj            **xret)
+{
+    int          retval = -1;
+    clixon_xvec *xmark = NULL;
+    cxobj       *x1t = NULL;
+    int          nr = 0;
+    int          i;
+
+    if ((xmark = clixon_xvec_new()) == NULL)
+        goto done;
+    if ((x1t = xml_new(xml_name(xt), NULL, CX_ELMNT)) == NULL)
+        goto done;
+    xml_spec_set(x1t, xml_spec(xt));
+    xml_flag_set(x1t, XML_FLAG_TOP);
+    if (filter_apply_children(xf, xt, x1t, xmark, &nr) < 0)
+        goto done;
+    if (xml_sort(x1t) < 0)
+        goto done;
+    *xret = x1t;
+    x1t = NULL;
+    retval = 0;
+ done:
+    if (xmark){
+        for (i=0; i<clixon_xvec_len(xmark); i++)
+            xml_flag_reset(clixon_xvec_i(xmark, i), XML_FLAG_MARK|XML_FLAG_CHANGE);
+        clixon_xvec_free(xmark);
+    }
+    if (x1t)
+        xml_free(x1t);
+    return retval;
+}
+
+/*! Free a compiled subtree filter
+ * @param[in]  xf   Compiled filter
+ * @retval     0    OK
+ */
+int
+clixon_xml_filter_free(clixon_xml_filter *xf)
+{
+    clixon_xml_filter *xnext;
+
+    while (xf != NULL){
+        xnext = xf->xf_next;
+        if (xf->xf_child)
+            clixon_xml_filter_free(xf->xf_child);
+        if (xf->xf_name)
+            free(xf->xf_name);
+        if (xf->xf_ns)
+            free(xf->xf_ns);
+        if (xf->xf_value)
+            free(xf->xf_value);
+        if (xf->xf_attrs)
+            cvec_free(xf->xf_attrs);
+        if (xf->xf_keys)
+            cvec_free(xf->xf_keys);
+        free(xf);
+        xf = xnext;
+    }
+    return 0;
+}
@@ -72,14 +72,14 @@
 #include "clixon_xml_vec.h"
 #include "clixon_xml_sort.h"
 #include "clixon_xml_nsctx.h"
-#include "clixon_xml_parse.h"
 #include "clixon_xml_io.h"
+#include "clixon_xml_sax.h"
 
 /*
  * Constants
  */
 /* Size of xml read buffer */
-#define BUFLEN 1024  
+#define BUFLEN 8192
 
 /*------------------------------------------------------------------------
  * XML printing functions. Output a parse tree to file, string cligen buf
@@ -502,135 +502,6 @@ xmltree2cbuf(cbuf  *cb,
 /*--------------------------------------------------------------------
  * XML parsing functions. Create XML parse tree from string and file.
  *--------------------------------------------------------------------*/
-/*! Common internal xml parsing function string to parse-tree
- *
- * Given a string containing XML, parse into existing XML tree and return
- * @param[in]     str   Pointer to string containing XML definition. 
- * @param[in]     yb    How to bind yang to XML top-level when parsing
- * @param[in]     yspec Yang specification (only if bind is TOP or CONFIG)
- * @param[in,out] xtop  Top of XML parse tree. Assume created. Holds new tree.
- * @param[out]    xerr  Reason for failure (yang assignment not made)
- * @retval        1     Parse OK and all yang assignment made
- * @retval        0     Parse OK but yang assigment not made (or only partial) and xerr set
- * @retval       -1     Error with clicon_err called. Includes parse error
- * @see clixon_xml_parse_file
- * @see clixon_xml_parse_string
- * @see _json_parse
- * @note special case is empty XML where the parser is not invoked.
- * It is questionable empty XML is legal. From https://www.w3.org/TR/2008/REC-xml-20081126 Sec 2.1:
- *    A well-formed document ... contains one or more elements.
- * But in clixon one can invoke a parser on a sub-part of a document where it makes sense to accept
- * an empty XML. For example where an empty config: <config></config> is parsed.
- * In other cases, such as receiving netconf ]]>]]> it should represent a complete document and 
- * therefore not well-formed.
- * Therefore checking for empty XML must be done by a calling function which knows wether the 
- * the XML represents a full document or not.
- * @note may be called recursively, some yang-bind (eg rpc) semantic checks may trigger error message
- */
-static int 
-_xml_parse(const char *str, 
-           yang_bind   yb,
-           yang_stmt  *yspec,
-           cxobj      *xt,
-           cxobj     **xerr)
-{
-    int             retval = -1;
-    clixon_xml_yacc xy = {0,};
-    cxobj          *x;
-    int             ret;
-    int             failed = 0; /* yang assignment */
-    int             i;
-
-    clicon_debug(2, "%s", __FUNCTION__);
-    if (strlen(str) == 0){
-        return 1; /* OK */
-    }
-    if (xt == NULL){
-        clicon_err(OE_XML, errno, "Unexpected NULL XML");
-        return -1;      
-    }
-    if ((xy.xy_parse_string = strdup(str)) == NULL){
-        clicon_err(OE_XML, errno, "strdup");
-        return -1;
-    }
-    xy.xy_xtop = xt;
-    xy.xy_xparent = xt;
-    xy.xy_yspec = yspec;
-    if (clixon_xml_parsel_init(&xy) < 0)
-        goto done;    
-    if (clixon_xml_parseparse(&xy) != 0)  /* yacc returns 1 on error */
-        goto done;
-    /* Purge all top-level body objects */
-    x = NULL;
-    while ((x = xml_find_type(xt, NULL, "body", CX_BODY)) != NULL)
-        xml_purge(x);
-    /* Traverse new objects */
-    for (i = 0; i < xy.xy_xlen; i++) {
-        x = xy.xy_xvec[i];
-        /* Verify namespaces after parsing */
-        if (xml2ns_recurse(x) < 0)
-            goto done;
-        /* Populate, ie associate xml nodes with yang specs 
-         */
-        switch (yb){
-        case YB_NONE:
-            break;
-        case YB_PARENT:
-            /* xt:n         Has spec
-             * x:   <a> <-- populate from parent
-             */
-            if ((ret = xml_bind_yang0(x, YB_PARENT, NULL, xerr)) < 0)
-                goto done;
-            if (ret == 0)
-                failed++;
-            break;
-
-        case YB_MODULE_NEXT:
-            if ((ret = xml_bind_yang(x, YB_MODULE, yspec, xerr)) < 0)
-                goto done;
-            if (ret == 0)
-                failed++;
-            break;
-        case YB_MODULE:
-            /* xt:<top>     nospec
-             * x:   <a> <-- populate from modules
-             */
-            if ((ret = xml_bind_yang0(x, YB_MODULE, yspec, xerr)) < 0)
-                goto done;
-            if (ret == 0)
-                failed++;
-            break;
-        case YB_RPC:
-            if ((ret = xml_bind_yang_rpc(x, yspec, xerr)) < 0)
-                goto done;
-            if (ret == 0){ /* Add message-id */
-                if (*xerr && clixon_xml_attr_copy(x, *xerr, "message-id") < 0)
-                    goto done;
-                failed++;
-            }
-            break;
-        } /* switch */
-    }
-    if (failed)
-        goto fail;
-    /* Sort the complete tree after parsing. Sorting is not really meaningful if Yang
-       not bound */
-    if (yb != YB_NONE)
-        if (xml_sort_recurse(xt) < 0)
-            goto done;
-    retval = 1;
-  done:
-    clixon_xml_parsel_exit(&xy);
-    if (xy.xy_parse_string != NULL)
-        free(xy.xy_parse_string);
-    if (xy.xy_xvec)
-        free(xy.xy_xvec);
-    return retval; 
- fail: /* invalid */
-    retval = 0;
-    goto done;
-}
-
 /*! Read an XML definition from file and parse it into a parse-tree, advanced API
  *
  * @param[in]     fd    A file descriptor containing the XML file (as ASCII characters)
@@ -656,6 +527,7 @@ _xml_parse(const char *str,
  * @see clixon_json_parse_file
  * @note, If xt empty, a top-level symbol will be added so that <tree../> will be:  <top><tree.../></tree></top>
  * @note May block on file I/O
+ * @note The file is read in chunks and parsed by the streaming parser, see clixon_xml_sax_new
  */
 int 
 clixon_xml_parse_file(FILE      *fp, 
@@ -664,15 +536,12 @@ clixon_xml_parse_file(FILE      *fp,
                       cxobj    **xt,
                       cxobj    **xerr)
 {
-    int   retval = -1;
-    int   ret;
-    int   len = 0;
-    char  ch;
-    char *xmlbuf = NULL;
-    char *ptr;
-    int   xmlbuflen = BUFLEN; /* start size */
-    int   oldxmlbuflen;
-    int   failed = 0;
+    int             retval = -1;
+    int             ret;
+    size_t          len;
+    char            buf[BUFLEN];
+    clixon_xml_sax *xs = NULL;
+    int             created = 0;
 
     if (xt==NULL || fp == NULL){
         clicon_err(OE_XML, EINVAL, "arg is NULL");
@@ -682,49 +551,81 @@ clixon_xml_parse_file(FILE      *fp,
         clicon_err(OE_XML, EINVAL, "yspec is required if yb == YB_MODULE");
         return -1;
     }
-    if ((xmlbuf = malloc(xmlbuflen)) == NULL){
-        clicon_err(OE_XML, errno, "malloc");
+    if (*xt == NULL){
+        if ((*xt = xml_new(XML_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
+            goto done;
+        created++;
+    }
+    /* Push file contents in chunks to streaming parser */
+    if ((xs = clixon_xml_sax_new(yb, yspec, *xt)) == NULL)
+        goto done;
+    while ((len = fread(buf, 1, sizeof(buf), fp)) > 0)
+        if (clixon_xml_sax_push(xs, buf, len) < 0)
+            goto done;
+    if (ferror(fp)){
+        clicon_err(OE_XML, errno, "fread");
+        goto done;
+    }
+    if ((ret = clixon_xml_sax_end(xs, xerr)) < 0)
         goto done;
+    retval = ret;
+ done:
+    if (xs)
+        clixon_xml_sax_free(xs);
+    if (retval < 0 && created && *xt){
+        xml_free(*xt);
+        *xt = NULL;
     }
-    memset(xmlbuf, 0, xmlbuflen);
-    ptr = xmlbuf;
-    while (1){
-        if ((ret = fread(&ch, 1, 1, fp)) < 0){
-            clicon_err(OE_XML, errno, "read");
-            break;
-        }
-        if (ret != 0){
-            xmlbuf[len++] = ch;
-        }
-        if (ret == 0) {
-            if (*xt == NULL)
-                if ((*xt = xml_new(XML_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
-                    goto done;
-            if ((ret = _xml_parse(ptr, yb, yspec, *xt, xerr)) < 0)
-                goto done;
-            if (ret == 0)
-                failed++;
-            break;
-        }
-        if (len >= xmlbuflen-1){ /* Space: one for the null character */
-            oldxmlbuflen = xmlbuflen;
-            xmlbuflen *= 2;
-            if ((xmlbuf = realloc(xmlbuf, xmlbuflen)) == NULL){
-                clicon_err(OE_XML, errno, "realloc");
-                goto done;
-            }
-            memset(xmlbuf+oldxmlbuflen, 0, xmlbuflen-oldxmlbuflen);
-            ptr = xmlbuf;
-        }
-    } /* while */
-    retval = (failed==0) ? 1 : 0;
+    return retval;
+}
+
+/*! Parse an XML buffer of given length into a parse-tree using the streaming parser
+ *
+ * As clixon_xml_parse_string but the buffer need not be null-terminated and is not copied
+ * @param[in]     buf   Buffer containing XML definition
+ * @param[in]     len   Length of buffer
+ * @param[in]     yb    How to bind yang to XML top-level when parsing
+ * @param[in]     yspec Yang specification, or NULL
+ * @param[in,out] xt    Pointer to XML parse tree. If empty will be created.
+ * @param[out]    xerr  Reason for failure (yang assignment not made) if retval = 0
+ * @retval        1     Parse OK and all yang assignment made
+ * @retval        0     Parse OK but yang assigment not made (or only partial), xerr is set
+ * @retval       -1     Error with clicon_err called. Includes parse error
+ * @see clixon_xml_parse_string
+ */
+int 
+clixon_xml_parse_buf(const char *buf,
+                     size_t      len,
+                     yang_bind   yb,
+                     yang_stmt  *yspec,
+                     cxobj     **xt,
+                     cxobj     **xerr)
+{
+    int             retval = -1;
+    clixon_xml_sax *xs = NULL;
+    int             created = 0;
+
+    if (xt == NULL){
+        clicon_err(OE_XML, EINVAL, "xt is NULL");
+        return -1;
+    }
+    if (*xt == NULL){
+        if ((*xt = xml_new(XML_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
+            goto done;
+        created++;
+    }
+    if ((xs = clixon_xml_sax_new(yb, yspec, *xt)) == NULL)
+        goto done;
+    if (clixon_xml_sax_push(xs, buf, len) < 0)
+        goto done;
+    retval = clixon_xml_sax_end(xs, xerr);
  done:
-    if (retval < 0 && *xt){
-        free(*xt);
+    if (xs)
+        clixon_xml_sax_free(xs);
+    if (retval < 0 && created && *xt){
+        xml_free(*xt);
         *xt = NULL;
     }
-    if (xmlbuf)
-        free(xmlbuf);
     return retval;
 }
 
@@ -753,6 +654,7 @@ clixon_xml_parse_file(FILE      *fp,
  * @see clixon_xml_parse_va
  * @note You need to free the xml parse tree after use, using xml_free()
  * @note If empty on entry, a new TOP xml will be created named "top"
+ * @note Empty XML is accepted, a caller parsing a complete document must check for it
  */
 int 
 clixon_xml_parse_string(const char *str, 
@@ -769,11 +671,7 @@ clixon_xml_parse_string(const char *str,
         clicon_err(OE_XML, EINVAL, "yspec is required if yb == YB_MODULE");
         return -1;
     }
-    if (*xt == NULL){
-        if ((*xt = xml_new(XML_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
-            return -1;
-    }
-    return _xml_parse(str, yb, yspec, *xt, xerr);
+    return clixon_xml_parse_buf(str, strlen(str), yb, yspec, xt, xerr);
 }
 
 /*! Read XML from var-arg list and parse it into xml tree
@@ -72,6 +72,7 @@
 #include "clixon_xml_nsctx.h"
 #include "clixon_xpath_ctx.h"
 #include "clixon_xpath.h"
+#include "clixon_xpath_compile.h"
 #include "clixon_log.h"
 #include "clixon_err.h"
 #include "clixon_netconf_lib.h"
@@ -1603,11 +1604,13 @@ yang_check_when_xpath(cxobj        *xn,
     cvec      *nsc = NULL;
     int        xmalloc = 0;   /* ugly help variable to clean temporary object */
     int        nscmalloc = 0; /* ugly help variable to remove */
+    xpath_compiled *xpc = NULL;
 
     /* First variant */
     if ((xpath = yang_when_xpath_get(yn)) != NULL){
         x = xp;
         nsc = yang_when_nsc_get(yn);
+        xpc = yang_xpath_compiled_get(yn);
         *hit = 1;
     }
     /* Second variant */
@@ -1622,14 +1625,20 @@ yang_check_when_xpath(cxobj        *xn,
         }
         else
             x = xn;
-        if (xml_nsctx_yang(yn, &nsc) < 0)
-            goto done;
-        nscmalloc++;
+        if ((xpc = yang_xpath_compiled_get(yc)) == NULL){
+            if (xml_nsctx_yang(yn, &nsc) < 0)
+                goto done;
+            nscmalloc++;
+        }
         *hit = 1;
     }
     else
         *hit = 0;
-    if (x && xpath){
+    if (x && xpc){
+        if ((nr = xpath_compiled_bool(xpc, x)) < 0)
+            goto done;
+    }
+    else if (x && xpath){
         if ((nr = xpath_vec_bool(x, nsc, "%s", xpath)) < 0)
             goto done;
     }
@@ -0,0 +1,1091 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ * Streaming (push) XML parser with SAX-style callbacks
+ *
+ * Input is pushed in arbitrary chunks, eg as read from a file or socket, and is scanned by a
+ * byte-level state machine. Elements are created as start-tags complete, yang-bound on the fly
+ * and closed (bodies added, children sorted) when their end-tags are seen. Only the text of the
+ * innermost open element and the current token are buffered, and an end callback may consume
+ * completed elements, so memory is bounded by the tree that is kept, not by the input size.
+ *
+ * This is the only XML parser, used for strings, buffers and files, see clixon_xml_parse_buf:
+ * - Several top-level elements are allowed and top-level text is dropped
+ * - Prolog XML declaration, processing instructions and comments
+ * - Mixed content is not supported: bodies of elements with element children are dropped
+ * - CDATA sections are kept verbatim, including the CDATA markers
+ * - CR LF and CR are translated to LF in content
+ * - Character references &#n; and &#xh; are decoded to UTF-8
+ * @see https://www.w3.org/TR/2008/REC-xml-20081126
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <string.h>
+#include <ctype.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon_err.h"
+#include "clixon_string.h"
+#include "clixon_queue.h"
+#include "clixon_hash.h"
+#include "clixon_handle.h"
+#include "clixon_log.h"
+#include "clixon_yang.h"
+#include "clixon_xml.h"
+#include "clixon_xml_bind.h"
+#include "clixon_xml_sort.h"
+#include "clixon_xml_nsctx.h"
+#include "clixon_xml_io.h"
+#include "clixon_xml_sax.h"
+
+/*
+ * Constants
+ */
+/* Max length of an entity reference between & and ; */
+#define XML_SAX_ENTITY_MAX 16
+
+/*
+ * Types
+ */
+/* Lexical state of the push parser */
+enum xml_sax_state{
+    XS_CONTENT,   /* Between tags */
+    XS_JUNK,      /* Non-whitespace text before first element */
+    XS_LT,        /* After < */
+    XS_STAG_NAME, /* In start-tag name */
+    XS_STAG,      /* In start-tag, between attributes */
+    XS_ATTR_NAME, /* In attribute name */
+    XS_ATTR_EQ,   /* After attribute name, expect = */
+    XS_ATTR_QUOTE,/* After =, expect quote */
+    XS_ATTR_VALUE,/* In quoted attribute value */
+    XS_EMPTY,     /* After / in start-tag, expect > */
+    XS_ETAG_NAME, /* In end-tag name */
+    XS_ETAG,      /* After end-tag name, expect > */
+    XS_BANG,      /* After <! */
+    XS_COMMENT,   /* In comment */
+    XS_CDATA,     /* In CDATA section */
+    XS_PI,        /* In processing instruction */
+    XS_ENTITY,    /* In entity reference */
+};
+
+/* Open element */
+struct xml_sax_frame{
+    cxobj    *xf_x;        /* XML element */
+    yang_bind xf_yb;       /* How to bind children: YB_NONE, YB_MODULE or YB_PARENT */
+    int       xf_elmnt;    /* Element has element children */
+    int       xf_rolemodel;/* Element was bound using a sibling as role model */
+    cxobj    *xf_xprev;    /* Last bound element child, role model for next sibling */
+};
+
+/* Push parser handle */
+struct clixon_xml_sax{
+    enum xml_sax_state    xs_state;
+    int                   xs_linenum; /* Number of \n in parsed input */
+    yang_bind             xs_yb;      /* How to bind yang to top-level elements */
+    yang_stmt            *xs_yspec;
+    cxobj                *xs_xtop;    /* Top of tree, parent of top-level elements */
+    struct xml_sax_frame *xs_stack;   /* Stack of open elements */
+    int                   xs_depth;   /* Number of open elements */
+    int                   xs_stacklen;/* Allocated length of stack */
+    cbuf                 *xs_text;    /* Body of innermost open element */
+    cbuf                 *xs_tok;     /* Current token: name, attribute value, entity, PI */
+    char                 *xs_prefix;  /* Prefix of current name token */
+    char                 *xs_aprefix; /* Attribute prefix */
+    char                 *xs_aname;   /* Attribute name */
+    cxobj                *xs_xelement;/* Element of current start-tag */
+    int                   xs_quote;   /* Quote char of attribute value */
+    int                   xs_count;   /* Consecutive '-' in comment, ']' in CDATA, '?' in PI */
+    int                   xs_cr;      /* Last content char was CR */
+    int                   xs_prolog;  /* Nothing but whitespace seen yet */
+    int                   xs_xmldecl; /* XML declaration seen */
+    int                   xs_element; /* At least one element seen */
+    int                   xs_skip;    /* Bind failed in current top-level element */
+    int                   xs_failed;  /* Number of yang bind failures */
+    int                   xs_error;   /* Parse error, parser is unusable */
+    cxobj                *xs_xerr;    /* Reason for first bind failure */
+    clixon_xml_sax_cb    *xs_startfn;
+    clixon_xml_sax_cb    *xs_endfn;
+    void                 *xs_arg;
+};
+
+#define IS_NAMESTART(c) (isalpha((unsigned char)(c)) || (c) == '_')
+#define IS_NAMECHAR(c)  (isalnum((unsigned char)(c)) || (c) == '_' || (c) == '-' || (c) == '.')
+#define IS_WHITESPACE(c) ((c) == ' ' || (c) == '\t' || (c) == '\n' || (c) == '\r')
+
+/*! Report a syntax error on the form "xml_parse: line N: syntax error: at or before: token"
+ *
+ * @param[in]  xs     Push parser handle
+ * @param[in]  token  Token at or before which the error was detected
+ */
+static int
+xml_sax_syntax_err(clixon_xml_sax *xs,
+                   const char     *token)
+{
+    clicon_err(OE_XML, XMLPARSE_ERRNO, "xml_parse: line %d: syntax error: at or before: %s",
+               xs->xs_linenum, token);
+    xs->xs_error++;
+    return -1;
+}
+
+/*! Report a syntax error at a single character
+ */
+static int
+xml_sax_syntax_errc(clixon_xml_sax *xs,
+                    int             c)
+{
+    char str[2] = {c, '\0'};
+
+    return xml_sax_syntax_err(xs, str);
+}
+
+/*! Split current name token into prefix and name at ':'
+ *
+ * @param[in]  xs   Push parser handle
+ * @retval     0    OK
+ * @retval    -1    Error, eg multiple or trailing ':'
+ */
+static int
+xml_sax_prefix(clixon_xml_sax *xs,
+               int             c)
+{
+    if (xs->xs_prefix != NULL || cbuf_len(xs->xs_tok) == 0)
+        return xml_sax_syntax_errc(xs, c);
+    if ((xs->xs_prefix = strdup(cbuf_get(xs->xs_tok))) == NULL){
+        clicon_err(OE_XML, errno, "strdup");
+        return -1;
+    }
+    cbuf_reset(xs->xs_tok);
+    return 0;
+}
+
+/*! Append a character to the current name token, check name syntax
+ */
+static int
+xml_sax_namechar(clixon_xml_sax *xs,
+                 int             c)
+{
+    if (cbuf_len(xs->xs_tok) == 0 ? !IS_NAMESTART(c) : !IS_NAMECHAR(c))
+        return xml_sax_syntax_errc(xs, c);
+    cbuf_append(xs->xs_tok, c);
+    return 0;
+}
+
+/*! Append text to body of innermost open element, unless it has element children
+ */
+static int
+xml_sax_text(clixon_xml_sax *xs,
+             const char     *buf,
+             size_t          len)
+{
+    if (xs->xs_depth > 0 && !xs->xs_stack[xs->xs_depth-1].xf_elmnt)
+        if (cbuf_append_buf(xs->xs_text, (void*)buf, len) < 0){
+            clicon_err(OE_UNIX, errno, "cbuf_append_buf");
+            return -1;
+        }
+    return 0;
+}
+
+/*! Encode a unicode code point as UTF-8 and append it to the current body
+ */
+static int
+xml_sax_text_codepoint(clixon_xml_sax *xs,
+                       uint32_t        cp)
+{
+    char buf[4];
+    int  len;
+
+    if (cp < 0x80){
+        buf[0] = cp;
+        len = 1;
+    }
+    else if (cp < 0x800){
+        buf[0] = 0xC0 | (cp >> 6);
+        buf[1] = 0x80 | (cp & 0x3F);
+        len = 2;
+    }
+    else if (cp < 0x10000){
+        buf[0] = 0xE0 | (cp >> 12);
+        buf[1] = 0x80 | ((cp >> 6) & 0x3F);
+        buf[2] = 0x80 | (cp & 0x3F);
+        len = 3;
+    }
+    else {
+        buf[0] = 0xF0 | (cp >> 18);
+        buf[1] = 0x80 | ((cp >> 12) & 0x3F);
+        buf[2] = 0x80 | ((cp >> 6) & 0x3F);
+        buf[3] = 0x80 | (cp & 0x3F);
+        len = 4;
+    }
+    return xml_sax_text(xs, buf, len);
+}
+
+/*! Decode an entity reference, ie the string between & and ;, and append to body
+ * @see xml_chardata_encode
+ */
+static int
+xml_sax_entity(clixon_xml_sax *xs)
+{
+    char         *ent = cbuf_get(xs->xs_tok);
+    char         *s = NULL;
+    unsigned long cp = 0;
+    char         *end = NULL;
+
+    if (strcmp(ent, "amp") == 0)
+        s = "&";
+    else if (strcmp(ent, "lt") == 0)
+        s = "<";
+    else if (strcmp(ent, "gt") == 0)
+        s = ">";
+    else if (strcmp(ent, "apos") == 0)
+        s = "'";
+    else if (strcmp(ent, "quot") == 0)
+        s = "\"";
+    if (s != NULL)
+        return xml_sax_text(xs, s, 1);
+    /* ISO/IEC 10646 character references */
+    if (ent[0] == '#'){
+        errno = 0;
+        if (ent[1] == 'x' && isxdigit(ent[2]))
+            cp = strtoul(ent+2, &end, 16);
+        else if (isdigit(ent[1]))
+            cp = strtoul(ent+1, &end, 10);
+        if (end != NULL && *end == '\0' && errno == 0 &&
+            cp > 0 && cp <= 0x10FFFF)
+            return xml_sax_text_codepoint(xs, cp);
+    }
+    return xml_sax_syntax_err(xs, "&");
+}
+
+/*! Parse XML declaration, ie the content of <?xml ... ?>
+ *
+ * [23] XMLDecl ::= '<?xml' VersionInfo EncodingDecl? SDDecl? S? '?>'
+ * @param[in]  xs   Push parser handle
+ * @param[in]  str  Declaration string after "xml"
+ */
+static int
+xml_sax_xmldecl(clixon_xml_sax *xs,
+                char           *str)
+{
+    char *s = str;
+    char *name;
+    char *val;
+    int   q;
+    int   i = 0;
+    char *names[] = {"version", "encoding", "standalone", NULL};
+
+    while (1){
+        while (IS_WHITESPACE(*s))
+            s++;
+        if (*s == '\0')
+            break;
+        name = s;
+        while (isalpha(*s))
+            s++;
+        /* Pseudo-attributes are given in order, version is mandatory */
+        while (names[i] && (s-name != strlen(names[i]) || strncmp(name, names[i], s-name) != 0)){
+            if (i == 0)
+                return xml_sax_syntax_errc(xs, *name);
+            i++;
+        }
+        if (names[i] == NULL)
+            return xml_sax_syntax_errc(xs, *name);
+        while (IS_WHITESPACE(*s))
+            s++;
+        if (*s++ != '=')
+            return xml_sax_syntax_errc(xs, *(s-1)?*(s-1):'?');
+        while (IS_WHITESPACE(*s))
+            s++;
+        if ((q = *s++) != '"' && q != '\'')
+            return xml_sax_syntax_errc(xs, q?q:'?');
+        val = s;
+        while (*s && *s != q)
+            s++;
+        if (*s == '\0')
+            return xml_sax_syntax_err(xs, "?>");
+        *s++ = '\0';
+        switch (i){
+        case 0:
+            if (strcmp(val, "1.0")){
+                clicon_err(OE_XML, XMLPARSE_ERRNO, "Unsupported XML version: %s expected 1.0", val);
+                xs->xs_error++;
+                return -1;
+            }
+            break;
+        case 1:
+            if (strcasecmp(val, "UTF-8")){
+                clicon_err(OE_XML, XMLPARSE_ERRNO, "Unsupported XML encoding: %s expected UTF-8", val);
+                xs->xs_error++;
+                return -1;
+            }
+            break;
+        default:
+            break;
+        }
+        i++;
+    }
+    if (i == 0)
+        return xml_sax_syntax_err(xs, "?>");
+    return 0;
+}
+
+/*! Processing instruction is complete, the token is the string between <? and ?>
+ */
+static int
+xml_sax_pi(clixon_xml_sax *xs)
+{
+    char  *str = cbuf_get(xs->xs_tok);
+    size_t len = strlen(str);
+    size_t i;
+
+    str[len-1] = '\0'; /* Strip trailing ? */
+    for (i=0; IS_NAMECHAR(str[i]); i++)
+        ;
+    if (i == 0 || !IS_NAMESTART(str[0]))
+        return xml_sax_syntax_errc(xs, str[0]?str[0]:'?');
+    if (i == 3 && strncmp(str, "xml", 3) == 0){
+        if (!xs->xs_prolog)
+            return xml_sax_syntax_err(xs, "<?xml");
+        xs->xs_xmldecl++;
+        if (xml_sax_xmldecl(xs, str+3) < 0)
+            return -1;
+    }
+    else if (str[i] != '\0' && !IS_WHITESPACE(str[i]))
+        return xml_sax_syntax_errc(xs, str[i]);
+    return 0;
+}
+
+/*! Start-tag name is complete, create the element
+ */
+static int
+xml_sax_element_new(clixon_xml_sax *xs)
+{
+    int    retval = -1;
+    cxobj *xp;
+    cxobj *x;
+
+    if (cbuf_len(xs->xs_tok) == 0)
+        return xml_sax_syntax_err(xs, ":");
+    if (xs->xs_depth > 0){
+        xp = xs->xs_stack[xs->xs_depth-1].xf_x;
+        xs->xs_stack[xs->xs_depth-1].xf_elmnt = 1;
+        cbuf_reset(xs->xs_text); /* Mixed content is dropped */
+    }
+    else
+        xp = xs->xs_xtop;
+    if ((x = xml_new(cbuf_get(xs->xs_tok), xp, CX_ELMNT)) == NULL)
+        goto done;
+    if (xml_prefix_set(x, xs->xs_prefix) < 0)
+        goto done;
+    xs->xs_xelement = x;
+    xs->xs_element++;
+    xs->xs_prolog = 0;
+    retval = 0;
+ done:
+    if (xs->xs_prefix){
+        free(xs->xs_prefix);
+        xs->xs_prefix = NULL;
+    }
+    cbuf_reset(xs->xs_tok);
+    return retval;
+}
+
+/*! Attribute value is complete, add attribute to element
+ * A duplicate attribute replaces the earlier value
+ */
+static int
+xml_sax_attr(clixon_xml_sax *xs)
+{
+    int    retval = -1;
+    cxobj *xa;
+
+    if ((xa = xml_find_type(xs->xs_xelement, xs->xs_aprefix, xs->xs_aname, CX_ATTR)) == NULL){
+        if ((xa = xml_new(xs->xs_aname, xs->xs_xelement, CX_ATTR)) == NULL)
+            goto done;
+        if (xml_prefix_set(xa, xs->xs_aprefix) < 0)
+            goto done;
+    }
+    if (xml_value_set(xa, cbuf_get(xs->xs_tok)) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (xs->xs_aprefix){
+        free(xs->xs_aprefix);
+        xs->xs_aprefix = NULL;
+    }
+    if (xs->xs_aname){
+        free(xs->xs_aname);
+        xs->xs_aname = NULL;
+    }
+    cbuf_reset(xs->xs_tok);
+    return retval;
+}
+
+/*! Start-tag is complete: check namespace, bind yang, push element on stack
+ */
+static int
+xml_sax_start(clixon_xml_sax *xs)
+{
+    int                   retval = -1;
+    cxobj                *x = xs->xs_xelement;
+    struct xml_sax_frame *xfp = NULL;  /* Parent frame */
+    struct xml_sax_frame *xf;
+    yang_bind             yb = YB_NONE; /* How to bind x */
+    yang_bind             ybc = YB_NONE;/* How to bind children of x */
+    cxobj                *xsibling = NULL;
+    char                 *prefix;
+    char                 *ns;
+    int                   ret;
+
+    xs->xs_xelement = NULL;
+    if (xs->xs_depth > 0){
+        xfp = &xs->xs_stack[xs->xs_depth-1];
+        /* Verify namespaces of all but top-level elements, see xml2ns_recurse */
+        if ((prefix = xml_prefix(x)) != NULL){
+            ns = NULL;
+            if (xml2ns(x, prefix, &ns) < 0)
+                goto done;
+            if (ns == NULL){
+                clicon_err(OE_XML, ENOENT, "No namespace associated with %s:%s", prefix, xml_name(x));
+                goto done;
+            }
+        }
+        if (!xs->xs_skip)
+            yb = xfp->xf_yb;
+    }
+    else {
+        xs->xs_skip = 0;
+        switch (xs->xs_yb){
+        case YB_MODULE:
+        case YB_PARENT:
+            yb = xs->xs_yb;
+            break;
+        case YB_MODULE_NEXT:
+            ybc = YB_MODULE;
+            break;
+        default: /* YB_RPC is bound when the top-level element is complete */
+            break;
+        }
+    }
+    if (yb != YB_NONE){
+        /* Optimization for massive lists - use previous sibling as role model */
+        if (xfp && xfp->xf_xprev &&
+            clicon_strcmp(xml_name(xfp->xf_xprev), xml_name(x)) == 0 &&
+            clicon_strcmp(xml_prefix(xfp->xf_xprev), xml_prefix(x)) == 0)
+            xsibling = xfp->xf_xprev;
+        if ((ret = xml_bind_yang_node(x, yb, xs->xs_yspec, xsibling,
+                                      xs->xs_xerr?NULL:&xs->xs_xerr)) < 0)
+            goto done;
+        if (ret == 0){ /* Stop binding this top-level element */
+            xs->xs_failed++;
+            xs->xs_skip++;
+        }
+        else if (ret == 1){
+            ybc = YB_PARENT;
+            if (xfp)
+                xfp->xf_xprev = x;
+        }
+    }
+    /* Push */
+    if (xs->xs_depth >= xs->xs_stacklen){
+        xs->xs_stacklen = xs->xs_stacklen ? 2*xs->xs_stacklen : 16;
+        if ((xs->xs_stack = realloc(xs->xs_stack, xs->xs_stacklen*sizeof(*xf))) == NULL){
+            clicon_err(OE_XML, errno, "realloc");
+            goto done;
+        }
+    }
+    xf = &xs->xs_stack[xs->xs_depth++];
+    memset(xf, 0, sizeof(*xf));
+    xf->xf_x = x;
+    xf->xf_yb = ybc;
+    xf->xf_rolemodel = (xsibling != NULL);
+    cbuf_reset(xs->xs_text);
+    if (xs->xs_startfn && xs->xs_startfn(x, xs->xs_arg) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (retval < 0)
+        xs->xs_error++;
+    return retval;
+}
+
+/*! Element is complete: add body, sort, bind deferred, invoke callback, pop from stack
+ *
+ * @param[in]  xs      Push parser handle
+ * @param[in]  check   Check end-tag name in token (and prefix) against start-tag
+ */
+static int
+xml_sax_end_element(clixon_xml_sax *xs,
+                    int             check)
+{
+    int                   retval = -1;
+    struct xml_sax_frame *xf;
+    cxobj                *x;
+    cxobj                *xb;
+    yang_stmt            *y;
+    enum rfc_6020         keyword;
+    int                   ret;
+
+    xf = &xs->xs_stack[xs->xs_depth-1];
+    x = xf->xf_x;
+    if (check &&
+        (clicon_strcmp(xml_name(x), cbuf_get(xs->xs_tok)) ||
+         clicon_strcmp(xml_prefix(x), xs->xs_prefix))){
+        clicon_err(OE_XML, XMLPARSE_ERRNO, "Sanity check failed: %s%s%s vs %s%s%s", 
+                   xml_prefix(x)?xml_prefix(x):"", xml_prefix(x)?":":"", xml_name(x),
+                   xs->xs_prefix?xs->xs_prefix:"", xs->xs_prefix?":":"", cbuf_get(xs->xs_tok));
+        goto done;
+    }
+    cbuf_reset(xs->xs_tok);
+    if (xs->xs_prefix){
+        free(xs->xs_prefix);
+        xs->xs_prefix = NULL;
+    }
+    /* Add body, unless element children or yang says container or list, see strip_body_objects */
+    if (!xf->xf_elmnt && cbuf_len(xs->xs_text)){
+        keyword = (y = xml_spec(x)) ? yang_keyword_get(y) : Y_LEAF;
+        if (keyword != Y_CONTAINER && keyword != Y_LIST){
+            if ((xb = xml_new("body", x, CX_BODY)) == NULL)
+                goto done;
+            if (xml_value_set(xb, cbuf_get(xs->xs_text)) < 0)
+                goto done;
+        }
+    }
+    cbuf_reset(xs->xs_text);
+#ifdef XML_EXPLICIT_INDEX
+    /* Index value is known first when body is set */
+    if (!xf->xf_rolemodel && xml_search_index_p(x))
+        if (xml_search_child_insert(xml_parent(x), x) < 0)
+            goto done;
+#endif
+    xs->xs_depth--;
+    if (xs->xs_depth == 0 && xs->xs_yb == YB_RPC){
+        if ((ret = xml_bind_yang_rpc(x, xs->xs_yspec, &xs->xs_xerr)) < 0)
+            goto done;
+        if (ret == 0){ /* Add message-id */
+            if (xs->xs_xerr && clixon_xml_attr_copy(x, xs->xs_xerr, "message-id") < 0)
+                goto done;
+            xs->xs_failed++;
+        }
+        if (xml_sort_recurse(x) < 0)
+            goto done;
+    }
+    else if (xs->xs_yb != YB_NONE &&
+             xml_sort_verify(x, NULL) < 0 && xml_sort(x) < 0)
+        goto done;
+    if (xs->xs_endfn){
+        if ((ret = xs->xs_endfn(x, xs->xs_arg)) < 0)
+            goto done;
+        if (ret == 1){ /* Consumed */
+            if (xs->xs_depth > 0 && xs->xs_stack[xs->xs_depth-1].xf_xprev == x)
+                xs->xs_stack[xs->xs_depth-1].xf_xprev = NULL;
+            if (xml_purge(x) < 0)
+                goto done;
+        }
+    }
+    retval = 0;
+ done:
+    if (retval < 0)
+        xs->xs_error++;
+    return retval;
+}
+
+/*! Create a new XML push parser
+ *
+ * @param[in]  yb     How to bind yang to XML top-level when parsing
+ * @param[in]  yspec  Yang specification, or NULL
+ * @param[in]  xtop   XML top, parsed elements are added as children
+ * @retval     xs     Push parser handle, free with clixon_xml_sax_free
+ * @retval     NULL   Error
+ * @code
+ *   clixon_xml_sax *xs;
+ *   if ((xs = clixon_xml_sax_new(YB_MODULE, yspec, xt)) == NULL)
+ *      err;
+ *   while ((len = read(s, buf, sizeof(buf))) > 0)
+ *      if (clixon_xml_sax_push(xs, buf, len) < 0)
+ *         err;
+ *   if ((ret = clixon_xml_sax_end(xs, &xerr)) < 0)
+ *      err;
+ *   clixon_xml_sax_free(xs);
+ * @endcode
+ */
+clixon_xml_sax *
+clixon_xml_sax_new(yang_bind  yb,
+                   yang_stmt *yspec,
+                   cxobj     *xtop)
+{
+    clixon_xml_sax *xs;
+
+    if (xtop == NULL){
+        clicon_err(OE_XML, EINVAL, "Unexpected NULL XML");
+        return NULL;
+    }
+    if ((yb == YB_MODULE || yb == YB_MODULE_NEXT) && yspec == NULL){
+        clicon_err(OE_XML, EINVAL, "yspec is required if yb == YB_MODULE");
+        return NULL;
+    }
+    if ((xs = malloc(sizeof(*xs))) == NULL){
+        clicon_err(OE_XML, errno, "malloc");
+        return NULL;
+    }
+    memset(xs, 0, sizeof(*xs));
+    xs->xs_state = XS_CONTENT;
+    xs->xs_yb = yb;
+    xs->xs_yspec = yspec;
+    xs->xs_xtop = xtop;
+    xs->xs_prolog = 1;
+    if ((xs->xs_text = cbuf_new()) == NULL ||
+        (xs->xs_tok = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        clixon_xml_sax_free(xs);
+        return NULL;
+    }
+    return xs;
+}
+
+/*! Register SAX element callbacks
+ *
+ * @param[in]  xs       Push parser handle
+ * @param[in]  startfn  Called when start-tag is complete, or NULL
+ * @param[in]  endfn    Called when element is complete, or NULL
+ * @param[in]  arg      User argument to callbacks
+ */
+int
+clixon_xml_sax_callbacks(clixon_xml_sax    *xs,
+                         clixon_xml_sax_cb *startfn,
+                         clixon_xml_sax_cb *endfn,
+                         void              *arg)
+{
+    xs->xs_startfn = startfn;
+    xs->xs_endfn = endfn;
+    xs->xs_arg = arg;
+    return 0;
+}
+
+/*! Push a chunk of XML input to the parser
+ *
+ * Chunks may be split anywhere, also within tags, entities or multi-byte characters
+ * @param[in]  xs    Push parser handle
+ * @param[in]  buf   Input chunk, not necessarily null-terminated
+ * @param[in]  len   Length of chunk
+ * @retval     0     OK
+ * @retval    -1    Error with clicon_err called. Includes parse error
+ */
+int
+clixon_xml_sax_push(clixon_xml_sax *xs,
+                    const char     *buf,
+                    size_t          len)
+{
+    const char *p = buf;
+    const char *end = buf + len;
+    const char *s;
+    int         c;
+    size_t      n;
+    int         nl;
+
+    if (xs->xs_error){
+        clicon_err(OE_XML, EINVAL, "XML push parser in error state");
+        return -1;
+    }
+    while (p < end){
+        c = (unsigned char)*p;
+        switch (xs->xs_state){
+        case XS_CONTENT:
+            /* Whitespace between elements is not kept, skip it in bulk */
+            if (IS_WHITESPACE(c) &&
+                (xs->xs_depth == 0 || xs->xs_stack[xs->xs_depth-1].xf_elmnt)){
+                nl = 0;
+                n = clixon_str_ws_span(p, end-p, &nl);
+                xs->xs_linenum += nl;
+                xs->xs_cr = (p[n-1] == '\r');
+                p += n;
+                continue;
+            }
+            /* Bulk scan of text run */
+            s = p + clixon_str_span(p, end-p, "<&\r\n", 0);
+            if (s > p){
+                if (xs->xs_depth == 0){
+                    /* Top-level text is dropped, text before first element is checked for junk */
+                    if (!xs->xs_element){
+                        for (; p < s && IS_WHITESPACE(*p); p++)
+                            ;
+                        if (p < s){
+                            cbuf_reset(xs->xs_tok);
+                            xs->xs_state = XS_JUNK;
+                            continue;
+                        }
+                    }
+                }
+                else if (xml_sax_text(xs, p, s-p) < 0)
+                    return -1;
+                xs->xs_cr = 0;
+                p = s;
+                continue;
+            }
+            switch (c){
+            case '<':
+                xs->xs_state = XS_LT;
+                break;
+            case '&':
+                xs->xs_state = XS_ENTITY;
+                cbuf_reset(xs->xs_tok);
+                break;
+            case '\r':
+                if (xml_sax_text(xs, "\n", 1) < 0)
+                    return -1;
+                xs->xs_cr = 1;
+                p++;
+                continue;
+            case '\n':
+                xs->xs_linenum++;
+                if (!xs->xs_cr && xml_sax_text(xs, "\n", 1) < 0)
+                    return -1;
+                break;
+            }
+            xs->xs_cr = 0;
+            break;
+        case XS_JUNK:
+            /* A name or a markup character is an error, other text is dropped */
+            if (cbuf_len(xs->xs_tok)){
+                if (!IS_NAMECHAR(c))
+                    return xml_sax_syntax_err(xs, cbuf_get(xs->xs_tok));
+                cbuf_append(xs->xs_tok, c);
+            }
+            else if (IS_NAMESTART(c))
+                cbuf_append(xs->xs_tok, c);
+            else if (c == '<')
+                xs->xs_state = XS_LT;
+            else if (strchr(":/=>\"'", c) != NULL)
+                return xml_sax_syntax_errc(xs, c);
+            else if (c == '\n')
+                xs->xs_linenum++;
+            break;
+        case XS_LT:
+            cbuf_reset(xs->xs_tok);
+            if (c == '/'){
+                if (xs->xs_depth == 0)
+                    return xml_sax_syntax_err(xs, "</");
+                xs->xs_state = XS_ETAG_NAME;
+            }
+            else if (c == '!')
+                xs->xs_state = XS_BANG;
+            else if (c == '?'){
+                xs->xs_state = XS_PI;
+                xs->xs_count = 0;
+            }
+            else{
+                if (xml_sax_namechar(xs, c) < 0)
+                    return -1;
+                xs->xs_state = XS_STAG_NAME;
+            }
+            break;
+        case XS_STAG_NAME:
+            if (c == ':'){
+                if (xml_sax_prefix(xs, c) < 0)
+                    return -1;
+            }
+            else if (IS_WHITESPACE(c) || c == '>' || c == '/'){
+                if (xml_sax_element_new(xs) < 0)
+                    return -1;
+                xs->xs_state = XS_STAG;
+                continue; /* Reparse c */
+            }
+            else if (xml_sax_namechar(xs, c) < 0)
+                return -1;
+            break;
+        case XS_STAG:
+            if (c == '>'){
+                xs->xs_state = XS_CONTENT;
+                if (xml_sax_start(xs) < 0)
+                    return -1;
+            }
+            else if (c == '/')
+                xs->xs_state = XS_EMPTY;
+            else if (IS_NAMESTART(c)){
+                xs->xs_state = XS_ATTR_NAME;
+                continue; /* Reparse c */
+            }
+            else if (!IS_WHITESPACE(c))
+                return xml_sax_syntax_errc(xs, c);
+            break;
+        case XS_ATTR_NAME:
+            if (c == ':'){
+                if (xml_sax_prefix(xs, c) < 0)
+                    return -1;
+            }
+            else if (IS_WHITESPACE(c) || c == '='){
+                if (cbuf_len(xs->xs_tok) == 0)
+                    return xml_sax_syntax_errc(xs, c);
+                if ((xs->xs_aname = strdup(cbuf_get(xs->xs_tok))) == NULL){
+                    clicon_err(OE_XML, errno, "strdup");
+                    return -1;
+                }
+                xs->xs_aprefix = xs->xs_prefix;
+                xs->xs_prefix = NULL;
+                cbuf_reset(xs->xs_tok);
+                xs->xs_state = XS_ATTR_EQ;
+                continue; /* Reparse c */
+            }
+            else if (xml_sax_namechar(xs, c) < 0)
+                return -1;
+            break;
+        case XS_ATTR_EQ:
+            if (c == '=')
+                xs->xs_state = XS_ATTR_QUOTE;
+            else if (!IS_WHITESPACE(c))
+                return xml_sax_syntax_errc(xs, c);
+            break;
+        case XS_ATTR_QUOTE:
+            if (c == '"' || c == '\''){
+                xs->xs_quote = c;
+                xs->xs_state = XS_ATTR_VALUE;
+            }
+            else if (!IS_WHITESPACE(c))
+                return xml_sax_syntax_errc(xs, c);
+            break;
+        case XS_ATTR_VALUE:
+            /* Bulk scan of value, not entity-decoded */
+            if ((s = memchr(p, xs->xs_quote, end-p)) == NULL)
+                s = end;
+            cbuf_append_buf(xs->xs_tok, (void*)p, s-p);
+            for (; p < s; p++)
+                if (*p == '\n')
+                    xs->xs_linenum++;
+            if (s < end){
+                if (xml_sax_attr(xs) < 0)
+                    return -1;
+                xs->xs_state = XS_STAG;
+                p++;
+            }
+            continue;
+        case XS_EMPTY:
+            if (c != '>')
+                return xml_sax_syntax_errc(xs, c);
+            xs->xs_state = XS_CONTENT;
+            if (xml_sax_start(xs) < 0)
+                return -1;
+            if (xml_sax_end_element(xs, 0) < 0)
+                return -1;
+            break;
+        case XS_ETAG_NAME:
+            if (c == ':'){
+                if (xml_sax_prefix(xs, c) < 0)
+                    return -1;
+            }
+            else if (IS_WHITESPACE(c) || c == '>'){
+                if (cbuf_len(xs->xs_tok) == 0)
+                    return xml_sax_syntax_errc(xs, c);
+                xs->xs_state = XS_ETAG;
+                continue; /* Reparse c */
+            }
+            else if (xml_sax_namechar(xs, c) < 0)
+                return -1;
+            break;
+        case XS_ETAG:
+            if (c == '>'){
+                xs->xs_state = XS_CONTENT;
+                if (xml_sax_end_element(xs, 1) < 0)
+                    return -1;
+            }
+            else if (!IS_WHITESPACE(c))
+                return xml_sax_syntax_errc(xs, c);
+            break;
+        case XS_BANG: /* Either <!-- or <![CDATA[ */
+            cbuf_append(xs->xs_tok, c);
+            if (strcmp(cbuf_get(xs->xs_tok), "--") == 0){
+                xs->xs_state = XS_COMMENT;
+                xs->xs_count = 0;
+            }
+            else if (strcmp(cbuf_get(xs->xs_tok), "[CDATA[") == 0){
+                if (xml_sax_text(xs, "<![CDATA[", strlen("<![CDATA[")) < 0)
+                    return -1;
+                xs->xs_state = XS_CDATA;
+                xs->xs_count = 0;
+            }
+            else if (strncmp(cbuf_get(xs->xs_tok), "--", cbuf_len(xs->xs_tok)) != 0 &&
+                     strncmp(cbuf_get(xs->xs_tok), "[CDATA[", cbuf_len(xs->xs_tok)) != 0)
+                return xml_sax_syntax_errc(xs, c);
+            break;
+        case XS_COMMENT:
+            /* Bulk skip of comment text */
+            s = p + clixon_str_span(p, end-p, "->\n", 0);
+            if (s > p){
+                xs->xs_count = 0;
+                p = s;
+                continue;
+            }
+            if (c == '>' && xs->xs_count >= 2){
+                xs->xs_state = XS_CONTENT;
+                xs->xs_prolog = 0;
+            }
+            else if (c == '-')
+                xs->xs_count++;
+            else{
+                xs->xs_count = 0;
+                if (c == '\n')
+                    xs->xs_linenum++;
+            }
+            break;
+        case XS_CDATA: /* Kept verbatim */
+            s = p + clixon_str_span(p, end-p, "]>\n", 0);
+            if (s > p){
+                if (xml_sax_text(xs, p, s-p) < 0)
+                    return -1;
+                xs->xs_count = 0;
+                p = s;
+                continue;
+            }
+            if (xml_sax_text(xs, p, 1) < 0)
+                return -1;
+            if (c == '>' && xs->xs_count >= 2)
+                xs->xs_state = XS_CONTENT;
+            else if (c == ']')
+                xs->xs_count++;
+            else{
+                xs->xs_count = 0;
+                if (c == '\n')
+                    xs->xs_linenum++;
+            }
+            break;
+        case XS_PI:
+            /* Bulk scan of processing instruction */
+            s = p + clixon_str_span(p, end-p, "?>\n", 0);
+            if (s > p){
+                cbuf_append_buf(xs->xs_tok, (void*)p, s-p);
+                xs->xs_count = 0;
+                p = s;
+                continue;
+            }
+            if (c == '>' && xs->xs_count){
+                xs->xs_state = XS_CONTENT;
+                if (xml_sax_pi(xs) < 0)
+                    return -1;
+                xs->xs_prolog = 0;
+                break;
+            }
+            xs->xs_count = (c == '?');
+            if (c == '\n')
+                xs->xs_linenum++;
+            cbuf_append(xs->xs_tok, c);
+            break;
+        case XS_ENTITY:
+            if (c == ';'){
+                xs->xs_state = XS_CONTENT;
+                if (xml_sax_entity(xs) < 0)
+                    return -1;
+            }
+            else if (cbuf_len(xs->xs_tok) >= XML_SAX_ENTITY_MAX || IS_WHITESPACE(c) || c == '<')
+                return xml_sax_syntax_err(xs, "&");
+            else
+                cbuf_append(xs->xs_tok, c);
+            break;
+        }
+        p++;
+    }
+    return 0;
+}
+
+/*! Signal end of input, check that document is complete
+ *
+ * @param[in]  xs    Push parser handle
+ * @param[out] xerr  Reason for failure (yang assignment not made) if retval = 0
+ * @retval     1     Parse OK and all yang assignment made
+ * @retval     0     Parse OK but yang assigment not made (or only partial), xerr is set
+ * @retval    -1     Error with clicon_err called. Includes parse error
+ */
+int
+clixon_xml_sax_end(clixon_xml_sax *xs,
+                   cxobj         **xerr)
+{
+    if (xs->xs_error){
+        clicon_err(OE_XML, EINVAL, "XML push parser in error state");
+        return -1;
+    }
+    if (xs->xs_state == XS_JUNK){
+        if (cbuf_len(xs->xs_tok))
+            return xml_sax_syntax_err(xs, cbuf_get(xs->xs_tok));
+        xs->xs_state = XS_CONTENT;
+    }
+    if (xs->xs_state != XS_CONTENT || xs->xs_depth > 0 ||
+        (xs->xs_xmldecl && !xs->xs_element))
+        return xml_sax_syntax_err(xs, "");
+    if (xs->xs_yb != YB_NONE &&
+        xml_sort_verify(xs->xs_xtop, NULL) < 0 && xml_sort(xs->xs_xtop) < 0)
+        return -1;
+    if (xs->xs_failed){
+        if (xerr){
+            *xerr = xs->xs_xerr;
+            xs->xs_xerr = NULL;
+        }
+        return 0;
+    }
+    return 1;
+}
+
+/*! Free XML push parser handle, the parsed tree is not freed
+ *
+ * @param[in]  xs    Push parser handle
+ */
+int
+clixon_xml_sax_free(clixon_xml_sax *xs)
+{
+    if (xs == NULL)
+        return 0;
+    if (xs->xs_stack)
+        free(xs->xs_stack);
+    if (xs->xs_text)
+        cbuf_free(xs->xs_text);
+    if (xs->xs_tok)
+        cbuf_free(xs->xs_tok);
+    if (xs->xs_prefix)
+        free(xs->xs_prefix);
+    if (xs->xs_aprefix)
+        free(xs->xs_aprefix);
+    if (xs->xs_aname)
+        free(xs->xs_aname);
+    if (xs->xs_xerr)
+        xml_free(xs->xs_xerr);
+    free(xs);
+    return 0;
+}
@@ -157,6 +157,156 @@ xml_cv_cache_clear(cxobj *xt)
     return retval;
 }
 
+/*! Append a value to a sort key so that memcmp order is the same as cv_cmp order
+ * @param[in]  cb   Sort key buffer
+ * @param[in]  cv   Value
+ * @retval     1    OK, appended
+ * @retval     0    No memcmp encoding of this type
+ * Integers are encoded as 8 bytes big-endian, signed with the sign bit flipped.
+ * Strings are encoded with a terminating NUL so that a prefix sorts first.
+ */
+static int
+xml_sortkey_cv(cbuf   *cb,
+               cg_var *cv)
+{
+    uint8_t  buf[8];
+    uint64_t u;
+    char    *str;
+    int      i;
+
+    switch (cv_type_get(cv)){
+    case CGV_INT8:
+        u = (uint64_t)(int64_t)cv_int8_get(cv) ^ 0x8000000000000000ULL;
+        break;
+    case CGV_INT16:
+        u = (uint64_t)(int64_t)cv_int16_get(cv) ^ 0x8000000000000000ULL;
+        break;
+    case CGV_INT32:
+        u = (uint64_t)(int64_t)cv_int32_get(cv) ^ 0x8000000000000000ULL;
+        break;
+    case CGV_INT64:
+        u = (uint64_t)cv_int64_get(cv) ^ 0x8000000000000000ULL;
+        break;
+    case CGV_UINT8:
+        u = cv_uint8_get(cv);
+        break;
+    case CGV_UINT16:
+        u = cv_uint16_get(cv);
+        break;
+    case CGV_UINT32:
+        u = cv_uint32_get(cv);
+        break;
+    case CGV_UINT64:
+        u = cv_uint64_get(cv);
+        break;
+    case CGV_BOOL:
+        u = cv_bool_get(cv)?1:0;
+        break;
+    case CGV_STRING:
+    case CGV_REST:
+        if ((str = cv_string_get(cv)) == NULL)
+            str = "";
+        cbuf_append_buf(cb, str, strlen(str)+1);
+        return 1;
+    default:
+        return 0;
+    }
+    for (i=0; i<8; i++)
+        buf[i] = (u >> (56-8*i)) & 0xff;
+    cbuf_append_buf(cb, buf, 8);
+    return 1;
+}
+
+/*! Get (cached) sort key of a list or leaf-list entry
+ * 
+ * The sort key is a byte string of the key values of a list entry, or the value of a
+ * leaf-list entry, such that two entries compare with memcmp as they do in xml_cmp.
+ * Each value is prefixed with a byte: 0 if the key leaf is absent, 1 if it has no body and
+ * 2 if the encoded value follows.
+ * The key is cached in the XML node and cleared when the entry is changed.
+ * @param[in]  x     XML list or leaf-list entry
+ * @param[in]  y     Yang spec of x
+ * @param[out] keyp  Sort key (cached in x, dont free)
+ * @param[out] lenp  Length of sort key
+ * @retval     1     OK, keyp and lenp set
+ * @retval     0     No sort key for this list or leaf-list, use cv_cmp
+ * @retval    -1     Error
+ * @see xml_cmp
+ */
+static int
+xml_sortkey_get(cxobj     *x,
+                yang_stmt *y,
+                uint8_t  **keyp,
+                size_t    *lenp)
+{
+    int      retval = -1;
+    cbuf    *cb = NULL;
+    cvec    *cvk = NULL;
+    cg_var  *cvi = NULL;
+    cxobj   *xb;
+    cg_var  *cv;
+    uint8_t *key;
+    size_t   len;
+    uint8_t  mark;
+
+    if (yang_flag_get(y, YANG_FLAG_SORTKEY_NO))
+        goto unsupported;
+    if ((key = xml_sortkey(x, &len)) != NULL)
+        goto ok;
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    if (yang_keyword_get(y) == Y_LIST){
+        cvk = yang_cvec_get(y); /* Use Y_LIST cache, see ys_populate_list() */
+        if (cvk == NULL || cvec_len(cvk) == 0) /* eg state list without keys */
+            goto unsupported;
+    }
+    do {
+        if (cvk != NULL){
+            if ((cvi = cvec_each(cvk, cvi)) == NULL)
+                break;
+            xb = xml_find(x, cv_string_get(cvi));
+        }
+        else
+            xb = x;
+        if (xb == NULL)
+            mark = 0;
+        else if (xml_body(xb) == NULL)
+            mark = 1;
+        else
+            mark = 2;
+        cbuf_append_buf(cb, &mark, 1);
+        if (mark == 2){
+            if (xml_cv_cache(xb, &cv) < 0)
+                goto done;
+            if (xml_sortkey_cv(cb, cv) == 0){
+                yang_flag_set(y, YANG_FLAG_SORTKEY_NO);
+                goto unsupported;
+            }
+        }
+    } while (cvk != NULL);
+    len = cbuf_len(cb);
+    if ((key = malloc(len)) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memcpy(key, cbuf_get(cb), len);
+    if (xml_sortkey_set(x, key, len) < 0)
+        goto done;
+ ok:
+    *keyp = key;
+    *lenp = len;
+    retval = 1;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+ unsupported:
+    retval = 0;
+    goto done;
+}
+
 /*! Help function to qsort for sorting entries in xml child vector same parent
  * @param[in]  x1    object 1
  * @param[in]  x2    object 2
@@ -220,6 +370,11 @@ xml_cmp(cxobj  *x1,
     cxobj      *x2b;
     enum cxobj_type xt1;
     enum cxobj_type xt2;
+    uint8_t    *k1;
+    uint8_t    *k2;
+    size_t      len1;
+    size_t      len2;
+    int         ret;
 
     if (x1==NULL || x2==NULL)
         goto done; /* shouldnt happen */
@@ -278,6 +433,21 @@ xml_cmp(cxobj  *x1,
             equal = nr1-nr2;
             goto done; /* Ordered by user or state data : maintain existing order */
         }
+    if (indexvar == NULL && skip1 == 0 &&
+        (yang_keyword_get(y1) == Y_LIST || yang_keyword_get(y1) == Y_LEAF_LIST)){
+        /* Compare precomputed sort keys if the key types allow it */
+        if ((ret = xml_sortkey_get(x1, y1, &k1, &len1)) < 0)
+            goto done;
+        if (ret == 1){
+            if ((ret = xml_sortkey_get(x2, y2, &k2, &len2)) < 0)
+                goto done;
+            if (ret == 1){
+                if ((equal = memcmp(k1, k2, len1<len2?len1:len2)) == 0)
+                    equal = len1<len2?-1:(len1>len2?1:0);
+                goto done;
+            }
+        }
+    }
     switch (yang_keyword_get(y1)){
     case Y_LEAF_LIST: /* Match with name and value */
         b1 = xml_body(x1);
@@ -398,8 +568,26 @@ xml_cmp_qsort(const void* arg1,
     return xml_cmp(*(struct xml**)arg1, *(struct xml**)arg2, 1, 0, NULL);
 }
 
+/*! Mark XML node as sorted if all its element children are marked
+ *
+ * The XML_FLAG_SORTED flag means that the whole subtree is sorted. It is cleared by
+ * changes to the subtree, see xml_sort_reset in clixon_xml.c
+ * @param[in] x   XML node whose children are sorted
+ */
+static void
+xml_sorted_mark(cxobj *x)
+{
+    cxobj *xc = NULL;
+
+    while ((xc = xml_child_each(x, xc, CX_ELMNT)) != NULL)
+        if (xml_flag(xc, XML_FLAG_SORTED) == 0)
+            return;
+    xml_flag_set(x, XML_FLAG_SORTED);
+}
+
 /*! Sort children of an XML node 
  * Assume populated by yang spec.
+ * The children are first checked in one pass, qsort is only made if they are not in order.
  * @param[in] x0   XML node
  * @retval    -1    Error, aborted at first error encounter
  * @retval     0    OK, all nodes traversed (subparts may have been skipped)
@@ -410,6 +598,9 @@ xml_cmp_qsort(const void* arg1,
 int
 xml_sort(cxobj *x)
 {
+    cxobj     **xvec;
+    int         xlen;
+    int         i;
 #ifndef STATE_ORDERED_BY_SYSTEM
     yang_stmt *ys;
     
@@ -417,8 +608,17 @@ xml_sort(cxobj *x)
     if ((ys = xml_spec(x)) != 0 && yang_config(ys)==0)
         return 1;
 #endif
+    if (xml_flag(x, XML_FLAG_SORTED))
+        return 0;
     xml_enumerate_children(x); /* This is to make sorting "stable", ie not change existing order */
-    qsort(xml_childvec_get(x), xml_child_nr(x), sizeof(cxobj *), xml_cmp_qsort);
+    xvec = xml_childvec_get(x);
+    xlen = xml_child_nr(x);
+    for (i=1; i<xlen; i++)
+        if (xml_cmp(xvec[i-1], xvec[i], 1, 0, NULL) > 0)
+            break;
+    if (i < xlen)
+        qsort(xvec, xlen, sizeof(cxobj *), xml_cmp_qsort);
+    xml_sorted_mark(x);
     return 0;
 }
 
@@ -432,6 +632,8 @@ xml_sort_recurse(cxobj *xn)
     cxobj *x;
     int    ret;
     
+    if (xml_flag(xn, XML_FLAG_SORTED)) /* Subtree already verified */
+        goto ok;
     ret = xml_sort_verify(xn, NULL);
     if (ret == 1) /* This node is not sortable */
         goto ok;
@@ -448,6 +650,7 @@ xml_sort_recurse(cxobj *xn)
         if (xml_sort_recurse(x) < 0)
             goto done;
     }
+    xml_sorted_mark(xn);
  ok:
     retval = 0;
  done:
@@ -1111,12 +1314,84 @@ xml_insert(cxobj           *xp,
     return retval;
 }
 
+/*! Insert a vector of new children into an XML node in one pass
+ *
+ * The existing (sorted) children and the new children are merged into a new child vector,
+ * instead of inserting each new child with xml_insert(), which moves the child vector in
+ * every insert.
+ * @param[in]  xp    XML parent node, children sorted
+ * @param[in]  xvec  New children without parent, sorted if not already
+ * @param[in]  xlen  Length of xvec
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @note The new children must be entries of system-ordered config lists or leaf-lists, and
+ *       not exist in xp.
+ * @see xml_insert  Insert a single child, also ordered-by user
+ */
+int
+xml_insert_vec(cxobj  *xp,
+               cxobj **xvec,
+               int     xlen)
+{
+    int     retval = -1;
+    cxobj **xold = NULL;
+    int     nold;
+    cxobj  *xc;
+    int     i;
+    int     j;
+    int     k;
+
+    if (xlen == 0)
+        goto ok;
+    for (j=0; j<xlen; j++)
+        if (xml_parent(xvec[j]) != NULL){
+            clicon_err(OE_XML, 0, "XML node %s should not have parent", xml_name(xvec[j]));
+            goto done;
+        }
+    /* New children are normally given in order, eg from a sorted edit */
+    for (j=1; j<xlen; j++)
+        if (xml_cmp(xvec[j-1], xvec[j], 0, 0, NULL) > 0)
+            break;
+    if (j < xlen)
+        qsort(xvec, xlen, sizeof(cxobj *), xml_cmp_qsort);
+    nold = xml_child_nr(xp);
+    if (nold){
+        if ((xold = malloc(nold*sizeof(cxobj *))) == NULL){
+            clicon_err(OE_UNIX, errno, "malloc");
+            goto done;
+        }
+        memcpy(xold, xml_childvec_get(xp), nold*sizeof(cxobj *));
+    }
+    if (xml_childvec_set(xp, nold+xlen) < 0)
+        goto done;
+    i = j = k = 0;
+    while (i < nold || j < xlen){
+        if (j == xlen ||
+            (i < nold && xml_cmp(xold[i], xvec[j], 0, 0, NULL) <= 0))
+            xc = xold[i++];
+        else{
+            xc = xvec[j++];
+            xml_parent_set(xc, xp);
+            /* clear namespace context cache of child */
+            nscache_clear(xc);
+        }
+        xml_child_i_set(xp, k++, xc);
+    }
+ ok:
+    retval = 0;
+ done:
+    if (xold)
+        free(xold);
+    return retval;
+}
+
 /*! Verify all children of XML node are sorted according to xml_sort()
  * @param[in]   x    XML node. Check its children
  * @param[in]   arg  Dummy. Ensures xml_apply can be used with this fn
  * @retval      1    Not sortable
  * @retval      0    Sorted
  * @retval     -1    Not sorted
+ * If sorted and all element children are marked sorted, x is marked with XML_FLAG_SORTED
  * @see xml_apply
  */
 int
@@ -1136,6 +1411,8 @@ xml_sort_verify(cxobj *x0,
     }
 #endif
     if (xml_type(x0) == CX_ELMNT){
+        if (xml_flag(x0, XML_FLAG_SORTED))
+            goto ok;
         xml_enumerate_children(x0);
         while ((x = xml_child_each(x0, x, -1)) != NULL) {
             if (xprev != NULL){ /* Check xprev <= x */
@@ -1144,7 +1421,9 @@ xml_sort_verify(cxobj *x0,
             }
             xprev = x;
         }
+        xml_sorted_mark(x0);
     }
+ ok:
     retval = 0;
  done:
     return retval;
@@ -1598,3 +1877,213 @@ clixon_xml_find_pos(cxobj        *xp,
  done:
     return retval;
 }
+
+/*! Get key (first key of a list) or value (leaf-list) used by prefix search
+ * @param[in]  xc       List or leaf-list entry
+ * @param[in]  keyname  Name of list key, or NULL for leaf-list
+ * @retval     str      Key or value string, "" if not present
+ */
+static char *
+xml_prefix_key(cxobj *xc,
+               char  *keyname)
+{
+    char *str;
+
+    if (keyname)
+        str = xml_find_body(xc, keyname);
+    else
+        str = xml_body(xc);
+    return str?str:"";
+}
+
+/*! Compare order of child xc with yang yc, as in xml_cmp
+ * Attributes and unbound children are sorted before bound children
+ */
+static int
+xml_prefix_ycmp(cxobj *xc,
+                int    yi)
+{
+    yang_stmt *y;
+
+    if (xml_type(xc) != CX_ELMNT || (y = xml_spec(xc)) == NULL)
+        return -1;
+    return yang_order(y) - yi;
+}
+
+/*! Find list or leaf-list entries whose key or value starts with a prefix
+ *
+ * For a list, the prefix is matched against the first key, for a leaf-list the value.
+ * If the entries are ordered-by system and the key or value is a string, xp is assumed to
+ * be sorted (as in a datastore) and the first match is found by binary search, and the
+ * search ends at the first entry not matching. Otherwise all children of xp are scanned.
+ * @param[in]  xp     Parent xml node. 
+ * @param[in]  yc     Yang spec of list or leaf-list child
+ * @param[in]  prefix Key or value prefix, NULL or "" matches all entries
+ * @param[in]  limit  Max number of entries, 0 means unbounded
+ * @param[out] xvec   Array of found nodes. Must be initialized on entry
+ * @retval     0      OK, see xvec
+ * @retval    -1      Error
+ */
+int
+clixon_xml_find_prefix(cxobj        *xp,
+                       yang_stmt    *yc,
+                       char         *prefix,
+                       uint32_t      limit,
+                       clixon_xvec  *xvec)
+{
+    int        retval = -1;
+    char      *keyname = NULL;
+    yang_stmt *yk = NULL;
+    cvec      *cvk;
+    cg_var    *cv;
+    int        sorted;
+    int        yi;
+    int        low;
+    int        upper;
+    int        mid;
+    int        i;
+    size_t     plen;
+    cxobj     *xc;
+    uint32_t   n = 0;
+
+    if (yc == NULL){
+        clicon_err(OE_YANG, ENOENT, "yang spec not found");
+        goto done;
+    }
+    switch (yang_keyword_get(yc)){
+    case Y_LIST:
+        cvk = yang_cvec_get(yc); /* Use Y_LIST cache, see ys_populate_list() */
+        if ((cv = cvec_i(cvk, 0)) == NULL){
+            clicon_err(OE_YANG, ENOENT, "list %s has no key", yang_argument_get(yc));
+            goto done;
+        }
+        keyname = cv_string_get(cv);
+        yk = yang_find(yc, Y_LEAF, keyname);
+        break;
+    case Y_LEAF_LIST:
+        yk = yc;
+        break;
+    default:
+        clicon_err(OE_YANG, EINVAL, "%s is not a list or leaf-list", yang_argument_get(yc));
+        goto done;
+        break;
+    }
+    plen = prefix?strlen(prefix):0;
+    sorted = yang_find(yc, Y_ORDERED_BY, "user") == NULL &&
+#ifndef STATE_ORDERED_BY_SYSTEM
+        yang_config(yc) != 0 &&
+#endif
+        yk != NULL &&
+        (cv = yang_cv_get(yk)) != NULL &&
+        cv_type_get(cv) == CGV_STRING;
+    if (!sorted){
+        xc = NULL;
+        while ((xc = xml_child_each(xp, xc, CX_ELMNT)) != NULL) {
+            if (xml_spec(xc) != yc)
+                continue;
+            if (plen && strncmp(xml_prefix_key(xc, keyname), prefix, plen) != 0)
+                continue;
+            if (clixon_xvec_append(xvec, xc) < 0)
+                goto done;
+            if (limit && ++n >= limit)
+                break;
+        }
+        goto ok;
+    }
+    if ((yi = yang_order(yc)) < -1)
+        goto done;
+    /* Lower bound of yc entries */
+    low = 0;
+    upper = xml_child_nr(xp);
+    while (low < upper){
+        mid = (low + upper) / 2;
+        if (xml_prefix_ycmp(xml_child_i(xp, mid), yi) < 0)
+            low = mid + 1;
+        else
+            upper = mid;
+    }
+    /* Lower bound of prefix among yc entries */
+    if (plen){
+        upper = xml_child_nr(xp);
+        while (low < upper){
+            mid = (low + upper) / 2;
+            xc = xml_child_i(xp, mid);
+            if (xml_prefix_ycmp(xc, yi) > 0 ||
+                (xml_spec(xc) == yc && strcmp(xml_prefix_key(xc, keyname), prefix) >= 0))
+                upper = mid;
+            else
+                low = mid + 1;
+        }
+    }
+    for (i = low; i < xml_child_nr(xp); i++){
+        xc = xml_child_i(xp, i);
+        if (xml_spec(xc) != yc)
+            break;
+        if (plen && strncmp(xml_prefix_key(xc, keyname), prefix, plen) != 0)
+            break;
+        if (clixon_xvec_append(xvec, xc) < 0)
+            goto done;
+        if (limit && ++n >= limit)
+            break;
+    }
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Find the range of list or leaf-list entries among the children of a sorted parent
+ *
+ * Entries of the same list or leaf-list are contiguous in a sorted parent (as in a datastore)
+ * since siblings are ordered by yang order first. The range is found by binary search.
+ * @param[in]  xp     Parent xml node, sorted
+ * @param[in]  yc     Yang spec of list or leaf-list child
+ * @param[out] lowp   Index of first entry in child vector of xp
+ * @param[out] upperp Index after last entry, same as lowp if no entries
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @code
+ *   cxobj **vec = xml_childvec_get(xp) + low;  # upper-low entries
+ * @endcode
+ */
+int
+clixon_xml_find_range(cxobj     *xp,
+                      yang_stmt *yc,
+                      int       *lowp,
+                      int       *upperp)
+{
+    int retval = -1;
+    int yi;
+    int low;
+    int upper;
+    int mid;
+
+    if (yc == NULL){
+        clicon_err(OE_YANG, ENOENT, "yang spec not found");
+        goto done;
+    }
+    if ((yi = yang_order(yc)) < -1)
+        goto done;
+    low = 0;
+    upper = xml_child_nr(xp);
+    while (low < upper){
+        mid = (low + upper) / 2;
+        if (xml_prefix_ycmp(xml_child_i(xp, mid), yi) < 0)
+            low = mid + 1;
+        else
+            upper = mid;
+    }
+    *lowp = low;
+    upper = xml_child_nr(xp);
+    while (low < upper){
+        mid = (low + upper) / 2;
+        if (xml_prefix_ycmp(xml_child_i(xp, mid), yi) <= 0)
+            low = mid + 1;
+        else
+            upper = mid;
+    }
+    *upperp = upper;
+    retval = 0;
+ done:
+    return retval;
+}
@@ -0,0 +1,1145 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+
+ *
+ * Compiled XPATH expressions for YANG must and when statements
+ * The xpath of a must/when statement is fixed when the YANG spec is loaded, but is evaluated
+ * for every instance node at every validation. xp_eval() allocates a context and a nodeset
+ * for every sub-expression, which dominates the validation of large datastores.
+ * Here the xpath is compiled once into a typed expression tree, where:
+ * - location paths are vectors of steps, evaluated by walking the XML tree depth-first
+ *   without building nodesets,
+ * - namespaces of node tests are resolved at compile time, and the namespace match of a
+ *   node is cached per YANG spec,
+ * - constant sub-expressions are folded.
+ * Only a subset of XPATH is compiled this way: paths without predicates, // or unions,
+ * relational, logical and arithmetic (not mod) operators, and the functions current(),
+ * count(), not(), boolean(), true() and false(). Other expressions are parsed once and
+ * evaluated by the regular interpreter xp_eval().
+ * The compiled evaluation follows the semantics of the interpreter, see xp_relop().
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <syslog.h>
+#include <math.h> /* NaN */
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clicon */
+#include "clixon_err.h"
+#include "clixon_log.h"
+#include "clixon_string.h"
+#include "clixon_queue.h"
+#include "clixon_hash.h"
+#include "clixon_handle.h"
+#include "clixon_yang.h"
+#include "clixon_xml.h"
+#include "clixon_xml_nsctx.h"
+#include "clixon_xml_vec.h"
+#include "clixon_xpath_ctx.h"
+#include "clixon_xpath.h"
+#include "clixon_xpath_function.h"
+#include "clixon_xpath_eval.h"
+#include "clixon_xpath_compile.h"
+
+/*
+ * Types
+ */
+/* Compiled expression operations */
+enum xpc_op{
+    XPC_CONST,   /* Constant of type xn_type */
+    XPC_PATH,    /* Location path */
+    XPC_LOGOP,   /* and, or */
+    XPC_RELOP,   /* =, !=, >=, <=, <, > */
+    XPC_NUMOP,   /* +, -, *, div */
+    XPC_NOT,     /* not() */
+    XPC_BOOLEAN, /* boolean() */
+    XPC_COUNT,   /* count() */
+};
+
+/*! Step in a compiled location path, child or parent axis */
+struct xpc_step{
+    enum axis_type  xst_axis;   /* A_CHILD or A_PARENT */
+    char           *xst_name;   /* Node name, NULL matches any element (*, node(), text()) */
+    char           *xst_prefix; /* Prefix of node test */
+    int             xst_nscset; /* Namespace context given, else compare prefixes */
+    char           *xst_ns;     /* Namespace of prefix, resolved at compile time */
+    yang_stmt      *xst_ymemo;  /* Yang spec of last node with matching name */
+    int             xst_ymatch; /* Namespace match of xst_ymemo */
+};
+
+/*! Compiled expression node */
+struct xpc_node{
+    enum xpc_op       xn_op;
+    enum xp_objtype   xn_type;   /* Result type, known at compile time */
+    enum xp_op        xn_xop;    /* Operator of XPC_LOGOP, XPC_RELOP and XPC_NUMOP */
+    int               xn_bool;   /* XPC_CONST of type XT_BOOL */
+    double            xn_number; /* XPC_CONST of type XT_NUMBER */
+    char             *xn_string; /* XPC_CONST of type XT_STRING */
+    int               xn_reverse; /* XPC_RELOP: operands swapped, nodeset is first */
+    int               xn_root;   /* XPC_PATH: start at root, else at current node */
+    struct xpc_step  *xn_steps;  /* XPC_PATH: vector of steps */
+    int               xn_nsteps; /* XPC_PATH: number of steps */
+    struct xpc_node  *xn_c0;     /* First operand */
+    struct xpc_node  *xn_c1;     /* Second operand */
+};
+
+/*! Compiled xpath, see xpath_compile */
+struct xpath_compiled{
+    xpath_tree       *xpc_tree;  /* Parsed xpath, used by interpreter if not compiled */
+    cvec             *xpc_nsc;   /* Copy of namespace context, or NULL */
+    struct xpc_node  *xpc_top;   /* Compiled expression, or NULL */
+};
+
+/*! Path visitor callback
+ * @retval  -1   Error
+ * @retval   0   Continue
+ * @retval   1   Stop walk
+ */
+typedef int (xpc_visit_fn)(cxobj *x, void *arg);
+
+/* Argument to relational operator visitors */
+struct xpc_relarg{
+    struct xpc_node *xr_node;    /* Relop node */
+    cxobj           *xr_cur;     /* Current node */
+    cxobj           *xr_x1;      /* Node of first nodeset (nodeset/nodeset) */
+    char            *xr_s1;      /* Body of xr_x1 */
+    char            *xr_string;  /* String operand */
+    double           xr_number;  /* Number operand */
+    int              xr_result;
+};
+
+/* Forward */
+static int xpc_eval_bool(struct xpc_node *xn, cxobj *xcur);
+static int xpc_eval_number(struct xpc_node *xn, cxobj *xcur, double *np);
+
+static struct xpc_node *
+xpc_node_new(enum xpc_op     op,
+             enum xp_objtype type)
+{
+    struct xpc_node *xn;
+
+    if ((xn = malloc(sizeof(*xn))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        return NULL;
+    }
+    memset(xn, 0, sizeof(*xn));
+    xn->xn_op = op;
+    xn->xn_type = type;
+    return xn;
+}
+
+static int
+xpc_node_free(struct xpc_node *xn)
+{
+    if (xn->xn_c0)
+        xpc_node_free(xn->xn_c0);
+    if (xn->xn_c1)
+        xpc_node_free(xn->xn_c1);
+    if (xn->xn_string)
+        free(xn->xn_string);
+    if (xn->xn_steps)
+        free(xn->xn_steps);
+    free(xn);
+    return 0;
+}
+
+/*! Node test of a compiled step, see nodetest_eval_node
+ * @param[in]  st   Compiled step
+ * @param[in]  x    XML node
+ * @retval     1    Match
+ * @retval     0    No match
+ * @retval    -1    Error
+ */
+static int
+xpc_nodetest(struct xpc_step *st,
+             cxobj           *x)
+{
+    char      *prefix;
+    char      *nsxml = NULL;
+    yang_stmt *y;
+    int        match;
+
+    if (st->xst_name == NULL)
+        return 1;
+    if (strcmp(xml_name(x), st->xst_name) != 0)
+        return 0;
+    prefix = xml_prefix(x);
+    if (!st->xst_nscset){
+        if (prefix == NULL || st->xst_prefix == NULL)
+            return prefix == st->xst_prefix;
+        return strcmp(prefix, st->xst_prefix) == 0;
+    }
+    if (st->xst_ns == NULL) /* No namespace in xpath context, eg augments */
+        return 1;
+    /* Namespace of a yang-bound node follows from its spec */
+    if ((y = xml_spec(x)) != NULL && y == st->xst_ymemo)
+        return st->xst_ymatch;
+    if (xml2ns(x, prefix, &nsxml) < 0)
+        return -1;
+    match = (nsxml != NULL && strcmp(nsxml, st->xst_ns) == 0);
+    if (y != NULL){
+        st->xst_ymemo = y;
+        st->xst_ymatch = match;
+    }
+    return match;
+}
+
+/*! Walk a compiled location path and call fn for every node in the resulting nodeset
+ * Nodes are visited in the same order, including duplicates, as the nodeset of xp_eval
+ * @param[in]  xn   Compiled path
+ * @param[in]  i    Step index
+ * @param[in]  x    Context node of step
+ * @param[in]  fn   Visitor function
+ * @param[in]  arg  Visitor argument
+ * @retval     1    Walk stopped by visitor
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+xpc_path_walk(struct xpc_node *xn,
+              int              i,
+              cxobj           *x,
+              xpc_visit_fn    *fn,
+              void            *arg)
+{
+    struct xpc_step *st;
+    cxobj           *xc;
+    int              ret;
+
+    if (i == xn->xn_nsteps)
+        return fn(x, arg);
+    st = &xn->xn_steps[i];
+    if (st->xst_axis == A_PARENT){
+        if ((xc = xml_parent(x)) == NULL
+#ifdef XML_PARENT_CANDIDATE
+            && (xc = xml_parent_candidate(x)) == NULL
+#endif
+            )
+            return 0;
+        return xpc_path_walk(xn, i+1, xc, fn, arg);
+    }
+    xc = NULL;
+    while ((xc = xml_child_each(x, xc, CX_ELMNT)) != NULL) {
+        if ((ret = xpc_nodetest(st, xc)) < 0)
+            return -1;
+        if (ret == 0)
+            continue;
+        if ((ret = xpc_path_walk(xn, i+1, xc, fn, arg)) != 0)
+            return ret;
+    }
+    return 0;
+}
+
+/*! Walk a compiled location path from its start node, the root or the current node
+ */
+static int
+xpc_path(struct xpc_node *xn,
+         cxobj           *xcur,
+         xpc_visit_fn    *fn,
+         void            *arg)
+{
+    cxobj *x = xcur;
+
+    if (xn->xn_root){
+#ifdef XML_PARENT_CANDIDATE
+        while (xml_parent(x) != NULL || xml_parent_candidate(x) != NULL)
+            x = xml_parent(x)?xml_parent(x):xml_parent_candidate(x);
+#else
+        while (xml_parent(x) != NULL)
+            x = xml_parent(x);
+#endif
+    }
+    return xpc_path_walk(xn, 0, x, fn, arg);
+}
+
+/*! Visitor: get first node of nodeset */
+static int
+xpc_visit_first(cxobj *x,
+                void  *arg)
+{
+    *(cxobj **)arg = x;
+    return 1;
+}
+
+/*! Visitor: count nodes of nodeset */
+static int
+xpc_visit_count(cxobj *x,
+                void  *arg)
+{
+    (*(int *)arg)++;
+    return 0;
+}
+
+/*! Compare two numbers using a relational operator
+ */
+static int
+xpc_numcmp(enum xp_op op,
+           double     n1,
+           double     n2)
+{
+    switch (op){
+    case XO_EQ:
+        return n1 == n2;
+    case XO_NE:
+        return n1 != n2;
+    case XO_GE:
+        return n1 >= n2;
+    case XO_LE:
+        return n1 <= n2;
+    case XO_LT:
+        return n1 < n2;
+    case XO_GT:
+        return n1 > n2;
+    default:
+        break;
+    }
+    return 0;
+}
+
+/*! Visitor: compare node body with string, only = and != */
+static int
+xpc_visit_string(cxobj *x,
+                 void  *arg)
+{
+    struct xpc_relarg *xr = (struct xpc_relarg *)arg;
+    char              *s1;
+    int                b;
+
+    s1 = xml_body(x);
+    if (xr->xr_node->xn_xop == XO_EQ)
+        b = s1 ? strcmp(s1, xr->xr_string) == 0 : strlen(xr->xr_string) == 0;
+    else
+        b = s1 ? strcmp(s1, xr->xr_string) != 0 : 1;
+    if (b){
+        xr->xr_result = 1;
+        return 1;
+    }
+    return 0;
+}
+
+/*! Visitor: compare node body with number */
+static int
+xpc_visit_number(cxobj *x,
+                 void  *arg)
+{
+    struct xpc_relarg *xr = (struct xpc_relarg *)arg;
+    char              *xb;
+    double             n1;
+    int                b;
+
+    if ((xb = xml_body(x)) == NULL ||
+        sscanf(xb, "%lf", &n1) != 1)
+        n1 = NAN;
+    if (xr->xr_node->xn_reverse)
+        b = xpc_numcmp(xr->xr_node->xn_xop, xr->xr_number, n1);
+    else
+        b = xpc_numcmp(xr->xr_node->xn_xop, n1, xr->xr_number);
+    if (b){
+        xr->xr_result = 1;
+        return 1;
+    }
+    return 0;
+}
+
+/*! Visitor: compare node of second nodeset with node of first nodeset
+ * YANG bound nodes are compared by value, others by string
+ */
+static int
+xpc_visit_node2(cxobj *x2,
+                void  *arg)
+{
+    struct xpc_relarg *xr = (struct xpc_relarg *)arg;
+    char              *s2;
+    cg_var            *cv1;
+    cg_var            *cv2;
+    int                ret;
+
+    if ((s2 = xml_body(x2)) == NULL){
+        xr->xr_result = 0;
+        return 1;
+    }
+    if (xml_spec(xr->xr_x1) && xml_spec(x2)){
+        if (xml_cv_cache(xr->xr_x1, &cv1) < 0)
+            return -1;
+        if (xml_cv_cache(x2, &cv2) < 0)
+            return -1;
+        if (cv1 != NULL && cv2 != NULL)
+            ret = cv_cmp(cv1, cv2);
+        else if (cv1 == NULL && cv2 == NULL)
+            ret = 0;
+        else if (cv1 == NULL)
+            ret = -1;
+        else
+            ret = 1;
+    }
+    else
+        ret = strcmp(xr->xr_s1, s2);
+    if (xpc_numcmp(xr->xr_node->xn_xop, ret, 0)){
+        xr->xr_result = 1;
+        return 1;
+    }
+    return 0;
+}
+
+/*! Visitor: compare node of first nodeset with all nodes of second nodeset
+ */
+static int
+xpc_visit_node1(cxobj *x1,
+                void  *arg)
+{
+    struct xpc_relarg *xr = (struct xpc_relarg *)arg;
+
+    if ((xr->xr_s1 = xml_body(x1)) == NULL){
+        xr->xr_result = 0;
+        return 1;
+    }
+    xr->xr_x1 = x1;
+    return xpc_path(xr->xr_node->xn_c1, xr->xr_cur, xpc_visit_node2, xr);
+}
+
+/*! Evaluate compiled relational operator
+ * @param[in]  xn    Compiled relop node
+ * @param[in]  xcur  Current node
+ * @retval     1     True
+ * @retval     0     False
+ * @retval    -1     Error
+ * @see xp_relop  Same semantics
+ */
+static int
+xpc_relop(struct xpc_node *xn,
+          cxobj           *xcur)
+{
+    struct xpc_node  *xn0 = xn->xn_c0;
+    struct xpc_node  *xn1 = xn->xn_c1;
+    struct xpc_relarg xr = {0,};
+    int               b0;
+    int               b1;
+    double            n0;
+    double            n1;
+    cxobj            *x = NULL;
+
+    xr.xr_node = xn;
+    xr.xr_cur = xcur;
+    if (xn0->xn_type == XT_NODESET){
+        switch (xn1->xn_type){
+        case XT_NODESET:
+            if (xpc_path(xn0, xcur, xpc_visit_node1, &xr) < 0)
+                return -1;
+            break;
+        case XT_BOOL:
+            if (xpc_path(xn0, xcur, xpc_visit_first, &x) < 0)
+                return -1;
+            if ((b1 = xpc_eval_bool(xn1, xcur)) < 0)
+                return -1;
+            xr.xr_result = (xn->xn_xop == XO_EQ) ? ((x != NULL) == b1) : ((x != NULL) != b1);
+            break;
+        case XT_STRING:
+            xr.xr_string = xn1->xn_string;
+            if (xpc_path(xn0, xcur, xpc_visit_string, &xr) < 0)
+                return -1;
+            break;
+        case XT_NUMBER:
+            if (xpc_eval_number(xn1, xcur, &xr.xr_number) < 0)
+                return -1;
+            if (xpc_path(xn0, xcur, xpc_visit_number, &xr) < 0)
+                return -1;
+            break;
+        }
+        return xr.xr_result;
+    }
+    switch (xn0->xn_type){
+    case XT_BOOL:
+        if ((b0 = xpc_eval_bool(xn0, xcur)) < 0)
+            return -1;
+        if ((b1 = xpc_eval_bool(xn1, xcur)) < 0)
+            return -1;
+        return b0 == b1;
+    case XT_NUMBER:
+        if (xpc_eval_number(xn0, xcur, &n0) < 0)
+            return -1;
+        if (xpc_eval_number(xn1, xcur, &n1) < 0)
+            return -1;
+        return xpc_numcmp(xn->xn_xop, n0, n1);
+    case XT_STRING: /* Strings are constants */
+        return strcmp(xn0->xn_string, xn1->xn_string) == 0;
+    default:
+        break;
+    }
+    return 0;
+}
+
+/*! Evaluate compiled expression as boolean
+ * @param[in]  xn    Compiled expression
+ * @param[in]  xcur  Current node, may be NULL if expression is constant
+ * @retval     1     True
+ * @retval     0     False
+ * @retval    -1     Error
+ * @see ctx2boolean
+ */
+static int
+xpc_eval_bool(struct xpc_node *xn,
+              cxobj           *xcur)
+{
+    int    b;
+    double n;
+    cxobj *x = NULL;
+
+    switch (xn->xn_op){
+    case XPC_CONST:
+        switch (xn->xn_type){
+        case XT_BOOL:
+            return xn->xn_bool;
+        case XT_NUMBER:
+            return xn->xn_number != 0.0;
+        case XT_STRING:
+            return strlen(xn->xn_string) != 0;
+        default:
+            break;
+        }
+        break;
+    case XPC_PATH:
+        if (xpc_path(xn, xcur, xpc_visit_first, &x) < 0)
+            return -1;
+        return x != NULL;
+    case XPC_LOGOP:
+        if ((b = xpc_eval_bool(xn->xn_c0, xcur)) < 0)
+            return -1;
+        if (xn->xn_xop == XO_AND ? !b : b)
+            return b;
+        return xpc_eval_bool(xn->xn_c1, xcur);
+    case XPC_RELOP:
+        return xpc_relop(xn, xcur);
+    case XPC_NOT:
+        if ((b = xpc_eval_bool(xn->xn_c0, xcur)) < 0)
+            return -1;
+        return !b;
+    case XPC_BOOLEAN:
+        return xpc_eval_bool(xn->xn_c0, xcur);
+    case XPC_NUMOP:
+    case XPC_COUNT:
+        if (xpc_eval_number(xn, xcur, &n) < 0)
+            return -1;
+        return n != 0.0;
+    }
+    clicon_err(OE_XML, EFAULT, "Invalid compiled xpath operation %d", xn->xn_op);
+    return -1;
+}
+
+/*! Evaluate compiled expression as number
+ * @param[in]  xn    Compiled expression
+ * @param[in]  xcur  Current node, may be NULL if expression is constant
+ * @param[out] np    Result number, NaN if not a number
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see ctx2number
+ */
+static int
+xpc_eval_number(struct xpc_node *xn,
+                cxobj           *xcur,
+                double          *np)
+{
+    int    b;
+    int    i = 0;
+    double n = NAN;
+    double n0;
+    double n1;
+    cxobj *x = NULL;
+    char  *xb;
+
+    switch (xn->xn_op){
+    case XPC_CONST:
+        if (xn->xn_type == XT_NUMBER)
+            n = xn->xn_number;
+        else if (xn->xn_type == XT_BOOL)
+            n = (double)xn->xn_bool;
+        else if (xn->xn_type == XT_STRING &&
+                 sscanf(xn->xn_string, "%lf", &n) != 1)
+            n = NAN;
+        break;
+    case XPC_PATH:
+        if (xpc_path(xn, xcur, xpc_visit_first, &x) < 0)
+            return -1;
+        if (x == NULL ||
+            (xb = xml_body(x)) == NULL ||
+            sscanf(xb, "%lf", &n) != 1)
+            n = NAN;
+        break;
+    case XPC_COUNT:
+        if (xpc_path(xn->xn_c0, xcur, xpc_visit_count, &i) < 0)
+            return -1;
+        n = i;
+        break;
+    case XPC_NUMOP:
+        if (xpc_eval_number(xn->xn_c0, xcur, &n0) < 0)
+            return -1;
+        if (xpc_eval_number(xn->xn_c1, xcur, &n1) < 0)
+            return -1;
+        if (isnan(n0) || isnan(n1))
+            n = NAN;
+        else
+            switch (xn->xn_xop){
+            case XO_DIV:
+                n = n0/n1;
+                break;
+            case XO_ADD:
+                n = n0+n1;
+                break;
+            case XO_MULT:
+                n = n0*n1;
+                break;
+            case XO_SUB:
+                n = n0-n1;
+                break;
+            default:
+                break;
+            }
+        break;
+    default: /* Boolean expressions */
+        if ((b = xpc_eval_bool(xn, xcur)) < 0)
+            return -1;
+        n = (double)b;
+        break;
+    }
+    *np = n;
+    return 0;
+}
+
+/*! Fold constant sub-expressions
+ * Operations with constant operands are replaced by their value. A logical operation with
+ * one constant operand is replaced by a constant or by the other operand.
+ * @param[in,out] xnp  Compiled expression, may be replaced
+ * @retval        0    OK
+ * @retval       -1    Error
+ */
+static int
+xpc_fold(struct xpc_node **xnp)
+{
+    struct xpc_node *xn = *xnp;
+    struct xpc_node *xc;
+    struct xpc_node *xo;
+    int              b;
+    double           n;
+
+    if (xn->xn_op == XPC_CONST || xn->xn_op == XPC_PATH)
+        return 0;
+    if (xn->xn_op == XPC_LOGOP &&
+        ((xc = xn->xn_c0)->xn_op == XPC_CONST || (xc = xn->xn_c1)->xn_op == XPC_CONST)){
+        if ((b = xpc_eval_bool(xc, NULL)) < 0)
+            return -1;
+        if (b != (xn->xn_xop == XO_OR)){ /* true and x, false or x: result is x */
+            xo = (xc == xn->xn_c0) ? xn->xn_c1 : xn->xn_c0;
+            if (xc == xn->xn_c0)
+                xn->xn_c1 = NULL;
+            else
+                xn->xn_c0 = NULL;
+            xpc_node_free(xn);
+            if (xo->xn_type == XT_BOOL)
+                *xnp = xo;
+            else {
+                if ((*xnp = xpc_node_new(XPC_BOOLEAN, XT_BOOL)) == NULL){
+                    xpc_node_free(xo);
+                    return -1;
+                }
+                (*xnp)->xn_c0 = xo;
+                return xpc_fold(xnp);
+            }
+            return 0;
+        }
+        xn->xn_bool = b; /* false and x, true or x: result is constant */
+    }
+    else {
+        if ((xn->xn_c0 && xn->xn_c0->xn_op != XPC_CONST) ||
+            (xn->xn_c1 && xn->xn_c1->xn_op != XPC_CONST))
+            return 0;
+        if (xn->xn_type == XT_BOOL){
+            if ((b = xpc_eval_bool(xn, NULL)) < 0)
+                return -1;
+            xn->xn_bool = b;
+        }
+        else if (xn->xn_type == XT_NUMBER){
+            if (xpc_eval_number(xn, NULL, &n) < 0)
+                return -1;
+            xn->xn_number = n;
+        }
+        else
+            return 0;
+    }
+    if (xn->xn_c0){
+        xpc_node_free(xn->xn_c0);
+        xn->xn_c0 = NULL;
+    }
+    if (xn->xn_c1){
+        xpc_node_free(xn->xn_c1);
+        xn->xn_c1 = NULL;
+    }
+    xn->xn_op = XPC_CONST;
+    return 0;
+}
+
+/*! Add step to compiled path
+ * @param[in]  xn      Compiled path
+ * @param[in]  axis    A_CHILD or A_PARENT
+ * @param[in]  prefix  Prefix of node test, or NULL
+ * @param[in]  name    Name of node test, or NULL for any
+ * @param[in]  nsc     Namespace context, or NULL
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+xpc_step_add(struct xpc_node *xn,
+             enum axis_type   axis,
+             char            *prefix,
+             char            *name,
+             cvec            *nsc)
+{
+    struct xpc_step *steps;
+    struct xpc_step *st;
+
+    if ((steps = realloc(xn->xn_steps, (xn->xn_nsteps+1)*sizeof(*steps))) == NULL){
+        clicon_err(OE_UNIX, errno, "realloc");
+        return -1;
+    }
+    xn->xn_steps = steps;
+    st = &steps[xn->xn_nsteps++];
+    memset(st, 0, sizeof(*st));
+    st->xst_axis = axis;
+    st->xst_prefix = prefix;
+    st->xst_name = name;
+    if (nsc != NULL){
+        st->xst_nscset = 1;
+        st->xst_ns = xml_nsctx_get(nsc, prefix);
+    }
+    return 0;
+}
+
+/*! Compile relative location path into steps of compiled path
+ * @param[in]  xn    Compiled path
+ * @param[in]  xs    XP_RELLOCPATH or XP_STEP parse tree
+ * @param[in]  nsc   Namespace context, or NULL
+ * @retval     1     OK
+ * @retval     0     Not supported, use interpreter
+ * @retval    -1     Error
+ */
+static int
+xpc_steps_build(struct xpc_node *xn,
+                xpath_tree      *xs,
+                cvec            *nsc)
+{
+    int         ret;
+    xpath_tree *xt;
+
+    switch (xs->xs_type){
+    case XP_RELLOCPATH:
+        if (xs->xs_int == A_DESCENDANT_OR_SELF)
+            return 0;
+        if (xs->xs_c0 && (ret = xpc_steps_build(xn, xs->xs_c0, nsc)) != 1)
+            return ret;
+        if (xs->xs_c1 && (ret = xpc_steps_build(xn, xs->xs_c1, nsc)) != 1)
+            return ret;
+        return 1;
+    case XP_STEP:
+        /* Predicates */
+        if ((xt = xs->xs_c1) != NULL && (xt->xs_c0 != NULL || xt->xs_c1 != NULL))
+            return 0;
+        xt = xs->xs_c0; /* nodetest */
+        switch (xs->xs_int){
+        case A_SELF:
+            return 1;
+        case A_PARENT:
+            return xpc_step_add(xn, A_PARENT, NULL, NULL, NULL) < 0 ? -1 : 1;
+        case A_CHILD:
+            if (xt == NULL)
+                return 0;
+            if (xt->xs_type == XP_NODE){
+                if (xt->xs_s1 == NULL) /* prefix:* */
+                    return 0;
+                if (strcmp(xt->xs_s1, "*") == 0)
+                    ret = xpc_step_add(xn, A_CHILD, NULL, NULL, NULL);
+                else
+                    ret = xpc_step_add(xn, A_CHILD, xt->xs_s0, xt->xs_s1, nsc);
+            }
+            else if (xt->xs_type == XP_NODE_FN &&
+                     (xt->xs_int == XPATHFN_NODE || xt->xs_int == XPATHFN_TEXT))
+                ret = xpc_step_add(xn, A_CHILD, NULL, NULL, NULL);
+            else
+                return 0;
+            return ret < 0 ? -1 : 1;
+        default:
+            break;
+        }
+        break;
+    default:
+        break;
+    }
+    return 0;
+}
+
+/*! Compile xpath parse tree to expression tree
+ * @param[in]  xs    XPath parse tree
+ * @param[in]  nsc   Namespace context, or NULL
+ * @param[out] xnp   Compiled expression (if retval is 1)
+ * @retval     1     OK
+ * @retval     0     Not supported, use interpreter
+ * @retval    -1     Error
+ */
+static int
+xpc_build(xpath_tree       *xs,
+          cvec             *nsc,
+          struct xpc_node **xnp)
+{
+    int              retval = -1;
+    struct xpc_node *xn = NULL;
+    struct xpc_node *xn0 = NULL;
+    struct xpc_node *xn1 = NULL;
+    struct xpc_node *xc;
+    int              ret;
+
+    switch (xs->xs_type){
+    case XP_EXP:
+        if (xs->xs_c1 != NULL)
+            goto unsupported;
+        /* fall through */
+    case XP_FILTEREXPR:
+    case XP_PRI0:
+    case XP_LOCPATH:
+        if (xs->xs_c0 == NULL)
+            goto unsupported;
+        return xpc_build(xs->xs_c0, nsc, xnp);
+    case XP_AND:
+    case XP_RELEX:
+    case XP_ADD:
+        if (xs->xs_c0 == NULL)
+            goto unsupported;
+        if (xs->xs_c1 == NULL)
+            return xpc_build(xs->xs_c0, nsc, xnp);
+        if ((ret = xpc_build(xs->xs_c0, nsc, &xn0)) < 0)
+            goto done;
+        if (ret == 0)
+            goto unsupported;
+        if ((ret = xpc_build(xs->xs_c1, nsc, &xn1)) < 0)
+            goto done;
+        if (ret == 0)
+            goto unsupported;
+        if (xs->xs_type == XP_AND){
+            if (xs->xs_int != XO_AND && xs->xs_int != XO_OR)
+                goto unsupported;
+            if ((xn = xpc_node_new(XPC_LOGOP, XT_BOOL)) == NULL)
+                goto done;
+        }
+        else if (xs->xs_type == XP_RELEX){
+            if (xn0->xn_type != XT_NODESET && xn1->xn_type != XT_NODESET){
+                if (xn0->xn_type != xn1->xn_type) /* Mixed types, error in interpreter */
+                    goto unsupported;
+            }
+            else if (xn0->xn_type != XT_NODESET || xn1->xn_type != XT_NODESET){
+                if ((xn = xpc_node_new(XPC_RELOP, XT_BOOL)) == NULL)
+                    goto done;
+                if (xn1->xn_type == XT_NODESET){ /* Nodeset is first operand */
+                    xc = xn0;
+                    xn0 = xn1;
+                    xn1 = xc;
+                    xn->xn_reverse = 1;
+                }
+                if (xn1->xn_type != XT_NUMBER &&
+                    xs->xs_int != XO_EQ && xs->xs_int != XO_NE)
+                    goto unsupported;
+            }
+            if (xn == NULL &&
+                (xn = xpc_node_new(XPC_RELOP, XT_BOOL)) == NULL)
+                goto done;
+        }
+        else {
+            if (xs->xs_int != XO_ADD && xs->xs_int != XO_SUB &&
+                xs->xs_int != XO_MULT && xs->xs_int != XO_DIV)
+                goto unsupported;
+            if ((xn = xpc_node_new(XPC_NUMOP, XT_NUMBER)) == NULL)
+                goto done;
+        }
+        xn->xn_xop = xs->xs_int;
+        xn->xn_c0 = xn0;
+        xn->xn_c1 = xn1;
+        xn0 = xn1 = NULL;
+        break;
+    case XP_UNION:
+        if (xs->xs_c0 == NULL || xs->xs_c1 != NULL)
+            goto unsupported;
+        return xpc_build(xs->xs_c0, nsc, xnp);
+    case XP_PATHEXPR:
+        if (xs->xs_c0 == NULL)
+            goto unsupported;
+        if (xs->xs_c1 == NULL)
+            return xpc_build(xs->xs_c0, nsc, xnp);
+        /* filterexpr / rellocpath, eg current()/../x */
+        if (xs->xs_s0 == NULL || strcmp(xs->xs_s0, "/") != 0)
+            goto unsupported;
+        if ((ret = xpc_build(xs->xs_c0, nsc, &xn)) < 0)
+            goto done;
+        if (ret == 0 || xn->xn_op != XPC_PATH)
+            goto unsupported;
+        if ((ret = xpc_steps_build(xn, xs->xs_c1, nsc)) < 0)
+            goto done;
+        if (ret == 0)
+            goto unsupported;
+        break;
+    case XP_ABSPATH:
+        if (xs->xs_int != A_ROOT)
+            goto unsupported;
+        if ((xn = xpc_node_new(XPC_PATH, XT_NODESET)) == NULL)
+            goto done;
+        xn->xn_root = 1;
+        if (xs->xs_c0 == NULL){ /* "/" is children of root, see xp_eval */
+            if (xpc_step_add(xn, A_CHILD, NULL, NULL, NULL) < 0)
+                goto done;
+        }
+        else {
+            if ((ret = xpc_steps_build(xn, xs->xs_c0, nsc)) < 0)
+                goto done;
+            if (ret == 0)
+                goto unsupported;
+        }
+        break;
+    case XP_RELLOCPATH:
+    case XP_STEP:
+        if ((xn = xpc_node_new(XPC_PATH, XT_NODESET)) == NULL)
+            goto done;
+        if ((ret = xpc_steps_build(xn, xs, nsc)) < 0)
+            goto done;
+        if (ret == 0)
+            goto unsupported;
+        break;
+    case XP_PRIME_NR:
+        if ((xn = xpc_node_new(XPC_CONST, XT_NUMBER)) == NULL)
+            goto done;
+        xn->xn_number = xs->xs_double;
+        break;
+    case XP_PRIME_STR:
+        if (xs->xs_s0 == NULL)
+            goto unsupported;
+        if ((xn = xpc_node_new(XPC_CONST, XT_STRING)) == NULL)
+            goto done;
+        if ((xn->xn_string = strdup(xs->xs_s0)) == NULL){
+            clicon_err(OE_UNIX, errno, "strdup");
+            goto done;
+        }
+        break;
+    case XP_PRIME_FN:
+        switch (xs->xs_int){
+        case XPATHFN_CURRENT:
+            if (xs->xs_c0 != NULL)
+                goto unsupported;
+            if ((xn = xpc_node_new(XPC_PATH, XT_NODESET)) == NULL)
+                goto done;
+            break;
+        case XPATHFN_TRUE:
+        case XPATHFN_FALSE:
+            if (xs->xs_c0 != NULL)
+                goto unsupported;
+            if ((xn = xpc_node_new(XPC_CONST, XT_BOOL)) == NULL)
+                goto done;
+            xn->xn_bool = (xs->xs_int == XPATHFN_TRUE);
+            break;
+        case XPATHFN_NOT:
+        case XPATHFN_BOOLEAN:
+        case XPATHFN_COUNT:
+            /* One argument: args -> expr */
+            if (xs->xs_c0 == NULL)
+                goto unsupported;
+            if ((ret = xpc_build(xs->xs_c0, nsc, &xn0)) < 0)
+                goto done;
+            if (ret == 0)
+                goto unsupported;
+            if (xs->xs_int == XPATHFN_COUNT){
+                if (xn0->xn_op != XPC_PATH)
+                    goto unsupported;
+                if ((xn = xpc_node_new(XPC_COUNT, XT_NUMBER)) == NULL)
+                    goto done;
+            }
+            else if (xs->xs_int == XPATHFN_BOOLEAN && xn0->xn_type == XT_BOOL){
+                *xnp = xn0;
+                return 1;
+            }
+            else if ((xn = xpc_node_new(xs->xs_int == XPATHFN_NOT ? XPC_NOT : XPC_BOOLEAN,
+                                        XT_BOOL)) == NULL)
+                goto done;
+            xn->xn_c0 = xn0;
+            xn0 = NULL;
+            break;
+        default:
+            goto unsupported;
+        }
+        break;
+    default:
+        goto unsupported;
+    }
+    if (xpc_fold(&xn) < 0)
+        goto done;
+    *xnp = xn;
+    xn = NULL;
+    retval = 1;
+ done:
+    if (xn)
+        xpc_node_free(xn);
+    if (xn0)
+        xpc_node_free(xn0);
+    if (xn1)
+        xpc_node_free(xn1);
+    return retval;
+ unsupported:
+    retval = 0;
+    goto done;
+}
+
+/*! Compile xpath
+ *
+ * The xpath is parsed and, if in the supported subset, compiled to an expression tree.
+ * @param[in]  xpath  XPath string
+ * @param[in]  nsc    Namespace context, or NULL, copied
+ * @param[out] xpcp   Compiled xpath, free with xpath_compiled_free
+ * @retval     0      OK
+ * @retval    -1      Error, eg xpath parse error
+ * @code
+ *   xpath_compiled *xpc = NULL;
+ *   if (xpath_compile("../type='static'", nsc, &xpc) < 0)
+ *      err;
+ *   if ((ret = xpath_compiled_bool(xpc, x)) < 0)
+ *      err;
+ *   xpath_compiled_free(xpc);
+ * @endcode
+ */
+int
+xpath_compile(const char      *xpath,
+              cvec            *nsc,
+              xpath_compiled **xpcp)
+{
+    int             retval = -1;
+    xpath_compiled *xpc = NULL;
+
+    if ((xpc = malloc(sizeof(*xpc))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(xpc, 0, sizeof(*xpc));
+    if (xpath_parse(xpath, &xpc->xpc_tree) < 0)
+        goto done;
+    if (nsc && (xpc->xpc_nsc = cvec_dup(nsc)) == NULL){
+        clicon_err(OE_XML, errno, "cvec_dup");
+        goto done;
+    }
+    if (xpc_build(xpc->xpc_tree, xpc->xpc_nsc, &xpc->xpc_top) < 0)
+        goto done;
+    clicon_debug(1, "%s %s: %s", __FUNCTION__, xpath, xpc->xpc_top?"compiled":"interpreted");
+    *xpcp = xpc;
+    xpc = NULL;
+    retval = 0;
+ done:
+    if (xpc)
+        xpath_compiled_free(xpc);
+    return retval;
+}
+
+/*! Free compiled xpath
+ * @param[in]  xpc   Compiled xpath
+ */
+int
+xpath_compiled_free(xpath_compiled *xpc)
+{
+    if (xpc->xpc_top)
+        xpc_node_free(xpc->xpc_top);
+    if (xpc->xpc_nsc)
+        cvec_free(xpc->xpc_nsc);
+    if (xpc->xpc_tree)
+        xpath_tree_free(xpc->xpc_tree);
+    free(xpc);
+    return 0;
+}
+
+/*! Check if xpath was compiled or is evaluated by the interpreter
+ * @param[in]  xpc   Compiled xpath
+ * @retval     1     Compiled to expression tree
+ * @retval     0     Evaluated by interpreter
+ */
+int
+xpath_compiled_native(xpath_compiled *xpc)
+{
+    return xpc->xpc_top != NULL;
+}
+
+/*! Evaluate compiled xpath as boolean
+ *
+ * Same result as xpath_vec_bool() of the original xpath and namespace context
+ * @param[in]  xpc   Compiled xpath
+ * @param[in]  xcur  XML tree where to search (current and context node)
+ * @retval     1     True
+ * @retval     0     False
+ * @retval    -1     Error
+ */
+int
+xpath_compiled_bool(xpath_compiled *xpc,
+                    cxobj          *xcur)
+{
+    int     retval = -1;
+    xp_ctx  xc = {0,};
+    xp_ctx *xr = NULL;
+
+    if (xpc->xpc_top)
+        return xpc_eval_bool(xpc->xpc_top, xcur);
+    /* Interpreter, as xpath_vec_ctx() without parsing */
+    xc.xc_type = XT_NODESET;
+    xc.xc_node = xcur;
+    xc.xc_initial = xcur;
+    if (cxvec_append(xcur, &xc.xc_nodeset, &xc.xc_size) < 0)
+        goto done;
+    if (xp_eval(&xc, xpc->xpc_tree, xpc->xpc_nsc, 0, &xr) < 0)
+        goto done;
+    if (xr)
+        retval = ctx2boolean(xr);
+ done:
+    if (xc.xc_nodeset)
+        free(xc.xc_nodeset);
+    if (xr)
+        ctx_free(xr);
+    return retval;
+}
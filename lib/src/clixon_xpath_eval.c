@@ -249,9 +249,83 @@ nodetest_eval(cxobj      *x,
     return retval;
 }
 
-/*!
- * @param[in]  xn
+#ifdef XPATH_DESCENDANT_PRUNE
+/*! Get element name of a nodetest, used to prune descendant searches
+ *
+ * @param[in]  nodetest  XPATH nodetest
+ * @retval     name      Element name (without prefix)
+ * @retval     NULL      Any element may match, eg "*" or node()
+ */
+static char *
+nodetest_name(xpath_tree *nodetest)
+{
+    if (nodetest != NULL &&
+        nodetest->xs_type == XP_NODE &&
+        nodetest->xs_s1 != NULL &&
+        strcmp(nodetest->xs_s1, "*") != 0)
+        return nodetest->xs_s1;
+    return NULL;
+}
+
+/*! Check if an element may occur below a yang node other than as entry of a given list
+ *
+ * @param[in]  yn     Yang node
+ * @param[in]  ylist  Yang list, child of yn
+ * @param[in]  name   Element name
+ * @retval     1      Element may occur elsewhere below yn
+ * @retval     0      Element may only occur as entry of ylist
+ * @retval    -1      Error
+ */
+static int
+nodetest_other_descendant(yang_stmt *yn,
+                          yang_stmt *ylist,
+                          char      *name)
+{
+    yang_stmt *yc;
+    int        i;
+    int        ret;
+
+    for (i=0; i<yang_len_get(yn); i++){
+        yc = yang_child_i(yn, i);
+        if (yc == ylist)
+            continue;
+        switch (yang_keyword_get(yc)){
+        case Y_CHOICE:
+        case Y_CASE:
+        case Y_INPUT:
+        case Y_OUTPUT:
+            if ((ret = nodetest_other_descendant(yc, ylist, name)) != 0)
+                return ret;
+            break;
+        case Y_CONTAINER:
+        case Y_LIST:
+        case Y_LEAF:
+        case Y_LEAF_LIST:
+        case Y_ANYDATA:
+        case Y_ANYXML:
+        case Y_ACTION:
+        case Y_NOTIFICATION:
+            if (strcmp(yang_argument_get(yc), name) == 0)
+                return 1;
+            if ((ret = yang_descendant_name(yc, name)) != 0)
+                return ret;
+            break;
+        default:
+            break;
+        }
+    }
+    return 0;
+}
+#endif /* XPATH_DESCENDANT_PRUNE */
+
+/*! Find all descendants of an XML node matching a nodetest
+ *
+ * If XPATH_DESCENDANT_PRUNE is set, subtrees of YANG-bound nodes where no element of the
+ * nodetest name may occur are skipped. If a step is given and the only match below a node is
+ * a list entry, the list key binary search is used, see xpath_optimize_check.
+ * @param[in]  xn         XML node
  * @param[in]  nodetest   XPATH stack
+ * @param[in]  xstep      XPATH step of nodetest for list key search, or NULL
  * @param[in]  node_type
  * @param[in]  flags
  * @param[in]  nsc        XML Namespace context
@@ -262,6 +336,7 @@ nodetest_eval(cxobj      *x,
 int
 nodetest_recursive(cxobj      *xn, 
                    xpath_tree *nodetest,
+                   xpath_tree *xstep,
                    int         node_type,
                    uint16_t    flags,
                    cvec       *nsc,
@@ -269,11 +344,41 @@ nodetest_recursive(cxobj      *xn,
                    cxobj    ***vec0,
                    int        *vec0len)
 {
-    int     retval = -1;
-    cxobj  *xsub; 
-    cxobj **vec = *vec0;
-    int     veclen = *vec0len;
+    int         retval = -1;
+    cxobj      *xsub; 
+    cxobj     **vec = *vec0;
+    int         veclen = *vec0len;
+#ifdef XPATH_DESCENDANT_PRUNE
+    char       *name;
+    yang_stmt  *ys;
+    yang_stmt  *ylist;
+    cxobj     **xvec = NULL;
+    int         xlen = 0;
+    int         i;
+    int         ret;
 
+    name = nodetest_name(nodetest);
+    if (name != NULL && xstep != NULL &&
+        (ys = xml_spec(xn)) != NULL &&
+        (ylist = yang_find(ys, Y_LIST, name)) != NULL){
+        if ((ret = yang_descendant_name(ylist, name)) == 0)
+            ret = nodetest_other_descendant(ys, ylist, name);
+        if (ret < 0)
+            goto done;
+        /* Only entries of ylist may match: try binary search */
+        if (ret == 0){
+            if ((ret = xpath_optimize_check(xstep, xn, &xvec, &xlen)) < 0)
+                goto done;
+            if (ret == 1){
+                for (i=0; i<xlen; i++)
+                    if (flags==0x0 || xml_flag(xvec[i], flags))
+                        if (cxvec_append(xvec[i], &vec, &veclen) < 0)
+                            goto done;
+                goto ok;
+            }
+        }
+    }
+#endif /* XPATH_DESCENDANT_PRUNE */
     xsub = NULL;
     while ((xsub = xml_child_each(xn, xsub, node_type)) != NULL) {
         if (nodetest_eval(xsub, nodetest, nsc, localonly) == 1){
@@ -283,13 +388,29 @@ nodetest_recursive(cxobj      *xn,
                     goto done;
             //      continue; /* Dont go deeper */
         }
-        if (nodetest_recursive(xsub, nodetest, node_type, flags, nsc, localonly, &vec, &veclen) < 0)
+#ifdef XPATH_DESCENDANT_PRUNE
+        /* Skip subtree if no element of that name may occur in it */
+        if (name != NULL && (ys = xml_spec(xsub)) != NULL){
+            if ((ret = yang_descendant_name(ys, name)) < 0)
+                goto done;
+            if (ret == 0)
+                continue;
+        }
+#endif
+        if (nodetest_recursive(xsub, nodetest, xstep, node_type, flags, nsc, localonly, &vec, &veclen) < 0)
             goto done;
     }
+#ifdef XPATH_DESCENDANT_PRUNE
+ ok:
+#endif
     retval = 0;
+ done:
     *vec0 = vec;
     *vec0len = veclen;
-  done:
+#ifdef XPATH_DESCENDANT_PRUNE
+    if (xvec)
+        free(xvec);
+#endif
     return retval;
 }
 
@@ -339,7 +460,7 @@ xp_eval_step(xp_ctx     *xc0,
         if (xc->xc_descendant){
             for (i=0; i<xc->xc_size; i++){
                 xv = xc->xc_nodeset[i];
-                if (nodetest_recursive(xv, nodetest, CX_ELMNT, 0x0, nsc, localonly, &vec, &veclen) < 0)
+                if (nodetest_recursive(xv, nodetest, xs, CX_ELMNT, 0x0, nsc, localonly, &vec, &veclen) < 0)
                     goto done;
             }
             xc->xc_descendant = 0;
@@ -367,7 +488,7 @@ xp_eval_step(xp_ctx     *xc0,
     case A_DESCENDANT_OR_SELF:
         for (i=0; i<xc->xc_size; i++){
             xv = xc->xc_nodeset[i];
-            if (nodetest_recursive(xv, xs->xs_c0, CX_ELMNT, 0x0, nsc, localonly, &vec, &veclen) < 0)
+            if (nodetest_recursive(xv, xs->xs_c0, NULL, CX_ELMNT, 0x0, nsc, localonly, &vec, &veclen) < 0)
                 goto done;
         }
         for (i=0; i<veclen; i++){
@@ -383,7 +504,7 @@ xp_eval_step(xp_ctx     *xc0,
     case A_DESCENDANT:
         for (i=0; i<xc->xc_size; i++){
             xv = xc->xc_nodeset[i];
-            if (nodetest_recursive(xv, xs->xs_c0, CX_ELMNT, 0x0, nsc, localonly, &vec, &veclen) < 0)
+            if (nodetest_recursive(xv, xs->xs_c0, NULL, CX_ELMNT, 0x0, nsc, localonly, &vec, &veclen) < 0)
                 goto done;
         }
         ctx_nodeset_replace(xc, vec, veclen);
@@ -687,7 +808,7 @@ xp_numop(xp_ctx    *xc1,
  * As a side-effect sets the cache.
  * Clear cache with xml_cv_set(x, NULL)
  */
-static int
+int
 xml_cv_cache(cxobj   *x,
              cg_var **cvp)
 {
@@ -45,6 +45,7 @@ extern const map_str2int xpopmap[];
 /*
  * Prototypes
  */
+int xml_cv_cache(cxobj *x, cg_var **cvp);
 int xp_eval(xp_ctx *xc, xpath_tree *xs, cvec *nsc, int localonly, xp_ctx **xrp);
 
 #endif /* _CLIXON_XPATH_EVAL_H */
@@ -84,6 +84,7 @@
 #include "clixon_yang_parse_lib.h"
 #include "clixon_yang_cardinality.h"
 #include "clixon_yang_type.h"
+#include "clixon_xpath_compile.h"
 #include "clixon_yang_internal.h" /* internal included by this file only, not API*/
 
 #ifdef XML_EXPLICIT_INDEX
@@ -416,6 +417,19 @@ yang_when_nsc_set(yang_stmt *ys,
     return retval;
 }
 
+/*! Get compiled xpath of must/when statement or of "when"-associated augment/uses
+ *
+ * @param[in]  ys     Yang statement: must, when or data node with when xpath
+ * @retval     xpc    Compiled xpath
+ * @retval     NULL   Not compiled, evaluate xpath with interpreter
+ * @see ys_populate_xpath
+ */
+struct xpath_compiled *
+yang_xpath_compiled_get(yang_stmt *ys)
+{
+    return ys->ys_xpath_compiled;
+}
+
 /*! Get yang filename for error/debug purpose
  *
  * @param[in]  ys       Yang statement
@@ -627,6 +641,7 @@ ys_free1(yang_stmt *ys,
 {
     cg_var         *cv;
     rpc_callback_t *rc;
+    int             i;
 
     if (ys->ys_argument){
         free(ys->ys_argument);
@@ -648,6 +663,13 @@ ys_free1(yang_stmt *ys,
         free(ys->ys_when_xpath);
     if (ys->ys_when_nsc)
         cvec_free(ys->ys_when_nsc);
+    if (ys->ys_xpath_compiled)
+        xpath_compiled_free(ys->ys_xpath_compiled);
+    if (ys->ys_desc_names){
+        for (i=0; i<ys->ys_desc_len; i++)
+            free(ys->ys_desc_names[i]);
+        free(ys->ys_desc_names);
+    }
     if (ys->ys_stmt)
         free(ys->ys_stmt);
     if (ys->ys_filename)
@@ -845,6 +867,10 @@ ys_cp(yang_stmt *ynew,
             goto done;
         }
     }
+    ynew->ys_xpath_compiled = NULL; /* Compiled in ys_populate2 */
+    ynew->ys_desc_names = NULL; /* Computed on demand in yang_descendant_name */
+    ynew->ys_desc_len = 0;
+    ynew->ys_flags &= ~(YANG_FLAG_DESC_CACHE|YANG_FLAG_DESC_ANY);
     for (i=0; i<ynew->ys_len; i++){
         yco = yold->ys_stmt[i];
         if ((ycn = ys_dup(yco)) == NULL)
@@ -2838,6 +2864,66 @@ ys_populate(yang_stmt    *ys,
     return retval;
 }
 
+#ifdef XPATH_COMPILE
+/*! Compile xpath of must and when statements, and of "when"-associated augment/uses
+ *
+ * Use the same namespace context as at validation, see xml_yang_validate_node and
+ * yang_check_when_xpath.
+ * Compile errors are not fatal, the xpath is then evaluated and the error reported at
+ * validation
+ * @param[in] h    Clicon handle
+ * @param[in] ys   The yang statement to populate.
+ * @retval    0    OK
+ * @retval    -1   Error with clicon_err called
+ */
+static int
+ys_populate_xpath(clicon_handle h,
+                  yang_stmt    *ys)
+{
+    int        retval = -1;
+    char      *xpath;
+    cvec      *nsc = NULL;
+    cvec      *nsc1 = NULL;
+    yang_stmt *yp;
+
+    if (ys->ys_xpath_compiled != NULL) /* Augmented nodes are populated twice */
+        goto ok;
+    switch (ys->ys_keyword){
+    case Y_MUST:
+        xpath = ys->ys_argument;
+        if (xml_nsctx_yang(ys, &nsc1) < 0)
+            goto done;
+        nsc = nsc1;
+        break;
+    case Y_WHEN: /* when of augment and uses are set in the augmented nodes */
+        yp = ys->ys_parent;
+        if (yp == NULL || yp->ys_keyword == Y_AUGMENT || yp->ys_keyword == Y_USES)
+            goto ok;
+        xpath = ys->ys_argument;
+        if (xml_nsctx_yang(yp, &nsc1) < 0)
+            goto done;
+        nsc = nsc1;
+        break;
+    default:
+        xpath = ys->ys_when_xpath;
+        nsc = ys->ys_when_nsc;
+        break;
+    }
+    if (xpath == NULL)
+        goto ok;
+    if (xpath_compile(xpath, nsc, &ys->ys_xpath_compiled) < 0){
+        clicon_debug(1, "%s %s: not compiled", __FUNCTION__, xpath);
+        clicon_err_reset();
+    }
+ ok:
+    retval = 0;
+ done:
+    if (nsc1)
+        xml_nsctx_free(nsc1);
+    return retval;
+}
+#endif /* XPATH_COMPILE */
+
 /*! Run after grouping expand and augment 
  * @see ys_populate   run before grouping expand and augment
  */
@@ -2848,6 +2934,10 @@ ys_populate2(yang_stmt    *ys,
     int           retval = -1;
     clicon_handle h = (clicon_handle)arg;
     
+#ifdef XPATH_COMPILE
+    if (ys_populate_xpath(h, ys) < 0)
+        goto done;
+#endif
     switch(ys->ys_keyword){
     case Y_LEAF:
     case Y_LEAF_LIST:
@@ -3026,6 +3116,212 @@ yang_datanode(yang_stmt *ys)
             keyw == Y_ANYDATA);
 }
 
+/*! Append names to a vector of names, strings are copied
+ *
+ * @param[in,out] namesp  Vector of names
+ * @param[in,out] lenp    Length of vector
+ * @param[in]     names   Names to append
+ * @param[in]     len     Number of names to append
+ * @retval        0       OK
+ * @retval       -1       Error
+ */
+static int
+yang_descendant_append(char ***namesp,
+                       int    *lenp,
+                       char  **names,
+                       int     len)
+{
+    int    retval = -1;
+    char **vec;
+    int    i;
+
+    if ((vec = realloc(*namesp, (*lenp+len)*sizeof(char*))) == NULL){
+        clicon_err(OE_UNIX, errno, "realloc");
+        goto done;
+    }
+    *namesp = vec;
+    for (i=0; i<len; i++){
+        if ((vec[*lenp] = strdup(names[i])) == NULL){
+            clicon_err(OE_UNIX, errno, "strdup");
+            goto done;
+        }
+        (*lenp)++;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+static int
+yang_descendant_cmp(const void *a,
+                    const void *b)
+{
+    return strcmp(*(char**)a, *(char**)b);
+}
+
+static int yang_descendant_cache(yang_stmt *ys);
+
+/*! Collect names of all data nodes that may occur as XML descendants of a yang node
+ *
+ * Choice, case, input and output are transparent, their data nodes occur directly in the XML.
+ * @param[in]     yn      Yang node
+ * @param[in,out] namesp  Vector of names, unsorted and possibly with duplicates
+ * @param[in,out] lenp    Length of vector
+ * @param[out]    anyp    Set to 1 if any name may occur, eg under anydata
+ * @retval        0       OK
+ * @retval       -1       Error
+ */
+static int
+yang_descendant_collect(yang_stmt *yn,
+                        char    ***namesp,
+                        int       *lenp,
+                        int       *anyp)
+{
+    int        retval = -1;
+    yang_stmt *yc;
+    int        i;
+
+    for (i=0; i<yn->ys_len && *anyp == 0; i++){
+        yc = yn->ys_stmt[i];
+        switch (yang_keyword_get(yc)){
+        case Y_CHOICE:
+        case Y_CASE:
+        case Y_INPUT:
+        case Y_OUTPUT:
+            if (yang_descendant_collect(yc, namesp, lenp, anyp) < 0)
+                goto done;
+            break;
+        case Y_ANYDATA:
+        case Y_ANYXML:
+            /* Nodes disabled by if-feature are also anydata, but have no schema descendants */
+            if (yang_flag_get(yc, YANG_FLAG_DISABLED) == 0)
+                *anyp = 1;
+            /* fall through */
+        case Y_LEAF:
+        case Y_LEAF_LIST:
+            if (yang_descendant_append(namesp, lenp, &yc->ys_argument, 1) < 0)
+                goto done;
+            break;
+        case Y_CONTAINER:
+        case Y_LIST:
+        case Y_RPC:
+        case Y_ACTION:
+        case Y_NOTIFICATION:
+            if (yang_descendant_append(namesp, lenp, &yc->ys_argument, 1) < 0)
+                goto done;
+            if (yang_descendant_cache(yc) < 0)
+                goto done;
+            if (yang_flag_get(yc, YANG_FLAG_DESC_ANY))
+                *anyp = 1;
+            else if (yang_descendant_append(namesp, lenp, yc->ys_desc_names, yc->ys_desc_len) < 0)
+                goto done;
+            break;
+        default:
+            break;
+        }
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Compute and cache sorted names of all data nodes that may occur as XML descendants
+ *
+ * @param[in]  ys  Yang node
+ * @retval     0   OK, names in ys_desc_names or YANG_FLAG_DESC_ANY set
+ * @retval    -1   Error
+ */
+static int
+yang_descendant_cache(yang_stmt *ys)
+{
+    int    retval = -1;
+    char **names = NULL;
+    int    len = 0;
+    int    any = 0;
+    int    i;
+    int    j;
+
+    if (yang_flag_get(ys, YANG_FLAG_DESC_CACHE))
+        return 0;
+    if (yang_descendant_collect(ys, &names, &len, &any) < 0)
+        goto done;
+    if (any){
+        yang_flag_set(ys, YANG_FLAG_DESC_ANY);
+    }
+    else if (len){
+        qsort(names, len, sizeof(char*), yang_descendant_cmp);
+        /* Remove duplicates */
+        j = 0;
+        for (i=1; i<len; i++){
+            if (strcmp(names[i], names[j]) == 0)
+                free(names[i]);
+            else
+                names[++j] = names[i];
+        }
+        ys->ys_desc_names = names;
+        ys->ys_desc_len = j+1;
+        names = NULL;
+        len = 0;
+    }
+    yang_flag_set(ys, YANG_FLAG_DESC_CACHE);
+    retval = 0;
+ done:
+    if (names){
+        for (i=0; i<len; i++)
+            free(names[i]);
+        free(names);
+    }
+    return retval;
+}
+
+/*! Clear cached descendant names of a yang node and all its ancestors
+ *
+ * Must be called when a data node is added after the cache may have been computed,
+ * eg unknown data added as anydata, see yang_anydata_add
+ * @param[in]  ys    Yang node
+ */
+static void
+yang_descendant_reset(yang_stmt *ys)
+{
+    int i;
+
+    for (; ys != NULL; ys = yang_parent_get(ys)){
+        if (ys->ys_desc_names){
+            for (i=0; i<ys->ys_desc_len; i++)
+                free(ys->ys_desc_names[i]);
+            free(ys->ys_desc_names);
+            ys->ys_desc_names = NULL;
+        }
+        ys->ys_desc_len = 0;
+        yang_flag_reset(ys, YANG_FLAG_DESC_CACHE|YANG_FLAG_DESC_ANY);
+    }
+}
+
+/*! Check if an XML element with a given name may occur as descendant of a yang node
+ *
+ * The names of all descendant data nodes are computed on first call, after YANG is loaded,
+ * and cached in the yang node. Used to prune subtrees in descendant xpath axes ("//").
+ * @param[in]  ys    Yang node of XML element
+ * @param[in]  name  Name of descendant element (without prefix)
+ * @retval     1     An element with this name may occur below ys
+ * @retval     0     No element with this name may occur below ys
+ * @retval    -1     Error
+ * @note Names are compared without namespaces, ie the result may be a false positive
+ */
+int
+yang_descendant_name(yang_stmt *ys,
+                     char      *name)
+{
+    if (yang_descendant_cache(ys) < 0)
+        return -1;
+    if (yang_flag_get(ys, YANG_FLAG_DESC_ANY))
+        return 1;
+    if (ys->ys_desc_len &&
+        bsearch(&name, ys->ys_desc_names, ys->ys_desc_len, sizeof(char*), yang_descendant_cmp) != NULL)
+        return 1;
+    return 0;
+}
+
 /*! All the work for schema_nodeid functions both absolute and descendant
  *
  * @param[in]  yn    Yang node. For absolute schemanodeids this should be a module, otherwise any yang
@@ -3659,6 +3955,8 @@ yang_anydata_add(yang_stmt *yp,
         ys = NULL;
         goto done;
     }
+    /* Descendant names of ancestors may be cached without the new node */
+    yang_descendant_reset(yp);
  done:
     return ys;
 }
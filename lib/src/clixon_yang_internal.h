@@ -99,6 +99,10 @@ struct yang_stmt{
     yang_type_cache   *ys_typecache; /* If ys_keyword==Y_TYPE, cache all typedef data except unions */
     char              *ys_when_xpath; /* Special conditional for a "when"-associated augment/uses xpath */
     cvec              *ys_when_nsc;   /* Special conditional for a "when"-associated augment/uses namespace ctx */
+    struct xpath_compiled *ys_xpath_compiled; /* Compiled xpath of must/when, or of when-associated
+                                                 augment/uses, see XPATH_COMPILE */
+    char             **ys_desc_names; /* Sorted names of descendant data nodes, see yang_descendant_name */
+    int                ys_desc_len;   /* Length of ys_desc_names */
     char              *ys_filename;   /* For debug/errors: filename (only (sub)modules) */
     int                ys_linenum;    /* For debug/errors: line number (in ys_filename) */
     rpc_callback_t    *ys_action_cb;  /* Action callback list, only for Y_ACTION */
@@ -0,0 +1,135 @@
+#!/usr/bin/env bash
+# Autocli generated clispec cache
+# Run the CLI several times with CLICON_CLI_AUTOCLI_CACHE_DIR set and check that the
+# generated clispec is written to the cache, that the cached CLI behaves the same, and
+# that a changed YANG file gives a new cache entry
+#
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/$APPNAME.yang
+clidir=$dir/cli
+cachedir=$dir/cache
+for d in $clidir $cachedir; do
+    if [ -d $d ]; then
+        rm -rf $d/*
+    else
+        mkdir $d
+    fi
+done
+
+# Generate autocli for these modules
+AUTOCLI=$(autocli_config ${APPNAME}\* kw-nokey false)
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>$dir</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_CLISPEC_DIR>$clidir</CLICON_CLISPEC_DIR>
+  <CLICON_CLI_DIR>/usr/local/lib/$APPNAME/cli</CLICON_CLI_DIR>
+  <CLICON_CLI_MODE>$APPNAME</CLICON_CLI_MODE>
+  <CLICON_CLI_AUTOCLI_CACHE_DIR>$cachedir</CLICON_CLI_AUTOCLI_CACHE_DIR>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+  ${AUTOCLI}
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module $APPNAME {
+  namespace "urn:example:clixon";
+  prefix ex;
+  container table{
+    list parameter{
+      key name;
+      leaf name{
+        type string;
+      }
+      leaf value{
+        type string;
+      }
+    }
+  }
+}
+EOF
+
+cat <<EOF > $clidir/ex.cli
+CLICON_MODE="example";
+CLICON_PROMPT="%U@%H %W> ";
+
+set @datamodel, cli_auto_set();
+delete("Delete a configuration item") {
+      @datamodel, cli_auto_del();
+      all("Delete whole candidate configuration"), delete_all("candidate");
+}
+show("Show a particular state of the system"){
+    configuration("Show configuration"), cli_show_config("candidate", "xml", "/");
+}
+EOF
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -z -f $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "cli set, generate and write cache"
+expectpart "$($clixon_cli -1 -f $cfg set table parameter p1 value 42 2>&1)" 0 "^$"
+
+new "cache file created"
+if [ -z "$(ls $cachedir/$APPNAME@*.cli 2> /dev/null)" ]; then
+    err "$cachedir/$APPNAME@<key>.cli" "$(ls $cachedir)"
+fi
+
+new "cli print generated, from cache"
+expectpart "$($clixon_cli -1 -f $cfg -G show config 2>&1)" 0 "parameter" "value"
+
+new "cli show config, from cache"
+expectpart "$($clixon_cli -1 -f $cfg show config 2>&1)" 0 '<table xmlns="urn:example:clixon"><parameter><name>p1</name><value>42</value></parameter></table>'
+
+new "cli set, from cache"
+expectpart "$($clixon_cli -1 -f $cfg set table parameter p2 value 43 2>&1)" 0 "^$"
+
+# Add a leaf to the yang file, which changes the cache key
+sed -i 's/leaf value{/leaf value2{ type string; }\n      leaf value{/' $fyang
+
+new "cli set new leaf, cache regenerated"
+expectpart "$($clixon_cli -1 -f $cfg set table parameter p2 value2 44 2>&1)" 0 "^$"
+
+new "one cache file, stale file removed"
+n=$(ls $cachedir/$APPNAME@*.cli | wc -l)
+if [ $n -ne 1 ]; then
+    err "1" "$n"
+fi
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
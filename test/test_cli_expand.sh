@@ -106,6 +106,30 @@ expectpart "$(echo "set list1 xyz list2 ?" | $clixon_cli -f $cfg 2>&1)" 0 123 ab
 new "Expand <TAB>"
 expectpart "$(echo "set list1 xyz list2 	" | $clixon_cli -f $cfg 2>&1)" 0 123 abc "<key2>"
 
+new "Add entry 3 on level2"
+expectpart "$($clixon_cli -1 -f $cfg set list1 xyz list2 abd)" 0 "^$"
+
+new "Expand prefix <TAB>"
+expectpart "$(echo "set list1 xyz list2 ab	" | $clixon_cli -f $cfg 2>&1)" 0 abc abd
+
+# Backend expand-values RPC used by expand_dbvar
+XPATH="<xpath xmlns:ex=\"urn:example:clixon\">/ex:list1[ex:key1='xyz']/ex:list2/ex:key2</xpath>"
+
+new "expand-values all"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><expand-values xmlns=\"http://clicon.org/lib\"><datastore>candidate</datastore>$XPATH</expand-values></rpc>" "" "<rpc-reply $DEFAULTNS><value xmlns=\"http://clicon.org/lib\">123</value><value xmlns=\"http://clicon.org/lib\">abc</value><value xmlns=\"http://clicon.org/lib\">abd</value></rpc-reply>"
+
+new "expand-values prefix"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><expand-values xmlns=\"http://clicon.org/lib\"><datastore>candidate</datastore>$XPATH<prefix>ab</prefix></expand-values></rpc>" "" "<rpc-reply $DEFAULTNS><value xmlns=\"http://clicon.org/lib\">abc</value><value xmlns=\"http://clicon.org/lib\">abd</value></rpc-reply>"
+
+new "expand-values prefix limit and exact"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><expand-values xmlns=\"http://clicon.org/lib\"><datastore>candidate</datastore>$XPATH<prefix>ab</prefix><exact>123</exact><exact>xxx</exact><limit>1</limit></expand-values></rpc>" "" "<rpc-reply $DEFAULTNS><value xmlns=\"http://clicon.org/lib\">abc</value><value xmlns=\"http://clicon.org/lib\">123</value></rpc-reply>"
+
+new "expand-values prefix limit and exact matching prefix"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><expand-values xmlns=\"http://clicon.org/lib\"><datastore>candidate</datastore>$XPATH<prefix>ab</prefix><exact>abc</exact><exact>abd</exact><limit>1</limit></expand-values></rpc>" "" "<rpc-reply $DEFAULTNS><value xmlns=\"http://clicon.org/lib\">abc</value><value xmlns=\"http://clicon.org/lib\">abd</value></rpc-reply>"
+
+new "expand-values top-level key"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><expand-values xmlns=\"http://clicon.org/lib\"><datastore>candidate</datastore><xpath xmlns:ex=\"urn:example:clixon\">/ex:list1/ex:key1</xpath><prefix>x</prefix></expand-values></rpc>" "" "<rpc-reply $DEFAULTNS><value xmlns=\"http://clicon.org/lib\">xyz</value></rpc-reply>"
+
 if [ $BE -ne 0 ]; then
     new "Kill backend"
     # Check if premature kill
@@ -0,0 +1,192 @@
+#!/usr/bin/env bash
+# Commit history as reverse diffs, see CLICON_XMLDB_HISTORY
+# Undo latest commits with the clixon-lib rollback RPC
+# Deleted and moved entries of ordered-by user lists are restored in order
+# Confirmed-commit cancel creates the rollback datastore from the history
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf.xml
+fyang=$dir/example.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_FEATURE>ietf-netconf:confirmed-commit</CLICON_FEATURE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+  <CLICON_XMLDB_HISTORY>3</CLICON_XMLDB_HISTORY>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module example{
+  yang-version 1.1;
+  namespace "urn:example:clixon";
+  prefix ex;
+  container table{
+    list parameter{
+      key name;
+      leaf name{
+        type string;
+      }
+      leaf value{
+        type string;
+      }
+    }
+    list order{
+      key name;
+      ordered-by user;
+      leaf name{
+        type string;
+      }
+    }
+    leaf-list item{
+      type string;
+      ordered-by user;
+    }
+  }
+}
+EOF
+
+# Edit candidate and commit
+# Args:
+# 1: edit-config content
+# 2: commit content
+function editcommit()
+{
+    new "edit-config"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><table xmlns=\"urn:example:clixon\" xmlns:nc=\"urn:ietf:params:xml:ns:netconf:base:1.0\" xmlns:yang=\"urn:ietf:params:xml:ns:yang:1\">$1</table></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "commit"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit>$2</commit></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+}
+
+# Check running
+# Args:
+# 1: expected table content
+function checkrunning()
+{
+    new "get-config running"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:clixon\">$1</table></data></rpc-reply>"
+}
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+editcommit "<parameter><name>a</name><value>1</value></parameter>"
+editcommit "<parameter><name>b</name><value>1</value></parameter>"
+editcommit "<parameter><name>a</name><value>2</value></parameter><parameter nc:operation=\"delete\"><name>b</name></parameter><parameter><name>c</name><value>1</value></parameter>"
+
+checkrunning "<parameter><name>a</name><value>2</value></parameter><parameter><name>c</name><value>1</value></parameter>"
+
+new "history file exists"
+if [ ! -f $dir/history_db ]; then
+    err "$dir/history_db" "no file"
+fi
+
+new "rollback more commits than in history"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><rollback xmlns=\"http://clicon.org/lib\"><commits>4</commits></rollback></rpc>" "" "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>invalid-value</error-tag><error-severity>error</error-severity><error-message>There are 3 commits in history</error-message></rpc-error></rpc-reply>"
+
+new "rollback latest commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><rollback xmlns=\"http://clicon.org/lib\"/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+checkrunning "<parameter><name>a</name><value>1</value></parameter><parameter><name>b</name><value>1</value></parameter>"
+
+new "rollback two commits, the rollback and the commit before it"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><rollback xmlns=\"http://clicon.org/lib\"><commits>2</commits></rollback></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+checkrunning "<parameter><name>a</name><value>1</value></parameter><parameter><name>b</name><value>1</value></parameter>"
+
+new "rollback the rollback"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><rollback xmlns=\"http://clicon.org/lib\"/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+checkrunning "<parameter><name>a</name><value>2</value></parameter><parameter><name>c</name><value>1</value></parameter>"
+
+editcommit "<order><name>x</name></order><order><name>y</name></order><order><name>z</name></order><item>x</item><item>y</item><item>z</item>"
+editcommit "<order nc:operation=\"delete\"><name>y</name></order><order yang:insert=\"first\"><name>z</name></order><item nc:operation=\"delete\">y</item><item yang:insert=\"first\">z</item>"
+
+checkrunning "<parameter><name>a</name><value>2</value></parameter><parameter><name>c</name><value>1</value></parameter><order><name>z</name></order><order><name>x</name></order><item>z</item><item>x</item>"
+
+new "rollback delete and move of ordered-by user entries"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><rollback xmlns=\"http://clicon.org/lib\"/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+checkrunning "<parameter><name>a</name><value>2</value></parameter><parameter><name>c</name><value>1</value></parameter><order><name>x</name></order><order><name>y</name></order><order><name>z</name></order><item>x</item><item>y</item><item>z</item>"
+
+new "rollback the rollback, the ordered-by user commit and the commit before it"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><rollback xmlns=\"http://clicon.org/lib\"><commits>3</commits></rollback></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+checkrunning "<parameter><name>a</name><value>2</value></parameter><parameter><name>c</name><value>1</value></parameter>"
+
+new "discard-changes"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+editcommit "<parameter><name>d</name><value>1</value></parameter>" "<confirmed/><persist>x</persist>"
+editcommit "<parameter><name>a</name><value>3</value></parameter>" "<confirmed/><persist>y</persist><persist-id>x</persist-id>"
+
+new "rollback during confirmed-commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><rollback xmlns=\"http://clicon.org/lib\"/></rpc>" "" "<rpc-reply $DEFAULTNS><rpc-error><error-type>protocol</error-type><error-tag>in-use</error-tag><error-severity>error</error-severity><error-message>Operation failed, confirmed-commit in progress</error-message></rpc-error></rpc-reply>"
+
+new "running is not copied to rollback datastore"
+if [ -f $dir/rollback_db ]; then
+    err "no file" "$dir/rollback_db"
+fi
+
+new "cancel-commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><cancel-commit><persist-id>y</persist-id></cancel-commit></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+checkrunning "<parameter><name>a</name><value>2</value></parameter><parameter><name>c</name><value>1</value></parameter>"
+
+if [ $BE -ne 0 ]; then
+    editcommit "<parameter><name>e</name><value>1</value></parameter>" "<confirmed/><persist>z</persist>"
+
+    new "Kill backend during confirmed-commit"
+    stop_backend -f $cfg
+
+    # As if the backend stopped while appending a record
+    new "append partial record to history file"
+    echo -n "<commit id=\"99\"><remove><table xmlns=\"urn:example:clixon\"><para" >> $dir/history_db
+
+    new "start backend -s startup -f $cfg"
+    start_backend -s startup -f $cfg
+
+    new "wait backend"
+    wait_backend
+
+    new "confirmed-commit is rolled back using the history before the partial record"
+    checkrunning "<parameter><name>a</name><value>2</value></parameter><parameter><name>c</name><value>1</value></parameter>"
+fi
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,107 @@
+#!/usr/bin/env bash
+# Datastore merge of large edits, see DATASTORE_MERGE_MIN
+# New entries of system-ordered lists and leaf-lists are merged with existing entries in one
+# pass. Check order and contents after merges interleaving new and existing entries.
+# Just run a binary direct to datastore. No clixon.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+: ${clixon_util_datastore:=clixon_util_datastore}
+
+# Number of list entries in each edit, should be larger than DATASTORE_MERGE_MIN
+: ${perfnr:=1000}
+
+fyang=$dir/example.yang
+mydir=$dir/db
+
+cat <<EOF > $fyang
+module example{
+  yang-version 1.1;
+  namespace "urn:example:clixon";
+  prefix ex;
+  container x {
+    list y {
+      key a;
+      leaf a {
+        type int32;
+      }
+      leaf c {
+        type string;
+      }
+    }
+    leaf-list e {
+      type int32;
+    }
+    list u {
+      key a;
+      ordered-by user;
+      leaf a {
+        type int32;
+      }
+    }
+    leaf g {
+      type string;
+    }
+  }
+}
+EOF
+
+if [ ! -d $mydir ]; then
+    mkdir $mydir
+fi
+
+conf="-d candidate -b $mydir -y $fyang"
+
+new "generate edits with $perfnr entries"
+# Even entries
+echo -n "<x xmlns=\"urn:example:clixon\">" > $dir/x1.xml
+for (( i=0; i<$perfnr; i++ )); do
+    echo -n "<y><a>$((2*i))</a><c>even</c></y><e>$((2*i))</e>" >> $dir/x1.xml
+done
+echo -n "<u><a>2</a></u><u><a>1</a></u>" >> $dir/x1.xml
+echo "</x>" >> $dir/x1.xml
+# Odd entries, in reverse order, and change of first entry
+echo -n "<x xmlns=\"urn:example:clixon\"><y><a>0</a><c>changed</c></y>" > $dir/x2.xml
+for (( i=$perfnr-1; i>=0; i-- )); do
+    echo -n "<y><a>$((2*i+1))</a><c>odd</c></y><e>$((2*i+1))</e>" >> $dir/x2.xml
+done
+echo -n "<u><a>0</a></u><g>merged</g>" >> $dir/x2.xml
+echo "</x>" >> $dir/x2.xml
+# Expected result
+echo -n "<${DATASTORE_TOP}><x xmlns=\"urn:example:clixon\"><y><a>0</a><c>changed</c></y><y><a>1</a><c>odd</c></y>" > $dir/expect.xml
+for (( i=1; i<$perfnr; i++ )); do
+    echo -n "<y><a>$((2*i))</a><c>even</c></y><y><a>$((2*i+1))</a><c>odd</c></y>" >> $dir/expect.xml
+done
+for (( i=0; i<2*$perfnr; i++ )); do
+    echo -n "<e>$i</e>" >> $dir/expect.xml
+done
+echo -n "<u><a>2</a></u><u><a>1</a></u><u><a>0</a></u><g>merged</g></x></${DATASTORE_TOP}>" >> $dir/expect.xml
+
+new "datastore init"
+expectpart "$($clixon_util_datastore $conf init)" 0 ""
+
+new "datastore put replace even entries"
+expectpart "$($clixon_util_datastore $conf -x $dir/x1.xml put replace)" 0 ""
+
+new "datastore put merge odd entries"
+expectpart "$($clixon_util_datastore $conf -x $dir/x2.xml put merge)" 0 ""
+
+new "datastore get merged"
+expectpart "$($clixon_util_datastore $conf get /)" 0 "^$(cat $dir/expect.xml)$"
+
+new "datastore put merge same entries again"
+expectpart "$($clixon_util_datastore $conf -x $dir/x2.xml put merge)" 0 ""
+
+new "datastore get unchanged"
+expectpart "$($clixon_util_datastore $conf get /)" 0 "^$(cat $dir/expect.xml)$"
+
+rm -rf $mydir
+rm -rf $dir
+
+# unset conditional parameters 
+unset clixon_util_datastore
+unset perfnr
+
+new "endtest"
+endtest
@@ -0,0 +1,71 @@
+#!/usr/bin/env bash
+# Read datastore files in canonical and non-canonical order, see XML_FLAG_SORTED
+# Subtrees already in order are not sorted again, other subtrees are sorted on read.
+# Check that order is correct also after edits of subtrees read in order.
+# Just run a binary direct to datastore. No clixon.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+: ${clixon_util_datastore:=clixon_util_datastore}
+
+fyang=$dir/example.yang
+mydir=$dir/db
+
+cat <<EOF > $fyang
+module example{
+  yang-version 1.1;
+  namespace "urn:example:clixon";
+  prefix ex;
+  container x {
+    list y {
+      key a;
+      leaf a {
+        type int32;
+      }
+      leaf-list e {
+        type string;
+      }
+    }
+    leaf b {
+      type string;
+    }
+  }
+}
+EOF
+
+if [ ! -d $mydir ]; then
+    mkdir $mydir
+fi
+
+conf="-d candidate -b $mydir -y $fyang"
+
+sorted="<${DATASTORE_TOP}><x xmlns=\"urn:example:clixon\"><y><a>1</a><e>a</e><e>b</e></y><y><a>2</a><e>c</e></y><y><a>10</a></y><b>x</b></x></${DATASTORE_TOP}>"
+
+new "datastore file in canonical order"
+echo "$sorted" > $mydir/candidate_db
+
+new "datastore get canonical order"
+expectpart "$($clixon_util_datastore $conf get /)" 0 "^$sorted$"
+
+new "datastore put merge into canonical order"
+echo "<x xmlns=\"urn:example:clixon\"><y><a>2</a><e>a</e></y><y><a>3</a></y></x>" > $dir/x1.xml
+expectpart "$($clixon_util_datastore $conf -x $dir/x1.xml put merge)" 0 ""
+
+new "datastore get merged"
+expectpart "$($clixon_util_datastore $conf get /)" 0 "^<${DATASTORE_TOP}><x xmlns=\"urn:example:clixon\"><y><a>1</a><e>a</e><e>b</e></y><y><a>2</a><e>a</e><e>c</e></y><y><a>3</a></y><y><a>10</a></y><b>x</b></x></${DATASTORE_TOP}>$"
+
+new "datastore file with unsorted subtrees"
+echo "<${DATASTORE_TOP}><x xmlns=\"urn:example:clixon\"><b>x</b><y><a>2</a><e>c</e></y><y><a>1</a><e>b</e><e>a</e></y><y><a>10</a></y></x></${DATASTORE_TOP}>" > $mydir/candidate_db
+
+new "datastore get sorted"
+expectpart "$($clixon_util_datastore $conf get /)" 0 "^$sorted$"
+
+rm -rf $mydir
+rm -rf $dir
+
+# unset conditional parameters 
+unset clixon_util_datastore
+
+new "endtest"
+endtest
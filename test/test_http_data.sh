@@ -233,6 +233,23 @@ EOF
             err1 "$dir/foo.png $dir/www/data/example.css should be equal" "Not equal"
         fi
 
+        new "WWW get etag and last-modified"
+        ret=$(curl $CURLOPTS -X GET $proto://localhost/data/index.html)
+        expectpart "$ret" 0 "HTTP/$HVER 200" "ETag: \"" "Last-Modified: "
+        etag=$(echo "$ret" | grep -i "^etag:" | cut -d' ' -f2 | tr -d '\r')
+        lastmod=$(echo "$ret" | grep -i "^last-modified:" | cut -d' ' -f2- | tr -d '\r')
+
+        new "WWW get If-None-Match expect not modified"
+        expectpart "$(curl $CURLOPTS -X GET -H "If-None-Match: $etag" $proto://localhost/data/index.html)" 0 "HTTP/$HVER 304" "ETag: $etag" --not-- "<title>Welcome to Clixon!</title>"
+
+        new "WWW get If-Modified-Since expect not modified"
+        expectpart "$(curl $CURLOPTS -X GET -H "If-Modified-Since: $lastmod" $proto://localhost/data/index.html)" 0 "HTTP/$HVER 304" --not-- "<title>Welcome to Clixon!</title>"
+
+        echo "<!-- modified -->" >> $dir/www/data/index.html
+
+        new "WWW get If-None-Match of modified file expect new body"
+        expectpart "$(curl $CURLOPTS -X GET -H "If-None-Match: $etag" $proto://localhost/data/index.html)" 0 "HTTP/$HVER 200" "<!-- modified -->" --not-- "ETag: $etag"
+
         # negative errors
         new "WWW get http not found"
         expectpart "$(curl $CURLOPTS -X GET -H 'Accept: text/html' $proto://localhost/data/notfound.html)" 0 "HTTP/$HVER 404" "Content-Type: text/html" "<title>404 Not Found</title>"
@@ -138,6 +138,27 @@ JSON='{"json:c":{"s":"<![CDATA[  z > x  & x < y ]]>"}}'
 new "json parse cdata xml"
 expecteofx "$clixon_util_json -j -y $fyang" 0 "$JSON" "$JSON"
 
+new "json parse string escapes to xml"
+expecteofx "$clixon_util_json" 0 '{"s":"a\"b\/c\u00e5"}' '<s>a"b/cå</s>'
+
+new "json parse surrogate pair to xml"
+expecteofx "$clixon_util_json" 0 '{"s":"x\ud83d\ude00y"}' '<s>x😀y</s>'
+
+new "json string escapes back to json"
+expecteofx "$clixon_util_json -j" 0 '{"s":"a\"b\tc\nd\u0001"}' '{"s":"a\"b\tc\nd\u0001"}'
+
+new "json invalid escape"
+expecteof "$clixon_util_json" 255 '{"s":"a\qb"}' '' 2> /dev/null
+
+new "json lone surrogate"
+expecteof "$clixon_util_json" 255 '{"s":"\udc00"}' '' 2> /dev/null
+
+new "json trailing comma"
+expecteof "$clixon_util_json" 255 '{"a":1,}' '' 2> /dev/null
+
+new "json number exponent"
+expecteofx "$clixon_util_json" 0 '{"a":1.5e3,"b":-2E-2}' '<a>1.5e3</a><b>-2E-2</b>'
+
 rm -rf $dir
 
 # unset conditional parameters 
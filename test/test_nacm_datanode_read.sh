@@ -282,6 +282,22 @@ testrun permit permit deny   permit true  true  false false
 testrun permit permit permit deny   true  true  true  false
 testrun permit permit permit permit true  true  true  true
 
+# Subtree filter content match must not test values the user cannot read
+new "deny read of parameter value"
+expecteof_netconf "$clixon_netconf -U andy -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><nacm xmlns=\"urn:ietf:params:xml:ns:yang:ietf-netconf-acm\"><rule-list><name>limited-acl</name><rule><name>parameter</name><path xmlns:ex=\"urn:example:nacm\">/ex:table/ex:parameters/ex:parameter/ex:value</path><action>deny</action></rule></rule-list></nacm></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "commit it"
+expecteof_netconf "$clixon_netconf -U andy -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "get-config subtree parameter without denied value"
+expecteof_netconf "$clixon_netconf -U wilma -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"subtree\"><table xmlns=\"urn:example:nacm\"><parameters><parameter><name>a</name></parameter></parameters></table></filter></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:nacm\"><parameters><parameter><name>a</name></parameter></parameters></table></data></rpc-reply>"
+
+new "get-config subtree content match on denied value"
+expecteof_netconf "$clixon_netconf -U wilma -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"subtree\"><table xmlns=\"urn:example:nacm\"><parameters><parameter><value>72</value></parameter></parameters></table></filter></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data/></rpc-reply>"
+
+new "get subtree content match on denied value"
+expecteof_netconf "$clixon_netconf -U wilma -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get><filter type=\"subtree\"><table xmlns=\"urn:example:nacm\"><parameters><parameter><value>72</value></parameter></parameters></table></filter></get></rpc>" "" "<rpc-reply $DEFAULTNS><data/></rpc-reply>"
+
 if [ $RC -ne 0 ]; then
     new "Kill restconf daemon"
     stop_restconf 
@@ -77,6 +77,15 @@ expecteof "$clixon_netconf -qef $cfg -o CLICON_NETCONF_BASE_CAPABILITY=0" 0 "<?x
 new "Netconf 1.0 eom framing get-config"
 expecteof "$clixon_netconf -qef $cfg -o CLICON_NETCONF_BASE_CAPABILITY=0" 0 "<?xml version=\"1.0\" encoding=\"UTF-8\"?><hello $DEFAULTNS><capabilities><capability>urn:ietf:params:netconf:base:1.0</capability></capabilities></hello>]]>]]><rpc $DEFAULTNS><get-config><source><candidate/></source></get-config></rpc>]]>]]>$" "^<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:clixon\"><parameter><name>a</name></parameter></table></data></rpc-reply>]]>]]>$"
 
+new "Netconf 1.0 eom framing, pipelined rpcs and ] in data"
+expecteof "$clixon_netconf -qef $cfg -o CLICON_NETCONF_BASE_CAPABILITY=0" 0 "<?xml version=\"1.0\" encoding=\"UTF-8\"?><hello $DEFAULTNS><capabilities><capability>urn:ietf:params:netconf:base:1.0</capability></capabilities></hello>]]>]]><rpc $DEFAULTNS message-id=\"1\"><edit-config><target><candidate/></target><config><table xmlns=\"urn:example:clixon\"><parameter><name>b</name><value>x]]y]</value></parameter></table></config></edit-config></rpc>]]>]]><rpc $DEFAULTNS message-id=\"2\"><get-config><source><candidate/></source><filter type=\"xpath\" select=\"/ex:table/ex:parameter[ex:name='b']\" xmlns:ex=\"urn:example:clixon\"/></get-config></rpc>]]>]]>$" "^<rpc-reply $DEFAULTNS message-id=\"1\"><ok/></rpc-reply>]]>]]><rpc-reply $DEFAULTNS message-id=\"2\"><data><table xmlns=\"urn:example:clixon\"><parameter><name>b</name><value>x]]y]</value></parameter></table></data></rpc-reply>]]>]]>$"
+
+new "Netconf 1.0 eom framing, replies in order with pipelined and local errors"
+expecteof "$clixon_netconf -qef $cfg -o CLICON_NETCONF_BASE_CAPABILITY=0" 0 "<?xml version=\"1.0\" encoding=\"UTF-8\"?><hello $DEFAULTNS><capabilities><capability>urn:ietf:params:netconf:base:1.0</capability></capabilities></hello>]]>]]><rpc $DEFAULTNS message-id=\"1\"><edit-config><target><candidate/></target><config><table xmlns=\"urn:example:clixon\"><parameter><name>c</name></parameter></table></config></edit-config></rpc>]]>]]><rpc $DEFAULTNS message-id=\"2\"><edit-config><target><candidate/></target><nonexist/></edit-config></rpc>]]>]]><rpc $DEFAULTNS message-id=\"3\"><discard-changes/></rpc>]]>]]><rpc $DEFAULTNS message-id=\"4\"><get-config><source><candidate/></source><filter type=\"xpath\" select=\"/ex:table/ex:parameter[ex:name='c']\" xmlns:ex=\"urn:example:clixon\"/></get-config></rpc>]]>]]>$" "^<rpc-reply $DEFAULTNS message-id=\"1\"><ok/></rpc-reply>]]>]]><rpc-reply $DEFAULTNS message-id=\"2\"><rpc-error>.*</rpc-error></rpc-reply>]]>]]><rpc-reply $DEFAULTNS message-id=\"3\"><ok/></rpc-reply>]]>]]><rpc-reply $DEFAULTNS message-id=\"4\"><data/></rpc-reply>]]>]]>$"
+
+new "Netconf 1.0 eom framing, delete entry"
+expecteof "$clixon_netconf -qef $cfg -o CLICON_NETCONF_BASE_CAPABILITY=0" 0 "<?xml version=\"1.0\" encoding=\"UTF-8\"?><hello $DEFAULTNS><capabilities><capability>urn:ietf:params:netconf:base:1.0</capability></capabilities></hello>]]>]]><rpc $DEFAULTNS><edit-config><target><candidate/></target><config><table xmlns=\"urn:example:clixon\" xmlns:nc=\"urn:ietf:params:xml:ns:netconf:base:1.0\"><parameter nc:operation=\"delete\"><name>b</name></parameter></table></config></edit-config></rpc>]]>]]>$" "^<rpc-reply $DEFAULTNS><ok/></rpc-reply>]]>]]>$"
+
 new "Netconf 1.1 eom framing, expect error"
 expecteof "$clixon_netconf -qef $cfg -o CLICON_NETCONF_BASE_CAPABILITY=1" 255 "<?xml version=\"1.0\" encoding=\"UTF-8\"?><hello $DEFAULTNS><capabilities><capability>urn:ietf:params:netconf:base:1.1</capability></capabilities></hello>]]>]]><rpc $DEFAULTNS><get-config><source><candidate/></source></get-config></rpc>]]>]]>$" ""
 
@@ -97,6 +106,24 @@ EOF
 new "Netconf 1.1 multi-chunked framing"
 expecteof_netconf "$clixon_netconf -qef $cfg -o CLICON_NETCONF_BASE_CAPABILITY=1" 0 "$rpc" "" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:clixon\"><parameter><name>a</name></parameter></table></data></rpc-reply>"
 
+# Two pipelined messages in separate frames, with chunks split within tags
+rpc=$(cat <<EOF
+<?xml version="1.0" encoding="UTF-8"?><hello $DEFAULTNS><capabilities><capability>urn:ietf:params:netconf:base:1.1</capability></capabilities></hello>]]>]]>
+#10
+<rpc xmlns
+#118
+="urn:ietf:params:xml:ns:netconf:base:1.0" message-id="1"><get-config><source><candidate/></source></get-config></rpc>
+##
+
+#128
+<rpc xmlns="urn:ietf:params:xml:ns:netconf:base:1.0" message-id="2"><get-config><source><candidate/></source></get-config></rpc>
+##
+EOF
+   )
+
+new "Netconf 1.1 pipelined chunked frames"
+expectpart "$($clixon_netconf -qef $cfg -o CLICON_NETCONF_BASE_CAPABILITY=1 <<< "$rpc")" 0 "<rpc-reply $DEFAULTNS message-id=\"1\"><data><table xmlns=\"urn:example:clixon\"><parameter><name>a</name></parameter></table></data></rpc-reply>" "<rpc-reply $DEFAULTNS message-id=\"2\"><data><table xmlns=\"urn:example:clixon\"><parameter><name>a</name></parameter></table></data></rpc-reply>"
+
 if [ $BE -ne 0 ]; then
     new "Kill backend"
     # Check if premature kill
@@ -1,7 +1,7 @@
 #!/usr/bin/env bash
 # List pagination tests according to draft-wwlh-netconf-list-pagination-00
 # Follow the example-social example in the draft and the tests in Appendix A.2 + A.3.1/A.3.2
-# Basically only offset and limit supported
+# offset, limit, direction, sort-by and where for config lists
 
 # Magic line must be first in script (see README.md)
 s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
@@ -413,6 +413,24 @@ testlimit 6 0 0 ""
 new "A.3.7. limit=2 offset=2"
 testlimit 2 2 2 "11 7"
 
+new "A.3.3. direction=backwards limit=2"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/es:members/es:member[es:member-id='alice']/es:favorites/es:uint8-numbers\" xmlns:es=\"http://example.com/ns/example-social\"/><list-pagination xmlns=\"urn:ietf:params:xml:ns:yang:ietf-list-pagination-nc\" xmlns:es=\"http://example.com/ns/example-social\"><direction>backwards</direction><limit>2</limit></list-pagination></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><members xmlns=\"http://example.com/ns/example-social\"><member><member-id>alice</member-id><favorites><uint8-numbers>3</uint8-numbers><uint8-numbers>5</uint8-numbers></favorites></member></members></data></rpc-reply>"
+
+new "A.3.4. sort-by=tagline limit=2 offset=1"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/es:members/es:member\" xmlns:es=\"http://example.com/ns/example-social\"/><list-pagination xmlns=\"urn:ietf:params:xml:ns:yang:ietf-list-pagination-nc\" xmlns:es=\"http://example.com/ns/example-social\"><sort-by>es:tagline</sort-by><limit>2</limit><offset>1</offset></list-pagination></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><members xmlns=\"http://example.com/ns/example-social\"><member><member-id>eric</member-id>.*</member><member><member-id>joe</member-id>.*</member></members></data></rpc-reply>"
+
+new "A.3.4. sort-by=tagline again, from sort cache"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/es:members/es:member\" xmlns:es=\"http://example.com/ns/example-social\"/><list-pagination xmlns=\"urn:ietf:params:xml:ns:yang:ietf-list-pagination-nc\" xmlns:es=\"http://example.com/ns/example-social\"><sort-by>es:tagline</sort-by><limit>1</limit><offset>3</offset></list-pagination></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><members xmlns=\"http://example.com/ns/example-social\"><member><member-id>bob</member-id>.*</member></members></data></rpc-reply>"
+
+new "A.3.4. sort-by=tagline direction=backwards limit=1, missing value last"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/es:members/es:member\" xmlns:es=\"http://example.com/ns/example-social\"/><list-pagination xmlns=\"urn:ietf:params:xml:ns:yang:ietf-list-pagination-nc\" xmlns:es=\"http://example.com/ns/example-social\"><sort-by>es:tagline</sort-by><direction>backwards</direction><limit>1</limit></list-pagination></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><members xmlns=\"http://example.com/ns/example-social\"><member><member-id>lin</member-id>.*</member></members></data></rpc-reply>"
+
+new "A.3.4. sort-by non-existing leaf, expect error"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/es:members/es:member\" xmlns:es=\"http://example.com/ns/example-social\"/><list-pagination xmlns=\"urn:ietf:params:xml:ns:yang:ietf-list-pagination-nc\" xmlns:es=\"http://example.com/ns/example-social\"><sort-by>es:nonexist</sort-by></list-pagination></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>invalid-value</error-tag>"
+
+new "A.3.5. where public posts limit=1 offset=1"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/es:members/es:member\" xmlns:es=\"http://example.com/ns/example-social\"/><list-pagination xmlns=\"urn:ietf:params:xml:ns:yang:ietf-list-pagination-nc\" xmlns:es=\"http://example.com/ns/example-social\"><where>es:privacy-settings/es:post-visibility='public'</where><limit>1</limit><offset>1</offset></list-pagination></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><members xmlns=\"http://example.com/ns/example-social\"><member><member-id>bob</member-id>.*</member></members></data></rpc-reply>"
+
 if [ $RC -ne 0 ]; then
     new "Kill restconf daemon"
     stop_restconf
@@ -1,6 +1,7 @@
 #!/usr/bin/env bash
 # JSON performance test:
 # 1. parse a long string
+# 2. parse and encode a long list, print MB/s in both directions
 
 # Magic line must be first in script (see README.md)
 s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
@@ -11,6 +12,7 @@ s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
 : ${perfnr:=100000}
 
 fjson=$dir/long.json
+flist=$dir/list.json
 
 new "generate long file $fjson"
 echo -n '{"foo": "' > $fjson
@@ -23,6 +25,21 @@ echo "$fjson"
 new "json parse long string"
 expecteof_file "time -p $clixon_util_json" 0 "$fjson" 2>&1 | awk '/real/ {print $2}'
 
+new "generate long list file $flist"
+echo -n '{"x":[' > $flist
+for (( i=0; i<$perfnr; i++ )); do  
+    if [ $i -ne 0 ]; then
+        echo -n "," >> $flist
+    fi
+    echo -n "{\"k\":$i,\"v\":\"value $i\"}" >> $flist
+done
+echo ']}' >> $flist
+
+new "json parse and encode list throughput"
+ret=$($clixon_util_json -t 10 < $flist)
+expectpart "$ret" 0 "parse:" "encode:"
+echo "$ret"
+
 rm -rf $dir
 
 # unset conditional parameters 
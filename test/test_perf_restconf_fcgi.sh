@@ -0,0 +1,154 @@
+#!/usr/bin/env bash
+# Load test of FastCGI RESTCONF with and without worker processes
+# clixon_util_fcgi_load is used as a stand-in for nginx: it connects directly to the
+# FastCGI socket with one connection per request and reports requests/s and p99 latency.
+# Run first with a single process, then with CLICON_RESTCONF_FCGI_WORKERS=$perfworkers
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+# Only works with fcgi
+if [ "${WITH_RESTCONF}" != "fcgi" ]; then
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi # skip
+fi
+
+: ${clixon_util_fcgi_load:=clixon_util_fcgi_load}
+
+# Number of list entries in datastore
+: ${perfnr:=1000}
+
+# Number of requests made by load generator
+: ${perfreq:=2000}
+
+# Concurrent requests
+: ${perfconc:=16}
+
+# Number of FastCGI workers in second run
+: ${perfworkers:=4}
+
+APPNAME=example
+
+cfg=$dir/conf.xml
+fyang=$dir/scaling.yang
+fsock=$dir/restconf.sock
+
+cat <<EOF > $fyang
+module scaling{
+   yang-version 1.1;
+   namespace "urn:example:clixon";
+   prefix ex;
+   container x {
+    list y {
+      key "a";
+      leaf a {
+        type int32;
+      }
+      leaf b {
+        type int32;
+      }
+    }
+  }
+}
+EOF
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_FEATURE>clixon-restconf:allow-auth-none</CLICON_FEATURE> <!-- Use auth-type=none -->
+  <CLICON_FEATURE>clixon-restconf:fcgi</CLICON_FEATURE>
+  <CLICON_YANG_DIR>$dir</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <restconf>
+     <enable>true</enable>
+     <auth-type>none</auth-type>
+     <debug>$DBG</debug>
+     <fcgi-socket>$fsock</fcgi-socket>
+  </restconf>
+</clixon-config>
+EOF
+
+new "generate startup with $perfnr list entries"
+echo -n "<${DATASTORE_TOP}><x xmlns=\"urn:example:clixon\">" > $dir/startup_db
+for (( i=0; i<$perfnr; i++ )); do
+    echo -n "<y><a>$i</a><b>$i</b></y>" >> $dir/startup_db
+done
+echo "</x></${DATASTORE_TOP}>" >> $dir/startup_db
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s startup -f $cfg"
+    start_backend -s startup -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+# Start restconf with given number of workers, run load and check there are no errors
+# Args:
+# 1: number of workers
+function testrun()
+{
+    workers=$1
+
+    new "kill old restconf daemon"
+    stop_restconf_pre
+    sudo rm -f $fsock
+
+    new "start restconf daemon with $workers workers"
+    start_restconf -f $cfg -o CLICON_RESTCONF_FCGI_WORKERS=$workers
+
+    new "wait restconf socket"
+    let i=0;
+    while ! sudo test -S $fsock; do
+        if [ $i -ge $DEMLOOP ]; then
+            err1 "restconf socket $fsock timeout $DEMWAIT seconds"
+        fi
+        sleep $DEMSLEEP
+        let i++;
+    done
+
+    new "restconf get one entry warmup"
+    expectpart "$(sudo $clixon_util_fcgi_load -s $fsock -n $perfconc -c $perfconc -u /restconf/data/scaling:x/y=1)" 0 "errors: 0"
+
+    new "restconf get one entry, workers:$workers requests:$perfreq concurrency:$perfconc"
+    ret=$(sudo $clixon_util_fcgi_load -s $fsock -n $perfreq -c $perfconc -u /restconf/data/scaling:x/y=1)
+    echo "$ret"
+    expectpart "$ret" 0 "errors: 0" "req/s" "p99:"
+
+    new "restconf get all entries, workers:$workers requests:$perfreq concurrency:$perfconc"
+    ret=$(sudo $clixon_util_fcgi_load -s $fsock -n $perfreq -c $perfconc -u /restconf/data/scaling:x)
+    echo "$ret"
+    expectpart "$ret" 0 "errors: 0" "req/s" "p99:"
+
+    new "kill restconf daemon"
+    stop_restconf
+}
+
+testrun 1
+testrun $perfworkers
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -210,7 +210,48 @@ REQ='{
   }
 }'
 new "RFC 8072 YANG Patch JSON: Error."
-expectpart "$(curl -u andy:bar $CURLOPTS -X PATCH -H 'Content-Type: application/yang-patch+json' -H 'Accept: application/yang-patch+json' $RCPROTO://localhost/restconf/data/ietf-interfaces:interfaces -d "$REQ")" 0 "HTTP/$HVER 204"
+expectpart "$(curl -u andy:bar $CURLOPTS -X PATCH -H 'Content-Type: application/yang-patch+json' -H 'Accept: application/yang-patch+json' $RCPROTO://localhost/restconf/data/ietf-interfaces:interfaces -d "$REQ")" 0 "HTTP/$HVER 200" '{"ietf-yang-patch:yang-patch-status":{"patch-id":"alan-test-patch","ok":{}}}'
+
+new "RFC 8072 YANG Patch JSON: check merged edits"
+expectpart "$(curl -u andy:bar $CURLOPTS -X GET $RCPROTO://localhost/restconf/data/ietf-interfaces:interfaces/interface=eth2/enabled)" 0 "HTTP/$HVER 200" '{"ietf-interfaces:enabled":true}'
+
+new "RFC 8072 YANG Patch JSON: check deleted edit"
+expectpart "$(curl -u andy:bar $CURLOPTS -X GET $RCPROTO://localhost/restconf/data/ietf-interfaces:interfaces/interface=eth1)" 0 "HTTP/$HVER 404"
+
+# A patch with an invalid edit is rejected as a whole and the failing edit is reported
+REQ='{
+  "ietf-yang-patch:yang-patch": {
+    "patch-id": "atomic-patch",
+    "edit": [
+      {
+        "edit-id": "edit-1",
+        "operation": "create",
+        "target": "/interface=eth5",
+        "value": {
+          "interface": [
+            {
+              "name": "eth5",
+              "type": "iana-if-type:atm"
+            }
+          ]
+        }
+      },
+      {
+        "edit-id": "edit-2",
+        "operation": "merge",
+        "target": "/interface=eth2",
+        "value": {
+          "foo": "bar"
+        }
+      }
+    ]
+  }
+}'
+new "RFC 8072 YANG Patch JSON: invalid edit"
+expectpart "$(curl -u andy:bar $CURLOPTS -X PATCH -H 'Content-Type: application/yang-patch+json' -H 'Accept: application/yang-patch+json' $RCPROTO://localhost/restconf/data/ietf-interfaces:interfaces -d "$REQ")" 0 "HTTP/$HVER 400" '"patch-id":"atomic-patch","edit-status":{"edit":{"edit-id":"edit-2","errors":{"error":' '"error-tag":"bad-element"'
+
+new "RFC 8072 YANG Patch JSON: check no edit applied"
+expectpart "$(curl -u andy:bar $CURLOPTS -X GET $RCPROTO://localhost/restconf/data/ietf-interfaces:interfaces/interface=eth5)" 0 "HTTP/$HVER 404"
 #
 # Create artist in jukebox example
 REQ='{"example-jukebox:artist":[{"name":"Foo Fighters"}]}'
@@ -305,7 +346,7 @@ REQ='{
   }
 }'
 new "RFC 8072 YANG Patch JSON jukebox example: Error."
-expectpart "$(curl -u andy:bar $CURLOPTS -X PATCH -H 'Content-Type: application/yang-patch+json' -H 'Accept: application/yang-patch+json' $RCPROTO://localhost/restconf/data/example-jukebox:jukebox/playlist=Foo-One -d "$REQ")" 0 "HTTP/$HVER 201"
+expectpart "$(curl -u andy:bar $CURLOPTS -X PATCH -H 'Content-Type: application/yang-patch+json' -H 'Accept: application/yang-patch+json' $RCPROTO://localhost/restconf/data/example-jukebox:jukebox/playlist=Foo-One -d "$REQ")" 0 "HTTP/$HVER 200" '{"ietf-yang-patch:yang-patch-status":{"patch-id":"alan-test-patch-jukebox","ok":{}}}'
 
 # Uncomment to get info about playlist in jukebox example
 #new "RFC 8072 YANG Patch jukebox example get : Error."
@@ -0,0 +1,135 @@
+#!/usr/bin/env bash
+# Test system state data cache
+# Use main example -- -sS <file> -c <ms> option to cache state read from a file
+# Change the state file and check that cached state is returned until the ttl
+# has expired or a commit invalidates the cache
+#
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/example-cache.yang
+fstate=$dir/state.xml
+
+# State cache time-to-live in ms
+: ${ttl:=2000}
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_CLISPEC_DIR>/usr/local/lib/$APPNAME/clispec</CLICON_CLISPEC_DIR>
+  <CLICON_CLI_DIR>/usr/local/lib/$APPNAME/cli</CLICON_CLI_DIR>
+  <CLICON_CLI_MODE>$APPNAME</CLICON_CLI_MODE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_XMLDB_DIR>/usr/local/var/$APPNAME</CLICON_XMLDB_DIR>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+  <CLICON_STREAM_DISCOVERY_RFC8040>false</CLICON_STREAM_DISCOVERY_RFC8040>
+  <CLICON_NETCONF_MONITORING>false</CLICON_NETCONF_MONITORING>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module example-cache {
+  yang-version 1.1;
+  namespace "urn:example:cache";
+  prefix ex;
+  container parameters {
+    leaf value {
+      type string;
+    }
+  }
+  container counters {
+    config false;
+    leaf in-octets {
+      type uint32;
+    }
+  }
+}
+EOF
+
+# Write state file
+# Arguments:
+# 1: counter value
+function setstate()
+{
+    cat <<EOF > $fstate
+<counters xmlns="urn:example:cache"><in-octets>$1</in-octets></counters>
+EOF
+}
+
+# Get state and check counter value
+# Arguments:
+# 1: expected counter value
+function getstate()
+{
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get content=\"nonconfig\"><filter type=\"xpath\" select=\"/ex:counters\" xmlns:ex=\"urn:example:cache\"/></get></rpc>" "" "<rpc-reply $DEFAULTNS><data><counters xmlns=\"urn:example:cache\"><in-octets>$1</in-octets></counters></data></rpc-reply>"
+}
+
+new "test params: -f $cfg -- -sS $fstate -c $ttl"
+
+setstate 1
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg -- -sS $fstate -c $ttl"
+    start_backend -s init -f $cfg -- -sS $fstate -c $ttl
+fi
+
+new "wait backend"
+wait_backend
+
+new "get state, fills cache"
+getstate 1
+
+setstate 2
+
+new "get state within ttl, expect cached value"
+getstate 1
+
+new "get all state within ttl, expect cached value"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get content=\"nonconfig\"/></rpc>" "" "<rpc-reply $DEFAULTNS><data><counters xmlns=\"urn:example:cache\"><in-octets>1</in-octets></counters></data></rpc-reply>"
+
+sleep $((ttl/1000 + 1))
+
+new "get state after ttl, expect new value"
+getstate 2
+
+setstate 3
+
+new "get state within ttl, expect cached value"
+getstate 2
+
+new "edit config"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><parameters xmlns=\"urn:example:cache\"><value>x</value></parameters></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "commit invalidates cache"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "get state after commit, expect new value"
+getstate 3
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,147 @@
+#!/usr/bin/env bash
+# Incremental validation using constraint dependencies, see CLICON_VALIDATE_INCREMENTAL
+# Changes to nodes referenced by must, leafref and unique of other, unchanged, nodes
+# Run first with incremental validation, then with full validation
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf.xml
+fyang=$dir/example.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_FEATURE>*:*</CLICON_FEATURE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module example{
+  yang-version 1.1;
+  namespace "urn:example:clixon";
+  prefix ex;
+  container sys{
+    leaf max-mtu{
+      type uint32;
+      default 9000;
+    }
+  }
+  container ifaces{
+    list iface{
+      key name;
+      unique address;
+      leaf name{
+        type string;
+      }
+      leaf address{
+        type string;
+      }
+      leaf mtu{
+        type uint32;
+        must ". <= /ex:sys/ex:max-mtu" {
+          error-message "MTU exceeds max-mtu";
+        }
+      }
+    }
+  }
+  container routing{
+    leaf default-iface{
+      type leafref{
+        path "/ex:ifaces/ex:iface/ex:name";
+      }
+    }
+  }
+}
+EOF
+
+# Edit candidate and validate
+# Args:
+# 1: edit-config content
+# 2: expected substring of validate reply
+function editvalidate()
+{
+    config=$1
+    expect=$2
+
+    new "edit-config"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config>$config</config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "validate"
+    expectpart "$(echo "$DEFAULTHELLO<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>]]>]]>" | $clixon_netconf -qf $cfg -o CLICON_NETCONF_BASE_CAPABILITY=0)" 0 "$expect"
+
+    new "discard-changes"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+}
+
+# Args:
+# 1: incremental true or false
+function testrun()
+{
+    incr=$1
+
+    new "test params: -f $cfg -o CLICON_VALIDATE_INCREMENTAL=$incr"
+    if [ $BE -ne 0 ]; then
+        new "kill old backend"
+        sudo clixon_backend -zf $cfg
+        if [ $? -ne 0 ]; then
+            err
+        fi
+        new "start backend -s init -f $cfg -o CLICON_VALIDATE_INCREMENTAL=$incr"
+        start_backend -s init -f $cfg -o CLICON_VALIDATE_INCREMENTAL=$incr
+    fi
+
+    new "wait backend"
+    wait_backend
+
+    new "add base config"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><sys xmlns=\"urn:example:clixon\"><max-mtu>1500</max-mtu></sys><ifaces xmlns=\"urn:example:clixon\"><iface><name>eth0</name><address>10.0.0.1</address><mtu>1500</mtu></iface><iface><name>eth1</name><address>10.0.0.2</address><mtu>1400</mtu></iface></ifaces><routing xmlns=\"urn:example:clixon\"><default-iface>eth0</default-iface></routing></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "commit base config"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    # must of unchanged mtu depends on changed max-mtu
+    editvalidate "<sys xmlns=\"urn:example:clixon\"><max-mtu>1450</max-mtu></sys>" "MTU exceeds max-mtu"
+
+    # leafref of unchanged default-iface depends on deleted interface
+    editvalidate "<ifaces xmlns=\"urn:example:clixon\" xmlns:nc=\"urn:ietf:params:xml:ns:netconf:base:1.0\"><iface nc:operation=\"delete\"><name>eth0</name></iface></ifaces>" "Leafref validation failed"
+
+    # unique of unchanged eth0 address depends on changed eth1 address
+    editvalidate "<ifaces xmlns=\"urn:example:clixon\"><iface><name>eth1</name><address>10.0.0.1</address></iface></ifaces>" "data-not-unique"
+
+    # Change not affecting any constraint
+    editvalidate "<ifaces xmlns=\"urn:example:clixon\"><iface><name>eth1</name><mtu>1300</mtu></iface></ifaces>" "<ok/>"
+
+    new "delete referenced interface and reference"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><ifaces xmlns=\"urn:example:clixon\" xmlns:nc=\"urn:ietf:params:xml:ns:netconf:base:1.0\"><iface nc:operation=\"delete\"><name>eth0</name></iface></ifaces><routing xmlns=\"urn:example:clixon\" xmlns:nc=\"urn:ietf:params:xml:ns:netconf:base:1.0\"><default-iface nc:operation=\"delete\"/></routing></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "commit"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    if [ $BE -ne 0 ]; then
+        new "Kill backend"
+        # Check if premature kill
+        pid=$(pgrep -u root -f clixon_backend)
+        if [ -z "$pid" ]; then
+            err "backend already dead"
+        fi
+        # kill backend
+        stop_backend -f $cfg
+    fi
+}
+
+testrun true
+testrun false
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,122 @@
+#!/usr/bin/env bash
+# Validation of a large datastore with worker processes, see CLICON_VALIDATE_WORKERS
+# Full validation (CLICON_VALIDATE_INCREMENTAL=false) of a startup with many list entries
+# Check that the first error in document order is reported, as in sequential validation
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+# Number of list entries in datastore, should be more than VALIDATE_WORKERS_MIN nodes
+: ${perfnr:=5000}
+
+# Number of worker processes
+: ${workers:=4}
+
+APPNAME=example
+
+cfg=$dir/conf.xml
+fyang=$dir/example.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+  <CLICON_VALIDATE_INCREMENTAL>false</CLICON_VALIDATE_INCREMENTAL>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module example{
+  yang-version 1.1;
+  namespace "urn:example:clixon";
+  prefix ex;
+  container x{
+    list y{
+      key a;
+      leaf a{
+        type int32;
+      }
+      leaf b{
+        type int32;
+        must ". != 0" {
+          error-message "b is zero";
+        }
+      }
+      leaf c{
+        type int32;
+        must ". != 0" {
+          error-message "c is zero";
+        }
+      }
+    }
+  }
+}
+EOF
+
+new "generate startup with $perfnr list entries"
+echo -n "<${DATASTORE_TOP}><x xmlns=\"urn:example:clixon\">" > $dir/startup_db
+for (( i=0; i<$perfnr; i++ )); do
+    echo -n "<y><a>$i</a><b>1</b><c>1</c></y>" >> $dir/startup_db
+done
+echo "</x></${DATASTORE_TOP}>" >> $dir/startup_db
+
+# Args:
+# 1: number of workers
+function testrun()
+{
+    nr=$1
+
+    new "test params: -f $cfg -o CLICON_VALIDATE_WORKERS=$nr"
+    if [ $BE -ne 0 ]; then
+        new "kill old backend"
+        sudo clixon_backend -zf $cfg
+        if [ $? -ne 0 ]; then
+            err
+        fi
+        new "start backend -s startup -f $cfg -o CLICON_VALIDATE_WORKERS=$nr"
+        start_backend -s startup -f $cfg -o CLICON_VALIDATE_WORKERS=$nr
+    fi
+
+    new "wait backend"
+    wait_backend
+
+    new "validate startup, workers:$nr"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "set b of late entry and c of early entry to zero"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x xmlns=\"urn:example:clixon\"><y><a>$((perfnr-10))</a><b>0</b></y><y><a>10</a><c>0</c></y></x></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "validate, expect first error in document order, workers:$nr"
+    expectpart "$(echo "$DEFAULTHELLO<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>]]>]]>" | $clixon_netconf -qf $cfg -o CLICON_NETCONF_BASE_CAPABILITY=0)" 0 "c is zero" --not-- "b is zero"
+
+    new "discard-changes"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    if [ $BE -ne 0 ]; then
+        new "Kill backend"
+        # Check if premature kill
+        pid=$(pgrep -u root -f clixon_backend)
+        if [ -z "$pid" ]; then
+            err "backend already dead"
+        fi
+        # kill backend
+        stop_backend -f $cfg
+    fi
+}
+
+testrun 0
+testrun $workers
+
+rm -rf $dir
+
+# unset conditional parameters
+unset perfnr
+unset workers
+
+new "endtest"
+endtest
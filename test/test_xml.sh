@@ -212,6 +212,19 @@ EOF
 )
 expecteof "$clixon_util_xml -o" 0 "$XML" '^<bk:book xmlns:bk="urn:loc.gov:books" xmlns:isbn="urn:ISBN:0-395-36341-6"><bk:title>Cheaper by the Dozen</bk:title><isbn:number>1568491379</isbn:number></bk:book>$'
 
+new "Character references"
+expecteof "$clixon_util_xml -o" 0 '<a>&#65;&#x42;&#x20AC;</a>' '<a>AB€</a>'
+
+# Streaming parser: input is split at every position
+XML='<?xml version="1.0"?><!-- c --><x xmlns:n="urn:n" a="t"><n:y>a &amp; b</n:y><z><![CDATA[]]]></z></x>'
+for c in 1 2 3 7; do
+    new "xml parse with input chunks of $c bytes"
+    expecteof "$clixon_util_xml -o -c $c" 0 "$XML" '^<x xmlns:n="urn:n" a="t"><n:y>a &amp; b</n:y><z><!\[CDATA\[\]\]\]></z></x>$'
+
+    new "xml parse error with input chunks of $c bytes"
+    expecteof "$clixon_util_xml -o -c $c" 255 "<a><b></c></a>" "" 2> /dev/null
+done
+
 rm -rf $dir
 
 # unset conditional parameters 
@@ -0,0 +1,84 @@
+#!/usr/bin/env bash
+# Sort order of list and leaf-list entries using precomputed sort keys, see xml_cmp
+# Signed and unsigned integer keys, string prefixes, multiple keys, and key types without
+# sort key encoding (decimal64) where values are compared as before.
+# Just run a binary direct to datastore. No clixon.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+: ${clixon_util_datastore:=clixon_util_datastore}
+
+fyang=$dir/example.yang
+mydir=$dir/db
+
+cat <<EOF > $fyang
+module example{
+  yang-version 1.1;
+  namespace "urn:example:clixon";
+  prefix ex;
+  container x {
+    list m {
+      key "s i";
+      leaf s {
+        type string;
+      }
+      leaf i {
+        type int8;
+      }
+    }
+    leaf-list u {
+      type uint64;
+    }
+    leaf-list t {
+      type string;
+    }
+    list d {
+      key k;
+      leaf k {
+        type decimal64{
+          fraction-digits 2;
+        }
+      }
+    }
+  }
+}
+EOF
+
+if [ ! -d $mydir ]; then
+    mkdir $mydir
+fi
+
+conf="-d candidate -b $mydir -y $fyang"
+
+cat <<EOF > $dir/x1.xml
+<x xmlns="urn:example:clixon"><m><s>b</s><i>-1</i></m><m><s>a</s><i>5</i></m><m><s>ab</s><i>-128</i></m><m><s>a</s><i>-3</i></m><m><s>a</s><i>127</i></m><u>18446744073709551615</u><u>256</u><u>1</u><u>0</u><t>ab</t><t>b</t><t>a</t><d><k>10.5</k></d><d><k>1.5</k></d><d><k>-2.25</k></d></x>
+EOF
+
+new "datastore init"
+expectpart "$($clixon_util_datastore $conf init)" 0 ""
+
+new "datastore put unsorted entries"
+expectpart "$($clixon_util_datastore $conf -x $dir/x1.xml put replace)" 0 ""
+
+new "datastore get sorted"
+expectpart "$($clixon_util_datastore $conf get /)" 0 "^<${DATASTORE_TOP}><x xmlns=\"urn:example:clixon\"><m><s>a</s><i>-3</i></m><m><s>a</s><i>5</i></m><m><s>a</s><i>127</i></m><m><s>ab</s><i>-128</i></m><m><s>b</s><i>-1</i></m><u>0</u><u>1</u><u>256</u><u>18446744073709551615</u><t>a</t><t>ab</t><t>b</t><d><k>-2.25</k></d><d><k>1.5</k></d><d><k>10.5</k></d></x></${DATASTORE_TOP}>$"
+
+cat <<EOF > $dir/x2.xml
+<x xmlns="urn:example:clixon"><m><s>a</s><i>0</i></m><u>255</u><t>aa</t></x>
+EOF
+
+new "datastore put merge entries between existing"
+expectpart "$($clixon_util_datastore $conf -x $dir/x2.xml put merge)" 0 ""
+
+new "datastore get merged"
+expectpart "$($clixon_util_datastore $conf get /)" 0 "^<${DATASTORE_TOP}><x xmlns=\"urn:example:clixon\"><m><s>a</s><i>-3</i></m><m><s>a</s><i>0</i></m><m><s>a</s><i>5</i></m><m><s>a</s><i>127</i></m><m><s>ab</s><i>-128</i></m><m><s>b</s><i>-1</i></m><u>0</u><u>1</u><u>255</u><u>256</u><u>18446744073709551615</u><t>a</t><t>aa</t><t>ab</t><t>b</t><d><k>-2.25</k></d><d><k>1.5</k></d><d><k>10.5</k></d></x></${DATASTORE_TOP}>$"
+
+rm -rf $mydir
+rm -rf $dir
+
+# unset conditional parameters 
+unset clixon_util_datastore
+
+new "endtest"
+endtest
@@ -0,0 +1,114 @@
+#!/usr/bin/env bash
+# Compiled xpath of YANG must and when statements, see XPATH_COMPILE
+# Compare compiled and interpreted evaluation of the test_when_must.sh models, and
+# benchmark the two
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+: ${clixon_util_xpath:=clixon_util_xpath}
+
+# Number of evaluations in benchmark
+: ${perfnr:=100000}
+
+fyang=$dir/example.yang
+xml=$dir/xml.xml
+
+cat <<EOF > $fyang
+module example{
+  yang-version 1.1;
+  namespace "urn:example:clixon";
+  prefix ex;
+  identity routing-protocol;
+  identity direct {
+    base routing-protocol;
+  }
+  identity static {
+    base routing-protocol;
+  }
+  list whenex {
+    key "type name";
+    leaf type {
+      type identityref {
+        base routing-protocol;
+      }
+    }
+    leaf name {
+      type string;
+    }
+    leaf route-preference {
+      type uint32;
+    }
+    container static-routes {
+      when "../type='static'";
+      presence true;
+    }
+  }
+  container interface {
+    leaf ifType {
+      type enumeration {
+        enum ethernet;
+        enum atm;
+      }
+    }
+    leaf ifMTU {
+      type uint32;
+    }
+    must 'ifType != "ethernet" or ifMTU = 1500';
+    must 'ifType != "atm" or (ifMTU <= 17966 and ifMTU >= 64)';
+  }
+}
+EOF
+
+cat <<EOF > $xml
+<whenex xmlns="urn:example:clixon"><type>static</type><name>r1</name><route-preference>10</route-preference><static-routes/></whenex>
+<whenex xmlns="urn:example:clixon"><type>direct</type><name>r2</name><route-preference>20</route-preference></whenex>
+<interface xmlns="urn:example:clixon"><ifType>ethernet</ifType><ifMTU>1500</ifMTU></interface>
+EOF
+
+# Evaluate xpath with interpreter and compiled, expect same result
+# Args:
+# 1: initial xpath (context node)
+# 2: xpath
+# 3: expected result: true or false
+# 4: compiled: native or interpreter (not supported by compiler)
+function xpathcmp()
+{
+    xpath0=$1
+    xpath=$2
+    result=$3
+    compiled=$4
+
+    new "xpath $xpath in $xpath0: $result $compiled"
+    expectpart "$($clixon_util_xpath -D $DBG -f $xml -n ex:urn:example:clixon -y $fyang -i "$xpath0" -p "$xpath" -t 1)" 0 "interpreted: $result" "compiled($compiled): $result"
+}
+
+xpathcmp "whenex[name='r1']/static-routes" "../type='static'" true native
+xpathcmp "whenex[name='r2']/route-preference" "../type='static'" false native
+xpathcmp "interface" 'ifType != "ethernet" or ifMTU = 1500' true native
+xpathcmp "interface" 'ifType != "atm" or (ifMTU <= 17966 and ifMTU >= 64)' true native
+xpathcmp "interface" "ex:ifMTU > 1500" false native
+xpathcmp "interface" "1500 >= ex:ifMTU" true native
+xpathcmp "interface" "count(/ex:whenex) = 2" true native
+xpathcmp "interface" "not(ifMTU) or 1 + 2 * 3 = 7" true native
+xpathcmp "interface" "current()/../whenex/name = ../whenex/route-preference" false native
+xpathcmp "interface" "../whenex/route-preference < ../whenex/route-preference" true native
+xpathcmp "interface" "../whenex/route-preference div 2 = 5" true native
+xpathcmp "interface" "true() and ../nonexist" false native
+xpathcmp "interface" "../whenex[name='r2']/route-preference = 20" true interpreter
+xpathcmp "interface" "//ifMTU = 1500" true interpreter
+
+new "benchmark when: $perfnr evaluations"
+expectpart "$($clixon_util_xpath -f $xml -n ex:urn:example:clixon -y $fyang -i "whenex[name='r1']/static-routes" -p "../type='static'" -t $perfnr)" 0 "interpreted: true" "compiled(native): true"
+
+new "benchmark must: $perfnr evaluations"
+expectpart "$($clixon_util_xpath -f $xml -n ex:urn:example:clixon -y $fyang -i "interface" -p 'ifType != "atm" or (ifMTU <= 17966 and ifMTU >= 64)' -t $perfnr)" 0 "interpreted: true" "compiled(native): true"
+
+rm -rf $dir
+
+# unset conditional parameters
+unset clixon_util_xpath
+unset perfnr
+
+new "endtest"
+endtest
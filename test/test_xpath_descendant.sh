@@ -0,0 +1,129 @@
+#!/usr/bin/env bash
+# Descendant xpath axes ("//") on YANG-bound XML, see XPATH_DESCENDANT_PRUNE
+# Subtrees are pruned using the YANG descendant names, choice and anydata are transparent,
+# and list entries directly below a node are found by list key binary search
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+: ${clixon_util_xpath:=clixon_util_xpath}
+
+# Number of list entries
+: ${perfnr:=1000}
+
+fyang=$dir/example.yang
+xml=$dir/xml.xml
+xml2=$dir/xml2.xml
+
+cat <<EOF > $fyang
+module example{
+  yang-version 1.1;
+  namespace "urn:example:clixon";
+  prefix ex;
+  container interfaces{
+    list interface{
+      key name;
+      leaf name{
+        type string;
+      }
+      leaf mtu{
+        type uint32;
+      }
+      container ipv4{
+        leaf address{
+          type string;
+        }
+      }
+    }
+  }
+  container routing{
+    list instance{
+      key name;
+      leaf name{
+        type string;
+      }
+      container interfaces{
+        leaf-list interface{
+          type string;
+        }
+      }
+    }
+  }
+  container system{
+    leaf hostname{
+      type string;
+    }
+    choice c{
+      case a{
+        container ca{
+          leaf address{
+            type string;
+          }
+        }
+      }
+    }
+    anydata data;
+  }
+}
+EOF
+
+cat <<EOF > $xml
+<interfaces xmlns="urn:example:clixon">
+  <interface><name>e0</name><mtu>1500</mtu><ipv4><address>10.0.0.1</address></ipv4></interface>
+  <interface><name>e1</name><mtu>1400</mtu></interface>
+</interfaces>
+<routing xmlns="urn:example:clixon">
+  <instance><name>r0</name><interfaces><interface>e0</interface><interface>e1</interface></interfaces></instance>
+</routing>
+<system xmlns="urn:example:clixon">
+  <hostname>h0</hostname>
+  <ca><address>10.0.0.2</address></ca>
+  <data><x><address>10.0.0.3</address></x></data>
+</system>
+EOF
+
+new "//interface list entry with key"
+expectpart "$($clixon_util_xpath -D $DBG -f $xml -y $fyang -n null:urn:example:clixon -p "//interface[name='e1']")" 0 "^nodeset:0:<interface><name>e1</name><mtu>1400</mtu></interface>$"
+
+new "//interface list entry with non-existing key"
+expectpart "$($clixon_util_xpath -D $DBG -f $xml -y $fyang -n null:urn:example:clixon -p "//interface[name='e9']")" 0 "^nodeset:$"
+
+new "//interface list and leaf-list entries"
+expectpart "$($clixon_util_xpath -D $DBG -f $xml -y $fyang -n null:urn:example:clixon -p "//interface")" 0 "0:<interface><name>e0</name>" "1:<interface><name>e1</name>" "2:<interface>e0</interface>" "3:<interface>e1</interface>"
+
+new "//interface leaf-list entry"
+expectpart "$($clixon_util_xpath -D $DBG -f $xml -y $fyang -n null:urn:example:clixon -p "//interface[.='e1']")" 0 "^nodeset:0:<interface>e1</interface>$"
+
+new "//address in container, choice and anydata"
+expectpart "$($clixon_util_xpath -D $DBG -f $xml -y $fyang -n null:urn:example:clixon -p "//address")" 0 "^nodeset:0:<address>10.0.0.1</address>1:<address>10.0.0.2</address>2:<address>10.0.0.3</address>$"
+
+new "/system//address"
+expectpart "$($clixon_util_xpath -D $DBG -f $xml -y $fyang -n null:urn:example:clixon -p "/system//address")" 0 "^nodeset:0:<address>10.0.0.2</address>1:<address>10.0.0.3</address>$"
+
+new "count(//hostname)"
+expectpart "$($clixon_util_xpath -D $DBG -f $xml -y $fyang -n null:urn:example:clixon -p "count(//hostname)")" 0 "^number:1$"
+
+new "//nonexist"
+expectpart "$($clixon_util_xpath -D $DBG -f $xml -y $fyang -n null:urn:example:clixon -p "//nonexist")" 0 "^nodeset:$"
+
+new "generate $perfnr list entries"
+echo -n "<interfaces xmlns=\"urn:example:clixon\">" > $xml2
+for (( i=0; i<$perfnr; i++ )); do
+    echo -n "<interface><name>e$i</name><mtu>$i</mtu></interface>" >> $xml2
+done
+echo "</interfaces>" >> $xml2
+
+new "//interface with key in $perfnr entries"
+expectpart "$($clixon_util_xpath -D $DBG -f $xml2 -y $fyang -n null:urn:example:clixon -p "//interface[name='e$((perfnr/2))']")" 0 "^nodeset:0:<interface><name>e$((perfnr/2))</name><mtu>$((perfnr/2))</mtu></interface>$"
+
+new "//mtu in $perfnr entries"
+expectpart "$($clixon_util_xpath -D $DBG -f $xml2 -y $fyang -n null:urn:example:clixon -p "count(//mtu)")" 0 "^number:$perfnr$"
+
+rm -rf $dir
+
+# unset conditional parameters
+unset clixon_util_xpath
+unset perfnr
+
+new "endtest"
+endtest
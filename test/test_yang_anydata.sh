@@ -194,9 +194,23 @@ EOF
         new "Put anydata"
         expecteof_netconf "$clixon_netconf -qf $cfg -D $DBG" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config>$XMLA</config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
 
+        if $unknown; then
+            # Populate cached descendant names of cu before unknown u21 is added below it
+            new "Put known part of unknown"
+            expecteof_netconf "$clixon_netconf -qf $cfg -D $DBG" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><cu xmlns=\"urn:example:unknown\"><b><k>22</k></b></cu></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+            new "Get //u21 before unknown is added"
+            expecteof_netconf "$clixon_netconf -qf $cfg -D $DBG" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source><filter type=\"xpath\" select=\"//un:u21\" xmlns:un=\"urn:example:unknown\"/></get-config></rpc>" "" "^<rpc-reply $DEFAULTNS><data/></rpc-reply>$"
+        fi
+
         new "Put unknown"
         expecteof_netconf "$clixon_netconf -qf $cfg -D $DBG" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config>$XMLU</config></edit-config></rpc>" "$unknownreply"
 
+        if $unknown; then
+            new "Get //u21 after unknown is added"
+            expecteof_netconf "$clixon_netconf -qf $cfg -D $DBG" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source><filter type=\"xpath\" select=\"//un:u21\" xmlns:un=\"urn:example:unknown\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><cu xmlns=\"urn:example:unknown\"><u2><u21>a string</u21></u2></cu></data></rpc-reply>"
+        fi
+
         new "commit"
         expecteof_netconf "$clixon_netconf -qf $cfg -D $DBG" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
     fi
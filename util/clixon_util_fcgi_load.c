@@ -0,0 +1,509 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC (Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+  * FastCGI load generator, a stand-in for a reverse proxy such as nginx.
+  * Connects directly to the restconf FastCGI socket with one connection per request (as
+  * nginx without fastcgi_keep_conn), keeps <concurrency> requests in flight, and reports
+  * requests/s and latency percentiles.
+  * Precondition:
+  * The FastCGI restconf daemon must have been started with fcgi-socket given as -s
+  * @see test_perf_restconf_fcgi.sh
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <stdint.h>
+#include <syslog.h>
+#include <time.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon/clixon.h"
+
+/* FastCGI protocol constants */
+#define FCGI_VERSION_1      1
+#define FCGI_BEGIN_REQUEST  1
+#define FCGI_END_REQUEST    3
+#define FCGI_PARAMS         4
+#define FCGI_STDIN          5
+#define FCGI_STDOUT         6
+#define FCGI_RESPONDER      1
+#define FCGI_HEADER_LEN     8
+
+/* Request id, one request per connection */
+#define FCGI_LOAD_ID        1
+
+/* Poll timeout in ms, a request not answered within this is an error */
+#define FCGI_LOAD_TIMEOUT   10000
+
+/*! One request in flight, on its own connection
+ */
+typedef struct {
+    int             fl_s;     /* Socket, or -1 if idle */
+    struct timespec fl_start; /* Time when request was started */
+    cbuf           *fl_in;    /* Received data */
+    size_t          fl_off;   /* Offset of next unparsed record in fl_in */
+    cbuf           *fl_out;   /* FCGI_STDOUT content, ie http headers and body */
+} fcgi_load_conn;
+
+static int
+usage(char *argv0)
+{
+    fprintf(stderr, "usage:%s [options]\n"
+            "where options are\n"
+            "\t-h \t\tHelp\n"
+            "\t-D <level> \tDebug\n"
+            "\t-s <sockpath> \tPath to FastCGI unix domain socket (mandatory)\n"
+            "\t-n <nr> \tNumber of requests (default 1000)\n"
+            "\t-c <nr> \tConcurrent requests (default 8)\n"
+            "\t-m <method> \tHTTP method (default GET)\n"
+            "\t-u <uri> \tRequest URI (default /restconf/data)\n"
+            "\t-a <media> \tAccept header (default application/yang-data+json)\n"
+            ,
+            argv0);
+    exit(0);
+}
+
+/*! Append a FastCGI record
+ */
+static int
+fcgi_record(cbuf       *cb,
+            int         type,
+            const char *data,
+            size_t      len)
+{
+    char hdr[FCGI_HEADER_LEN];
+
+    hdr[0] = FCGI_VERSION_1;
+    hdr[1] = type;
+    hdr[2] = (FCGI_LOAD_ID >> 8) & 0xff;
+    hdr[3] = FCGI_LOAD_ID & 0xff;
+    hdr[4] = (len >> 8) & 0xff;
+    hdr[5] = len & 0xff;
+    hdr[6] = 0; /* padding */
+    hdr[7] = 0;
+    if (cbuf_append_buf(cb, hdr, FCGI_HEADER_LEN) < 0)
+        return -1;
+    if (len && cbuf_append_buf(cb, (void*)data, len) < 0)
+        return -1;
+    return 0;
+}
+
+/*! Append a FastCGI name-value pair length
+ */
+static int
+fcgi_nv_len(cbuf  *cb,
+            size_t len)
+{
+    char b[4];
+
+    if (len < 128){
+        b[0] = len;
+        return cbuf_append_buf(cb, b, 1);
+    }
+    b[0] = ((len >> 24) & 0x7f) | 0x80;
+    b[1] = (len >> 16) & 0xff;
+    b[2] = (len >> 8) & 0xff;
+    b[3] = len & 0xff;
+    return cbuf_append_buf(cb, b, 4);
+}
+
+/*! Append a FastCGI name-value pair
+ */
+static int
+fcgi_nv(cbuf       *cb,
+        const char *name,
+        const char *value)
+{
+    if (fcgi_nv_len(cb, strlen(name)) < 0 ||
+        fcgi_nv_len(cb, strlen(value)) < 0 ||
+        cbuf_append_buf(cb, (void*)name, strlen(name)) < 0 ||
+        cbuf_append_buf(cb, (void*)value, strlen(value)) < 0)
+        return -1;
+    return 0;
+}
+
+/*! Connect and send one request
+ * @param[in]  fl       Idle connection
+ * @param[in]  sockpath FastCGI unix socket
+ * @param[in]  req      Encoded request records
+ * @retval     1        OK, request sent
+ * @retval     0        Connect or write failed
+ * @retval    -1        Error
+ */
+static int
+fcgi_load_send(fcgi_load_conn *fl,
+               char           *sockpath,
+               cbuf           *req)
+{
+    int                retval = -1;
+    struct sockaddr_un addr;
+    int                s = -1;
+    size_t             off = 0;
+    ssize_t            n;
+
+    clock_gettime(CLOCK_MONOTONIC, &fl->fl_start);
+    if ((s = socket(AF_UNIX, SOCK_STREAM, 0)) < 0){
+        clicon_err(OE_UNIX, errno, "socket");
+        goto done;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, sockpath, sizeof(addr.sun_path)-1);
+    if (connect(s, (struct sockaddr*)&addr, sizeof(addr)) < 0){
+        clicon_debug(1, "%s connect: %s", __FUNCTION__, strerror(errno));
+        goto fail;
+    }
+    while (off < cbuf_len(req)){
+        if ((n = write(s, cbuf_get(req) + off, cbuf_len(req) - off)) < 0){
+            if (errno == EINTR)
+                continue;
+            clicon_debug(1, "%s write: %s", __FUNCTION__, strerror(errno));
+            goto fail;
+        }
+        off += n;
+    }
+    cbuf_reset(fl->fl_in);
+    cbuf_reset(fl->fl_out);
+    fl->fl_off = 0;
+    fl->fl_s = s;
+    s = -1;
+    retval = 1;
+ done:
+    if (s != -1)
+        close(s);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Read reply data and parse complete records
+ * @param[in]  fl       Connection with request in flight
+ * @retval     1        FCGI_END_REQUEST received, reply in fl_out
+ * @retval     0        More data needed
+ * @retval    -1        Closed before end of request
+ */
+static int
+fcgi_load_recv(fcgi_load_conn *fl)
+{
+    char           buf[8192];
+    ssize_t        n;
+    unsigned char *p;
+    size_t         clen;
+    size_t         plen;
+
+    if ((n = read(fl->fl_s, buf, sizeof(buf))) <= 0){
+        if (n < 0 && errno == EINTR)
+            return 0;
+        return -1;
+    }
+    if (cbuf_append_buf(fl->fl_in, buf, n) < 0)
+        return -1;
+    while (cbuf_len(fl->fl_in) - fl->fl_off >= FCGI_HEADER_LEN){
+        p = (unsigned char*)cbuf_get(fl->fl_in) + fl->fl_off;
+        clen = (p[4] << 8) | p[5];
+        plen = p[6];
+        if (cbuf_len(fl->fl_in) - fl->fl_off < FCGI_HEADER_LEN + clen + plen)
+            break;
+        if (p[1] == FCGI_STDOUT &&
+            cbuf_append_buf(fl->fl_out, p + FCGI_HEADER_LEN, clen) < 0)
+            return -1;
+        fl->fl_off += FCGI_HEADER_LEN + clen + plen;
+        if (p[1] == FCGI_END_REQUEST)
+            return 1;
+    }
+    return 0;
+}
+
+/*! Get HTTP status of reply from Status header, default 200 as in CGI
+ */
+static int
+fcgi_load_status(cbuf *cb)
+{
+    char *str;
+    int   status = 200;
+
+    if ((str = strstr(cbuf_get(cb), "Status: ")) != NULL)
+        if (sscanf(str + strlen("Status: "), "%d", &status) != 1)
+            status = 0;
+    return status;
+}
+
+static int
+dblcmp(const void *a,
+       const void *b)
+{
+    double da = *(const double*)a;
+    double db = *(const double*)b;
+
+    return (da > db) - (da < db);
+}
+
+/*! Percentile of sorted vector
+ */
+static double
+percentile(double *vec,
+           int     len,
+           double  p)
+{
+    int i;
+
+    if (len == 0)
+        return 0.0;
+    i = (int)(p * len + 0.999999) - 1;
+    if (i < 0)
+        i = 0;
+    if (i >= len)
+        i = len - 1;
+    return vec[i];
+}
+
+int
+main(int    argc,
+     char **argv)
+{
+    int              retval = -1;
+    int              c;
+    int              dbg = 0;
+    char            *sockpath = NULL;
+    int              nr = 1000;
+    int              conc = 8;
+    char            *method = "GET";
+    char            *uri = "/restconf/data";
+    char            *accept = "application/yang-data+json";
+    char            *query;
+    cbuf            *cbp = NULL;
+    cbuf            *req = NULL;
+    fcgi_load_conn  *fls = NULL;
+    fcgi_load_conn  *fl;
+    struct pollfd   *fds = NULL;
+    double          *lat = NULL;
+    int              nlat = 0;
+    int              issued = 0;
+    int              finished = 0;
+    int              errors = 0;
+    int              status;
+    int              nfds;
+    int              i;
+    int              ret;
+    struct timespec  t0;
+    struct timespec  t1;
+    double           ms;
+    double           elapsed;
+    char             body[8] = {0,};
+
+    clicon_log_init(__FILE__, LOG_INFO, CLICON_LOG_STDERR);
+    optind = 1;
+    opterr = 0;
+    while ((c = getopt(argc, argv, "hD:s:n:c:m:u:a:")) != -1)
+        switch (c) {
+        case 'h':
+            usage(argv[0]);
+            break;
+        case 'D':
+            if (sscanf(optarg, "%d", &dbg) != 1)
+                usage(argv[0]);
+            break;
+        case 's':
+            sockpath = optarg;
+            break;
+        case 'n':
+            if (sscanf(optarg, "%d", &nr) != 1 || nr < 1)
+                usage(argv[0]);
+            break;
+        case 'c':
+            if (sscanf(optarg, "%d", &conc) != 1 || conc < 1)
+                usage(argv[0]);
+            break;
+        case 'm':
+            method = optarg;
+            break;
+        case 'u':
+            uri = optarg;
+            break;
+        case 'a':
+            accept = optarg;
+            break;
+        default:
+            usage(argv[0]);
+            break;
+        }
+    clicon_log_init(__FILE__, dbg?LOG_DEBUG:LOG_INFO, CLICON_LOG_STDERR);
+    clicon_debug_init(dbg, NULL);
+    if (sockpath == NULL){
+        fprintf(stderr, "Mandatory option missing: -s <sockpath>\n");
+        usage(argv[0]);
+    }
+    if (conc > nr)
+        conc = nr;
+    /* Encode the request once, same for all */
+    if ((cbp = cbuf_new()) == NULL || (req = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    body[1] = FCGI_RESPONDER; /* role, flags: close connection after request */
+    if (fcgi_record(req, FCGI_BEGIN_REQUEST, body, sizeof(body)) < 0)
+        goto done;
+    query = index(uri, '?');
+    if (fcgi_nv(cbp, "REQUEST_METHOD", method) < 0 ||
+        fcgi_nv(cbp, "REQUEST_URI", uri) < 0 ||
+        fcgi_nv(cbp, "QUERY_STRING", query?query+1:"") < 0 ||
+        fcgi_nv(cbp, "HTTP_ACCEPT", accept) < 0 ||
+        fcgi_nv(cbp, "HTTP_HOST", "localhost") < 0 ||
+        fcgi_nv(cbp, "SERVER_PROTOCOL", "HTTP/1.1") < 0)
+        goto done;
+    if (fcgi_record(req, FCGI_PARAMS, cbuf_get(cbp), cbuf_len(cbp)) < 0 ||
+        fcgi_record(req, FCGI_PARAMS, NULL, 0) < 0 ||
+        fcgi_record(req, FCGI_STDIN, NULL, 0) < 0)
+        goto done;
+    if ((fls = calloc(conc, sizeof(*fls))) == NULL ||
+        (fds = calloc(conc, sizeof(*fds))) == NULL ||
+        (lat = calloc(nr, sizeof(*lat))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    for (i=0; i<conc; i++){
+        fls[i].fl_s = -1;
+        if ((fls[i].fl_in = cbuf_new()) == NULL ||
+            (fls[i].fl_out = cbuf_new()) == NULL){
+            clicon_err(OE_UNIX, errno, "cbuf_new");
+            goto done;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    while (finished < nr){
+        /* Start new requests on idle connections */
+        for (i=0; i<conc && issued < nr; i++){
+            fl = &fls[i];
+            if (fl->fl_s != -1)
+                continue;
+            issued++;
+            if ((ret = fcgi_load_send(fl, sockpath, req)) < 0)
+                goto done;
+            if (ret == 0){
+                errors++;
+                finished++;
+            }
+        }
+        nfds = 0;
+        for (i=0; i<conc; i++){
+            fds[i].fd = fls[i].fl_s; /* Negative fd is ignored by poll */
+            fds[i].events = POLLIN;
+            fds[i].revents = 0;
+            if (fls[i].fl_s != -1)
+                nfds++;
+        }
+        if (nfds == 0)
+            continue;
+        if ((ret = poll(fds, conc, FCGI_LOAD_TIMEOUT)) < 0){
+            if (errno == EINTR)
+                continue;
+            clicon_err(OE_UNIX, errno, "poll");
+            goto done;
+        }
+        if (ret == 0){
+            clicon_err(OE_UNIX, ETIMEDOUT, "No reply in %d ms", FCGI_LOAD_TIMEOUT);
+            goto done;
+        }
+        for (i=0; i<conc; i++){
+            fl = &fls[i];
+            if (fl->fl_s == -1 || fds[i].revents == 0)
+                continue;
+            if ((ret = fcgi_load_recv(fl)) == 0)
+                continue;
+            clock_gettime(CLOCK_MONOTONIC, &t1);
+            if (ret < 0)
+                errors++;
+            else {
+                ms = (t1.tv_sec - fl->fl_start.tv_sec)*1000.0 +
+                    (t1.tv_nsec - fl->fl_start.tv_nsec)/1000000.0;
+                lat[nlat++] = ms;
+                status = fcgi_load_status(fl->fl_out);
+                if (status < 200 || status > 299){
+                    clicon_debug(1, "status %d", status);
+                    errors++;
+                }
+            }
+            close(fl->fl_s);
+            fl->fl_s = -1;
+            finished++;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    elapsed = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec)/1000000000.0;
+    qsort(lat, nlat, sizeof(*lat), dblcmp);
+    fprintf(stdout, "requests: %d errors: %d concurrency: %d time: %.3f s "
+            "rate: %.1f req/s p50: %.3f ms p99: %.3f ms max: %.3f ms\n",
+            nr, errors, conc, elapsed,
+            elapsed > 0.0 ? nr/elapsed : 0.0,
+            percentile(lat, nlat, 0.50),
+            percentile(lat, nlat, 0.99),
+            nlat ? lat[nlat-1] : 0.0);
+    retval = errors ? 1 : 0;
+ done:
+    if (fls){
+        for (i=0; i<conc; i++){
+            if (fls[i].fl_s != -1)
+                close(fls[i].fl_s);
+            if (fls[i].fl_in)
+                cbuf_free(fls[i].fl_in);
+            if (fls[i].fl_out)
+                cbuf_free(fls[i].fl_out);
+        }
+        free(fls);
+    }
+    if (fds)
+        free(fds);
+    if (lat)
+        free(lat);
+    if (cbp)
+        cbuf_free(cbp);
+    if (req)
+        cbuf_free(req);
+    return retval;
+}
@@ -50,6 +50,7 @@
 #include <stdint.h>
 #include <syslog.h>
 #include <signal.h>
+#include <sys/time.h>
 
 /* cligen */
 #include <cligen/cligen.h>
@@ -65,6 +66,8 @@
  gcc -g -o json -I. -I../clixon ./clixon_json.c -lclixon -lcligen
  * Example run:
     echo '{"foo": -23}' | ./json
+ * Example benchmark, parse and encode 100 times:
+    ./json -t 100 < file.json
 */
 static int
 usage(char *argv0)
@@ -76,11 +79,90 @@ usage(char *argv0)
             "\t-j \t\tOutput as JSON (default is as XML)\n"
             "\t-l <s|e|o> \tLog on (s)yslog, std(e)rr, std(o)ut (stderr is default)\n"
             "\t-p \t\tPretty-print output\n"
+            "\t-t <nr> \tBenchmark: parse and encode input <nr> times, print MB/s\n"
             "\t-y <filename> \tyang filename to parse (must be stand-alone)\n"      ,
             argv0);
     exit(0);
 }
 
+/*! Parse and encode JSON input a number of times and print throughput
+ *
+ * @param[in]  fp     Input file
+ * @param[in]  yspec  Yang spec, or NULL
+ * @param[in]  nr     Number of iterations
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+json_benchmark(FILE      *fp,
+               yang_stmt *yspec,
+               int        nr)
+{
+    int            retval = -1;
+    cbuf          *cbin = NULL;
+    cbuf          *cbout = NULL;
+    cxobj         *xt = NULL;
+    cxobj         *xerr = NULL;
+    char           buf[8192];
+    size_t         len;
+    size_t         outlen = 0;
+    struct timeval t0;
+    struct timeval t1;
+    struct timeval td;
+    struct timeval tparse = {0,};
+    struct timeval tencode = {0,};
+    double         secs;
+    int            ret;
+    int            i;
+
+    if ((cbin = cbuf_new()) == NULL || (cbout = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    while ((len = fread(buf, 1, sizeof(buf), fp)) > 0)
+        cbuf_append_buf(cbin, buf, len);
+    for (i=0; i<nr; i++){
+        gettimeofday(&t0, NULL);
+        if ((ret = clixon_json_parse_string(cbuf_get(cbin), yspec?1:0, yspec?YB_MODULE:YB_NONE,
+                                            yspec, &xt, &xerr)) < 0)
+            goto done;
+        gettimeofday(&t1, NULL);
+        if (ret == 0){
+            xml_print(stderr, xerr);
+            goto done;
+        }
+        timersub(&t1, &t0, &td);
+        timeradd(&tparse, &td, &tparse);
+        cbuf_reset(cbout);
+        gettimeofday(&t0, NULL);
+        if (clixon_json2cbuf(cbout, xt, 0, 1, 0) < 0)
+            goto done;
+        gettimeofday(&t1, NULL);
+        timersub(&t1, &t0, &td);
+        timeradd(&tencode, &td, &tencode);
+        outlen += cbuf_len(cbout);
+        xml_free(xt);
+        xt = NULL;
+    }
+    secs = tparse.tv_sec + tparse.tv_usec/1000000.0;
+    fprintf(stdout, "parse: %zu bytes x %d: %.3f s %.1f MB/s\n",
+            cbuf_len(cbin), nr, secs, secs>0?(double)cbuf_len(cbin)*nr/secs/1000000:0);
+    secs = tencode.tv_sec + tencode.tv_usec/1000000.0;
+    fprintf(stdout, "encode: %zu bytes x %d: %.3f s %.1f MB/s\n",
+            nr?outlen/nr:0, nr, secs, secs>0?(double)outlen/secs/1000000:0);
+    retval = 0;
+ done:
+    if (xt)
+        xml_free(xt);
+    if (xerr)
+        xml_free(xerr);
+    if (cbin)
+        cbuf_free(cbin);
+    if (cbout)
+        cbuf_free(cbout);
+    return retval;
+}
+
 int
 main(int    argc,
      char **argv)
@@ -97,10 +179,11 @@ main(int    argc,
     int        ret;
     int        pretty = 0;
     int        dbg = 0;
+    int        bench = 0;
     
     optind = 1;
     opterr = 0;
-    while ((c = getopt(argc, argv, "hD:jl:py:")) != -1)
+    while ((c = getopt(argc, argv, "hD:jl:pt:y:")) != -1)
         switch (c) {
         case 'h':
             usage(argv[0]);
@@ -119,6 +202,10 @@ main(int    argc,
         case 'p':
             pretty++;
             break;
+        case 't':
+            if (sscanf(optarg, "%d", &bench) != 1)
+                usage(argv[0]);
+            break;
         case 'y':
             yang_filename = optarg;
             break;
@@ -137,6 +224,12 @@ main(int    argc,
             return -1;
         }
     }
+    if (bench){
+        if (json_benchmark(stdin, yspec, bench) < 0)
+            goto done;
+        retval = 0;
+        goto done;
+    }
     if ((ret = clixon_json_parse_file(stdin, yspec?1:0, yspec?YB_MODULE:YB_NONE, yspec, &xt, &xerr)) < 0)
         goto done;
     if (ret == 0){
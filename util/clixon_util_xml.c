@@ -67,7 +67,7 @@
 #include "clixon/clixon.h"
 
 /* Command line options passed to getopt(3) */
-#define UTIL_XML_OPTS "hD:f:JjXl:pvoy:Y:t:T:u"
+#define UTIL_XML_OPTS "hD:f:JjXl:pvoy:Y:t:T:uc:"
 
 static int
 validate_tree(clicon_handle h,
@@ -108,6 +108,44 @@ validate_tree(clicon_handle h,
     return retval;
 }
 
+/*! Parse XML by pushing input in fixed size chunks to the streaming parser
+ *
+ * Used to check that parsing does not depend on where input is split
+ */
+static int
+parse_chunked(FILE      *fp,
+              int        chunk,
+              yang_bind  yb,
+              yang_stmt *yspec,
+              cxobj    **xt,
+              cxobj    **xerr)
+{
+    int             retval = -1;
+    clixon_xml_sax *xs = NULL;
+    char           *buf = NULL;
+    size_t          len;
+
+    if ((buf = malloc(chunk)) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    if (*xt == NULL &&
+        (*xt = xml_new(XML_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
+        goto done;
+    if ((xs = clixon_xml_sax_new(yb, yspec, *xt)) == NULL)
+        goto done;
+    while ((len = fread(buf, 1, chunk, fp)) > 0)
+        if (clixon_xml_sax_push(xs, buf, len) < 0)
+            goto done;
+    retval = clixon_xml_sax_end(xs, xerr);
+ done:
+    if (xs)
+        clixon_xml_sax_free(xs);
+    if (buf)
+        free(buf);
+    return retval;
+}
+
 static int
 usage(char *argv0)
 {
@@ -128,6 +166,7 @@ usage(char *argv0)
             "\t-t <file>\tXML top input file (where base tree is pasted to)\n"
             "\t-T <path>\tXPath to where in top input file base should be pasted\n"
             "\t-u \t\tTreat unknown XML as anydata\n"
+            "\t-c <bytes>\tPush XML input in chunks of <bytes> to streaming parser\n"
             ,
             argv0);
     exit(0);
@@ -166,6 +205,7 @@ main(int    argc,
     cvec         *nsc = NULL; 
     yang_bind     yb;
     int           dbg = 0;
+    int           chunk = 0;
 
     /* In the startup, logs to stderr & debug flag set later */
     clicon_log_init(__FILE__, LOG_INFO, CLICON_LOG_STDERR); 
@@ -232,6 +272,10 @@ main(int    argc,
                 goto done;
             xml_bind_yang_unknown_anydata(1);
             break;
+        case 'c':
+            if ((chunk = atoi(optarg)) <= 0)
+                usage(argv[0]);
+            break;
         default:
             usage(argv[0]);
             break;
@@ -316,7 +360,11 @@ main(int    argc,
             yb = YB_MODULE;
         else
             yb = YB_PARENT;
-        if ((ret = clixon_xml_parse_file(fp, yb, yspec, &xt, &xerr)) < 0){
+        if (chunk)
+            ret = parse_chunked(fp, chunk, yb, yspec, &xt, &xerr);
+        else
+            ret = clixon_xml_parse_file(fp, yb, yspec, &xt, &xerr);
+        if (ret < 0){
             fprintf(stderr, "xml parse error: %s\n", clicon_err_reason);
             goto done;
         }
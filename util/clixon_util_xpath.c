@@ -52,6 +52,7 @@ See https://www.w3.org/TR/xpath/
 #include <fcntl.h>
 #include <signal.h>
 #include <sys/stat.h>
+#include <sys/time.h>
 
 /* cligen */
 #include <cligen/cligen.h>
@@ -60,7 +61,7 @@ See https://www.w3.org/TR/xpath/
 #include "clixon/clixon.h"
 
 /* Command line options to be passed to getopt(3) */
-#define XPATH_OPTS "hD:f:p:i:In:cl:y:Y:"
+#define XPATH_OPTS "hD:f:p:i:In:ct:l:y:Y:"
 
 static int
 usage(char *argv0)
@@ -75,6 +76,7 @@ usage(char *argv0)
             "\t-I \t\tCheck inverse, map back xml result to xpath and check if equal\n"
             "\t-n <pfx:id>\tNamespace binding (pfx=NULL for default)\n"
             "\t-c \t\tMap xpath to canonical form\n"
+            "\t-t <nr> \tBenchmark: evaluate xpath as boolean <nr> times, interpreted and compiled\n"
             "\t-l <s|e|o|f<file>> \tLog on (s)yslog, std(e)rr, std(o)ut or (f)ile (stderr is default)\n"
             "\t-y <filename> \tYang filename or dir (load all files)\n"
             "\t-Y <dir> \tYang dirs (can be several)\n"
@@ -118,6 +120,62 @@ ctx_print2(cbuf   *cb,
     return retval;
 }
 
+/*! Evaluate xpath as boolean a number of times with interpreter and compiled xpath
+ *
+ * Print results and times. It is an error if the results differ.
+ * @param[in]  x      XML context node
+ * @param[in]  nsc    Namespace context
+ * @param[in]  xpath  XPath
+ * @param[in]  nr     Number of iterations
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @see xpath_compile
+ */
+static int
+xpath_benchmark(cxobj *x,
+                cvec  *nsc,
+                char  *xpath,
+                int    nr)
+{
+    int             retval = -1;
+    xpath_compiled *xpc = NULL;
+    struct timeval  t0;
+    struct timeval  t1;
+    struct timeval  td;
+    int             b0 = 0;
+    int             b1 = 0;
+    int             i;
+
+    if (xpath_compile(xpath, nsc, &xpc) < 0)
+        goto done;
+    gettimeofday(&t0, NULL);
+    for (i=0; i<nr; i++)
+        if ((b0 = xpath_vec_bool(x, nsc, "%s", xpath)) < 0)
+            goto done;
+    gettimeofday(&t1, NULL);
+    timersub(&t1, &t0, &td);
+    fprintf(stdout, "interpreted: %s %d x: %.3f s\n",
+            b0?"true":"false", nr, td.tv_sec + td.tv_usec/1000000.0);
+    gettimeofday(&t0, NULL);
+    for (i=0; i<nr; i++)
+        if ((b1 = xpath_compiled_bool(xpc, x)) < 0)
+            goto done;
+    gettimeofday(&t1, NULL);
+    timersub(&t1, &t0, &td);
+    fprintf(stdout, "compiled(%s): %s %d x: %.3f s\n",
+            xpath_compiled_native(xpc)?"native":"interpreter",
+            b1?"true":"false", nr, td.tv_sec + td.tv_usec/1000000.0);
+    if (b0 != b1){
+        fprintf(stderr, "Error: compiled xpath result differs from interpreter\n");
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (xpc)
+        xpath_compiled_free(xpc);
+    return retval;
+}
+
 int
 main(int    argc,
      char **argv)
@@ -149,6 +207,7 @@ main(int    argc,
     int         logdst = CLICON_LOG_STDERR;
     int         dbg = 0;
     int         xpath_inverse = 0;
+    int         bench = 0;
 
     /* In the startup, logs to stderr & debug flag set later */
     clicon_log_init("xpath", LOG_DEBUG, logdst); 
@@ -211,6 +270,10 @@ main(int    argc,
         case 'c': /* Map namespace to canonical form */
             canonical = 1;
             break;
+        case 't': /* Benchmark compiled xpath */
+            if (sscanf(optarg, "%d", &bench) != 1)
+                usage(argv0);
+            break;
         case 'l': /* Log destination: s|e|o|f */
             if ((logdst = clicon_log_opt(optarg[0])) < 0)
                 usage(argv[0]);
@@ -367,6 +430,11 @@ main(int    argc,
     }
     else
         x = x0;
+    if (bench){
+        if (xpath_benchmark(x, nsc, xpath, bench) < 0)
+            goto done;
+        goto ok;
+    }
 #if 0 // filter syntax errors
     {
         xpath_tree *xptree = NULL;